@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include <Math/XMath.h>
+#include <Utils/MeshUtility.h>
 
 class MeshData;
 
@@ -28,9 +29,23 @@ private:
 	~MeshFilter() override;
 
 	MeshData* m_pSharedMesh = nullptr;
+	// 共享网格由ResourceManager缓存时持有其引用
+	std::shared_ptr<MeshData> m_pSharedMeshRef;
 	std::unique_ptr<MeshData> m_pMesh = nullptr;
 };
 
+// 网格中的一段索引区间
+struct SubMeshDescriptor
+{
+	uint32_t indexStart = 0;
+	uint32_t indexCount = 0;
+	// 绘制时加到每个索引上的值，用于让超过65536个顶点的网格也能使用16位索引
+	uint32_t baseVertex = 0;
+	// 该区间所引用顶点的包围盒
+	XMath::Vector3 vMin = {};
+	XMath::Vector3 vMax = {};
+};
+
 class MeshData
 {
 public:
@@ -48,9 +63,44 @@ public:
 	XMath::Vector3 vMin = {};
 	XMath::Vector3 vMax = {};
 
+	// 子网格，为空时整个索引缓冲区作为一个子网格
+	std::vector<SubMeshDescriptor> subMeshes;
+	// 簇，非空时绘制前逐簇做视锥体与背面剔除
+	std::vector<MeshUtility::Meshlet> meshlets;
+
 	void UpdateBoundingData();
 
+	// 顶点属性、索引与子网格的内容哈希，用于查找内容相同的网格
+	uint64_t ComputeContentHash() const;
+	// 顶点属性、索引与子网格是否完全相同
+	bool HasSameContent(const MeshData& other) const;
+	// 顶点属性与索引占用的字节数
+	size_t GetByteSize() const;
+
+	// 重排三角形以提高变换后顶点缓存的命中率并减少过度绘制，再按使用顺序重排顶点
+	// 应在上传到GPU之前调用。pBefore/pAfter输出优化前后的顶点缓存统计
+	// parallel为true时各子网格在线程池中并行处理，已在线程池任务中(如按网格并行)调用时应传入false
+	void Optimize(MeshUtility::VertexCacheStatistics* pBefore = nullptr, MeshUtility::VertexCacheStatistics* pAfter = nullptr,
+		bool parallel = true);
+
+	// 将各子网格划分为簇并按簇重排三角形。重排索引的操作会清除已有的簇，应在OptimizeIndexFormat之后调用
+	// parallel的含义与Optimize相同
+	void BuildMeshlets(uint32_t maxVertices = 64, uint32_t maxTriangles = 124, bool parallel = true);
+
+	// 在所有索引都能用16位表示时将索引缩减为16位，返回当前是否为16位索引
+	// allowSplit为true时，顶点过多的网格会被划分为使用baseVertex的子网格(网格原本没有子网格时)
+	bool OptimizeIndexFormat(bool allowSplit = false);
+
+	// 动态顶点的缓冲区容量按2倍增长，修改顶点后需调用UploadMeshData或MarkVertexRangeDirty，
+	// 只有被标记的顶点区间会经由每帧的上传缓冲区拷贝到GPU
 	void MarkVertexDynamic(bool isDynamic = true);
+	// 标记[vertexStart, vertexStart + vertexCount)的顶点属性需要重新上传，仅对动态顶点有效
+	void MarkVertexRangeDirty(uint32_t vertexStart, uint32_t vertexCount);
+	// 上传时将所有属性交错到一个顶点缓冲区中
+	void MarkVertexInterleaved(bool isInterleaved = true);
+	// 上传时压缩顶点属性：法线/切线使用snorm16(着色器以float2声明NORMAL时使用八面体编码)，
+	// 纹理坐标使用half，颜色使用unorm8。位置保持float
+	void MarkVertexCompressed(bool isCompressed = true);
 
 	void UploadMeshData();
 private:
@@ -67,4 +117,11 @@ private:
 	bool m_IsUploading = true;				// 默认缓冲区需要重建Buffer
 											// 动态顶点缓冲区仅大小增加时重建Buffer
 	bool m_IsDynamicVertex = false;			// 使用动态顶点缓冲区标记为true
+	bool m_IsInterleavedVertex = false;		// 交错存放顶点属性标记为true
+	bool m_IsCompressedVertex = false;		// 压缩顶点属性标记为true
+	uint32_t m_VertexFormat = 0;			// 已创建顶点缓冲区的格式 1|0
+											//                         c|i|
+
+	bool m_IsVertexDirty = true;			// 所有顶点需要上传
+	std::vector<std::pair<uint32_t, uint32_t>> m_DirtyVertexRanges;	// 需要上传的顶点区间[start, end)，有序且不相交
 };
\ No newline at end of file
@@ -6,17 +6,19 @@
 #include <memory>
 #include <map>
 #include <unordered_map>
-#include <variant>
 #include <XCore.h>
 
 class Shader;
+class MeshData;
+struct MaterialCBufferCache;
 
 class MaterialPropertyBlock
 {
 public:
-	using Property = std::variant<
-		int, float, XMath::Vector4, Color, XMath::Matrix4x4,
-		std::vector<XMath::Vector4>, std::vector<XMath::Matrix4x4>>;
+	enum class PropertyType : uint8_t
+	{
+		Int, Float, Vector, Color, Matrix, VectorArray, MatrixArray
+	};
 
 	void SetInt(std::string_view name, int value);
 	void SetInt(size_t propertyId, int value);
@@ -40,11 +42,36 @@ public:
 	void SetMatrixArray(size_t propertyId, const std::vector<XMath::Matrix4x4>& value);
 
 	bool HasProperty(std::string_view name) const;
+	bool HasProperty(size_t propertyId) const;
+
+	// 预留属性数目与数据字节数，之后的Set*不再分配内存
+	void Reserve(size_t propertyCount, size_t byteCount);
+	// 清空所有属性，保留已分配的内存
+	void Clear();
 
 private:
+	// 按id排序存放，值保存在m_Payload的[offset, offset + byteWidth)中
+	struct Entry
+	{
+		size_t id;
+		uint32_t offset;
+		uint32_t byteWidth;
+		uint32_t capacity;
+		PropertyType type;
+	};
+
+	void SetRaw(size_t propertyId, PropertyType type, const void* data, uint32_t byteWidth);
+	const Entry* FindEntry(size_t propertyId) const;
+	void MarkDirty();
+
 	friend class CommandBuffer;
 
-	std::unordered_map<size_t, Property> m_Properties;
+	std::vector<Entry> m_Entries;
+	std::vector<uint8_t> m_Payload;
+	// 因数组变长而废弃的字节数，过多时整理
+	uint32_t m_WastedBytes = 0;
+	// 每次修改都会取一个全局递增的值，内容相同的副本版本号也相同
+	uint64_t m_Version = 0;
 };
 
 class Material
@@ -83,12 +110,27 @@ public:
 	void SetShader(Shader* pShader);
 	Shader* GetShader();
 
+	// 启用的关键字决定使用着色器的哪个变体。变体在首次使用时于后台编译，完成前使用默认变体
+	void EnableKeyword(std::string_view keyword);
+	void DisableKeyword(std::string_view keyword);
+	bool IsKeywordEnabled(std::string_view keyword) const;
+
 private:
 	friend class CommandBuffer;
+
+	// 按当前关键字查找变体并记录，仅允许在主线程调用
+	Shader* ResolveShader();
+	// 最近一次解析出的变体，可在工作线程调用
+	Shader* GetActiveShader() const { return m_pActiveShader ? m_pActiveShader : m_pShader; }
 	
 	Shader* m_pShader = nullptr;
+	Shader* m_pActiveShader = nullptr;
+	// 已启用关键字的id，升序排列
+	std::vector<size_t> m_KeywordIds;
 	std::map<size_t, std::string> m_Textures;
 	MaterialPropertyBlock m_PropertyBlock;
+	// 按着色器反射布局烘焙好的常量缓冲区数据，着色器或属性版本变化时重建
+	std::shared_ptr<MaterialCBufferCache> m_pCBufferCache;
 };
 
 class MeshRenderer : public Component
@@ -111,12 +153,17 @@ public:
 	void SetCastShadows(bool enabled);
 	bool GetCastShadows() const;
 
+	// 是否已被合并到静态合批的网格中
+	bool IsStaticBatched() const { return m_pStaticBatchMesh != nullptr; }
+
 private:
 	~MeshRenderer() override;
 
 private:
 	friend class ResourceManager;
 	friend class Scene;
+	friend class StaticBatching;
+	friend class RenderContext;
 
 
 	std::vector<std::unique_ptr<Material>> m_pMaterials;
@@ -124,4 +171,8 @@ private:
 	std::vector<MaterialPropertyBlock*> m_pMaterialPropertyBlocks;
 	bool m_CastShadows = true;
 	bool m_ReceivedShadows = true;
+
+	// 静态合批后使用的合并网格及其中属于本物体的子网格
+	MeshData* m_pStaticBatchMesh = nullptr;
+	uint32_t m_StaticBatchSubMesh = 0;
 };
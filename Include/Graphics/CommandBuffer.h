@@ -9,6 +9,7 @@ class Material;
 class MaterialPropertyBlock;
 class MeshData;
 class GameObject;
+class RenderTexture;
 
 class CommandBuffer
 {
@@ -22,8 +23,10 @@ public:
     void SetViewport(const Rect& rect);
     void SetViewMatrix(const XMath::Matrix4x4& matrix);
     void SetProjMatrix(const XMath::Matrix4x4& matrix);
-    // need to be implemented after renderTexture implements.
+    // 设置为后备缓冲区
     void SetRenderTarget();
+    // pRenderTexture为nullptr时表示后备缓冲区。之后的ClearRenderTarget和SetViewport都针对该目标
+    void SetRenderTarget(RenderTexture* pRenderTexture);
 
 
 private:
@@ -4,9 +4,11 @@
 
 #include <XCore.h>
 #include <memory>
+#include <vector>
 #include <Graphics/CommandBuffer.h>
 
 class Camera;
+class RenderTexture;
 
 // Get From Camera
 class DrawingData
@@ -34,8 +36,17 @@ public:
     void DrawSkybox(Camera& pCamera);
     
     void SetupCameraProperties(Camera& camera);
+    // 设置之后绘制使用的渲染目标，nullptr表示后备缓冲区
+    void SetRenderTarget(RenderTexture* pRenderTexture);
     void ExecuteCommandBuffer(CommandBuffer& commandBuffer);
     void DrawGameObject(GameObject* pObject);
+    // 绘制多个物体(包含子物体)。开启并行录制后，绘制列表会被分块交给工作线程录制，
+    // 得到的命令列表按分块顺序执行，因此绘制顺序与串行录制一致
+    void DrawGameObjects(const std::vector<GameObject*>& pObjects);
+
+    // workerCount为0时关闭并行录制
+    void SetParallelRecording(uint32_t workerCount);
+    uint32_t GetParallelRecordingWorkerCount() const;
 
     void Submit();
 
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Graphics/RenderTexture.h>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+class RenderContext;
+class RenderGraph;
+
+// 图中纹理资源的句柄，仅在当前帧的图中有效
+struct RenderGraphTexture
+{
+    uint32_t index = UINT32_MAX;
+
+    bool IsValid() const { return index != UINT32_MAX; }
+};
+
+// Pass在Setup阶段通过Builder声明要创建、读取和写入的资源
+class RenderGraphBuilder
+{
+public:
+    // 创建一个瞬态纹理，由图负责分配，生命周期不重叠的同描述纹理会共用同一个RenderTexture
+    RenderGraphTexture CreateTexture(std::string_view name, const RenderTextureDesc& desc);
+    RenderGraphTexture Read(RenderGraphTexture texture);
+    RenderGraphTexture Write(RenderGraphTexture texture);
+    // 标记该Pass具有副作用，即使输出无人读取也不会被剔除
+    void SetSideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderGraphBuilder(RenderGraph& graph, uint32_t passIndex);
+
+    RenderGraph& m_Graph;
+    uint32_t m_PassIndex;
+};
+
+class RenderGraph
+{
+public:
+    using SetupFunc = std::function<void(RenderGraphBuilder&)>;
+    using ExecuteFunc = std::function<void(RenderGraph&, RenderContext&)>;
+
+    struct Statistics
+    {
+        uint32_t passCount = 0;
+        uint32_t culledPassCount = 0;
+        uint32_t transientTextureCount = 0;
+        uint32_t physicalTextureCount = 0;
+        // 不复用时瞬态纹理的总显存
+        uint64_t transientBytesWithoutAliasing = 0;
+        // 复用后实际分配的瞬态纹理显存
+        uint64_t transientBytes = 0;
+        // 同时存活的瞬态纹理显存的最大值
+        uint64_t peakLiveBytes = 0;
+    };
+
+    RenderGraph();
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // 导入外部创建的纹理，写入导入纹理的Pass不会被剔除
+    RenderGraphTexture ImportTexture(std::string_view name, RenderTexture* pTexture);
+    // 导入后备缓冲区，GetTexture返回nullptr，传给SetRenderTarget时表示后备缓冲区
+    RenderGraphTexture ImportBackBuffer();
+
+    void AddPass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute);
+
+    // 剔除Pass，计算生命周期并为瞬态纹理分配物理资源
+    void Compile();
+    // 按顺序执行未被剔除的Pass
+    void Execute(RenderContext& context);
+    // 清空本帧的Pass与资源，开始构建新的一帧。物理纹理由RenderTexturePool跨帧复用
+    void Reset();
+
+    // 仅在Execute期间有效
+    RenderTexture* GetTexture(RenderGraphTexture texture) const;
+    bool IsPassCulled(std::string_view name) const;
+    const Statistics& GetStatistics() const;
+
+private:
+    friend class RenderGraphBuilder;
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
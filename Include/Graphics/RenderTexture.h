@@ -0,0 +1,106 @@
+#pragma once
+
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <cstdint>
+#include <string>
+
+enum class ShadowSamplingMode
+{
+    None,
+    CompareDepths,
+    RawDepth
+};
+
+// 创建RenderTexture所需的全部参数
+struct RenderTextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depthBits = 0;
+    DXGI_FORMAT colorFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+    uint32_t msaaLevel = 1;
+    bool useMipmaps = false;
+    bool useRandomWrite = false;
+    bool bindTextureMS = false;
+    ShadowSamplingMode shadowSamplingMode = ShadowSamplingMode::None;
+
+    size_t GetHash() const;
+    // 估算显存占用(字节)
+    uint64_t GetByteSize() const;
+
+    bool operator==(const RenderTextureDesc& rhs) const;
+    bool operator!=(const RenderTextureDesc& rhs) const { return !(*this == rhs); }
+};
+
+class RenderTexture
+{
+public:
+    template<class T>
+    using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    RenderTexture(uint32_t width, uint32_t height, uint32_t depthBits = 24,
+        DXGI_FORMAT colorFormat = DXGI_FORMAT_R8G8B8A8_UNORM, bool enableRW = false);
+    RenderTexture(const RenderTextureDesc& desc);
+    ~RenderTexture() = default;
+
+    RenderTexture(const RenderTexture&) = delete;
+    RenderTexture& operator=(const RenderTexture&) = delete;
+
+    void SetTextureSize(uint32_t width, uint32_t height);
+    void SetAntiAliasingLevel(uint32_t level);
+    void SetMipmapsEnabled(bool enable);
+    void SetRandomWriteEnabled(bool enable);
+    void SetBindMultiSampleTextureEnabled(bool enable);
+    void SetColorBufferFormat(DXGI_FORMAT format);
+    void SetDepthBits(uint32_t depthBits);
+    void SetShadowSamplingMode(ShadowSamplingMode mode);
+
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    uint32_t GetDepthBits() const { return m_DepthBits; }
+    DXGI_FORMAT GetColorBufferFormat() const { return m_ColorFormat; }
+    uint32_t GetAntiAliasingLevel() const { return m_MsaaLevel; }
+    RenderTextureDesc GetDesc() const;
+
+    HRESULT Create(ID3D11Device* pDevice);
+    void Clear();
+    HRESULT CreateFromSwapChain(ID3D11Device* pDevice, ID3D11Texture2D* pBackBuffer);
+
+    void GenerateMips(ID3D11DeviceContext* deviceContext);
+    void ResolveAntiAliasedSurface(ID3D11DeviceContext* deviceContext);
+
+    ID3D11ShaderResourceView* GetColorBufferSRV();
+    ID3D11RenderTargetView* GetColorBufferRTV();
+    ID3D11UnorderedAccessView* GetColorBufferUAV();
+    ID3D11ShaderResourceView* GetDepthBufferSRV();
+    ID3D11DepthStencilView* GetDepthBufferDSV();
+
+    void SetDebugObjectName(const std::string& name);
+
+    static bool DepthStencilFormats(uint32_t depthBits, DXGI_FORMAT& depthBufferFormat, DXGI_FORMAT& depthSRVFormat, DXGI_FORMAT& depthDSVFormat);
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_DepthBits;
+    DXGI_FORMAT m_ColorFormat;
+    bool m_UseRandomWrite;
+    uint32_t m_MsaaLevel = 1;
+    bool m_UseMipmaps = false;
+    bool m_BindTextureMS = false;
+    ShadowSamplingMode m_ShadowSamplingMode = ShadowSamplingMode::None;
+
+    ComPtr<ID3D11Texture2D> m_pColorBuffer;
+    ComPtr<ID3D11Texture2D> m_pColorBufferMS;
+    ComPtr<ID3D11Texture2D> m_pDepthBuffer;
+
+    ComPtr<ID3D11RenderTargetView> m_pColorBufferRTV;
+    ComPtr<ID3D11ShaderResourceView> m_pColorBufferSRV;
+    ComPtr<ID3D11UnorderedAccessView> m_pColorBufferUAV;
+    ComPtr<ID3D11RenderTargetView> m_pColorBufferMSRTV;
+    ComPtr<ID3D11ShaderResourceView> m_pColorBufferMSSRV;
+
+    ComPtr<ID3D11ShaderResourceView> m_pDepthBufferSRV;
+    ComPtr<ID3D11DepthStencilView> m_pDepthBufferDSV;
+};
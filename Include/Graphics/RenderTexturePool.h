@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Graphics/RenderTexture.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// 临时RenderTexture池，按描述复用已创建的纹理
+// 归还后连续若干帧没有被再次取用的纹理会被释放
+// 仅在主线程使用
+class RenderTexturePool
+{
+public:
+    struct Statistics
+    {
+        // 从池中取到已有纹理的次数
+        uint64_t hitCount = 0;
+        // 需要新建纹理的次数
+        uint64_t missCount = 0;
+        // 因长时间未使用而被释放的纹理数
+        uint64_t evictedCount = 0;
+        // 当前被借出的纹理数
+        uint32_t activeCount = 0;
+        // 当前池中空闲的纹理数与显存估算
+        uint32_t pooledCount = 0;
+        uint64_t pooledBytes = 0;
+    };
+
+    RenderTexturePool(ID3D11Device* device);
+    ~RenderTexturePool();
+
+    RenderTexturePool(const RenderTexturePool&) = delete;
+    RenderTexturePool& operator=(const RenderTexturePool&) = delete;
+
+    static RenderTexturePool& Get();
+
+    // 获取一个符合描述的纹理，用完后需调用ReleaseTemporary归还
+    RenderTexture* GetTemporary(const RenderTextureDesc& desc);
+    void ReleaseTemporary(RenderTexture* pTexture);
+
+    // 每帧结束时调用，释放超过maxUnusedFrames帧未被使用的空闲纹理
+    void EndFrame();
+    // 释放所有空闲纹理，借出的纹理不受影响
+    void ReleaseUnused();
+
+    void SetMaxUnusedFrames(uint32_t frames) { m_MaxUnusedFrames = frames; }
+    uint32_t GetMaxUnusedFrames() const { return m_MaxUnusedFrames; }
+
+    const Statistics& GetStatistics() const { return m_Statistics; }
+    void ResetStatistics();
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<RenderTexture> pTexture;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    ID3D11Device* m_pDevice;
+    uint64_t m_FrameIndex = 0;
+    uint32_t m_MaxUnusedFrames = 3;
+
+    // 空闲纹理，按描述哈希分组，组内越靠后越近使用过
+    std::unordered_map<size_t, std::vector<Entry>> m_FreeEntries;
+    std::unordered_map<RenderTexture*, std::unique_ptr<RenderTexture>> m_pActiveTextures;
+
+    Statistics m_Statistics;
+};
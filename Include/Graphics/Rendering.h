@@ -4,6 +4,8 @@
 #include <Graphics/ResourceManager.h>
 #include <Graphics/Shader.h>
 #include <Graphics/RenderPipeline.h>
+#include <Graphics/RenderGraph.h>
+#include <Graphics/StaticBatching.h>
 // TODO LIST:
 // [ ] Mouse mode switching problem.
 // [ ] ImGui support.
@@ -5,6 +5,8 @@
 #include <wrl/client.h>
 #include <d3d11_1.h>
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 #include <Hierarchy/GameObject.h>
 // Add all components here
@@ -25,18 +27,58 @@ struct MeshGraphicsResource
 		if (indexBuffer) indexBuffer->Release();
 	}
 
+	// 按顶点着色器的输入签名查找输入布局，未准备时返回nullptr
+	ID3D11InputLayout* FindInputLayout(uint64_t signatureHash) const
+	{
+		for (auto& entry : signatureInputLayouts)
+			if (entry.first == signatureHash)
+				return entry.second;
+		return nullptr;
+	}
+
 	std::vector<ID3D11Buffer*> vertexBuffers;
 	std::vector<uint32_t> strides;
 	std::vector<uint32_t> offsets;
 	ID3D11Buffer* indexBuffer = nullptr;
+	// 已上传的顶点属性，格式为压缩前的格式，槽位为属性的序号
 	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayouts;
+	// 顶点缓冲区实际的布局(压缩后的格式、交错后的槽位与偏移)及其哈希
+	std::vector<D3D11_INPUT_ELEMENT_DESC> streamElements;
+	uint64_t streamLayoutHash = 0;
+	// 已用过的顶点着色器签名哈希及对应的输入布局，输入布局由InputLayoutCache持有
+	// 在主线程准备时添加，录制时只读
+	std::vector<std::pair<uint64_t, ID3D11InputLayout*>> signatureInputLayouts;
 	
 
 };
 
+// 基本几何体网格的生成参数，参数相同的几何体共享同一个网格
+struct PrimitiveMeshDesc
+{
+	enum class Type : uint32_t { Box, Sphere, Cylinder, Plane };
+
+	Type type = Type::Box;
+	float params[4] = {};			// Box: width/height/depth  Sphere: radius  Cylinder: radius/height  Plane: width/depth
+	uint32_t counts[2] = {};		// Sphere: levels/slices  Cylinder: slices/stacks
+
+	static PrimitiveMeshDesc Box(float width = 2.0f, float height = 2.0f, float depth = 2.0f);
+	static PrimitiveMeshDesc Sphere(float radius = 1.0f, uint32_t levels = 20, uint32_t slices = 20);
+	static PrimitiveMeshDesc Cylinder(float radius = 1.0f, float height = 2.0f, uint32_t slices = 20, uint32_t stacks = 10);
+	static PrimitiveMeshDesc Plane(float width = 10.0f, float depth = 10.0f);
+
+	bool operator<(const PrimitiveMeshDesc& rhs) const;
+};
+
 class ResourceManager
 {
 public:
+	struct MeshRegistryStatistics
+	{
+		size_t uniqueMeshCount = 0;		// 已注册且仍被引用的网格数
+		size_t duplicateMeshCount = 0;	// 被合并到已有网格的重复网格数
+		size_t savedBytes = 0;			// 重复网格本应占用的顶点与索引字节数(CPU与GPU各一份)
+	};
+
 	ResourceManager(ID3D11Device* device);
 	~ResourceManager();
 
@@ -53,6 +95,15 @@ public:
 	MeshGraphicsResource* FindMeshGraphicsResources(MeshData* ptr);
 	void DestroyMeshGraphicsResources(MeshData* ptr);
 
+	// 获取参数对应的基本几何体网格，不存在时生成。网格在最后一个引用释放时销毁，其GPU资源一并释放
+	std::shared_ptr<MeshData> GetPrimitiveMesh(const PrimitiveMeshDesc& desc);
+	size_t GetPrimitiveMeshCount() const { return m_PrimitiveMeshes.size(); }
+
+	// 按内容去重的网格注册表：已有内容相同的网格时返回它并丢弃pMeshData，否则接管pMeshData。
+	// 返回的网格在最后一个引用释放时销毁，其GPU资源一并释放
+	std::shared_ptr<MeshData> RegisterMesh(std::unique_ptr<MeshData> pMeshData);
+	const MeshRegistryStatistics& GetMeshRegistryStatistics() const { return m_MeshRegistryStatistics; }
+
 	Material* CreateMaterial(std::string_view path);
 	Material* FindMaterial(std::string_view path);
 	
@@ -70,4 +121,11 @@ private:
 	std::map<std::string, Material> m_pMaterials;
 
 	std::map<MeshData*, MeshGraphicsResource> m_MeshGraphicsResources;
+
+	// 仍被引用的基本几何体网格
+	std::map<PrimitiveMeshDesc, std::weak_ptr<MeshData>> m_PrimitiveMeshes;
+
+	// 注册的网格，按内容哈希索引
+	std::unordered_multimap<uint64_t, std::weak_ptr<MeshData>> m_RegisteredMeshes;
+	MeshRegistryStatistics m_MeshRegistryStatistics;
 };
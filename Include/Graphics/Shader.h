@@ -17,6 +17,7 @@
 #include <string_view>
 #include <XCore.h>
 #include <Math/XMath.h>
+#include <Utils/Hash.h>
 
 struct ID3D11ShaderResourceView;
 
@@ -25,14 +26,71 @@ class Shader
 public:
 	using ShaderTagId = size_t;
 
-	static size_t StringToID(std::string_view str)
+	struct CompileStatistics
 	{
-		static std::hash<std::string_view> hash;
-		return hash(str);
+		uint32_t compiledCount = 0;		// 重新编译的入口点数
+		uint32_t cachedCount = 0;		// 从.cso缓存读取的入口点数
+		uint32_t archivedCount = 0;		// 从着色器归档读取的入口点数
+		uint32_t reflectedCount = 0;	// 缺少反射缓存而调用D3DReflect的入口点数
+		double compileSeconds = 0.0;	// 并行读取与编译所有入口点的耗时
+		double totalSeconds = 0.0;		// 包括解析json、创建着色器与反射的总耗时
+	};
+
+	// 按常量缓冲区名称前缀约定的更新频率分组：PerFrame、PerCamera/PerView、PerMaterial、PerDraw/PerObject
+	// 未识别的名称归入每物体。材质烘焙的常量缓冲区计入每材质
+	struct CBufferUploadStatistics
+	{
+		uint64_t perFrameBytes = 0;
+		uint64_t perCameraBytes = 0;
+		uint64_t perMaterialBytes = 0;
+		uint64_t perObjectBytes = 0;
+
+		// 各种上传方式的调用次数
+		uint64_t discardMapCount = 0;			// Map(WRITE_DISCARD)，包括帧常量缓冲区每页在每个命令列表中的第一次
+		uint64_t noOverwriteMapCount = 0;		// 在帧常量缓冲区中追加写入的Map(WRITE_NO_OVERWRITE)
+		uint64_t updateSubresourceCount = 0;	// DEFAULT缓冲区的(部分)更新
+
+		uint64_t TotalBytes() const { return perFrameBytes + perCameraBytes + perMaterialBytes + perObjectBytes; }
+	};
+
+	// 64位FNV-1a，结果与平台和标准库无关，可作为编译期常量：
+	// constexpr size_t s_BaseColorID = Shader::StringToID("x_BaseColor");
+	static constexpr size_t StringToID(std::string_view str)
+	{
+		static_assert(sizeof(size_t) == sizeof(uint64_t), "property id requires 64-bit size_t");
+		return static_cast<size_t>(Hash::FNV1a64(str));
 	}
-
+	// 计算id并记录其对应的字符串，与已记录的不同字符串冲突时抛出异常
+	// 着色器名、入口点、关键字与反射得到的所有属性名在InitFromJson时自动记录
+	static size_t RegisterPropertyName(std::string_view name);
+	// 返回id对应的已记录字符串，未记录时为空
+	static std::string_view GetPropertyName(size_t id);
+
+	// 映射着色器归档，之后的InitFromJson与变体编译优先从归档读取字节码与反射数据
+	// 文件不存在或格式不正确时返回false，继续使用各自的.cso
+	static bool LoadArchive(std::string_view archiveFile);
+	// 将本次运行中加载的所有入口点(包括已请求的变体)写入归档，用于离线生成发布使用的归档
+	static void WriteArchive(std::string_view archiveFile);
 	static void InitFromJson(std::string_view jsonFile, std::string_view recordFile = "");
+	// 监视已加载着色器的源文件及其包含的文件，修改后在后台重新编译受影响的入口点，并在下一帧开始时替换
+	static void EnableHotReload(bool enable);
 	static Shader* Find(std::string_view name);
+	// 最近一次InitFromJson的统计，删除所有.cso后的统计即冷启动的编译耗时
+	static const CompileStatistics& GetCompileStatistics();
+	// 上一帧上传到常量缓冲区的字节数
+	static const CBufferUploadStatistics& GetCBufferUploadStatistics();
+	// 每次绘制的常量数据是否从帧常量缓冲区中分配并以偏移方式绑定(默认开启，设备不支持时无效)
+	// 关闭后每个常量缓冲区各自Map(WRITE_DISCARD)，用于对比两种方式的上传次数
+	static void EnableConstantRing(bool enable);
+	static bool IsConstantRingEnabled();
+	// DEFAULT常量缓冲区是否只上传修改过的区间(默认开启，设备不支持部分更新时无效)
+	// 关闭后任何修改都上传整个缓冲区，用于对比CB Upload的字节数
+	static void EnableCBufferDirtyRanges(bool enable);
+	static bool IsCBufferDirtyRangesEnabled();
+
+	// 返回启用了给定关键字(StringToID的结果，升序排列)的变体，仅允许在主线程调用
+	// 变体在首次请求时于后台编译，完成前返回默认变体
+	Shader* GetVariant(const std::vector<size_t>& keywordIds);
 	
 
 	void Destroy();
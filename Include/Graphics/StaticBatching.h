@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Scene;
+
+// 静态合批：将场景中标记为静态、使用相同材质的物体预先变换到世界空间，
+// 合并到共享的顶点/索引缓冲区中。每个物体在合并网格中占据一个子网格，
+// 绘制时仍按子网格做视锥体剔除，相邻的可见子网格合并为一次绘制
+class StaticBatching
+{
+public:
+	// 单个合批的顶点数上限，保证可以使用16位索引
+	static constexpr uint32_t s_MaxVerticesPerBatch = 65535;
+
+	// 合并场景中的静态物体，返回生成的合批数目。会先撤销之前的合批
+	// 合批后静态物体的变换与网格的修改不会再生效，需要重新合并
+	static size_t Combine(Scene* pScene);
+	// 撤销合批，物体恢复使用各自的网格绘制
+	static void Clear(Scene* pScene);
+};
@@ -37,6 +37,19 @@ float4 TransformWorldToHClip(float3 posW)
     return mul(X_MATRIX_VP, float4(posW, 1.0f));
 }
 
+//
+// Vertex Decompression
+//
+// MeshData::MarkVertexCompressed() stores normals as octahedral-encoded
+// R16G16_SNORM when the vertex shader declares NORMAL as float2.
+float3 UnpackNormalOct(float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 
 
 #endif
@@ -22,6 +22,10 @@ public:
 	bool IsEnabled() const;
 	void SetEnabled(bool enabled);
 
+	// 静态物体在StaticBatching::Combine后不应再移动
+	bool IsStatic() const;
+	void SetStatic(bool isStatic);
+
 	GameObject* GetParent();
 	GameObject* GetChild(size_t index);
 
@@ -77,6 +81,7 @@ private:
 	Scene* m_pScene = nullptr;
 	
 	bool m_IsEnabled = true;
+	bool m_IsStatic = false;
 
 	GameObject* m_pParent = nullptr;
 	std::list<GameObject*> m_pChildrens;
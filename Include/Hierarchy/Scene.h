@@ -6,11 +6,14 @@
 #include <set>
 #include <vector>
 #include <list>
+#include <memory>
+#include <cstdint>
 #include <Utils/ObjectPool.h>
 
 class GameObject;
 class Component;
 class Camera;
+class MeshData;
 
 class Scene
 {
@@ -23,10 +26,11 @@ public:
 
 	GameObject* AddGameObject();
 	GameObject* AddGameObject(std::string_view name);
-	GameObject* AddCube(std::string_view name);
-	GameObject* AddSphere(std::string_view name);
-	GameObject* AddCylinder(std::string_view name);
-	GameObject* AddPlane(std::string_view name);
+	// 参数相同的基本几何体共享同一个网格(MeshFilter::GetSharedMesh)及其GPU资源
+	GameObject* AddCube(std::string_view name, float width = 2.0f, float height = 2.0f, float depth = 2.0f);
+	GameObject* AddSphere(std::string_view name, float radius = 1.0f, uint32_t levels = 20, uint32_t slices = 20);
+	GameObject* AddCylinder(std::string_view name, float radius = 1.0f, float height = 2.0f, uint32_t slices = 20, uint32_t stacks = 10);
+	GameObject* AddPlane(std::string_view name, float width = 10.0f, float depth = 10.0f);
 	GameObject* AddModel(std::string_view name, std::string_view filename);
 
 	GameObject* FindGameObject(std::string_view name);
@@ -44,6 +48,7 @@ public:
 private:
 	friend class GameObject;
 	friend class Component;
+	friend class StaticBatching;
 
 	void* NotifyGameObjectCreated(std::string_view name);
 	void NotifyGameObjectDestroyed(std::string_view name, GameObject* pObject);
@@ -71,4 +76,7 @@ private:
 
 	Camera* m_pMainCamera = nullptr;
 
+	// 静态合批生成的合并网格
+	std::vector<std::unique_ptr<MeshData>> m_pStaticBatchMeshes;
+
 };
@@ -197,6 +197,47 @@ namespace XMath
             return A.inverse().transpose();
         }
 
+        // 仿射变换矩阵(最后一行为0 0 0 1)的逆，只需对左上3x3求逆，比通用的4x4求逆快很多
+        inline Matrix4x4 InverseAffine(const Matrix4x4& Mat)
+        {
+            Matrix3x3 invLinear = Mat.topLeftCorner<3, 3>().inverse();
+            Matrix4x4 Inv;
+            Inv.topLeftCorner<3, 3>() = invLinear;
+            Inv.topRightCorner<3, 1>() = -(invLinear * Mat.topRightCorner<3, 1>());
+            Inv.row(3) << 0.0f, 0.0f, 0.0f, 1.0f;
+            return Inv;
+        }
+
+    }
+
+    namespace Collision
+    {
+        // 从观察投影矩阵(列向量约定，裁剪空间z范围[0, w])提取视锥体的6个平面
+        // 平面(a, b, c, d)满足a*x + b*y + c*z + d >= 0的点位于内侧，法向量未归一化
+        inline void ExtractFrustumPlanes(const Matrix4x4& viewProj, Vector4 planes[6])
+        {
+            planes[0] = (viewProj.row(3) + viewProj.row(0)).transpose();   // 左
+            planes[1] = (viewProj.row(3) - viewProj.row(0)).transpose();   // 右
+            planes[2] = (viewProj.row(3) + viewProj.row(1)).transpose();   // 下
+            planes[3] = (viewProj.row(3) - viewProj.row(1)).transpose();   // 上
+            planes[4] = viewProj.row(2).transpose();                        // 近
+            planes[5] = (viewProj.row(3) - viewProj.row(2)).transpose();   // 远
+        }
+
+        // AABB与视锥体是否相交(保守判定，可能把少量视锥体外的包围盒判为相交)
+        inline bool FrustumIntersectsBox(const Vector4 planes[6], const Vector3& vMin, const Vector3& vMax)
+        {
+            for (int i = 0; i < 6; ++i)
+            {
+                // 取包围盒在平面法向上最远的顶点，它在外侧则整个包围盒在外侧
+                Vector3 p(planes[i].x() >= 0.0f ? vMax.x() : vMin.x(),
+                    planes[i].y() >= 0.0f ? vMax.y() : vMin.y(),
+                    planes[i].z() >= 0.0f ? vMax.z() : vMin.z());
+                if (planes[i].head<3>().dot(p) + planes[i].w() < 0.0f)
+                    return false;
+            }
+            return true;
+        }
     }
     
 }
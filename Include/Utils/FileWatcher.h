@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 监视文件的修改、创建与删除，按所在目录注册系统通知
+// Windows使用FindFirstChangeNotification，Linux(工具链)使用inotify
+// 不创建线程，由使用者在合适的时机(如每帧开始)调用PollChanges
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// 文件可以暂不存在，之后创建时同样会报告。所在目录不存在时忽略
+	void Watch(std::string_view path);
+	void Clear();
+
+	// 返回自上次调用以来发生过变化的文件，字符串与Watch时传入的一致，不阻塞
+	std::vector<std::string> PollChanges();
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> pImpl;
+};
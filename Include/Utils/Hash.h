@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// 64位FNV-1a哈希，只依赖标准库
+namespace Hash
+{
+	constexpr uint64_t s_FNVOffsetBasis = 14695981039346656037ull;
+	constexpr uint64_t s_FNVPrime = 1099511628211ull;
+
+	// 逐字节的FNV-1a，可在编译期求值
+	constexpr uint64_t FNV1a64(std::string_view str, uint64_t hash = s_FNVOffsetBasis)
+	{
+		for (char c : str)
+		{
+			hash ^= (uint8_t)c;
+			hash *= s_FNVPrime;
+		}
+		return hash;
+	}
+
+	// 按8字节为单位折叠的FNV-1a，用于大块数据(顶点、索引、文件内容)
+	// 结果与逐字节的FNV1a64不同，只能与同一函数的结果比较
+	inline uint64_t HashBytes(const void* data, size_t byteSize, uint64_t hash = s_FNVOffsetBasis)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(data);
+		size_t i = 0;
+		for (; i + 8 <= byteSize; i += 8)
+		{
+			uint64_t word;
+			memcpy(&word, pBytes + i, sizeof word);
+			hash ^= word;
+			hash *= s_FNVPrime;
+			// 乘法只向高位扩散，混入高位避免低位的差异被吞掉
+			hash ^= hash >> 32;
+		}
+		for (; i < byteSize; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= s_FNVPrime;
+		}
+		// 长度参与哈希，区分末尾补零的数据
+		hash ^= (uint64_t)byteSize;
+		hash *= s_FNVPrime;
+		return hash;
+	}
+
+	inline uint64_t Combine(uint64_t hash, uint64_t value)
+	{
+		hash ^= value;
+		hash *= s_FNVPrime;
+		return hash;
+	}
+}
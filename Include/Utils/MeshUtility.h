@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 网格数据处理的通用算法，只依赖标准库
+namespace MeshUtility
+{
+	struct IndexRange
+	{
+		uint32_t indexStart;
+		uint32_t indexCount;
+		// 该区间的索引都需要加上baseVertex
+		uint32_t baseVertex;
+	};
+
+	// 所有索引按位或的结果，小于65536时所有索引都可以用16位表示
+	uint32_t ComputeIndexBitsOr(const uint32_t* pIndices, size_t count);
+
+	// 将32位索引减去baseVertex后写为16位索引，调用者需保证结果位于[0, 65535]
+	void NarrowIndices(const uint32_t* pSrc, uint16_t* pDest, size_t count, uint32_t baseVertex = 0);
+
+	// 按三角形顺序贪心地划分索引，使每段内索引的跨度不超过65535，从而可以用baseVertex加16位索引绘制
+	// 索引数不是3的倍数或存在跨度超过65535的三角形时返回false
+	bool SplitIndicesFor16Bit(const uint32_t* pIndices, size_t count, std::vector<IndexRange>& ranges);
+
+	struct VertexCacheStatistics
+	{
+		uint32_t verticesTransformed = 0;	// 缓存未命中的次数
+		uint32_t triangleCount = 0;
+		uint32_t vertexCount = 0;			// 被引用的顶点数
+		float acmr = 0.0f;					// 每个三角形平均变换的顶点数，最优约为0.5
+		float atvr = 0.0f;					// 平均每个顶点被变换的次数，最优为1
+	};
+
+	// 模拟大小为cacheSize的FIFO顶点缓存，统计三角形列表的顶点变换次数
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+	// 按Forsyth的线性时间算法重排三角形，提高变换后顶点缓存的命中率
+	void OptimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount);
+
+	// 在顶点缓存优化的结果上将三角形划分为簇，并按朝外的程度排序簇，使先绘制的三角形更可能遮挡后绘制的
+	// 簇的划分会让ACMR最多增加到原来的threshold倍。pPositions中相邻顶点位置相隔positionStride个float
+	void OptimizeOverdraw(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride,
+		size_t vertexCount, float threshold = 1.05f);
+
+	// 按索引中第一次出现的顺序重排顶点，提高顶点读取的局部性。会改写索引，
+	// remap[旧顶点] = 新顶点，未被引用的顶点保持原顺序放在最后。返回被引用的顶点数
+	size_t OptimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+	// 网格中一段索引连续的簇，用于逐簇剔除
+	struct Meshlet
+	{
+		uint32_t indexStart;
+		uint32_t indexCount;
+		uint32_t baseVertex;
+		uint32_t vertexCount;
+		// 包围球，位于网格的顶点坐标系
+		float center[3];
+		float radius;
+		// 法线锥：所有三角形法线与coneAxis的夹角不超过锥角，coneCutoff为锥角的余角的余弦，大于1时不做背面剔除
+		float coneAxis[3];
+		float coneCutoff;
+	};
+
+	// 沿三角形的邻接关系贪心地生长簇，每簇最多maxVertices个顶点、maxTriangles个三角形，
+	// 并将三角形按簇重排使每簇的索引连续。输出簇的indexStart相对于pIndices，baseVertex为0
+	void BuildMeshlets(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, size_t vertexCount,
+		std::vector<Meshlet>& meshlets, uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+	// 剔除在视锥体外或整体背向摄像机的簇，索引相邻且baseVertex相同的可见簇合并为一个区间
+	// pPlanes为6个平面(a, b, c, d)，a*x + b*y + c*z + d >= 0为内侧。平面与摄像机位置都位于网格的顶点坐标系
+	void CullMeshlets(const Meshlet* pMeshlets, size_t count, const float* pPlanes, const float* pCameraPos,
+		std::vector<IndexRange>& visibleRanges);
+
+	// 按remap重排顶点属性，remap需来自OptimizeVertexFetch
+	template<class T>
+	void RemapVertices(std::vector<T>& attributes, const std::vector<uint32_t>& remap)
+	{
+		if (attributes.size() != remap.size())
+			return;
+		std::vector<T> result(attributes.size());
+		for (size_t i = 0; i < remap.size(); ++i)
+			result[remap[i]] = attributes[i];
+		attributes.swap(result);
+	}
+}
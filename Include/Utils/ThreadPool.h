@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+
+class ThreadPool
+{
+public:
+	// threadCount为0时使用硬件线程数-1(至少1个)
+	ThreadPool(size_t threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// 全局共享的线程池
+	static ThreadPool& Get();
+
+	size_t GetThreadCount() const;
+
+	// 提交任务，返回可等待的future
+	template<class Func>
+	auto Submit(Func&& func) -> std::future<decltype(func())>;
+
+	// 将[0, count)分成若干块并行执行func(begin, end)，调用线程也参与执行，返回时全部完成
+	// 可以在线程池的任务中嵌套调用。func抛出的第一个异常在所有块完成后由调用线程重新抛出
+	void ParallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& func);
+
+private:
+	void Enqueue(std::function<void()> task);
+	void WorkerLoop();
+
+	std::vector<std::thread> m_Workers;
+	std::queue<std::function<void()>> m_Tasks;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping = false;
+};
+
+template<class Func>
+inline auto ThreadPool::Submit(Func&& func) -> std::future<decltype(func())>
+{
+	using ResultType = decltype(func());
+	auto pTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(func));
+	std::future<ResultType> res = pTask->get_future();
+	Enqueue([pTask]() { (*pTask)(); });
+	return res;
+}
@@ -11,6 +11,9 @@ public:
         m_MainScene.SetAsMainScene();
         
         Shader::InitFromJson("shaders.json", "record.json");
+#if defined(DEBUG) | defined(_DEBUG)
+        Shader::EnableHotReload(true);
+#endif
 
         m_Material.SetShader(Shader::Find("HLSL/Unlit"));
         m_Material.SetColor(Shader::StringToID("x_BaseColor"), Color(0.5f, 0.5f, 0.5f, 1.0f));
@@ -27,8 +30,29 @@ public:
         m_pRenderContext = pContext;
         m_pCamera = pCamera;
 
-        Setup();
-        DrawGameObjects();
+        m_pCameraController->Update(Time::DeltaTime());
+        // F1: 切换帧常量缓冲区，标题栏中的CB Map统计对比两种方式的上传次数
+        if (Input::Keyboard::IsFirstPressed(Input::Keyboard::F1))
+            Shader::EnableConstantRing(!Shader::IsConstantRingEnabled());
+        // F2: 切换常量缓冲区的脏区间上传，标题栏中的CB Upload对比只上传修改区间与整体上传的字节数
+        if (Input::Keyboard::IsFirstPressed(Input::Keyboard::F2))
+            Shader::EnableCBufferDirtyRanges(!Shader::IsCBufferDirtyRangesEnabled());
+
+        // 每帧重新构建渲染图，不写入后备缓冲区(或其它被读取的资源)的Pass会被剔除
+        m_RenderGraph.Reset();
+        RenderGraphTexture backBuffer = m_RenderGraph.ImportBackBuffer();
+        m_RenderGraph.AddPass("Opaque",
+            [&](RenderGraphBuilder& builder) {
+                builder.Write(backBuffer);
+            },
+            [this, backBuffer](RenderGraph& graph, RenderContext&) {
+                m_pRenderContext->SetRenderTarget(graph.GetTexture(backBuffer));
+                Setup();
+                DrawGameObjects();
+            });
+        m_RenderGraph.Compile();
+        m_RenderGraph.Execute(*m_pRenderContext);
+
         Submit();
     }
 
@@ -36,7 +60,6 @@ private:
 
     void Setup()
     {
-        m_pCameraController->Update(Time::DeltaTime());
         m_pRenderContext->SetupCameraProperties(*m_pCamera);
         m_CommandBuffer.ClearRenderTarget(true, true, Color::Black(), 1.0f);
         ExecuteBuffer();
@@ -44,11 +67,7 @@ private:
 
     void DrawGameObjects()
     {
-        auto gameObjects = m_MainScene.GetRootGameObjects();
-        for (auto pObject : gameObjects)
-        {
-            m_pRenderContext->DrawGameObject(pObject);
-        }
+        m_pRenderContext->DrawGameObjects(m_MainScene.GetRootGameObjects());
     }
 
     void ExecuteBuffer()
@@ -70,6 +89,7 @@ private:
     Camera* m_pCamera = nullptr;
     std::unique_ptr<FlyingFPSCamera> m_pCameraController;
     CommandBuffer m_CommandBuffer;
+    RenderGraph m_RenderGraph;
 
     Material m_Material;
     
@@ -82,12 +102,20 @@ class MyRenderPipeline : public RenderPipeline
 public:
     void Render(RenderContext* pContext, std::vector<Camera*>& pCameras) override
     {
+        // RenderContext只在渲染时传入，第一帧设置一次
+        if (!m_IsContextSetup)
+        {
+            pContext->SetParallelRecording(4);
+            m_IsContextSetup = true;
+        }
+
         for (auto& pCamera : pCameras)
             m_CameraRenderer.Render(pContext, pCamera);
     }
 
 private:
     CameraRenderer m_CameraRenderer;
+    bool m_IsContextSetup = false;
 };
 
 
@@ -1,5 +1,9 @@
 #include <Component/MeshFilter.h>
 #include <Hierarchy/GameObject.h>
+#include <Utils/ThreadPool.h>
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <cstring>
 
 #pragma warning(disable: 26812)
 
@@ -21,14 +25,282 @@ void MeshData::UpdateBoundingData()
 	}
 }
 
+uint64_t MeshData::ComputeContentHash() const
+{
+	uint64_t hash = Hash::s_FNVOffsetBasis;
+	hash = Hash::HashBytes(vertices.data(), vertices.size() * sizeof(Vector3), hash);
+	hash = Hash::HashBytes(normals.data(), normals.size() * sizeof(Vector3), hash);
+	hash = Hash::HashBytes(texcoords.data(), texcoords.size() * sizeof(Vector2), hash);
+	hash = Hash::HashBytes(tangents.data(), tangents.size() * sizeof(Vector4), hash);
+	hash = Hash::HashBytes(colors.data(), colors.size() * sizeof(Vector4), hash);
+	hash = Hash::HashBytes(indices.data(), indices.size(), hash);
+	hash = Hash::Combine(hash, indexSize);
+	for (auto& subMesh : subMeshes)
+	{
+		hash = Hash::Combine(hash, subMesh.indexStart);
+		hash = Hash::Combine(hash, subMesh.indexCount);
+		hash = Hash::Combine(hash, subMesh.baseVertex);
+	}
+	return hash;
+}
+
+bool MeshData::HasSameContent(const MeshData& other) const
+{
+	auto SameBytes = [](const auto& lhs, const auto& rhs) {
+		return lhs.size() == rhs.size() && (lhs.empty() || !memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(lhs[0])));
+	};
+	if (indexSize != other.indexSize || subMeshes.size() != other.subMeshes.size())
+		return false;
+	for (size_t i = 0; i < subMeshes.size(); ++i)
+	{
+		if (subMeshes[i].indexStart != other.subMeshes[i].indexStart ||
+			subMeshes[i].indexCount != other.subMeshes[i].indexCount ||
+			subMeshes[i].baseVertex != other.subMeshes[i].baseVertex)
+			return false;
+	}
+	return SameBytes(vertices, other.vertices) && SameBytes(normals, other.normals) &&
+		SameBytes(texcoords, other.texcoords) && SameBytes(tangents, other.tangents) &&
+		SameBytes(colors, other.colors) && SameBytes(indices, other.indices);
+}
+
+size_t MeshData::GetByteSize() const
+{
+	return vertices.size() * sizeof(Vector3) + normals.size() * sizeof(Vector3) + texcoords.size() * sizeof(Vector2) +
+		tangents.size() * sizeof(Vector4) + colors.size() * sizeof(Vector4) + indices.size();
+}
+
+namespace
+{
+	// 各子网格的索引区间，没有子网格时为整个索引缓冲区。越界的区间被丢弃
+	std::vector<SubMeshDescriptor> GetIndexRanges(const MeshData& meshData, size_t indexCount)
+	{
+		std::vector<SubMeshDescriptor> ranges;
+		for (auto& subMesh : meshData.subMeshes)
+		{
+			if ((size_t)subMesh.indexStart + subMesh.indexCount <= indexCount)
+				ranges.push_back(subMesh);
+		}
+		if (meshData.subMeshes.empty())
+		{
+			SubMeshDescriptor whole;
+			whole.indexCount = (uint32_t)indexCount;
+			ranges.push_back(whole);
+		}
+		return ranges;
+	}
+
+	// 将16/32位索引展开为32位的绝对索引(加上子网格的baseVertex)
+	std::vector<uint32_t> WidenIndices(const MeshData& meshData, const std::vector<SubMeshDescriptor>& ranges)
+	{
+		size_t indexCount = meshData.indices.size() / meshData.indexSize;
+		std::vector<uint32_t> wideIndices(indexCount);
+		if (meshData.indexSize == sizeof(uint32_t))
+			memcpy(wideIndices.data(), meshData.indices.data(), meshData.indices.size());
+		else
+			std::copy_n(reinterpret_cast<const uint16_t*>(meshData.indices.data()), indexCount, wideIndices.begin());
+		for (auto& range : ranges)
+		{
+			if (!range.baseVertex)
+				continue;
+			for (uint32_t i = 0; i < range.indexCount; ++i)
+				wideIndices[range.indexStart + i] += range.baseVertex;
+		}
+		return wideIndices;
+	}
+
+	// WidenIndices的逆过程
+	void RestoreIndices(MeshData& meshData, const std::vector<SubMeshDescriptor>& ranges, std::vector<uint32_t>& wideIndices)
+	{
+		if (meshData.indexSize == sizeof(uint32_t))
+		{
+			memcpy(meshData.indices.data(), wideIndices.data(), meshData.indices.size());
+			return;
+		}
+		for (auto& range : ranges)
+		{
+			if (!range.baseVertex)
+				continue;
+			for (uint32_t i = 0; i < range.indexCount; ++i)
+				wideIndices[range.indexStart + i] -= range.baseVertex;
+		}
+		uint16_t* pIndices = reinterpret_cast<uint16_t*>(meshData.indices.data());
+		for (size_t i = 0; i < wideIndices.size(); ++i)
+			pIndices[i] = (uint16_t)wideIndices[i];
+	}
+}
+
+void MeshData::Optimize(MeshUtility::VertexCacheStatistics* pBefore, MeshUtility::VertexCacheStatistics* pAfter, bool parallel)
+{
+	if ((indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) || vertices.empty())
+		return;
+
+	// 三角形顺序改变后原有的簇不再有效
+	meshlets.clear();
+
+	size_t indexCount = indices.size() / indexSize;
+	std::vector<SubMeshDescriptor> ranges = GetIndexRanges(*this, indexCount);
+	std::vector<uint32_t> wideIndices = WidenIndices(*this, ranges);
+	bool hasBaseVertex = std::any_of(ranges.begin(), ranges.end(),
+		[](const SubMeshDescriptor& range) { return range.baseVertex != 0; });
+
+	if (pBefore)
+		*pBefore = MeshUtility::AnalyzeVertexCache(wideIndices.data(), indexCount, vertices.size());
+
+	// 子网格的索引区间互不重叠，可以并行重排
+	auto optimizeRanges = [this, &ranges, &wideIndices](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			uint32_t* pIndices = wideIndices.data() + ranges[i].indexStart;
+			MeshUtility::OptimizeVertexCache(pIndices, ranges[i].indexCount, vertices.size());
+			MeshUtility::OptimizeOverdraw(pIndices, ranges[i].indexCount, vertices.data()->data(), 3, vertices.size());
+		}
+	};
+	if (parallel && ranges.size() > 1)
+		ThreadPool::Get().ParallelFor(ranges.size(), 1, optimizeRanges);
+	else
+		optimizeRanges(0, ranges.size());
+
+	// 重排顶点会改变各子网格引用的顶点区间，使用baseVertex的网格不重排顶点
+	if (!hasBaseVertex)
+	{
+		std::vector<uint32_t> remap;
+		MeshUtility::OptimizeVertexFetch(wideIndices.data(), indexCount, vertices.size(), remap);
+		MeshUtility::RemapVertices(vertices, remap);
+		MeshUtility::RemapVertices(normals, remap);
+		MeshUtility::RemapVertices(texcoords, remap);
+		MeshUtility::RemapVertices(tangents, remap);
+		MeshUtility::RemapVertices(colors, remap);
+	}
+
+	if (pAfter)
+		*pAfter = MeshUtility::AnalyzeVertexCache(wideIndices.data(), indexCount, vertices.size());
+
+	RestoreIndices(*this, ranges, wideIndices);
+}
+
+void MeshData::BuildMeshlets(uint32_t maxVertices, uint32_t maxTriangles, bool parallel)
+{
+	meshlets.clear();
+	if ((indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) || vertices.empty())
+		return;
+
+	size_t indexCount = indices.size() / indexSize;
+	std::vector<SubMeshDescriptor> ranges = GetIndexRanges(*this, indexCount);
+	std::vector<uint32_t> wideIndices = WidenIndices(*this, ranges);
+
+	// 簇不跨越子网格，每个子网格的三角形只在自己的区间内重排
+	std::vector<std::vector<MeshUtility::Meshlet>> rangeMeshlets(ranges.size());
+	auto buildRanges = [this, &ranges, &wideIndices, &rangeMeshlets, maxVertices, maxTriangles](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			MeshUtility::BuildMeshlets(wideIndices.data() + ranges[i].indexStart, ranges[i].indexCount, vertices.data()->data(), 3,
+				vertices.size(), rangeMeshlets[i], maxVertices, maxTriangles);
+			for (auto& meshlet : rangeMeshlets[i])
+			{
+				meshlet.indexStart += ranges[i].indexStart;
+				meshlet.baseVertex = ranges[i].baseVertex;
+			}
+		}
+	};
+	if (parallel && ranges.size() > 1)
+		ThreadPool::Get().ParallelFor(ranges.size(), 1, buildRanges);
+	else
+		buildRanges(0, ranges.size());
+	for (auto& subMeshlets : rangeMeshlets)
+		meshlets.insert(meshlets.end(), subMeshlets.begin(), subMeshlets.end());
+
+	RestoreIndices(*this, ranges, wideIndices);
+}
+
+bool MeshData::OptimizeIndexFormat(bool allowSplit)
+{
+	if (indexSize == sizeof(uint16_t))
+		return true;
+	if (indexSize != sizeof(uint32_t) || indices.empty())
+		return false;
+
+	const uint32_t* pIndices = reinterpret_cast<const uint32_t*>(indices.data());
+	size_t indexCount = indices.size() / sizeof(uint32_t);
+	std::vector<uint8_t> narrowed(indexCount * sizeof(uint16_t));
+	uint16_t* pNarrowed = reinterpret_cast<uint16_t*>(narrowed.data());
+
+	if (MeshUtility::ComputeIndexBitsOr(pIndices, indexCount) <= UINT16_MAX)
+	{
+		// 已有子网格的baseVertex保持不变
+		MeshUtility::NarrowIndices(pIndices, pNarrowed, indexCount);
+	}
+	else
+	{
+		std::vector<MeshUtility::IndexRange> ranges;
+		if (!allowSplit || !subMeshes.empty() || !MeshUtility::SplitIndicesFor16Bit(pIndices, indexCount, ranges))
+			return false;
+
+		// 划分后原有的簇不再有效
+		meshlets.clear();
+		for (auto& range : ranges)
+		{
+			MeshUtility::NarrowIndices(pIndices + range.indexStart, pNarrowed + range.indexStart, range.indexCount, range.baseVertex);
+
+			SubMeshDescriptor subMesh;
+			subMesh.indexStart = range.indexStart;
+			subMesh.indexCount = range.indexCount;
+			subMesh.baseVertex = range.baseVertex;
+			subMesh.vMin = subMesh.vMax = vertices[pIndices[range.indexStart]];
+			for (uint32_t i = 0; i < range.indexCount; ++i)
+			{
+				const Vector3& pos = vertices[pIndices[range.indexStart + i]];
+				subMesh.vMin = subMesh.vMin.cwiseMin(pos);
+				subMesh.vMax = subMesh.vMax.cwiseMax(pos);
+			}
+			subMeshes.push_back(subMesh);
+		}
+	}
+
+	indices.swap(narrowed);
+	indexSize = sizeof(uint16_t);
+	return true;
+}
+
 void MeshData::MarkVertexDynamic(bool isDynamic)
 {
 	m_IsDynamicVertex = isDynamic;
 }
 
+void MeshData::MarkVertexRangeDirty(uint32_t vertexStart, uint32_t vertexCount)
+{
+	if (m_IsVertexDirty || vertexCount == 0)
+		return;
+
+	// 插入后与重叠或相邻的区间合并
+	uint32_t vertexEnd = vertexStart + vertexCount;
+	auto it = std::lower_bound(m_DirtyVertexRanges.begin(), m_DirtyVertexRanges.end(), vertexStart,
+		[](const std::pair<uint32_t, uint32_t>& range, uint32_t start) { return range.second < start; });
+	auto last = it;
+	while (last != m_DirtyVertexRanges.end() && last->first <= vertexEnd)
+	{
+		vertexStart = (std::min)(vertexStart, last->first);
+		vertexEnd = (std::max)(vertexEnd, last->second);
+		++last;
+	}
+	it = m_DirtyVertexRanges.erase(it, last);
+	m_DirtyVertexRanges.insert(it, { vertexStart, vertexEnd });
+}
+
+void MeshData::MarkVertexInterleaved(bool isInterleaved)
+{
+	m_IsInterleavedVertex = isInterleaved;
+}
+
+void MeshData::MarkVertexCompressed(bool isCompressed)
+{
+	m_IsCompressedVertex = isCompressed;
+}
+
 void MeshData::UploadMeshData()
 {
 	m_IsUploading = true;
+	m_IsVertexDirty = true;
+	m_DirtyVertexRanges.clear();
 
 	size_t vertCount = vertices.size();
 	size_t normalCount = normals.size();
@@ -74,7 +346,10 @@ Component* MeshFilter::Instantiate(GameObject* pObject)
 		return nullptr;
 	MeshFilter* pMeshFilter = pObject->AddComponent<MeshFilter>();
 	if (m_pSharedMesh)
+	{
 		pMeshFilter->m_pSharedMesh = m_pSharedMesh;
+		pMeshFilter->m_pSharedMeshRef = m_pSharedMeshRef;
+	}
 	else
 		pMeshFilter->m_pSharedMesh = m_pMesh.get();
 	pMeshFilter->m_IsEnabled = m_IsEnabled;
@@ -95,7 +370,8 @@ MeshData* MeshFilter::CreateMesh()
 { 
 	if (m_pMesh)
 		return nullptr;
-	m_pMesh = std::unique_ptr<MeshData>(); 
+	m_pMesh = std::make_unique<MeshData>(); 
 	m_pSharedMesh = nullptr;
+	m_pSharedMeshRef.reset();
 	return m_pMesh.get();
 }
\ No newline at end of file
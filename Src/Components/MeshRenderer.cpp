@@ -1,6 +1,8 @@
 #include <Component/MeshRenderer.h>
 #include <Graphics/Shader.h>
 #include <Hierarchy/GameObject.h>
+#include <atomic>
+#include <algorithm>
 
 
 #pragma warning(disable: 26812)
@@ -206,6 +208,7 @@ std::string_view Material::GetTexture(size_t propertyId) const
 void Material::SetShader(Shader* pShader)
 {
 	m_pShader = pShader;
+	m_pActiveShader = nullptr;
 }
 
 Shader* Material::GetShader()
@@ -213,6 +216,33 @@ Shader* Material::GetShader()
 	return m_pShader;
 }
 
+void Material::EnableKeyword(std::string_view keyword)
+{
+	size_t id = Shader::StringToID(keyword);
+	auto it = std::lower_bound(m_KeywordIds.begin(), m_KeywordIds.end(), id);
+	if (it == m_KeywordIds.end() || *it != id)
+		m_KeywordIds.insert(it, id);
+}
+
+void Material::DisableKeyword(std::string_view keyword)
+{
+	size_t id = Shader::StringToID(keyword);
+	auto it = std::lower_bound(m_KeywordIds.begin(), m_KeywordIds.end(), id);
+	if (it != m_KeywordIds.end() && *it == id)
+		m_KeywordIds.erase(it);
+}
+
+bool Material::IsKeywordEnabled(std::string_view keyword) const
+{
+	return std::binary_search(m_KeywordIds.begin(), m_KeywordIds.end(), Shader::StringToID(keyword));
+}
+
+Shader* Material::ResolveShader()
+{
+	m_pActiveShader = m_pShader ? m_pShader->GetVariant(m_KeywordIds) : nullptr;
+	return m_pActiveShader;
+}
+
 //
 // MaterialPropertyBlock
 //
@@ -223,7 +253,7 @@ void MaterialPropertyBlock::SetInt(std::string_view name, int value)
 
 void MaterialPropertyBlock::SetInt(size_t propertyId, int value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::Int, &value, sizeof(int));
 }
 
 void MaterialPropertyBlock::SetFloat(std::string_view name, float value)
@@ -233,7 +263,7 @@ void MaterialPropertyBlock::SetFloat(std::string_view name, float value)
 
 void MaterialPropertyBlock::SetFloat(size_t propertyId, float value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::Float, &value, sizeof(float));
 }
 
 void MaterialPropertyBlock::SetVector(std::string_view name, const XMath::Vector4& value)
@@ -243,7 +273,7 @@ void MaterialPropertyBlock::SetVector(std::string_view name, const XMath::Vector
 
 void MaterialPropertyBlock::SetVector(size_t propertyId, const XMath::Vector4& value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::Vector, value.data(), (uint32_t)sizeof(XMath::Vector4));
 }
 
 void MaterialPropertyBlock::SetColor(std::string_view name, const Color& value)
@@ -253,7 +283,7 @@ void MaterialPropertyBlock::SetColor(std::string_view name, const Color& value)
 
 void MaterialPropertyBlock::SetColor(size_t propertyId, const Color& value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::Color, (const float*)value, (uint32_t)sizeof(Color));
 }
 
 void MaterialPropertyBlock::SetMatrix(std::string_view name, const XMath::Matrix4x4& value)
@@ -263,7 +293,7 @@ void MaterialPropertyBlock::SetMatrix(std::string_view name, const XMath::Matrix
 
 void MaterialPropertyBlock::SetMatrix(size_t propertyId, const XMath::Matrix4x4& value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::Matrix, value.data(), (uint32_t)sizeof(XMath::Matrix4x4));
 }
 
 void MaterialPropertyBlock::SetVectorArray(std::string_view name, const std::vector<XMath::Vector4>& value)
@@ -273,7 +303,7 @@ void MaterialPropertyBlock::SetVectorArray(std::string_view name, const std::vec
 
 void MaterialPropertyBlock::SetVectorArray(size_t propertyId, const std::vector<XMath::Vector4>& value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::VectorArray, value.data(), (uint32_t)(value.size() * sizeof(XMath::Vector4)));
 }
 
 void MaterialPropertyBlock::SetMatrixArray(std::string_view name, const std::vector<XMath::Matrix4x4>& value)
@@ -283,10 +313,87 @@ void MaterialPropertyBlock::SetMatrixArray(std::string_view name, const std::vec
 
 void MaterialPropertyBlock::SetMatrixArray(size_t propertyId, const std::vector<XMath::Matrix4x4>& value)
 {
-	m_Properties[propertyId] = value;
+	SetRaw(propertyId, PropertyType::MatrixArray, value.data(), (uint32_t)(value.size() * sizeof(XMath::Matrix4x4)));
 }
 
 bool MaterialPropertyBlock::HasProperty(std::string_view name) const
 {
-	return m_Properties.find(Shader::StringToID(name)) != m_Properties.end();
+	return HasProperty(Shader::StringToID(name));
+}
+
+bool MaterialPropertyBlock::HasProperty(size_t propertyId) const
+{
+	return FindEntry(propertyId) != nullptr;
+}
+
+void MaterialPropertyBlock::Reserve(size_t propertyCount, size_t byteCount)
+{
+	m_Entries.reserve(propertyCount);
+	m_Payload.reserve(byteCount);
+}
+
+void MaterialPropertyBlock::Clear()
+{
+	m_Entries.clear();
+	m_Payload.clear();
+	m_WastedBytes = 0;
+	MarkDirty();
+}
+
+void MaterialPropertyBlock::SetRaw(size_t propertyId, PropertyType type, const void* data, uint32_t byteWidth)
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), propertyId,
+		[](const Entry& entry, size_t id) { return entry.id < id; });
+	if (it == m_Entries.end() || it->id != propertyId)
+		it = m_Entries.insert(it, Entry{ propertyId, (uint32_t)m_Payload.size(), 0, 0, type });
+	// 值未改变时不更新版本号，避免每帧设置相同值的材质重新烘焙常量缓冲区
+	else if (it->type == type && it->byteWidth == byteWidth &&
+		(byteWidth == 0 || memcmp(m_Payload.data() + it->offset, data, byteWidth) == 0))
+		return;
+
+	// 原有空间足够时原地覆盖，否则在末尾重新分配
+	if (byteWidth > it->capacity)
+	{
+		m_WastedBytes += it->capacity;
+		it->offset = (uint32_t)m_Payload.size();
+		it->capacity = byteWidth;
+		m_Payload.resize(m_Payload.size() + byteWidth);
+	}
+	it->type = type;
+	it->byteWidth = byteWidth;
+	if (byteWidth)
+		memcpy(m_Payload.data() + it->offset, data, byteWidth);
+
+	// 废弃的空间超过一半时整理，保持数据紧凑
+	if (m_WastedBytes > 0 && m_WastedBytes * 2 > m_Payload.size())
+	{
+		std::vector<uint8_t> payload;
+		payload.reserve(m_Payload.capacity());
+		for (auto& entry : m_Entries)
+		{
+			uint32_t offset = (uint32_t)payload.size();
+			payload.insert(payload.end(), m_Payload.begin() + entry.offset, m_Payload.begin() + entry.offset + entry.byteWidth);
+			entry.offset = offset;
+			entry.capacity = entry.byteWidth;
+		}
+		m_Payload.swap(payload);
+		m_WastedBytes = 0;
+	}
+
+	MarkDirty();
+}
+
+const MaterialPropertyBlock::Entry* MaterialPropertyBlock::FindEntry(size_t propertyId) const
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), propertyId,
+		[](const Entry& entry, size_t id) { return entry.id < id; });
+	if (it == m_Entries.end() || it->id != propertyId)
+		return nullptr;
+	return &*it;
+}
+
+void MaterialPropertyBlock::MarkDirty()
+{
+	static std::atomic<uint64_t> s_Version = 0;
+	m_Version = ++s_Version;
 }
@@ -123,7 +123,7 @@ Matrix4x4 Transform::GetLocalToWorldMatrix() const
 
 Matrix4x4 Transform::GetWorldToLocalMatrix() const
 {
-	return GetLocalToWorldMatrix().inverse();
+	return XMath::Matrix::InverseAffine(GetLocalToWorldMatrix());
 }
 
 void Transform::SetScale(const Vector3& scale)
@@ -3,28 +3,188 @@
 #include "ShaderImpl.h"
 #include "DXTrace.h"
 #include "d3dUtil.h"
+#include "VertexPacking.h"
+#include "DynamicVertexRing.h"
+#include "InputLayoutCache.h"
+#include <Graphics/RenderTexture.h>
+#include <algorithm>
 
+namespace
+{
+	// 内置属性ID，编译期计算
+	constexpr size_t s_LocalToWorldID = Shader::StringToID("x_Matrix_LocalToWorld");
+	constexpr size_t s_WorldToLocalID = Shader::StringToID("x_Matrix_WorldToLocal");
+	constexpr size_t s_ViewID = Shader::StringToID("x_Matrix_View");
+	constexpr size_t s_ProjID = Shader::StringToID("x_Matrix_Proj");
+	constexpr size_t s_ViewProjID = Shader::StringToID("x_Matrix_ViewProj");
+
+	// 顶点属性在输入布局语义中的下标：0-POSITION 1-NORMAL 2-TANGENT 3-COLOR 4-TEXCOORD
+	int GetSemanticIndex(std::string_view semanticName)
+	{
+		static const std::map<std::string_view, int> semanticMap = {
+			{ "POSITION", 0 },
+			{ "NORMAL", 1 },
+			{ "TANGENT", 2 },
+			{ "COLOR", 3 },
+			{ "TEXCOORD", 4 }
+		};
+		auto it = semanticMap.find(semanticName);
+		return it != semanticMap.end() ? it->second : 0;
+	}
+
+	std::vector<std::pair<void*, size_t>> GetVertexAttributeDatas(MeshData* pMeshData)
+	{
+		return {
+			{ pMeshData->vertices.data(), pMeshData->vertices.size() * sizeof(XMath::Vector3) },
+			{ pMeshData->normals.data(), pMeshData->normals.size() * sizeof(XMath::Vector3) },
+			{ pMeshData->tangents.data(), pMeshData->tangents.size() * sizeof(XMath::Vector4) },
+			{ pMeshData->colors.data(), pMeshData->colors.size() * sizeof(XMath::Vector4) },
+			{ pMeshData->texcoords.data(), pMeshData->texcoords.size() * sizeof(XMath::Vector2) }
+		};
+	}
+
+	uint32_t GetComponentCount(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R32_FLOAT: case DXGI_FORMAT_R32_SINT: case DXGI_FORMAT_R32_UINT: return 1;
+		case DXGI_FORMAT_R32G32_FLOAT: case DXGI_FORMAT_R32G32_SINT: case DXGI_FORMAT_R32G32_UINT: return 2;
+		case DXGI_FORMAT_R32G32B32_FLOAT: case DXGI_FORMAT_R32G32B32_SINT: case DXGI_FORMAT_R32G32B32_UINT: return 3;
+		default: return 4;
+		}
+	}
+
+	// 按着色器的输入签名将顶点属性打包为顶点流，并给出对应的输入元素
+	// 法线在着色器声明为float2时总是使用八面体编码的R16G16_SNORM，与是否压缩无关
+	// 压缩时：其余法线为R16G16B16A16_SNORM；切线为R16G16B16A16_SNORM，颜色为R8G8B8A8_UNORM，纹理坐标为R16G16_FLOAT。
+	// 交错时所有属性合并到槽0的一个顶点流中。只打包[vertexStart, vertexStart + vertexCount)的顶点
+	void PackVertexStreams(MeshData* pMeshData, const std::vector<D3D11_INPUT_ELEMENT_DESC>& inputLayout, bool compressed, bool interleaved,
+		size_t vertexStart, size_t vertexCount,
+		std::vector<D3D11_INPUT_ELEMENT_DESC>& elements, std::vector<std::vector<uint8_t>>& streams, std::vector<uint32_t>& strides)
+	{
+		auto datas = GetVertexAttributeDatas(pMeshData);
+
+		elements = inputLayout;
+		streams.assign(inputLayout.size(), {});
+		strides.assign(inputLayout.size(), 0);
+		for (size_t i = 0; i < elements.size(); ++i)
+		{
+			auto& elem = elements[i];
+			auto& stream = streams[i];
+			int idx = GetSemanticIndex(elem.SemanticName);
+			if (idx == 1 && GetComponentCount(elem.Format) == 2)
+			{
+				elem.Format = DXGI_FORMAT_R16G16_SNORM;
+				strides[i] = 2 * sizeof(int16_t);
+				stream.resize(vertexCount * strides[i]);
+				VertexPacking::EncodeOctahedralSnorm16(pMeshData->normals[vertexStart].data(), 3,
+					reinterpret_cast<int16_t*>(stream.data()), vertexCount);
+			}
+			else if (compressed && idx == 1)
+			{
+				elem.Format = DXGI_FORMAT_R16G16B16A16_SNORM;
+				strides[i] = 4 * sizeof(int16_t);
+				std::vector<int16_t> packed(vertexCount * 3);
+				VertexPacking::FloatToSnorm16(pMeshData->normals[vertexStart].data(), packed.data(), packed.size());
+				stream.assign(vertexCount * strides[i], 0);
+				for (size_t v = 0; v < vertexCount; ++v)
+					memcpy(stream.data() + v * strides[i], packed.data() + v * 3, 3 * sizeof(int16_t));
+			}
+			else if (compressed && idx == 2)
+			{
+				elem.Format = DXGI_FORMAT_R16G16B16A16_SNORM;
+				strides[i] = 4 * sizeof(int16_t);
+				stream.resize(vertexCount * strides[i]);
+				VertexPacking::FloatToSnorm16(pMeshData->tangents[vertexStart].data(), reinterpret_cast<int16_t*>(stream.data()), vertexCount * 4);
+			}
+			else if (compressed && idx == 3)
+			{
+				elem.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+				strides[i] = 4 * sizeof(uint8_t);
+				stream.resize(vertexCount * strides[i]);
+				VertexPacking::FloatToUnorm8(pMeshData->colors[vertexStart].data(), stream.data(), vertexCount * 4);
+			}
+			else if (compressed && idx == 4)
+			{
+				elem.Format = DXGI_FORMAT_R16G16_FLOAT;
+				strides[i] = 2 * sizeof(uint16_t);
+				stream.resize(vertexCount * strides[i]);
+				VertexPacking::FloatToHalf(pMeshData->texcoords[vertexStart].data(), reinterpret_cast<uint16_t*>(stream.data()), vertexCount * 2);
+			}
+			else
+			{
+				strides[i] = (uint32_t)(datas[idx].second / pMeshData->vertices.size());
+				stream.resize(vertexCount * strides[i]);
+				memcpy(stream.data(), static_cast<uint8_t*>(datas[idx].first) + vertexStart * strides[i], stream.size());
+			}
+			elem.InputSlot = (uint32_t)i;
+			elem.AlignedByteOffset = 0;
+		}
 
-bool CommandBuffer::Impl::UpdateMeshResource(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const std::vector<D3D11_INPUT_ELEMENT_DESC>& inputLayout)
+		if (interleaved && streams.size() > 1)
+		{
+			std::vector<const void*> pStreams;
+			uint32_t vertexStride = 0;
+			for (size_t i = 0; i < elements.size(); ++i)
+			{
+				elements[i].InputSlot = 0;
+				elements[i].AlignedByteOffset = vertexStride;
+				vertexStride += strides[i];
+				pStreams.push_back(streams[i].data());
+			}
+			std::vector<uint8_t> merged(vertexCount * vertexStride);
+			VertexPacking::Interleave(pStreams.data(), strides.data(), (uint32_t)streams.size(), vertexCount, merged.data());
+			streams.assign(1, std::move(merged));
+			strides.assign(1, vertexStride);
+		}
+	}
+
+	// 以float2声明的法线需要八面体编码，未压缩的网格同样要经过打包
+	bool NeedsPacking(uint32_t vertexFormat, const std::vector<D3D11_INPUT_ELEMENT_DESC>& attributes)
+	{
+		return vertexFormat || std::any_of(attributes.begin(), attributes.end(), [](const D3D11_INPUT_ELEMENT_DESC& elem) {
+			return GetSemanticIndex(elem.SemanticName) == 1 && GetComponentCount(elem.Format) == 2;
+		});
+	}
+
+	// 需要上传的顶点属性：签名中的属性，加上之前上传过且网格仍有数据的其他属性，
+	// 这样交替使用签名不同的着色器时不会反复重建顶点缓冲区。每个属性占用一个槽位
+	std::vector<D3D11_INPUT_ELEMENT_DESC> MergeVertexAttributes(const std::vector<D3D11_INPUT_ELEMENT_DESC>& signature,
+		const std::vector<D3D11_INPUT_ELEMENT_DESC>& uploaded, uint32_t vertexMask)
+	{
+		std::vector<D3D11_INPUT_ELEMENT_DESC> attributes;
+		auto append = [&attributes](const D3D11_INPUT_ELEMENT_DESC& elem) {
+			if (std::none_of(attributes.begin(), attributes.end(),
+				[&elem](const D3D11_INPUT_ELEMENT_DESC& other) { return InputLayoutCache::IsSameSemantic(elem, other); }))
+				attributes.push_back(elem);
+		};
+		for (const auto& elem : signature)
+		{
+			if (!InputLayoutCache::IsSystemValue(elem.SemanticName))
+				append(elem);
+		}
+		for (const auto& elem : uploaded)
+		{
+			if (vertexMask & (1 << GetSemanticIndex(elem.SemanticName)))
+				append(elem);
+		}
+		for (size_t i = 0; i < attributes.size(); ++i)
+		{
+			attributes[i].InputSlot = (uint32_t)i;
+			attributes[i].AlignedByteOffset = 0;
+		}
+		return attributes;
+	}
+}
+
+bool CommandBuffer::Impl::UpdateMeshResource(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const VertexShaderInfo& vsInfo)
 {
 	// 顶点缓冲的更新
 
 	// 默认缓冲区需要重建Buffer
-	// 动态顶点缓冲区仅大小增加时重建Buffer
-	static std::map<std::string_view, int> semanticMap = {
-		{ "POSITION", 0 },
-		{ "NORMAL", 1 },
-		{ "TANGENT", 2 },
-		{ "COLOR", 3 },
-		{ "TEXCOORD", 4 }
-	};
-	std::vector<std::pair<void*, size_t>> datas = {
-		{ pMeshData->vertices.data(), pMeshData->vertices.size() * sizeof(XMath::Vector3) },
-		{ pMeshData->normals.data(), pMeshData->normals.size() * sizeof(XMath::Vector3) },
-		{ pMeshData->tangents.data(), pMeshData->tangents.size() * sizeof(XMath::Vector4) },
-		{ pMeshData->colors.data(), pMeshData->colors.size() * sizeof(XMath::Vector4) },
-		{ pMeshData->texcoords.data(), pMeshData->texcoords.size() * sizeof(XMath::Vector2) }
-	};
+	// 动态顶点缓冲区仅容量不足时重建Buffer，否则只上传被标记的顶点区间
+	const auto& signature = vsInfo.signatureParams;
+	auto datas = GetVertexAttributeDatas(pMeshData);
 
 	uint32_t vertexMask = 0;
 	size_t elemTypes = datas.size();
@@ -35,50 +195,154 @@ bool CommandBuffer::Impl::UpdateMeshResource(MeshData* pMeshData, MeshGraphicsRe
 	}
 
 	uint32_t layoutMask = 0;
-	for (const auto& inputElem : inputLayout)
+	for (const auto& inputElem : signature)
 	{
-		layoutMask |= (1 << semanticMap[inputElem.SemanticName]);
+		if (!InputLayoutCache::IsSystemValue(inputElem.SemanticName))
+			layoutMask |= (1 << GetSemanticIndex(inputElem.SemanticName));
 	}
 
 	if ((layoutMask & vertexMask) != layoutMask)
 		return false;
 
-	if (layoutMask != pMeshData->m_VertexMask || pMeshData->m_VertexCapacity < pMeshData->vertices.size())
+	// 默认格式每个属性一个float顶点缓冲区
+	// 已上传的顶点流满足签名时不重建，签名不同的着色器共用同一组顶点缓冲区，只是输入布局不同
+	uint32_t vertexCount = (uint32_t)pMeshData->vertices.size();
+	uint32_t vertexFormat = (pMeshData->m_IsInterleavedVertex ? 1 : 0) | (pMeshData->m_IsCompressedVertex ? 2 : 0);
+	bool needRebuild = !InputLayoutCache::IsCompatible(pMeshResource->streamElements, signature) ||
+		pMeshData->m_VertexCapacity < vertexCount || vertexFormat != pMeshData->m_VertexFormat;
+
+	// 静态顶点创建为不可变缓冲区；动态顶点创建为默认缓冲区，数据经由上传缓冲区拷贝
+	auto createVertexBuffer = [this, pMeshData](const void* data, uint32_t dataSize, uint32_t byteWidth, ID3D11Buffer** ppBuffer) {
+		if (!pMeshData->m_IsDynamicVertex)
+			return SUCCEEDED(CreateVertexBuffer(Graphics::Impl::GetDevice(), const_cast<void*>(data), byteWidth, ppBuffer, false));
+
+		D3D11_BUFFER_DESC bd{};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.ByteWidth = byteWidth;
+		if (FAILED(Graphics::Impl::GetDevice()->CreateBuffer(&bd, nullptr, ppBuffer)))
+			return false;
+		return GetVertexRing().CopyTo(*ppBuffer, 0, data, dataSize);
+	};
+
+	std::vector<D3D11_INPUT_ELEMENT_DESC> packedElements;
+	std::vector<std::vector<uint8_t>> packedStreams;
+	std::vector<uint32_t> packedStrides;
+	if (needRebuild)
 	{
+		// 格式改变时之前上传的属性格式已不适用，只按签名上传
+		std::vector<D3D11_INPUT_ELEMENT_DESC> attributes = MergeVertexAttributes(signature,
+			vertexFormat == pMeshData->m_VertexFormat ? pMeshResource->inputLayouts : std::vector<D3D11_INPUT_ELEMENT_DESC>{}, vertexMask);
+		bool packed = NeedsPacking(vertexFormat, attributes);
+		if (packed)
+		{
+			PackVertexStreams(pMeshData, attributes, pMeshData->m_IsCompressedVertex, pMeshData->m_IsInterleavedVertex,
+				0, vertexCount, packedElements, packedStreams, packedStrides);
+		}
+
+		for (auto pBuffer : pMeshResource->vertexBuffers)
+			SAFE_RELEASE(pBuffer);
 		pMeshResource->vertexBuffers.clear();
 		pMeshResource->strides.clear();
-		pMeshResource->vertexBuffers.resize(inputLayout.size());
-		pMeshResource->inputLayouts = inputLayout;
-		pMeshResource->offsets.assign(inputLayout.size(), 0);
+		pMeshResource->inputLayouts = attributes;
+		pMeshResource->streamElements = packed ? packedElements : attributes;
+		pMeshResource->streamLayoutHash = InputLayoutCache::HashElements(pMeshResource->streamElements.data(),
+			(uint32_t)pMeshResource->streamElements.size());
+		// 输入布局仍由InputLayoutCache持有，顶点流布局相同的网格可以继续使用
+		pMeshResource->signatureInputLayouts.clear();
 
+		layoutMask = 0;
+		for (const auto& inputElem : attributes)
+			layoutMask |= (1 << GetSemanticIndex(inputElem.SemanticName));
 		pMeshData->m_VertexMask = layoutMask;
-		pMeshData->m_VertexCapacity = pMeshData->m_VertexCount = (uint32_t)pMeshData->vertices.size();
+		pMeshData->m_VertexFormat = vertexFormat;
+		pMeshData->m_VertexCount = vertexCount;
+		// 动态顶点的容量只在顶点数超出时按2倍增长，避免顶点数逐帧增加时反复重建；
+		// 仅因布局或格式改变的重建保持原有容量
+		if (!pMeshData->m_IsDynamicVertex)
+			pMeshData->m_VertexCapacity = vertexCount;
+		else if (pMeshData->m_VertexCapacity < vertexCount)
+			pMeshData->m_VertexCapacity = (std::max)(vertexCount, pMeshData->m_VertexCapacity * 2);
 
-		size_t currPos = 0;
-		for (const auto& inputElem : inputLayout)
+		if (packed)
+		{
+			pMeshResource->vertexBuffers.resize(packedStreams.size());
+			for (size_t i = 0; i < packedStreams.size(); ++i)
+			{
+				if (!createVertexBuffer(packedStreams[i].data(), (uint32_t)packedStreams[i].size(),
+					packedStrides[i] * pMeshData->m_VertexCapacity, &pMeshResource->vertexBuffers[i]))
+					return false;
+			}
+			pMeshResource->strides = packedStrides;
+			pMeshResource->offsets.assign(packedStreams.size(), 0);
+		}
+		else
 		{
-			int idx = semanticMap[inputElem.SemanticName];
-			CreateVertexBuffer(Graphics::Impl::GetDevice(), datas[idx].first, (uint32_t)datas[idx].second,
-				&pMeshResource->vertexBuffers[currPos++], pMeshData->m_IsDynamicVertex);
-			pMeshResource->strides.push_back((uint32_t)datas[idx].second / pMeshData->m_VertexCount);
+			pMeshResource->vertexBuffers.resize(attributes.size());
+			pMeshResource->offsets.assign(attributes.size(), 0);
+
+			size_t currPos = 0;
+			for (const auto& inputElem : attributes)
+			{
+				int idx = GetSemanticIndex(inputElem.SemanticName);
+				uint32_t stride = (uint32_t)datas[idx].second / vertexCount;
+				if (!createVertexBuffer(datas[idx].first, (uint32_t)datas[idx].second,
+					stride * pMeshData->m_VertexCapacity, &pMeshResource->vertexBuffers[currPos++]))
+					return false;
+				pMeshResource->strides.push_back(stride);
+			}
 		}
+		pMeshData->m_IsVertexDirty = false;
+		pMeshData->m_DirtyVertexRanges.clear();
 	}
-	else if (pMeshData->m_IsDynamicVertex)
+	else if (pMeshData->m_IsDynamicVertex && (pMeshData->m_IsVertexDirty || !pMeshData->m_DirtyVertexRanges.empty()))
 	{
-		D3D11_MAPPED_SUBRESOURCE mappedData;
-		size_t currPos = 0;
-		for (const auto& inputElem : inputLayout)
+		// 只上传被标记的顶点区间
+		std::vector<std::pair<uint32_t, uint32_t>> ranges;
+		if (pMeshData->m_IsVertexDirty)
+			ranges.push_back({ 0, vertexCount });
+		else
+			ranges.swap(pMeshData->m_DirtyVertexRanges);
+
+		DynamicVertexRing& vertexRing = GetVertexRing();
+		bool packed = NeedsPacking(vertexFormat, pMeshResource->inputLayouts);
+		for (auto& range : ranges)
 		{
-			int idx = semanticMap[inputElem.SemanticName];
-			m_pDeferredContext->Map(pMeshResource->vertexBuffers[currPos], 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData);
-			memcpy_s(mappedData.pData, datas[idx].second, datas[idx].first, datas[idx].second);
-			m_pDeferredContext->Unmap(pMeshResource->vertexBuffers[currPos++], 0);
-			pMeshData->m_VertexCount = (uint32_t)pMeshData->vertices.size();
+			uint32_t rangeStart = range.first;
+			uint32_t rangeEnd = (std::min)(range.second, vertexCount);
+			if (rangeStart >= rangeEnd)
+				continue;
+
+			if (packed)
+			{
+				PackVertexStreams(pMeshData, pMeshResource->inputLayouts, pMeshData->m_IsCompressedVertex, pMeshData->m_IsInterleavedVertex,
+					rangeStart, rangeEnd - rangeStart, packedElements, packedStreams, packedStrides);
+				for (size_t i = 0; i < packedStreams.size(); ++i)
+				{
+					vertexRing.CopyTo(pMeshResource->vertexBuffers[i], rangeStart * packedStrides[i],
+						packedStreams[i].data(), (uint32_t)packedStreams[i].size());
+				}
+			}
+			else
+			{
+				size_t currPos = 0;
+				for (const auto& inputElem : pMeshResource->inputLayouts)
+				{
+					int idx = GetSemanticIndex(inputElem.SemanticName);
+					uint32_t stride = pMeshResource->strides[currPos];
+					vertexRing.CopyTo(pMeshResource->vertexBuffers[currPos++], rangeStart * stride,
+						static_cast<const uint8_t*>(datas[idx].first) + rangeStart * stride, (rangeEnd - rangeStart) * stride);
+				}
+			}
 		}
+		pMeshData->m_VertexCount = vertexCount;
+		pMeshData->m_IsVertexDirty = false;
+		pMeshData->m_DirtyVertexRanges.clear();
 	}
 
-	if (pMeshData->m_IndexCapacity < pMeshData->indices.size())
+	if (pMeshData->m_IndexCapacity < pMeshData->indices.size() || pMeshData->m_IndexSize != pMeshData->indexSize)
 	{
+		SAFE_RELEASE(pMeshResource->indexBuffer);
 		CreateIndexBuffer(Graphics::Impl::GetDevice(), pMeshData->indices.data(), (uint32_t)pMeshData->indices.size(), &pMeshResource->indexBuffer);
 		pMeshData->m_IndexCapacity = (uint32_t)pMeshData->indices.size();
 		pMeshData->m_IndexSize = pMeshData->indexSize;
@@ -89,91 +353,107 @@ bool CommandBuffer::Impl::UpdateMeshResource(MeshData* pMeshData, MeshGraphicsRe
 	return true;
 }
 
-CommandBuffer::CommandBuffer()
-    : pImpl(std::make_unique<CommandBuffer::Impl>())
+MeshGraphicsResource* CommandBuffer::Impl::PrepareMeshResource(MeshData* pMeshData, Shader* pShader)
 {
-    ThrowIfFailed(Graphics::Impl::GetDevice()->CreateDeferredContext(0, pImpl->m_pDeferredContext.GetAddressOf()));
-}
-
-CommandBuffer::~CommandBuffer()
-{
-}
+	if (!pShader)
+		return nullptr;
 
-void CommandBuffer::Clear()
-{
-    pImpl->m_pCommandLists.clear();
-}
+	auto pMeshResource = ResourceManager::Get().FindMeshGraphicsResources(pMeshData);
+	if (!pMeshResource)
+	{
+		pMeshResource = ResourceManager::Get().CreateMeshGraphicsResources(pMeshData);
+	}
+	// TODO: 多Pass
+	const VertexShaderInfo* pVSInfo = pShader->pImpl->m_Passes[0].pVSInfo;
+	if (!pVSInfo)
+		return nullptr;
+	if (pMeshData->m_IsUploading)
+	{
+		if (!UpdateMeshResource(pMeshData, pMeshResource, *pVSInfo))
+			return nullptr;
+	}
 
-void CommandBuffer::ClearRenderTarget(bool clearDepth, bool clearColor, Color backgroundColor, float depth)
-{
-    if (clearColor)
-    {
-        pImpl->m_pDeferredContext->ClearRenderTargetView(Graphics::Impl::GetColorBuffer(), backgroundColor);
-    }
-    if (clearDepth)
-    {
-        pImpl->m_pDeferredContext->ClearDepthStencilView(Graphics::Impl::GetDepthBuffer(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, depth, 0);
-    }
+	// 为该签名准备输入布局，录制时只读取，不再创建
+	if (!pMeshResource->FindInputLayout(pVSInfo->signatureHash))
+	{
+		ID3D11InputLayout* pInputLayout = nullptr;
+		if (!InputLayoutCache::IsCompatible(pMeshResource->streamElements, pVSInfo->signatureParams) ||
+			FAILED(InputLayoutCache::Get().GetOrCreate(Graphics::Impl::GetDevice(), pVSInfo->signatureHash, pMeshResource->streamElements,
+				pMeshResource->streamLayoutHash, pVSInfo->pByteCode->GetBufferPointer(), pVSInfo->pByteCode->GetBufferSize(), &pInputLayout)))
+			return nullptr;
+		pMeshResource->signatureInputLayouts.emplace_back(pVSInfo->signatureHash, pInputLayout);
+	}
+	return pMeshResource;
 }
 
-void CommandBuffer::DrawMesh(MeshData* pMeshData, const XMath::Matrix4x4& matrix, Material* pMaterial, MaterialPropertyBlock* pPropertyBlock)
+void CommandBuffer::Impl::RecordDrawMesh(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const XMath::Matrix4x4& matrix, 
+	Material* pMaterial, MaterialPropertyBlock* pPropertyBlock, uint32_t indexStart, uint32_t indexCount, uint32_t baseVertex)
 {
+	if (indexStart >= pMeshData->m_IndexCount)
+		return;
+	indexCount = (std::min)(indexCount, pMeshData->m_IndexCount - indexStart);
 
-    Shader* pShader = pMaterial->GetShader();
+	Shader* pShader = pMaterial->GetActiveShader();
 	if (!pShader)
 		return;
+	// 输入布局在PrepareMeshResource中按着色器的签名准备
+	const VertexShaderInfo* pVSInfo = pShader->pImpl->m_Passes[0].pVSInfo;
+	ID3D11InputLayout* pInputLayout = pVSInfo ? pMeshResource->FindInputLayout(pVSInfo->signatureHash) : nullptr;
+	if (!pInputLayout)
+		return;
 
-    auto pMeshResource = ResourceManager::Get().FindMeshGraphicsResources(pMeshData);
-    if (!pMeshResource)
-    {
-        pMeshResource = ResourceManager::Get().CreateMeshGraphicsResources(pMeshData);
-    }
-    if (pMeshData->m_IsUploading)
-    {
-		// TODO: 多Pass
-        if (!pImpl->UpdateMeshResource(pMeshData, pMeshResource, pShader->pImpl->m_Passes[0].GetInputSignatures()))
-			return;
-    }
+	auto& cbuffers = GetCBufferDatas(pShader);
+	auto& shaderImpl = *pShader->pImpl;
 
 	//
 	// 常量缓冲区更新
 	//
-	pShader->SetGlobalMatrix(Shader::StringToID("x_Matrix_LocalToWorld"), matrix);
-	pShader->SetGlobalMatrix(Shader::StringToID("x_Matrix_WorldToLocal"), matrix.inverse());
-	pShader->SetGlobalMatrix(Shader::StringToID("x_Matrix_View"), pImpl->m_View);
-	pShader->SetGlobalMatrix(Shader::StringToID("x_Matrix_Proj"), pImpl->m_Proj);
-	pShader->SetGlobalMatrix(Shader::StringToID("x_Matrix_ViewProj"), pImpl->m_Proj * pImpl->m_View);
+	// 物体的变换矩阵总是仿射的
+	XMath::Matrix4x4 worldToLocal = XMath::Matrix::InverseAffine(matrix);
+	shaderImpl.SetRaw(cbuffers, s_LocalToWorldID, matrix.data(), 0, (uint32_t)sizeof matrix);
+	shaderImpl.SetRaw(cbuffers, s_WorldToLocalID, worldToLocal.data(), 0, (uint32_t)sizeof worldToLocal);
+	// 摄像机矩阵在同一摄像机下不变，SetRaw比较后不会重复标记为脏
+	shaderImpl.SetRaw(cbuffers, s_ViewID, m_View.data(), 0, (uint32_t)sizeof m_View);
+	shaderImpl.SetRaw(cbuffers, s_ProjID, m_Proj.data(), 0, (uint32_t)sizeof m_Proj);
+	shaderImpl.SetRaw(cbuffers, s_ViewProjID, m_ViewProj.data(), 0, (uint32_t)sizeof m_ViewProj);
 
-	for (auto& attri : pMaterial->m_PropertyBlock.m_Properties)
-	{
-		switch (attri.second.index())
-		{
-		case 0: pShader->SetGlobalInt(attri.first, std::get<0>(attri.second)); break;
-		case 1: pShader->SetGlobalFloat(attri.first, std::get<1>(attri.second)); break;
-		case 2: pShader->SetGlobalVector(attri.first, std::get<2>(attri.second)); break;
-		case 3: pShader->SetGlobalColor(attri.first, std::get<3>(attri.second)); break;
-		case 4: pShader->SetGlobalMatrix(attri.first, std::get<4>(attri.second)); break;
-		case 5: pShader->SetGlobalVectorArray(attri.first, std::get<5>(attri.second)); break;
-		case 6: pShader->SetGlobalMatrixArray(attri.first, std::get<6>(attri.second)); break;
-		}
-	}
-
-	if (pPropertyBlock)
+	// 材质属性使用烘焙好的镜像：完整覆盖的常量缓冲区直接绑定材质的缓冲区，
+	// 其余的按区间拷贝。属性块会覆盖材质的值，此时不能使用材质的缓冲区
+	const MaterialCBufferCache* pCache = pMaterial->m_pCBufferCache.get();
+	const CBufferOverride* pOverrides = nullptr;
+	uint32_t numOverrides = 0;
+	if (pCache && pCache->pShader == pShader && pCache->propertyVersion == pMaterial->m_PropertyBlock.m_Version)
 	{
-		for (auto& attri : pPropertyBlock->m_Properties)
+		for (auto& image : pCache->images)
 		{
-			switch (attri.second.index())
+			if (image.pBuffer && !pPropertyBlock)
+				continue;
+			auto it = cbuffers.find(image.startSlot);
+			if (it == cbuffers.end())
+				continue;
+			for (auto& range : image.ranges)
 			{
-			case 0: pShader->SetGlobalInt(attri.first, std::get<0>(attri.second)); break;
-			case 1: pShader->SetGlobalFloat(attri.first, std::get<1>(attri.second)); break;
-			case 2: pShader->SetGlobalVector(attri.first, std::get<2>(attri.second)); break;
-			case 3: pShader->SetGlobalColor(attri.first, std::get<3>(attri.second)); break;
-			case 4: pShader->SetGlobalMatrix(attri.first, std::get<4>(attri.second)); break;
-			case 5: pShader->SetGlobalVectorArray(attri.first, std::get<5>(attri.second)); break;
-			case 6: pShader->SetGlobalMatrixArray(attri.first, std::get<6>(attri.second)); break;
+				if (memcmp(it->second.data.data() + range.first, image.data.data() + range.first, range.second))
+				{
+					memcpy_s(it->second.data.data() + range.first, range.second, image.data.data() + range.first, range.second);
+					it->second.MarkDirty(range.first, range.second);
+				}
 			}
 		}
+		if (!pPropertyBlock)
+		{
+			pOverrides = pCache->overrides.data();
+			numOverrides = (uint32_t)pCache->overrides.size();
+		}
+	}
+	else
+	{
+		SetProperties(pShader, cbuffers, pMaterial->m_PropertyBlock);
 	}
+
+	if (pPropertyBlock)
+		SetProperties(pShader, cbuffers, *pPropertyBlock);
+
 	//
 	// TODO: 纹理更新
 	//
@@ -184,34 +464,340 @@ void CommandBuffer::DrawMesh(MeshData* pMeshData, const XMath::Matrix4x4& matrix
 	}*/
 
 	// TODO: 多Pass
-	pShader->pImpl->m_Passes[0].Apply(pImpl->m_pDeferredContext.Get());
+	ShaderPass& pass = shaderImpl.m_Passes[0];
+	DXGI_FORMAT indexFormat = pMeshData->m_IndexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+	if (m_Batching)
+	{
+		// 常量已按本次绘制的值写入CPU页，绑定与绘制在EndDrawBatch中录制
+		m_BatchedDraws.push_back({ &pass, &cbuffers, pMeshResource, pInputLayout, indexFormat, indexStart, indexCount, baseVertex,
+			m_BatchCBufferBindings.size() });
+		pass.PrepareCBuffers(m_pDeferredContext.Get(), cbuffers, m_pFrameCBuffer.get(), pOverrides, numOverrides, m_BatchCBufferBindings);
+		return;
+	}
+	pass.Apply(m_pDeferredContext.Get(), cbuffers, m_pFrameCBuffer.get(), pOverrides, numOverrides, &m_BoundStates);
+	RecordDrawIndexed(pMeshResource, pInputLayout, indexFormat, indexStart, indexCount, baseVertex);
+}
 
-	pImpl->m_pDeferredContext->IASetVertexBuffers(0, (uint32_t)pMeshResource->vertexBuffers.size(), pMeshResource->vertexBuffers.data(),
+void CommandBuffer::Impl::RecordDrawIndexed(MeshGraphicsResource* pMeshResource, ID3D11InputLayout* pInputLayout, DXGI_FORMAT indexFormat,
+	uint32_t indexStart, uint32_t indexCount, uint32_t baseVertex)
+{
+	m_pDeferredContext->IASetVertexBuffers(0, (uint32_t)pMeshResource->vertexBuffers.size(), pMeshResource->vertexBuffers.data(),
 		pMeshResource->strides.data(), pMeshResource->offsets.data());
-	pImpl->m_pDeferredContext->IASetIndexBuffer(pMeshResource->indexBuffer, (pMeshData->m_IndexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT), 0);
-	pImpl->m_pDeferredContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	pImpl->m_pDeferredContext->IASetInputLayout(pShader->pImpl->m_Passes[0].pVSInfo->pDefaultInputLayout.Get());
-	pImpl->m_pDeferredContext->DrawIndexed(pMeshData->m_IndexCount, 0, 0);
+	m_pDeferredContext->IASetIndexBuffer(pMeshResource->indexBuffer, indexFormat, 0);
+	m_pDeferredContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	m_pDeferredContext->IASetInputLayout(pInputLayout);
+	m_pDeferredContext->DrawIndexed(indexCount, indexStart, (INT)baseVertex);
+}
+
+void CommandBuffer::Impl::BeginDrawBatch()
+{
+	m_Batching = m_pFrameCBuffer && m_pFrameCBuffer->IsSupported() && Shader::IsConstantRingEnabled();
+	if (m_Batching)
+		m_pFrameCBuffer->BeginBatch();
+}
+
+void CommandBuffer::Impl::EndDrawBatch()
+{
+	if (!m_Batching)
+		return;
+	m_Batching = false;
+
+	// 延迟上下文中的Map需要位于引用它的绘制之前，所有绘制的常量写完后每页只Map一次
+	m_pFrameCBuffer->EndBatch();
+	for (auto& draw : m_BatchedDraws)
+	{
+		draw.pPass->Apply(m_pDeferredContext.Get(), *draw.pCBuffers, m_pFrameCBuffer.get(), nullptr, 0, &m_BoundStates,
+			m_BatchCBufferBindings.data() + draw.firstCBufferBinding);
+		RecordDrawIndexed(draw.pMeshResource, draw.pInputLayout, draw.indexFormat, draw.indexStart, draw.indexCount, draw.baseVertex);
+	}
+	m_BatchedDraws.clear();
+	m_BatchCBufferBindings.clear();
+}
+
+void CommandBuffer::Impl::SetProperties(Shader* pShader, std::map<uint32_t, CBufferData>& cbuffers, const MaterialPropertyBlock& block)
+{
+	for (auto& entry : block.m_Entries)
+	{
+		pShader->pImpl->SetRaw(cbuffers, entry.id, block.m_Payload.data() + entry.offset, 0, entry.byteWidth);
+	}
+}
+
+Shader* CommandBuffer::Impl::PrepareMaterial(Material* pMaterial)
+{
+	Shader* pShader = pMaterial->ResolveShader();
+	if (!pShader)
+		return nullptr;
+
+	auto& pCache = pMaterial->m_pCBufferCache;
+	if (pCache && pCache->pShader == pShader && pCache->shaderVersion == pShader->pImpl->m_Version &&
+		pCache->propertyVersion == pMaterial->m_PropertyBlock.m_Version)
+		return pShader;
+
+	// 材质的副本共享同一份缓存，重建时不能修改共享的缓存；独占时原地重建，复用已创建的常量缓冲区
+	std::vector<MaterialCBufferCache::CBufferImage> oldImages;
+	if (!pCache || pCache.use_count() > 1)
+		pCache = std::make_shared<MaterialCBufferCache>();
+	else
+		oldImages.swap(pCache->images);
+	pCache->overrides.clear();
+	pCache->pShader = pShader;
+	pCache->shaderVersion = pShader->pImpl->m_Version;
+	pCache->propertyVersion = pMaterial->m_PropertyBlock.m_Version;
+
+	auto& shaderImpl = *pShader->pImpl;
+	std::map<uint32_t, uint32_t> coveredCounts;
+	const MaterialPropertyBlock& block = pMaterial->m_PropertyBlock;
+	for (auto& entry : block.m_Entries)
+	{
+		auto propIt = shaderImpl.m_Properties.find(entry.id);
+		if (propIt == shaderImpl.m_Properties.end())
+			continue;
+		const Property& prop = propIt->second;
+		uint32_t startSlot = prop.pCBufferData->startSlot;
+
+		auto imageIt = std::find_if(pCache->images.begin(), pCache->images.end(),
+			[startSlot](const MaterialCBufferCache::CBufferImage& image) { return image.startSlot == startSlot; });
+		if (imageIt == pCache->images.end())
+		{
+			pCache->images.push_back({ startSlot, prop.pCBufferData->data });
+			imageIt = pCache->images.end() - 1;
+		}
+
+		uint32_t byteWidth = (std::min)(entry.byteWidth, prop.byteWidth);
+		if (byteWidth == 0)
+			continue;
+		memcpy_s(imageIt->data.data() + prop.startByteOffset, byteWidth, block.m_Payload.data() + entry.offset, byteWidth);
+		imageIt->ranges.emplace_back(prop.startByteOffset, byteWidth);
+		++coveredCounts[startSlot];
+	}
+
+	std::map<uint32_t, uint32_t> propertyCounts;
+	for (auto& prop : shaderImpl.m_Properties)
+		++propertyCounts[prop.second.pCBufferData->startSlot];
+
+	for (auto& image : pCache->images)
+	{
+		// 合并相邻的区间
+		std::sort(image.ranges.begin(), image.ranges.end());
+		std::vector<std::pair<uint32_t, uint32_t>> merged;
+		for (auto& range : image.ranges)
+		{
+			if (!merged.empty() && merged.back().first + merged.back().second >= range.first)
+			{
+				uint32_t end = (std::max)(merged.back().first + merged.back().second, range.first + range.second);
+				merged.back().second = end - merged.back().first;
+			}
+			else
+				merged.push_back(range);
+		}
+		image.ranges = std::move(merged);
+
+		// 材质提供了该常量缓冲区的所有属性，绘制时可直接绑定
+		if (coveredCounts[image.startSlot] != propertyCounts[image.startSlot])
+			continue;
+		auto oldIt = std::find_if(oldImages.begin(), oldImages.end(), [&image](const MaterialCBufferCache::CBufferImage& oldImage) {
+			return oldImage.startSlot == image.startSlot && oldImage.pBuffer && oldImage.data.size() == image.data.size();
+		});
+		if (oldIt != oldImages.end())
+		{
+			image.pBuffer = std::move(oldIt->pBuffer);
+			if (oldIt->data == image.data)
+			{
+				pCache->overrides.push_back({ image.startSlot, image.pBuffer.Get() });
+				continue;
+			}
+		}
+		else
+		{
+			D3D11_BUFFER_DESC cbd{};
+			cbd.Usage = D3D11_USAGE_DEFAULT;
+			cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			cbd.ByteWidth = (uint32_t)image.data.size();
+			if (FAILED(Graphics::Impl::GetDevice()->CreateBuffer(&cbd, nullptr, image.pBuffer.GetAddressOf())))
+				continue;
+		}
+		// 在录制绘制的延迟上下文中更新，之前录制的绘制仍使用旧的值
+		m_pDeferredContext->UpdateSubresource(image.pBuffer.Get(), 0, nullptr, image.data.data(), 0, 0);
+		CBufferData::s_UploadBytes[(size_t)CBufferFrequency::PerMaterial].fetch_add(image.data.size(), std::memory_order_relaxed);
+		CBufferData::s_UpdateSubresourceCount.fetch_add(1, std::memory_order_relaxed);
+		pCache->overrides.push_back({ image.startSlot, image.pBuffer.Get() });
+	}
+	return pShader;
+}
+
+std::map<uint32_t, CBufferData>& CommandBuffer::Impl::GetCBufferDatas(Shader* pShader)
+{
+	if (!m_UseLocalCBuffers)
+		return pShader->pImpl->m_CBuffers;
+
+	auto it = m_LocalCBuffers.find(pShader);
+	if (it == m_LocalCBuffers.end())
+	{
+		it = m_LocalCBuffers.try_emplace(pShader, pShader->pImpl->m_CBuffers).first;
+		CreateLocalCBuffers(it->second);
+	}
+	return it->second;
+}
+
+void CommandBuffer::Impl::CreateLocalCBuffers(std::map<uint32_t, CBufferData>& cbuffers)
+{
+	// 每物体的本地副本与着色器共享同一个动态ID3D11Buffer，各延迟上下文分别以WRITE_DISCARD映射，互不影响
+	// 部分更新的缓冲区依赖上次上传后的内容，每个本地副本需要独占一个
+	for (auto& cbuffer : cbuffers)
+	{
+		if (cbuffer.second.UsesPartialUpdate())
+		{
+			cbuffer.second.cBuffer.Reset();
+			ThrowIfFailed(cbuffer.second.CreateBuffer(Graphics::Impl::GetDevice()));
+		}
+		cbuffer.second.MarkAllDirty();
+	}
+}
+
+void CommandBuffer::Impl::SyncLocalCBufferDatas()
+{
+	for (auto& localCBuffers : m_LocalCBuffers)
+	{
+		// 着色器热重载后常量缓冲区被重建，重新复制整个布局
+		auto& shaderCBuffers = localCBuffers.first->pImpl->m_CBuffers;
+		bool isStale = localCBuffers.second.size() != shaderCBuffers.size() ||
+			!std::equal(localCBuffers.second.begin(), localCBuffers.second.end(), shaderCBuffers.begin(),
+				[](auto& lhs, auto& rhs) {
+					return lhs.first == rhs.first && lhs.second.cbufferName == rhs.second.cbufferName &&
+						lhs.second.data.size() == rhs.second.data.size() &&
+						(lhs.second.UsesPartialUpdate() || lhs.second.cBuffer == rhs.second.cBuffer);
+				});
+		if (isStale)
+		{
+			localCBuffers.second = shaderCBuffers;
+			CreateLocalCBuffers(localCBuffers.second);
+			continue;
+		}
+
+		for (auto& cbuffer : localCBuffers.second)
+		{
+			auto it = shaderCBuffers.find(cbuffer.first);
+			if (it == shaderCBuffers.end())
+				continue;
+			std::vector<uint8_t>& dst = cbuffer.second.data;
+			const std::vector<uint8_t>& src = it->second.data;
+			if (!cbuffer.second.UsesPartialUpdate())
+			{
+				// 共享的动态缓冲区可能已被其他上下文重新映射，总是重新上传
+				dst = src;
+				cbuffer.second.MarkAllDirty();
+				continue;
+			}
+			// 独占的缓冲区只上传与上一帧不同的区间，未改变时不上传
+			auto first = std::mismatch(dst.begin(), dst.end(), src.begin());
+			if (first.first == dst.end())
+				continue;
+			auto last = std::mismatch(dst.rbegin(), dst.rend(), src.rbegin());
+			uint32_t begin = (uint32_t)(first.first - dst.begin());
+			uint32_t end = (uint32_t)(dst.rend() - last.first);
+			memcpy_s(dst.data() + begin, end - begin, src.data() + begin, end - begin);
+			cbuffer.second.MarkDirty(begin, end - begin);
+		}
+	}
+}
+
+DynamicVertexRing& CommandBuffer::Impl::GetVertexRing()
+{
+	if (!m_pVertexRing)
+		m_pVertexRing = std::make_unique<DynamicVertexRing>(Graphics::Impl::GetDevice(), m_pDeferredContext.Get());
+	return *m_pVertexRing;
+}
+
+void CommandBuffer::Impl::FinishCommandList(bool restoreDeferredContextState, ID3D11CommandList** ppCommandList)
+{
+	EndDrawBatch();
+	m_pDeferredContext->FinishCommandList(restoreDeferredContextState, ppCommandList);
+	// 命令列表总是从默认状态开始执行，之后的绘制需要重新设置渲染状态
+	m_BoundStates.Invalidate();
+	// 常量页与动态顶点环都是按命令列表WRITE_DISCARD的
+	if (m_pFrameCBuffer)
+		m_pFrameCBuffer->Reset();
+	if (m_pVertexRing)
+		m_pVertexRing->Reset();
+}
+
+CommandBuffer::CommandBuffer()
+    : pImpl(std::make_unique<CommandBuffer::Impl>())
+{
+    ThrowIfFailed(Graphics::Impl::GetDevice()->CreateDeferredContext(0, pImpl->m_pDeferredContext.GetAddressOf()));
+    pImpl->m_pFrameCBuffer = std::make_unique<FrameConstantBuffer>(Graphics::Impl::GetDevice(), pImpl->m_pDeferredContext.Get());
+}
+
+CommandBuffer::~CommandBuffer()
+{
+}
+
+void CommandBuffer::Clear()
+{
+    pImpl->m_pCommandLists.clear();
+}
+
+void CommandBuffer::ClearRenderTarget(bool clearDepth, bool clearColor, Color backgroundColor, float depth)
+{
+    RenderTexture* pRenderTarget = pImpl->m_pRenderTarget;
+    ID3D11RenderTargetView* pRTV = pRenderTarget ? pRenderTarget->GetColorBufferRTV() : Graphics::Impl::GetColorBuffer();
+    ID3D11DepthStencilView* pDSV = pRenderTarget ? pRenderTarget->GetDepthBufferDSV() : Graphics::Impl::GetDepthBuffer();
+    if (clearColor && pRTV)
+    {
+        pImpl->m_pDeferredContext->ClearRenderTargetView(pRTV, backgroundColor);
+    }
+    if (clearDepth && pDSV)
+    {
+        pImpl->m_pDeferredContext->ClearDepthStencilView(pDSV, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, depth, 0);
+    }
+}
+
+void CommandBuffer::DrawMesh(MeshData* pMeshData, const XMath::Matrix4x4& matrix, Material* pMaterial, MaterialPropertyBlock* pPropertyBlock)
+{
+	Shader* pShader = pImpl->PrepareMaterial(pMaterial);
+	if (!pShader)
+		return;
+	auto pMeshResource = pImpl->PrepareMeshResource(pMeshData, pShader);
+	if (!pMeshResource)
+		return;
+	pImpl->RecordDrawMesh(pMeshData, pMeshResource, matrix, pMaterial, pPropertyBlock);
 }
 
 void CommandBuffer::SetViewport(const Rect& rect)
 {
-    D3D11_VIEWPORT vp{ rect.x(), rect.y(), rect.width() * Graphics::Impl::GetClientWidth(), rect.height() * Graphics::Impl::GetClientHeight(), 0.0f, 1.0f };
+    float width = pImpl->m_pRenderTarget ? (float)pImpl->m_pRenderTarget->GetWidth() : (float)Graphics::Impl::GetClientWidth();
+    float height = pImpl->m_pRenderTarget ? (float)pImpl->m_pRenderTarget->GetHeight() : (float)Graphics::Impl::GetClientHeight();
+    D3D11_VIEWPORT vp{ rect.x(), rect.y(), rect.width() * width, rect.height() * height, 0.0f, 1.0f };
     pImpl->m_pDeferredContext->RSSetViewports(1, &vp);
 }
 
 void CommandBuffer::SetViewMatrix(const XMath::Matrix4x4& matrix)
 {
     pImpl->m_View = matrix;
+    pImpl->m_ViewProj = pImpl->m_Proj * pImpl->m_View;
 }
 
 void CommandBuffer::SetProjMatrix(const XMath::Matrix4x4& matrix)
 {
     pImpl->m_Proj = matrix;
+    pImpl->m_ViewProj = pImpl->m_Proj * pImpl->m_View;
 }
 
 void CommandBuffer::SetRenderTarget()
 {
-	ID3D11RenderTargetView* pRTVs[1] = { Graphics::Impl::GetColorBuffer() };
-	pImpl->m_pDeferredContext->OMSetRenderTargets(1, pRTVs, Graphics::Impl::GetDepthBuffer());
+	SetRenderTarget(nullptr);
+}
+
+void CommandBuffer::SetRenderTarget(RenderTexture* pRenderTexture)
+{
+	pImpl->m_pRenderTarget = pRenderTexture;
+	if (!pRenderTexture)
+	{
+		ID3D11RenderTargetView* pRTVs[1] = { Graphics::Impl::GetColorBuffer() };
+		pImpl->m_pDeferredContext->OMSetRenderTargets(1, pRTVs, Graphics::Impl::GetDepthBuffer());
+		return;
+	}
+
+	ID3D11RenderTargetView* pRTV = pRenderTexture->GetColorBufferRTV();
+	pImpl->m_pDeferredContext->OMSetRenderTargets(pRTV ? 1 : 0, pRTV ? &pRTV : nullptr, pRenderTexture->GetDepthBufferDSV());
 }
@@ -1,7 +1,34 @@
+#pragma once
+
 #include <Graphics/CommandBuffer.h>
 #include <Graphics/ResourceManager.h>
 #include <wrl/client.h>
 #include <d3d11_1.h>
+#include <unordered_map>
+#include "ShaderImpl.h"
+#include "DynamicVertexRing.h"
+
+
+// 材质按着色器反射布局烘焙好的常量缓冲区数据
+struct MaterialCBufferCache
+{
+    struct CBufferImage
+    {
+        uint32_t startSlot = 0;
+        // 以着色器当前数据为底，写入材质属性后的完整镜像
+        std::vector<uint8_t> data;
+        // 材质写入过的字节区间(已合并)
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        // 材质覆盖了该常量缓冲区的全部属性时，预先上传好的DEFAULT缓冲区，属性改变时原地更新
+        Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+    };
+
+    Shader* pShader = nullptr;
+    uint32_t shaderVersion = 0;
+    uint64_t propertyVersion = 0;
+    std::vector<CBufferImage> images;
+    std::vector<CBufferOverride> overrides;
+};
 
 
 class CommandBuffer::Impl
@@ -12,12 +39,79 @@ public:
     }
     ~Impl() = default;
 
-    bool UpdateMeshResource(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const std::vector<D3D11_INPUT_ELEMENT_DESC>& inputLayout);
+    bool UpdateMeshResource(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const VertexShaderInfo& vsInfo);
+
+    // 查找或创建网格的GPU资源并上传数据，会修改ResourceManager与MeshData，仅允许在主线程调用
+    MeshGraphicsResource* PrepareMeshResource(MeshData* pMeshData, Shader* pShader);
+    // 仅录制绘制命令，不修改共享资源，可在工作线程调用
+    // [indexStart, indexStart + indexCount)为要绘制的索引区间，默认绘制整个网格
+    void RecordDrawMesh(MeshData* pMeshData, MeshGraphicsResource* pMeshResource, const XMath::Matrix4x4& matrix, 
+        Material* pMaterial, MaterialPropertyBlock* pPropertyBlock, uint32_t indexStart = 0, uint32_t indexCount = UINT32_MAX,
+        uint32_t baseVertex = 0);
+    void RecordDrawIndexed(MeshGraphicsResource* pMeshResource, ID3D11InputLayout* pInputLayout, DXGI_FORMAT indexFormat,
+        uint32_t indexStart, uint32_t indexCount, uint32_t baseVertex);
+
+    // 批量录制之间的RecordDrawMesh只写入常量并在帧常量缓冲区的CPU页中分配，
+    // EndDrawBatch时每页只Map一次，再按顺序录制绑定与绘制。帧常量缓冲区不可用时逐个录制
+    void BeginDrawBatch();
+    void EndDrawBatch();
+
+    // 解析材质当前关键字对应的着色器变体并返回，材质属性或着色器变化时重新烘焙常量缓冲区镜像，
+    // 并在该命令缓冲区中录制对材质常量缓冲区的更新。会修改材质，仅允许在主线程调用
+    Shader* PrepareMaterial(Material* pMaterial);
+    // 将属性块的值逐个写入常量缓冲区
+    void SetProperties(Shader* pShader, std::map<uint32_t, CBufferData>& cbuffers, const MaterialPropertyBlock& block);
+
+    // 获取录制时使用的常量缓冲区数据。开启本地常量缓冲区后返回该命令缓冲区独有的副本，
+    // 避免多个工作线程同时写入着色器的CBufferData
+    std::map<uint32_t, CBufferData>& GetCBufferDatas(Shader* pShader);
+    // 从着色器同步本地常量缓冲区副本，并标记为需要更新(新的命令列表需要重新Map)
+    // 独占缓冲区的副本只标记与上一帧不同的区间
+    void SyncLocalCBufferDatas();
+    // 为部分更新的常量缓冲区创建副本独占的缓冲区，并标记为整体需要更新
+    void CreateLocalCBuffers(std::map<uint32_t, CBufferData>& cbuffers);
+
+    // 动态顶点数据的上传缓冲区，首次使用时创建
+    DynamicVertexRing& GetVertexRing();
+    // 结束当前命令列表。之后的第一次上传需要重新WRITE_DISCARD
+    void FinishCommandList(bool restoreDeferredContextState, ID3D11CommandList** ppCommandList);
 
     // Deferred Context
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_pDeferredContext;
     std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>> m_pCommandLists;
 
-    XMath::Matrix4x4 m_View;
-    XMath::Matrix4x4 m_Proj;
+    // 常量数据的线性分配，写入延迟上下文，每个命令列表结束后回收
+    std::unique_ptr<FrameConstantBuffer> m_pFrameCBuffer;
+    std::unique_ptr<DynamicVertexRing> m_pVertexRing;
+
+    // 延迟上下文中已设置的渲染状态
+    RenderStateBindings m_BoundStates;
+
+    // 批量录制中等待录制的绘制，常量缓冲区的绑定在m_BatchCBufferBindings中从firstCBufferBinding开始
+    struct BatchedDraw
+    {
+        ShaderPass* pPass;
+        std::map<uint32_t, CBufferData>* pCBuffers;
+        MeshGraphicsResource* pMeshResource;
+        ID3D11InputLayout* pInputLayout;
+        DXGI_FORMAT indexFormat;
+        uint32_t indexStart;
+        uint32_t indexCount;
+        uint32_t baseVertex;
+        size_t firstCBufferBinding;
+    };
+    bool m_Batching = false;
+    std::vector<BatchedDraw> m_BatchedDraws;
+    std::vector<FrameConstantBuffer::Binding> m_BatchCBufferBindings;
+
+    bool m_UseLocalCBuffers = false;
+    std::unordered_map<Shader*, std::map<uint32_t, CBufferData>> m_LocalCBuffers;
+
+    // 摄像机相关的矩阵在设置时计算一次，每次绘制直接使用
+    XMath::Matrix4x4 m_View = XMath::Matrix4x4::Identity();
+    XMath::Matrix4x4 m_Proj = XMath::Matrix4x4::Identity();
+    XMath::Matrix4x4 m_ViewProj = XMath::Matrix4x4::Identity();
+
+    // 当前渲染目标，nullptr表示后备缓冲区
+    RenderTexture* m_pRenderTarget = nullptr;
 };
@@ -0,0 +1,66 @@
+#include "ConstantRingAllocator.h"
+#include <cstring>
+
+ConstantRingAllocator::ConstantRingAllocator(uint32_t pageSize)
+	: m_PageSize((pageSize + s_Alignment - 1) & ~(s_Alignment - 1))
+{
+	if (m_PageSize < s_MaxAllocationSize)
+		m_PageSize = s_MaxAllocationSize;
+}
+
+ConstantRingAllocator::Allocation ConstantRingAllocator::Allocate(uint32_t byteSize)
+{
+	Allocation allocation;
+	if (byteSize == 0 || byteSize > s_MaxAllocationSize)
+		return allocation;
+
+	uint32_t alignedSize = (byteSize + s_Alignment - 1) & ~(s_Alignment - 1);
+	// 当前页剩余空间不足时切换到下一页
+	if (m_CurrOffset + alignedSize > m_PageSize)
+	{
+		m_PageUsedBytes[m_CurrPage] = m_CurrOffset;
+		++m_CurrPage;
+		m_CurrOffset = 0;
+	}
+	if (m_CurrPage == m_Pages.size())
+	{
+		m_Pages.emplace_back(m_PageSize);
+		m_PageUsedBytes.push_back(0);
+	}
+
+	allocation.pageIndex = m_CurrPage;
+	allocation.byteOffset = m_CurrOffset;
+	allocation.byteSize = alignedSize;
+	allocation.pData = m_Pages[m_CurrPage].data() + m_CurrOffset;
+
+	m_CurrOffset += alignedSize;
+	m_PageUsedBytes[m_CurrPage] = m_CurrOffset;
+	m_AllocatedBytes += alignedSize;
+	return allocation;
+}
+
+ConstantRingAllocator::Allocation ConstantRingAllocator::Allocate(const void* data, uint32_t byteSize)
+{
+	Allocation allocation = Allocate(byteSize);
+	if (allocation.pData)
+	{
+		memcpy(allocation.pData, data, byteSize);
+		// 对齐填充部分清零，避免上传未初始化的数据
+		memset(allocation.pData + byteSize, 0, allocation.byteSize - byteSize);
+	}
+	return allocation;
+}
+
+void ConstantRingAllocator::Reset()
+{
+	m_CurrPage = 0;
+	m_CurrOffset = 0;
+	m_AllocatedBytes = 0;
+	m_PageUsedBytes.assign(m_PageUsedBytes.size(), 0);
+	++m_Generation;
+}
+
+uint32_t ConstantRingAllocator::GetPageUsedBytes(uint32_t pageIndex) const
+{
+	return pageIndex < m_PageUsedBytes.size() ? m_PageUsedBytes[pageIndex] : 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 线性分配的常量数据分配器
+// 仅负责CPU端的内存布局，不依赖D3D设备：数据按页存放，每次分配按256字节对齐，
+// 分配后由FrameConstantBuffer写入对应的GPU缓冲区，命令列表结束后调用Reset重用
+class ConstantRingAllocator
+{
+public:
+	// 常量缓冲区偏移绑定要求以16个常量(256字节)为单位
+	static constexpr uint32_t s_Alignment = 256;
+	// 单次绑定最多4096个常量
+	static constexpr uint32_t s_MaxAllocationSize = 65536;
+
+	struct Allocation
+	{
+		uint32_t pageIndex = 0;
+		uint32_t byteOffset = 0;
+		uint32_t byteSize = 0;			// 对齐后的大小
+		uint8_t* pData = nullptr;
+
+		uint32_t GetFirstConstant() const { return byteOffset / 16; }
+		uint32_t GetNumConstants() const { return byteSize / 16; }
+	};
+
+	explicit ConstantRingAllocator(uint32_t pageSize = 256 * 1024);
+
+	// byteSize为0或超过s_MaxAllocationSize时返回pData为nullptr的分配结果
+	Allocation Allocate(uint32_t byteSize);
+	Allocation Allocate(const void* data, uint32_t byteSize);
+
+	// 回收所有分配，保留已有的页
+	void Reset();
+
+	uint32_t GetPageSize() const { return m_PageSize; }
+	uint32_t GetPageCount() const { return (uint32_t)m_Pages.size(); }
+	// 本帧被使用的页数，后面的页无需上传
+	uint32_t GetUsedPageCount() const { return m_CurrPage + (m_CurrOffset > 0 ? 1 : 0); }
+	const uint8_t* GetPageData(uint32_t pageIndex) const { return m_Pages[pageIndex].data(); }
+	uint32_t GetPageUsedBytes(uint32_t pageIndex) const;
+
+	// 每次Reset后递增，用于判断之前的分配是否仍然有效
+	uint64_t GetGeneration() const { return m_Generation; }
+	size_t GetAllocatedBytes() const { return m_AllocatedBytes; }
+
+private:
+	uint32_t m_PageSize;
+	uint32_t m_CurrPage = 0;
+	uint32_t m_CurrOffset = 0;
+	uint64_t m_Generation = 1;
+	size_t m_AllocatedBytes = 0;
+	std::vector<uint32_t> m_PageUsedBytes;
+	std::vector<std::vector<uint8_t>> m_Pages;
+};
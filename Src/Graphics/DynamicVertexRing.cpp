@@ -0,0 +1,77 @@
+#include "DynamicVertexRing.h"
+#include "DXTrace.h"
+#include <algorithm>
+#include <cstring>
+
+DynamicVertexRing::DynamicVertexRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32_t initialCapacity)
+	: m_pDevice(device), m_pDeviceContext(deviceContext)
+{
+	Grow((std::max)(initialCapacity, s_Alignment));
+}
+
+DynamicVertexRing::Allocation DynamicVertexRing::Upload(const void* data, uint32_t byteSize)
+{
+	Allocation allocation;
+	if (byteSize == 0)
+		return allocation;
+
+	uint32_t alignedSize = (byteSize + s_Alignment - 1) & ~(s_Alignment - 1);
+	if (m_Offset + alignedSize > m_Capacity)
+	{
+		// 本命令列表已写入的数据仍要保留，按已用量加本次大小翻倍扩容
+		uint64_t required = (uint64_t)m_Offset + alignedSize;
+		uint64_t newCapacity = m_Capacity;
+		while (newCapacity < required)
+			newCapacity *= 2;
+		if (newCapacity > UINT32_MAX)
+			return allocation;
+		Grow((uint32_t)newCapacity);
+	}
+
+	// 延迟上下文中资源的第一次Map必须使用WRITE_DISCARD，之后可以不覆盖地追加
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	if (FAILED(m_pDeviceContext->Map(m_pBuffer.Get(), 0,
+		m_NeedDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedData)))
+		return allocation;
+	memcpy(static_cast<uint8_t*>(mappedData.pData) + m_Offset, data, byteSize);
+	m_pDeviceContext->Unmap(m_pBuffer.Get(), 0);
+	m_NeedDiscard = false;
+
+	allocation.pBuffer = m_pBuffer.Get();
+	allocation.byteOffset = m_Offset;
+	allocation.byteSize = byteSize;
+	m_Offset += alignedSize;
+	return allocation;
+}
+
+bool DynamicVertexRing::CopyTo(ID3D11Buffer* pDestBuffer, uint32_t destOffset, const void* data, uint32_t byteSize)
+{
+	Allocation allocation = Upload(data, byteSize);
+	if (!allocation.pBuffer)
+		return false;
+
+	D3D11_BOX box{ allocation.byteOffset, 0, 0, allocation.byteOffset + byteSize, 1, 1 };
+	m_pDeviceContext->CopySubresourceRegion(pDestBuffer, 0, destOffset, 0, 0, allocation.pBuffer, 0, &box);
+	return true;
+}
+
+void DynamicVertexRing::Reset()
+{
+	m_Offset = 0;
+	m_NeedDiscard = true;
+}
+
+void DynamicVertexRing::Grow(uint32_t minCapacity)
+{
+	// 旧缓冲区被已录制的拷贝命令引用，由命令列表负责延长其生命周期
+	D3D11_BUFFER_DESC bd{};
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bd.ByteWidth = minCapacity;
+	m_pBuffer.Reset();
+	ThrowIfFailed(m_pDevice->CreateBuffer(&bd, nullptr, m_pBuffer.GetAddressOf()));
+	m_Capacity = minCapacity;
+	m_Offset = 0;
+	m_NeedDiscard = true;
+}
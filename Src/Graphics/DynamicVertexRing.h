@@ -0,0 +1,48 @@
+#pragma once
+
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <cstdint>
+
+// 每个CommandBuffer持有一个，用于动态顶点数据的上传
+// 数据先线性写入一个动态缓冲区：命令列表中的第一次Map使用WRITE_DISCARD，之后使用WRITE_NO_OVERWRITE追加，
+// 再通过CopySubresourceRegion拷贝到网格的顶点缓冲区中。空间不足时容量翻倍，已录制的拷贝仍引用旧的缓冲区
+class DynamicVertexRing
+{
+public:
+	// 拷贝源区间的对齐
+	static constexpr uint32_t s_Alignment = 16;
+
+	struct Allocation
+	{
+		ID3D11Buffer* pBuffer = nullptr;
+		uint32_t byteOffset = 0;
+		uint32_t byteSize = 0;
+	};
+
+	DynamicVertexRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32_t initialCapacity = 1024 * 1024);
+
+	DynamicVertexRing(const DynamicVertexRing&) = delete;
+	DynamicVertexRing& operator=(const DynamicVertexRing&) = delete;
+
+	// 写入数据并返回其在上传缓冲区中的位置，失败时pBuffer为nullptr
+	Allocation Upload(const void* data, uint32_t byteSize);
+	// 将数据上传并拷贝到pDestBuffer的destOffset处
+	bool CopyTo(ID3D11Buffer* pDestBuffer, uint32_t destOffset, const void* data, uint32_t byteSize);
+
+	// 命令列表结束后调用，下一个命令列表需要重新WRITE_DISCARD
+	void Reset();
+
+	uint32_t GetCapacity() const { return m_Capacity; }
+	uint32_t GetUsedBytes() const { return m_Offset; }
+
+private:
+	void Grow(uint32_t minCapacity);
+
+	Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_pDeviceContext;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_pBuffer;
+	uint32_t m_Capacity = 0;
+	uint32_t m_Offset = 0;
+	bool m_NeedDiscard = true;
+};
@@ -0,0 +1,83 @@
+#include "FrameConstantBuffer.h"
+#include "DXTrace.h"
+#include <cstring>
+
+FrameConstantBuffer::FrameConstantBuffer(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+	: m_pDevice(device)
+{
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof options)) &&
+		options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer)
+	{
+		deviceContext->QueryInterface(IID_PPV_ARGS(m_pDeviceContext1.GetAddressOf()));
+	}
+}
+
+FrameConstantBuffer::Binding FrameConstantBuffer::Upload(const void* data, uint32_t byteWidth)
+{
+	Binding binding;
+	auto allocation = m_Allocator.Allocate(data, byteWidth);
+	if (!allocation.pData)
+		return binding;
+
+	// GPU缓冲区与CPU页一一对应，按需创建
+	if (allocation.pageIndex == m_Pages.size())
+	{
+		D3D11_BUFFER_DESC cbd{};
+		cbd.Usage = D3D11_USAGE_DYNAMIC;
+		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		cbd.ByteWidth = m_Allocator.GetPageSize();
+		m_Pages.emplace_back();
+		ThrowIfFailed(m_pDevice->CreateBuffer(&cbd, nullptr, m_Pages.back().pBuffer.GetAddressOf()));
+	}
+
+	if (!m_Batching && !FlushPage(allocation.pageIndex))
+		return binding;
+
+	Page& page = m_Pages[allocation.pageIndex];
+	binding.pBuffer = page.pBuffer.Get();
+	binding.firstConstant = allocation.GetFirstConstant();
+	binding.numConstants = allocation.GetNumConstants();
+	return binding;
+}
+
+void FrameConstantBuffer::EndBatch()
+{
+	m_Batching = false;
+	for (uint32_t i = 0; i < m_Allocator.GetUsedPageCount(); ++i)
+		FlushPage(i);
+}
+
+bool FrameConstantBuffer::FlushPage(uint32_t pageIndex)
+{
+	Page& page = m_Pages[pageIndex];
+	uint32_t usedBytes = m_Allocator.GetPageUsedBytes(pageIndex);
+	if (usedBytes <= page.uploadedBytes)
+		return true;
+
+	// 延迟上下文中资源的第一次Map必须使用WRITE_DISCARD，丢弃后整页已使用的部分都要写入；
+	// 之后用WRITE_NO_OVERWRITE只追加新的数据，不覆盖已录制的绘制所引用的区间
+	uint32_t begin = page.needDiscard ? 0 : page.uploadedBytes;
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	if (FAILED(m_pDeviceContext1->Map(page.pBuffer.Get(), 0,
+		page.needDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedData)))
+		return false;
+	memcpy(static_cast<uint8_t*>(mappedData.pData) + begin, m_Allocator.GetPageData(pageIndex) + begin, usedBytes - begin);
+	m_pDeviceContext1->Unmap(page.pBuffer.Get(), 0);
+	(page.needDiscard ? s_DiscardMapCount : s_NoOverwriteMapCount).fetch_add(1, std::memory_order_relaxed);
+	page.needDiscard = false;
+	page.uploadedBytes = usedBytes;
+	return true;
+}
+
+void FrameConstantBuffer::Reset()
+{
+	m_Allocator.Reset();
+	m_Batching = false;
+	for (auto& page : m_Pages)
+	{
+		page.needDiscard = true;
+		page.uploadedBytes = 0;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ConstantRingAllocator.h"
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <atomic>
+#include <vector>
+
+// 每个CommandBuffer持有一个，录制时将常量数据线性分配到页中，并以
+// XSSetConstantBuffers1的偏移方式绑定。数据写入录制所用的延迟上下文：
+// 每页在命令列表中的第一次Map使用WRITE_DISCARD，之后使用WRITE_NO_OVERWRITE追加，
+// 因此命令列表只引用它自己写入的内容，与其它命令列表或即时上下文的更新无关
+// 单独的Upload每次都Map一次；BeginBatch与EndBatch之间的Upload只写入CPU页，
+// EndBatch时每个用到的页只Map一次，引用这些数据的绑定需要在EndBatch之后录制
+class FrameConstantBuffer
+{
+public:
+	struct Binding
+	{
+		ID3D11Buffer* pBuffer = nullptr;
+		uint32_t firstConstant = 0;
+		uint32_t numConstants = 0;
+	};
+
+	FrameConstantBuffer(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+
+	FrameConstantBuffer(const FrameConstantBuffer&) = delete;
+	FrameConstantBuffer& operator=(const FrameConstantBuffer&) = delete;
+
+	// 设备不支持常量缓冲区偏移绑定或不支持对动态常量缓冲区WRITE_NO_OVERWRITE时返回false，
+	// 此时应使用普通的动态常量缓冲区
+	bool IsSupported() const { return m_pDeviceContext1 != nullptr; }
+	ID3D11DeviceContext1* GetDeviceContext1() const { return m_pDeviceContext1.Get(); }
+
+	Binding Upload(const void* data, uint32_t byteWidth);
+	uint64_t GetGeneration() const { return m_Allocator.GetGeneration(); }
+
+	void BeginBatch() { m_Batching = true; }
+	// 上传批量期间写入的数据，每页一次Map
+	void EndBatch();
+
+	// 命令列表结束后调用，回收所有分配，下一个命令列表中每页需要重新WRITE_DISCARD
+	void Reset();
+
+	// 所有实例本帧的Map次数，工作线程录制时同样会累加
+	inline static std::atomic<uint64_t> s_DiscardMapCount = 0;
+	inline static std::atomic<uint64_t> s_NoOverwriteMapCount = 0;
+
+private:
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+		bool needDiscard = true;
+		uint32_t uploadedBytes = 0;		// 本命令列表中已写入GPU缓冲区的字节数
+	};
+
+	// 将页中尚未上传的数据写入GPU缓冲区
+	bool FlushPage(uint32_t pageIndex);
+
+	ConstantRingAllocator m_Allocator;
+	Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_pDeviceContext1;
+	std::vector<Page> m_Pages;
+	bool m_Batching = false;
+};
@@ -1,5 +1,6 @@
 #include <Graphics/ResourceManager.h>
 #include <Graphics/RenderStates.h>
+#include <Graphics/RenderTexturePool.h>
 #include "RenderContextImpl.h"
 #include "CommandBufferImpl.h"
 #include "GraphicsImpl.h"
@@ -23,6 +24,7 @@ namespace
 	ComPtr<ID3D11DepthStencilView> s_pDepthStencilBuffer;
 
 	std::unique_ptr<ResourceManager> s_pResourceManager;
+	std::unique_ptr<RenderTexturePool> s_pRenderTexturePool;
 
 	std::unique_ptr<RenderContext> s_pRenderContext;
 	RenderPipeline* s_pRenderPipeline;
@@ -184,6 +186,7 @@ bool Graphics::Impl::Initialize(HWND hWnd, int startWidth, int startHeight)
 	// 全局初始化
 	s_pRenderContext = std::unique_ptr<RenderContext>(new RenderContext);
 	s_pResourceManager = std::make_unique<ResourceManager>(s_pDevice.Get());
+	s_pRenderTexturePool = std::make_unique<RenderTexturePool>(s_pDevice.Get());
 	RenderStates::InitAll(s_pDevice.Get());
 	Shader::Impl::InitAll(s_pDevice.Get());
 	/*auto pMat = ResourceManager::Get().CreateMaterial("@DefaultColorLit");
@@ -270,6 +273,9 @@ void Graphics::Impl::RegisterRenderPipeline(RenderPipeline* rp)
 
 void Graphics::Impl::RunRenderPipeline()
 {
+	// 在帧边界替换热重载完成的着色器
+	Shader::Impl::UpdateHotReload();
+
 	auto cameras = Scene::GetMainScene()->GetComponents(Camera::GetType());
 	
 	auto it = std::remove_if(cameras.begin(), cameras.end(), [](Component* pCamera) {
@@ -283,12 +289,15 @@ void Graphics::Impl::RunRenderPipeline()
 		});
 	s_pRenderPipeline->Render(s_pRenderContext.get(), _cameras);
 	s_pSwapChain->Present(1, 0);
+	// 老化本帧没有再用到的临时纹理
+	s_pRenderTexturePool->EndFrame();
+	Shader::Impl::EndFrameStatistics();
 }
 
 void Graphics::Impl::SubmitRenderContext()
 {
 	ComPtr<ID3D11CommandList> pCmdList;
-	s_pRenderContext->pImpl->m_CommandBuffer.pImpl->m_pDeferredContext->FinishCommandList(false, pCmdList.GetAddressOf());
+	s_pRenderContext->pImpl->m_CommandBuffer.pImpl->FinishCommandList(false, pCmdList.GetAddressOf());
 	s_pImmediateContext->ExecuteCommandList(pCmdList.Get(), false);
 }
 
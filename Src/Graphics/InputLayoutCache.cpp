@@ -0,0 +1,106 @@
+#include "InputLayoutCache.h"
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace
+{
+	// 语义名不区分大小写
+	bool EqualsSemantic(std::string_view lhs, std::string_view rhs)
+	{
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+			[](char a, char b) { return toupper((unsigned char)a) == toupper((unsigned char)b); });
+	}
+
+	uint32_t GetComponentCount(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R32_FLOAT: case DXGI_FORMAT_R32_SINT: case DXGI_FORMAT_R32_UINT: return 1;
+		case DXGI_FORMAT_R32G32_FLOAT: case DXGI_FORMAT_R32G32_SINT: case DXGI_FORMAT_R32G32_UINT: return 2;
+		case DXGI_FORMAT_R32G32B32_FLOAT: case DXGI_FORMAT_R32G32B32_SINT: case DXGI_FORMAT_R32G32B32_UINT: return 3;
+		default: return 4;
+		}
+	}
+}
+
+InputLayoutCache& InputLayoutCache::Get()
+{
+	static InputLayoutCache s_Instance;
+	return s_Instance;
+}
+
+bool InputLayoutCache::IsSameSemantic(const D3D11_INPUT_ELEMENT_DESC& lhs, const D3D11_INPUT_ELEMENT_DESC& rhs)
+{
+	return lhs.SemanticIndex == rhs.SemanticIndex && EqualsSemantic(lhs.SemanticName, rhs.SemanticName);
+}
+
+bool InputLayoutCache::IsSystemValue(const char* semanticName)
+{
+	std::string_view name = semanticName ? semanticName : "";
+	return name.size() > 3 && EqualsSemantic(name.substr(0, 3), "SV_");
+}
+
+uint64_t InputLayoutCache::HashElements(const D3D11_INPUT_ELEMENT_DESC* pElements, uint32_t numElements)
+{
+	uint64_t hash = Hash::s_FNVOffsetBasis;
+	for (uint32_t i = 0; i < numElements; ++i)
+	{
+		const D3D11_INPUT_ELEMENT_DESC& element = pElements[i];
+		for (const char* p = element.SemanticName; p && *p; ++p)
+			hash = Hash::Combine(hash, (uint8_t)toupper((unsigned char)*p));
+		hash = Hash::Combine(hash, 0);
+		hash = Hash::Combine(hash, element.SemanticIndex);
+		hash = Hash::Combine(hash, (uint64_t)element.Format);
+		hash = Hash::Combine(hash, element.InputSlot);
+		hash = Hash::Combine(hash, element.AlignedByteOffset);
+		hash = Hash::Combine(hash, (uint64_t)element.InputSlotClass);
+		hash = Hash::Combine(hash, element.InstanceDataStepRate);
+	}
+	return hash;
+}
+
+bool InputLayoutCache::IsCompatible(const std::vector<D3D11_INPUT_ELEMENT_DESC>& streamElements,
+	const std::vector<D3D11_INPUT_ELEMENT_DESC>& signature)
+{
+	for (auto& input : signature)
+	{
+		if (IsSystemValue(input.SemanticName))
+			continue;
+		auto it = std::find_if(streamElements.begin(), streamElements.end(),
+			[&input](const D3D11_INPUT_ELEMENT_DESC& element) { return IsSameSemantic(element, input); });
+		if (it == streamElements.end())
+			return false;
+		// 以float2声明的法线在着色器中按八面体编码解码，顶点流必须是R16G16_SNORM，
+		// 其余格式(未压缩或R16G16B16A16_SNORM)只能用于float3/float4的声明
+		bool isOctahedral = it->Format == DXGI_FORMAT_R16G16_SNORM;
+		if (EqualsSemantic(input.SemanticName, "NORMAL") && isOctahedral != (GetComponentCount(input.Format) == 2))
+			return false;
+	}
+	return true;
+}
+
+HRESULT InputLayoutCache::GetOrCreate(ID3D11Device* device, uint64_t signatureHash, const std::vector<D3D11_INPUT_ELEMENT_DESC>& streamElements,
+	uint64_t streamLayoutHash, const void* pByteCode, size_t byteSize, ID3D11InputLayout** ppInputLayout)
+{
+	if (!device || !ppInputLayout || !pByteCode)
+		return E_INVALIDARG;
+
+	auto key = std::make_pair(signatureHash, streamLayoutHash);
+	if (auto it = m_InputLayouts.find(key); it != m_InputLayouts.end())
+	{
+		*ppInputLayout = it->second.Get();
+		return S_OK;
+	}
+
+	// 顶点流中着色器不使用的元素不影响创建
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout;
+	HRESULT hr = device->CreateInputLayout(streamElements.data(), (uint32_t)streamElements.size(), pByteCode, byteSize,
+		pInputLayout.GetAddressOf());
+	if (FAILED(hr))
+		return hr;
+	*ppInputLayout = pInputLayout.Get();
+	m_InputLayouts.emplace(key, std::move(pInputLayout));
+	return S_OK;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 按(顶点着色器输入签名, 网格顶点流布局)缓存的输入布局，相同的组合只创建一次
+// 输入布局只与签名有关，签名相同的不同顶点着色器共享同一对象；内容不同但顶点流布局相同的网格也共享
+// 只在主线程准备网格资源时使用，不加锁
+class InputLayoutCache
+{
+public:
+	static InputLayoutCache& Get();
+
+	// 语义名(不区分大小写)、语义索引、格式、槽位、偏移与步进方式的哈希，不需要设备
+	static uint64_t HashElements(const D3D11_INPUT_ELEMENT_DESC* pElements, uint32_t numElements);
+	// 语义名(不区分大小写)与语义索引都相同
+	static bool IsSameSemantic(const D3D11_INPUT_ELEMENT_DESC& lhs, const D3D11_INPUT_ELEMENT_DESC& rhs);
+	// SV_VertexID等系统值语义，不需要顶点流
+	static bool IsSystemValue(const char* semanticName);
+	// 顶点流提供了签名需要的所有语义时返回true
+	// 八面体编码的法线(R16G16_SNORM)只能用于以float2声明NORMAL的着色器，反之亦然：
+	// float2的NORMAL不接受未压缩或R16G16B16A16_SNORM的法线
+	static bool IsCompatible(const std::vector<D3D11_INPUT_ELEMENT_DESC>& streamElements,
+		const std::vector<D3D11_INPUT_ELEMENT_DESC>& signature);
+
+	// 返回的输入布局由缓存持有，在缓存的生命周期内有效
+	// pByteCode为任一具有该签名的顶点着色器的字节码，用于创建时的验证
+	HRESULT GetOrCreate(ID3D11Device* device, uint64_t signatureHash, const std::vector<D3D11_INPUT_ELEMENT_DESC>& streamElements,
+		uint64_t streamLayoutHash, const void* pByteCode, size_t byteSize, ID3D11InputLayout** ppInputLayout);
+
+	size_t GetLayoutCount() const { return m_InputLayouts.size(); }
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const std::pair<uint64_t, uint64_t>& key) const
+		{
+			return (size_t)(key.first ^ (key.second * 1099511628211ull));
+		}
+	};
+
+	std::unordered_map<std::pair<uint64_t, uint64_t>, Microsoft::WRL::ComPtr<ID3D11InputLayout>, KeyHash> m_InputLayouts;
+};
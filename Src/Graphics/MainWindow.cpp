@@ -335,11 +335,16 @@ void MainWindow::CalculateFrameStats()
 		float fps = (float)frameCnt; // fps = frameCnt / 1
 		float mspf = 1000.0f / fps;
 
+		const auto& cbufferStats = Shader::GetCBufferUploadStatistics();
 		std::wostringstream outs;
 		outs.precision(6);
 		outs << m_WinName << L"    "
 			<< L"FPS: " << fps << L"    "
-			<< L"Frame Time: " << mspf << L" (ms)";
+			<< L"Frame Time: " << mspf << L" (ms)    "
+			<< L"CB Upload: " << cbufferStats.TotalBytes() / 1024.0 << L" (KB/frame, dirty ranges "
+			<< (Shader::IsCBufferDirtyRangesEnabled() ? L"on" : L"off") << L")    "
+			<< L"CB Map: " << cbufferStats.discardMapCount << L" discard / " << cbufferStats.noOverwriteMapCount << L" no-overwrite / "
+			<< cbufferStats.updateSubresourceCount << L" update";
 		SetWindowText(m_hWindow, outs.str().c_str());
 
 		// Reset for next average.
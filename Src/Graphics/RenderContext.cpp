@@ -3,6 +3,8 @@
 #include <Hierarchy/GameObject.h>
 #include "GraphicsImpl.h"
 #include <Component/Camera.h>
+#include <Utils/ThreadPool.h>
+#include <algorithm>
 
 
 using namespace Microsoft::WRL;
@@ -26,16 +28,28 @@ void RenderContext::DrawSkybox(Camera& pCamera)
 
 void RenderContext::SetupCameraProperties(Camera& camera)
 {
-	pImpl->m_CommandBuffer.SetViewMatrix(camera.GetGameObject()->GetTransform()->GetWorldToLocalMatrix());
-	pImpl->m_CommandBuffer.SetProjMatrix(camera.GetProjMatrix());
-	pImpl->m_CommandBuffer.SetViewport(camera.GetViewPortRect());
-	pImpl->m_CommandBuffer.SetRenderTarget();
+	pImpl->m_View = camera.GetGameObject()->GetTransform()->GetWorldToLocalMatrix();
+	pImpl->m_Proj = camera.GetProjMatrix();
+	pImpl->m_ViewportRect = camera.GetViewPortRect();
+
+	pImpl->m_CommandBuffer.SetViewMatrix(pImpl->m_View);
+	pImpl->m_CommandBuffer.SetProjMatrix(pImpl->m_Proj);
+	// 视口大小取决于渲染目标，先设置渲染目标
+	pImpl->m_CommandBuffer.SetRenderTarget(pImpl->m_pRenderTarget);
+	pImpl->m_CommandBuffer.SetViewport(pImpl->m_ViewportRect);
+}
+
+void RenderContext::SetRenderTarget(RenderTexture* pRenderTexture)
+{
+	pImpl->m_pRenderTarget = pRenderTexture;
+	pImpl->m_CommandBuffer.SetRenderTarget(pRenderTexture);
+	pImpl->m_CommandBuffer.SetViewport(pImpl->m_ViewportRect);
 }
 
 void RenderContext::ExecuteCommandBuffer(CommandBuffer& commandBuffer)
 {
     commandBuffer.pImpl->m_pCommandLists.push_back(nullptr);
-    commandBuffer.pImpl->m_pDeferredContext->FinishCommandList(true, commandBuffer.pImpl->m_pCommandLists.back().GetAddressOf());
+    commandBuffer.pImpl->FinishCommandList(true, commandBuffer.pImpl->m_pCommandLists.back().GetAddressOf());
     for (auto& pCmdList : commandBuffer.pImpl->m_pCommandLists)
         pImpl->m_CommandBuffer.pImpl->m_pDeferredContext->ExecuteCommandList(pCmdList.Get(), true);
 }
@@ -44,40 +58,204 @@ void RenderContext::DrawGameObject(GameObject* pObject)
 {
 	if (!pObject)
 		return;
+	DrawGameObjects({ pObject });
+}
+
+void RenderContext::DrawGameObjects(const std::vector<GameObject*>& pObjects)
+{
+	pImpl->m_DrawItems.clear();
+	pImpl->m_StaticBatchDraws.clear();
+	pImpl->m_StaticBatchDrawIndices.clear();
+	XMath::Collision::ExtractFrustumPlanes(pImpl->m_Proj * pImpl->m_View, pImpl->m_FrustumPlanes);
+
+	for (auto pObject : pObjects)
+		pImpl->CollectDrawItems(pObject);
+	pImpl->CollectStaticBatchDrawItems();
+
+	// 未开启并行录制，或绘制数不足以分给两个工作线程时直接在主线程录制
+	if (pImpl->m_pWorkerCommandBuffers.empty() || pImpl->m_DrawItems.size() < 2 * Impl::s_MinDrawsPerWorker)
+	{
+		auto& commandBuffer = *pImpl->m_CommandBuffer.pImpl;
+		commandBuffer.BeginDrawBatch();
+		for (auto& item : pImpl->m_DrawItems)
+			commandBuffer.RecordDrawMesh(item.pMeshData, item.pMeshResource, item.localToWorld, item.pMaterial, nullptr,
+				item.indexStart, item.indexCount, item.baseVertex);
+		commandBuffer.EndDrawBatch();
+		return;
+	}
+
+	pImpl->RecordDrawItemsParallel();
+}
+
+void RenderContext::SetParallelRecording(uint32_t workerCount)
+{
+	pImpl->m_pWorkerCommandBuffers.resize(workerCount);
+	for (auto& pCommandBuffer : pImpl->m_pWorkerCommandBuffers)
+	{
+		if (!pCommandBuffer)
+		{
+			pCommandBuffer = std::make_unique<CommandBuffer>();
+			pCommandBuffer->pImpl->m_UseLocalCBuffers = true;
+		}
+	}
+}
 
+uint32_t RenderContext::GetParallelRecordingWorkerCount() const
+{
+	return (uint32_t)pImpl->m_pWorkerCommandBuffers.size();
+}
+
+void RenderContext::Submit()
+{
+    Graphics::Impl::SubmitRenderContext();
+}
+
+//
+// RenderContext::Impl
+//
+
+void RenderContext::Impl::CollectDrawItems(GameObject* pObject)
+{
+	if (!pObject)
+		return;
+
+	// 与DrawGameObject保持相同的遍历顺序
 	for (auto pChild : pObject->m_pChildrens)
 	{
-		DrawGameObject(pChild);
+		CollectDrawItems(pChild);
 	}
 
 	MeshRenderer* pMeshRenderer = pObject->FindComponent<MeshRenderer>();
-	if (!pMeshRenderer)
+	if (!pMeshRenderer || !pMeshRenderer->IsEnabled())
 		return;
 
 	Material* pMat = pMeshRenderer->GetMaterial();
-	if (!pMat)
+	if (!pMat || !pMat->GetShader())
 		return;
 
-	Transform* pTransform = pObject->GetTransform();
+	// 已合批的静态物体只记录可见的子网格，最后统一绘制
+	if (MeshData* pBatchMesh = pMeshRenderer->m_pStaticBatchMesh)
+	{
+		const SubMeshDescriptor& subMesh = pBatchMesh->subMeshes[pMeshRenderer->m_StaticBatchSubMesh];
+		if (!XMath::Collision::FrustumIntersectsBox(m_FrustumPlanes, subMesh.vMin, subMesh.vMax))
+			return;
+		auto it = m_StaticBatchDrawIndices.try_emplace(pBatchMesh, m_StaticBatchDraws.size()).first;
+		if (it->second == m_StaticBatchDraws.size())
+			m_StaticBatchDraws.push_back({ pBatchMesh, pMat, {} });
+		m_StaticBatchDraws[it->second].subMeshes.push_back(pMeshRenderer->m_StaticBatchSubMesh);
+		return;
+	}
 
 	MeshFilter* pMeshFilter = pObject->FindComponent<MeshFilter>();
+	if (!pMeshFilter)
+		return;
+
+	MeshData* pMeshData = pMeshFilter->GetMesh();
+	if (pMeshData == nullptr)
+		pMeshData = pMeshFilter->GetSharedMesh();
+	if (!pMeshData)
+		return;
 
-	if (pMat && pMeshFilter)
+	// 资源的创建与上传会修改ResourceManager和MeshData，需要在主线程完成
+	Shader* pShader = m_CommandBuffer.pImpl->PrepareMaterial(pMat);
+	MeshGraphicsResource* pMeshResource = m_CommandBuffer.pImpl->PrepareMeshResource(pMeshData, pShader);
+	if (!pMeshResource)
+		return;
+
+	const XMath::Matrix4x4& localToWorld = pObject->GetTransform()->GetLocalToWorldMatrix();
+	if (!pMeshData->meshlets.empty())
+	{
+		// 在网格的顶点坐标系中剔除簇，只绘制可见的索引区间
+		XMath::Matrix4x4 localToView = m_View * localToWorld;
+		XMath::Vector4 localPlanes[6];
+		XMath::Collision::ExtractFrustumPlanes(m_Proj * localToView, localPlanes);
+		// 观察矩阵与物体矩阵都是仿射变换，摄像机在网格顶点坐标系中的位置只需仿射逆
+		XMath::Vector3 cameraPos = XMath::Matrix::InverseAffine(localToView).topRightCorner<3, 1>();
+		MeshUtility::CullMeshlets(pMeshData->meshlets.data(), pMeshData->meshlets.size(), localPlanes[0].data(), cameraPos.data(),
+			m_VisibleMeshletRanges);
+		for (auto& range : m_VisibleMeshletRanges)
+			m_DrawItems.push_back({ pMeshData, pMeshResource, pMat, localToWorld, range.indexStart, range.indexCount, range.baseVertex });
+		return;
+	}
+
+	// 顶点数超过65536的网格被划分为带baseVertex的子网格后，需要逐个子网格绘制
+	bool hasBaseVertex = std::any_of(pMeshData->subMeshes.begin(), pMeshData->subMeshes.end(),
+		[](const SubMeshDescriptor& subMesh) { return subMesh.baseVertex != 0; });
+	if (!hasBaseVertex)
 	{
-		MeshData* pMeshData = pMeshFilter->GetMesh();
-		if (pMeshData == nullptr)
-			pMeshData = pMeshFilter->GetSharedMesh();
-		if (pMeshData)
+		m_DrawItems.push_back({ pMeshData, pMeshResource, pMat, localToWorld });
+		return;
+	}
+	for (auto& subMesh : pMeshData->subMeshes)
+		m_DrawItems.push_back({ pMeshData, pMeshResource, pMat, localToWorld, subMesh.indexStart, subMesh.indexCount, subMesh.baseVertex });
+}
+
+void RenderContext::Impl::CollectStaticBatchDrawItems()
+{
+	for (auto& batchDraw : m_StaticBatchDraws)
+	{
+		Shader* pShader = m_CommandBuffer.pImpl->PrepareMaterial(batchDraw.pMaterial);
+		MeshGraphicsResource* pMeshResource = m_CommandBuffer.pImpl->PrepareMeshResource(batchDraw.pMeshData, pShader);
+		if (!pMeshResource)
+			continue;
+
+		// 子网格在合并网格中按顺序相邻存放，连续可见的子网格合并为一次绘制
+		auto& subMeshes = batchDraw.subMeshes;
+		std::sort(subMeshes.begin(), subMeshes.end());
+		const auto& descs = batchDraw.pMeshData->subMeshes;
+		for (size_t i = 0; i < subMeshes.size();)
 		{
-			pImpl->m_CommandBuffer.DrawMesh(pMeshData, pTransform->GetLocalToWorldMatrix(), pMat);
+			uint32_t indexStart = descs[subMeshes[i]].indexStart;
+			uint32_t indexEnd = indexStart + descs[subMeshes[i]].indexCount;
+			size_t j = i + 1;
+			for (; j < subMeshes.size() && descs[subMeshes[j]].indexStart == indexEnd; ++j)
+				indexEnd += descs[subMeshes[j]].indexCount;
+			m_DrawItems.push_back({ batchDraw.pMeshData, pMeshResource, batchDraw.pMaterial, XMath::Matrix4x4::Identity(),
+				indexStart, indexEnd - indexStart });
+			i = j;
 		}
 	}
-
-	
 }
 
-void RenderContext::Submit()
+void RenderContext::Impl::RecordDrawItemsParallel()
 {
-    Graphics::Impl::SubmitRenderContext();
+	size_t drawCount = m_DrawItems.size();
+	size_t workerCount = (std::min)(m_pWorkerCommandBuffers.size(), drawCount / s_MinDrawsPerWorker);
+	size_t chunkSize = (drawCount + workerCount - 1) / workerCount;
+
+	// 着色器的全局属性可能在上一帧之后被修改，录制前同步到各工作线程的副本
+	for (size_t i = 0; i < workerCount; ++i)
+		m_pWorkerCommandBuffers[i]->pImpl->SyncLocalCBufferDatas();
+
+	ThreadPool::Get().ParallelFor(drawCount, chunkSize, [this, chunkSize](size_t begin, size_t end) {
+		CommandBuffer& commandBuffer = *m_pWorkerCommandBuffers[begin / chunkSize];
+		// 延迟上下文的每个命令列表都从默认状态开始，需要重新设置摄像机相关状态
+		commandBuffer.SetViewMatrix(m_View);
+		commandBuffer.SetProjMatrix(m_Proj);
+		commandBuffer.SetRenderTarget(m_pRenderTarget);
+		commandBuffer.SetViewport(m_ViewportRect);
+
+		commandBuffer.pImpl->BeginDrawBatch();
+		for (size_t i = begin; i < end; ++i)
+		{
+			auto& item = m_DrawItems[i];
+			commandBuffer.pImpl->RecordDrawMesh(item.pMeshData, item.pMeshResource, item.localToWorld, item.pMaterial, nullptr,
+				item.indexStart, item.indexCount, item.baseVertex);
+		}
+		commandBuffer.pImpl->EndDrawBatch();
+
+		commandBuffer.pImpl->m_pCommandLists.push_back(nullptr);
+		commandBuffer.pImpl->FinishCommandList(false, commandBuffer.pImpl->m_pCommandLists.back().GetAddressOf());
+	});
+
+	// 按分块顺序执行，保证结果与串行录制一致
+	auto pMainContext = m_CommandBuffer.pImpl->m_pDeferredContext.Get();
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		auto& pCmdLists = m_pWorkerCommandBuffers[i]->pImpl->m_pCommandLists;
+		for (auto& pCmdList : pCmdLists)
+			pMainContext->ExecuteCommandList(pCmdList.Get(), true);
+		pCmdLists.clear();
+	}
 }
 
@@ -1,6 +1,10 @@
+#pragma once
+
 #include <Graphics/RenderContext.h>
+#include <Graphics/ResourceManager.h>
 
 #include <Math/XMath.h>
+#include <unordered_map>
 
 
 class RenderContext::Impl
@@ -19,5 +23,50 @@ public:
 
     void Submit();
 
+    struct DrawItem
+    {
+        MeshData* pMeshData;
+        MeshGraphicsResource* pMeshResource;
+        Material* pMaterial;
+        XMath::Matrix4x4 localToWorld;
+        uint32_t indexStart = 0;
+        uint32_t indexCount = UINT32_MAX;
+        uint32_t baseVertex = 0;
+    };
+
+    // 一个静态合批在本次绘制中可见的子网格
+    struct StaticBatchDraw
+    {
+        MeshData* pMeshData;
+        Material* pMaterial;
+        std::vector<uint32_t> subMeshes;
+    };
+
+    // 在主线程收集可见的绘制项，同时完成网格资源的创建与上传
+    void CollectDrawItems(GameObject* pObject);
+    // 将可见的静态合批子网格按索引区间合并为绘制项
+    void CollectStaticBatchDrawItems();
+    // 将绘制项分块交给工作线程录制，并按顺序执行到主命令缓冲区
+    void RecordDrawItemsParallel();
+
+    // 每个工作线程至少分到的绘制数，过少时线程调度开销会超过收益
+    static constexpr size_t s_MinDrawsPerWorker = 64;
+
     CommandBuffer m_CommandBuffer;
+
+    // 并行录制
+    std::vector<std::unique_ptr<CommandBuffer>> m_pWorkerCommandBuffers;
+    std::vector<DrawItem> m_DrawItems;
+    std::vector<StaticBatchDraw> m_StaticBatchDraws;
+    std::unordered_map<MeshData*, size_t> m_StaticBatchDrawIndices;
+    // 逐簇剔除的结果，避免每次绘制都重新分配
+    std::vector<MeshUtility::IndexRange> m_VisibleMeshletRanges;
+
+    // 当前摄像机属性，用于在工作线程的延迟上下文中重新设置
+    XMath::Matrix4x4 m_View = XMath::Matrix4x4::Identity();
+    XMath::Matrix4x4 m_Proj = XMath::Matrix4x4::Identity();
+    Rect m_ViewportRect = Rect(0.0f, 0.0f, 1.0f, 1.0f);
+    RenderTexture* m_pRenderTarget = nullptr;
+    // 视锥体平面，用于剔除静态合批的子网格
+    XMath::Vector4 m_FrustumPlanes[6];
 };
\ No newline at end of file
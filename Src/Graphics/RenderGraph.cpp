@@ -0,0 +1,232 @@
+#include <Graphics/RenderGraph.h>
+#include <Graphics/RenderContext.h>
+#include <Graphics/RenderTexturePool.h>
+#include "RenderGraphCompiler.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class RenderGraph::Impl
+{
+public:
+    struct Resource
+    {
+        std::string name;
+        RenderTextureDesc desc;
+        bool imported = false;
+        RenderTexture* pTexture = nullptr;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        RenderGraphCompiler::PassNode node;
+        ExecuteFunc execute;
+    };
+
+    // 归还本帧从纹理池取得的物理纹理
+    void ReleasePhysicalTextures();
+
+    std::vector<Resource> m_Resources;
+    std::vector<Pass> m_Passes;
+    RenderGraphCompiler::Result m_CompileResult;
+    bool m_Compiled = false;
+
+    std::vector<RenderTexture*> m_pPhysicalTextures;
+
+    Statistics m_Statistics;
+};
+
+void RenderGraph::Impl::ReleasePhysicalTextures()
+{
+    for (RenderTexture* pTexture : m_pPhysicalTextures)
+    {
+        if (pTexture)
+            RenderTexturePool::Get().ReleaseTemporary(pTexture);
+    }
+    m_pPhysicalTextures.clear();
+    for (auto& resource : m_Resources)
+    {
+        if (!resource.imported)
+            resource.pTexture = nullptr;
+    }
+}
+
+//
+// RenderGraphBuilder
+//
+
+RenderGraphBuilder::RenderGraphBuilder(RenderGraph& graph, uint32_t passIndex)
+    : m_Graph(graph), m_PassIndex(passIndex)
+{
+}
+
+RenderGraphTexture RenderGraphBuilder::CreateTexture(std::string_view name, const RenderTextureDesc& desc)
+{
+    auto& resources = m_Graph.pImpl->m_Resources;
+    resources.push_back({ std::string(name), desc, false, nullptr });
+    return RenderGraphTexture{ (uint32_t)resources.size() - 1 };
+}
+
+RenderGraphTexture RenderGraphBuilder::Read(RenderGraphTexture texture)
+{
+    if (texture.IsValid())
+        m_Graph.pImpl->m_Passes[m_PassIndex].node.reads.push_back(texture.index);
+    return texture;
+}
+
+RenderGraphTexture RenderGraphBuilder::Write(RenderGraphTexture texture)
+{
+    if (texture.IsValid())
+        m_Graph.pImpl->m_Passes[m_PassIndex].node.writes.push_back(texture.index);
+    return texture;
+}
+
+void RenderGraphBuilder::SetSideEffect()
+{
+    m_Graph.pImpl->m_Passes[m_PassIndex].node.hasSideEffect = true;
+}
+
+//
+// RenderGraph
+//
+
+RenderGraph::RenderGraph()
+    : pImpl(std::make_unique<RenderGraph::Impl>())
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    pImpl->ReleasePhysicalTextures();
+}
+
+RenderGraphTexture RenderGraph::ImportTexture(std::string_view name, RenderTexture* pTexture)
+{
+    RenderTextureDesc desc;
+    if (pTexture)
+        desc = pTexture->GetDesc();
+    pImpl->m_Resources.push_back({ std::string(name), desc, true, pTexture });
+    return RenderGraphTexture{ (uint32_t)pImpl->m_Resources.size() - 1 };
+}
+
+RenderGraphTexture RenderGraph::ImportBackBuffer()
+{
+    return ImportTexture("BackBuffer", nullptr);
+}
+
+void RenderGraph::AddPass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute)
+{
+    pImpl->m_Passes.push_back({ std::string(name), {}, std::move(execute) });
+    pImpl->m_Compiled = false;
+    RenderGraphBuilder builder(*this, (uint32_t)pImpl->m_Passes.size() - 1);
+    if (setup)
+        setup(builder);
+}
+
+void RenderGraph::Compile()
+{
+    // 按完整的描述分配类别，一帧中不同的描述通常只有几种，线性查找即可
+    std::vector<const RenderTextureDesc*> pDescClasses;
+    std::vector<RenderGraphCompiler::ResourceNode> resourceNodes(pImpl->m_Resources.size());
+    for (size_t i = 0; i < resourceNodes.size(); ++i)
+    {
+        auto& resource = pImpl->m_Resources[i];
+        resourceNodes[i].imported = resource.imported;
+        if (!resource.imported)
+        {
+            auto it = std::find_if(pDescClasses.begin(), pDescClasses.end(),
+                [&resource](const RenderTextureDesc* pDesc) { return *pDesc == resource.desc; });
+            resourceNodes[i].descClass = (uint32_t)(it - pDescClasses.begin());
+            if (it == pDescClasses.end())
+                pDescClasses.push_back(&resource.desc);
+            resourceNodes[i].byteSize = resource.desc.GetByteSize();
+        }
+    }
+    std::vector<RenderGraphCompiler::PassNode> passNodes;
+    passNodes.reserve(pImpl->m_Passes.size());
+    for (auto& pass : pImpl->m_Passes)
+        passNodes.push_back(pass.node);
+
+    pImpl->m_CompileResult = RenderGraphCompiler::Compile(resourceNodes, passNodes);
+    pImpl->m_Compiled = true;
+
+    auto& result = pImpl->m_CompileResult;
+    auto& stats = pImpl->m_Statistics;
+    stats = Statistics();
+    stats.passCount = (uint32_t)passNodes.size();
+    for (bool culled : result.passCulled)
+        stats.culledPassCount += culled ? 1 : 0;
+    for (uint32_t physicalIndex : result.physicalIndex)
+        stats.transientTextureCount += physicalIndex != RenderGraphCompiler::s_InvalidIndex ? 1 : 0;
+    stats.physicalTextureCount = (uint32_t)result.physicalDescClasses.size();
+    stats.transientBytesWithoutAliasing = result.transientBytesWithoutAliasing;
+    stats.transientBytes = result.transientBytes;
+    stats.peakLiveBytes = result.peakLiveBytes;
+}
+
+void RenderGraph::Execute(RenderContext& context)
+{
+    if (!pImpl->m_Compiled)
+        Compile();
+
+    auto& result = pImpl->m_CompileResult;
+
+    // D3D11没有放置资源，复用以整张RenderTexture为单位：
+    // 每个物理下标对应一张从纹理池取得的纹理，生命周期不重叠的瞬态纹理共用它
+    pImpl->ReleasePhysicalTextures();
+    pImpl->m_pPhysicalTextures.assign(result.physicalDescClasses.size(), nullptr);
+    for (size_t i = 0; i < pImpl->m_Resources.size(); ++i)
+    {
+        uint32_t physicalIndex = result.physicalIndex[i];
+        if (physicalIndex == RenderGraphCompiler::s_InvalidIndex)
+            continue;
+        auto& pPhysical = pImpl->m_pPhysicalTextures[physicalIndex];
+        if (!pPhysical)
+            pPhysical = RenderTexturePool::Get().GetTemporary(pImpl->m_Resources[i].desc);
+        pImpl->m_Resources[i].pTexture = pPhysical;
+    }
+
+    for (size_t i = 0; i < pImpl->m_Passes.size(); ++i)
+    {
+        if (result.passCulled[i] || !pImpl->m_Passes[i].execute)
+            continue;
+        pImpl->m_Passes[i].execute(*this, context);
+    }
+
+    // 命令按录制顺序执行，之后的使用者拿到同一纹理也不会与本帧的Pass冲突
+    pImpl->ReleasePhysicalTextures();
+}
+
+void RenderGraph::Reset()
+{
+    pImpl->ReleasePhysicalTextures();
+    pImpl->m_Resources.clear();
+    pImpl->m_Passes.clear();
+    pImpl->m_CompileResult = RenderGraphCompiler::Result();
+    pImpl->m_Compiled = false;
+}
+
+RenderTexture* RenderGraph::GetTexture(RenderGraphTexture texture) const
+{
+    if (!texture.IsValid() || texture.index >= pImpl->m_Resources.size())
+        return nullptr;
+    return pImpl->m_Resources[texture.index].pTexture;
+}
+
+bool RenderGraph::IsPassCulled(std::string_view name) const
+{
+    if (!pImpl->m_Compiled)
+        return false;
+    for (size_t i = 0; i < pImpl->m_Passes.size(); ++i)
+    {
+        if (pImpl->m_Passes[i].name == name)
+            return pImpl->m_CompileResult.passCulled[i];
+    }
+    return false;
+}
+
+const RenderGraph::Statistics& RenderGraph::GetStatistics() const
+{
+    return pImpl->m_Statistics;
+}
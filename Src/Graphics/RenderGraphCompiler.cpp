@@ -0,0 +1,138 @@
+#include "RenderGraphCompiler.h"
+#include <algorithm>
+
+RenderGraphCompiler::Result RenderGraphCompiler::Compile(const std::vector<ResourceNode>& resources, const std::vector<PassNode>& passes)
+{
+	Result result;
+	size_t resourceCount = resources.size();
+	size_t passCount = passes.size();
+
+	//
+	// Pass剔除
+	//
+
+	// Pass的引用计数为其写入的资源数，资源的引用计数为读取它的Pass数
+	std::vector<uint32_t> passRefCounts(passCount);
+	std::vector<uint32_t> resourceRefCounts(resourceCount);
+	std::vector<std::vector<uint32_t>> producers(resourceCount);
+	for (uint32_t i = 0; i < passCount; ++i)
+	{
+		passRefCounts[i] = (uint32_t)passes[i].writes.size();
+		for (uint32_t res : passes[i].reads)
+			++resourceRefCounts[res];
+		for (uint32_t res : passes[i].writes)
+			producers[res].push_back(i);
+	}
+
+	result.passCulled.assign(passCount, false);
+	std::vector<uint32_t> unreferenced;
+	auto CullPass = [&](uint32_t pass) {
+		result.passCulled[pass] = true;
+		for (uint32_t res : passes[pass].reads)
+		{
+			if (--resourceRefCounts[res] == 0 && !resources[res].imported)
+				unreferenced.push_back(res);
+		}
+	};
+
+	for (uint32_t i = 0; i < passCount; ++i)
+	{
+		if (passRefCounts[i] == 0 && !passes[i].hasSideEffect)
+			CullPass(i);
+	}
+	for (uint32_t i = 0; i < resourceCount; ++i)
+	{
+		if (resourceRefCounts[i] == 0 && !resources[i].imported)
+			unreferenced.push_back(i);
+	}
+
+	while (!unreferenced.empty())
+	{
+		uint32_t res = unreferenced.back();
+		unreferenced.pop_back();
+		for (uint32_t pass : producers[res])
+		{
+			if (result.passCulled[pass])
+				continue;
+			if (--passRefCounts[pass] == 0 && !passes[pass].hasSideEffect)
+				CullPass(pass);
+		}
+	}
+
+	//
+	// 生命周期
+	//
+	result.firstUse.assign(resourceCount, s_InvalidIndex);
+	result.lastUse.assign(resourceCount, s_InvalidIndex);
+	auto Touch = [&](uint32_t res, uint32_t pass) {
+		if (result.firstUse[res] == s_InvalidIndex)
+			result.firstUse[res] = pass;
+		result.lastUse[res] = pass;
+	};
+	for (uint32_t i = 0; i < passCount; ++i)
+	{
+		if (result.passCulled[i])
+			continue;
+		for (uint32_t res : passes[i].reads)
+			Touch(res, i);
+		for (uint32_t res : passes[i].writes)
+			Touch(res, i);
+	}
+
+	//
+	// 瞬态资源复用：按首次使用的顺序分配，描述相同且生命周期不重叠的资源共享同一个物理资源
+	//
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < resourceCount; ++i)
+	{
+		if (!resources[i].imported && result.firstUse[i] != s_InvalidIndex)
+			order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+		return result.firstUse[lhs] < result.firstUse[rhs];
+	});
+
+	result.physicalIndex.assign(resourceCount, s_InvalidIndex);
+	std::vector<uint32_t> physicalLastUse;
+	for (uint32_t res : order)
+	{
+		result.transientBytesWithoutAliasing += resources[res].byteSize;
+
+		// 选择最早空闲的可用物理资源
+		uint32_t chosen = s_InvalidIndex;
+		for (uint32_t p = 0; p < (uint32_t)physicalLastUse.size(); ++p)
+		{
+			if (result.physicalDescClasses[p] != resources[res].descClass || physicalLastUse[p] >= result.firstUse[res])
+				continue;
+			if (chosen == s_InvalidIndex || physicalLastUse[p] < physicalLastUse[chosen])
+				chosen = p;
+		}
+
+		if (chosen == s_InvalidIndex)
+		{
+			chosen = (uint32_t)physicalLastUse.size();
+			physicalLastUse.push_back(0);
+			result.physicalDescClasses.push_back(resources[res].descClass);
+			result.physicalByteSizes.push_back(resources[res].byteSize);
+			result.transientBytes += resources[res].byteSize;
+		}
+		physicalLastUse[chosen] = result.lastUse[res];
+		result.physicalIndex[res] = chosen;
+	}
+
+	// 统计各Pass执行时同时存活的瞬态资源大小
+	for (uint32_t i = 0; i < passCount; ++i)
+	{
+		if (result.passCulled[i])
+			continue;
+		uint64_t liveBytes = 0;
+		for (uint32_t res : order)
+		{
+			if (result.firstUse[res] <= i && i <= result.lastUse[res])
+				liveBytes += resources[res].byteSize;
+		}
+		result.peakLiveBytes = (std::max)(result.peakLiveBytes, liveBytes);
+	}
+
+	return result;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// RenderGraph的编译部分：Pass剔除、资源生命周期计算与瞬态资源复用
+// 只处理抽象的依赖关系，不依赖D3D设备
+class RenderGraphCompiler
+{
+public:
+	static constexpr uint32_t s_InvalidIndex = UINT32_MAX;
+
+	struct ResourceNode
+	{
+		// 描述的类别，由调用者按完整的描述比较后分配：只有描述完全相同(可相互替代)的资源类别相同
+		// 不能直接使用描述的哈希，哈希冲突会让格式或大小不同的资源共用同一个物理资源
+		uint32_t descClass = 0;
+		uint64_t byteSize = 0;
+		// 外部导入的资源(如后备缓冲区)不参与复用，且写入它的Pass不会被剔除
+		bool imported = false;
+	};
+
+	struct PassNode
+	{
+		std::vector<uint32_t> reads;
+		std::vector<uint32_t> writes;
+		// 具有副作用的Pass(如回读数据)即使没有消费者也不剔除
+		bool hasSideEffect = false;
+	};
+
+	struct Result
+	{
+		std::vector<bool> passCulled;
+		// 资源在未剔除的Pass中首次与最后一次使用的Pass下标，未使用时为s_InvalidIndex
+		std::vector<uint32_t> firstUse;
+		std::vector<uint32_t> lastUse;
+		// 瞬态资源对应的物理资源下标，导入或未使用的资源为s_InvalidIndex
+		std::vector<uint32_t> physicalIndex;
+		// 每个物理资源的描述类别与大小
+		std::vector<uint32_t> physicalDescClasses;
+		std::vector<uint64_t> physicalByteSizes;
+
+		// 不复用时瞬态资源的总大小
+		uint64_t transientBytesWithoutAliasing = 0;
+		// 复用后物理资源的总大小
+		uint64_t transientBytes = 0;
+		// 任意时刻同时存活的瞬态资源大小的最大值(理论下限)
+		uint64_t peakLiveBytes = 0;
+	};
+
+	static Result Compile(const std::vector<ResourceNode>& resources, const std::vector<PassNode>& passes);
+};
@@ -0,0 +1,195 @@
+#include "RenderStateCache.h"
+#include <Utils/Hash.h>
+#include <cstring>
+
+namespace
+{
+	// -0.0与0.0的效果相同，统一为0.0
+	float NormalizeFloat(float value)
+	{
+		return value == 0.0f ? 0.0f : value;
+	}
+
+	BOOL NormalizeBool(BOOL value)
+	{
+		return value ? TRUE : FALSE;
+	}
+
+	D3D11_RENDER_TARGET_BLEND_DESC NormalizeRenderTarget(const D3D11_RENDER_TARGET_BLEND_DESC& desc)
+	{
+		D3D11_RENDER_TARGET_BLEND_DESC out;
+		memset(&out, 0, sizeof out);
+		out.BlendEnable = NormalizeBool(desc.BlendEnable);
+		out.RenderTargetWriteMask = desc.RenderTargetWriteMask;
+		if (out.BlendEnable)
+		{
+			out.SrcBlend = desc.SrcBlend;
+			out.DestBlend = desc.DestBlend;
+			out.BlendOp = desc.BlendOp;
+			out.SrcBlendAlpha = desc.SrcBlendAlpha;
+			out.DestBlendAlpha = desc.DestBlendAlpha;
+			out.BlendOpAlpha = desc.BlendOpAlpha;
+		}
+		else
+		{
+			out.SrcBlend = out.SrcBlendAlpha = D3D11_BLEND_ONE;
+			out.DestBlend = out.DestBlendAlpha = D3D11_BLEND_ZERO;
+			out.BlendOp = out.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		}
+		return out;
+	}
+
+	D3D11_DEPTH_STENCILOP_DESC DefaultStencilOp()
+	{
+		D3D11_DEPTH_STENCILOP_DESC out;
+		out.StencilFailOp = out.StencilDepthFailOp = out.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+		out.StencilFunc = D3D11_COMPARISON_ALWAYS;
+		return out;
+	}
+}
+
+D3D11_RASTERIZER_DESC RenderStateDesc::Normalize(const D3D11_RASTERIZER_DESC& desc)
+{
+	D3D11_RASTERIZER_DESC out;
+	memset(&out, 0, sizeof out);
+	out.FillMode = desc.FillMode;
+	out.CullMode = desc.CullMode;
+	out.FrontCounterClockwise = NormalizeBool(desc.FrontCounterClockwise);
+	out.DepthBias = desc.DepthBias;
+	out.SlopeScaledDepthBias = NormalizeFloat(desc.SlopeScaledDepthBias);
+	// 没有深度偏移时Clamp不起作用
+	out.DepthBiasClamp = out.DepthBias == 0 && out.SlopeScaledDepthBias == 0.0f ? 0.0f : NormalizeFloat(desc.DepthBiasClamp);
+	out.DepthClipEnable = NormalizeBool(desc.DepthClipEnable);
+	out.ScissorEnable = NormalizeBool(desc.ScissorEnable);
+	out.MultisampleEnable = NormalizeBool(desc.MultisampleEnable);
+	out.AntialiasedLineEnable = NormalizeBool(desc.AntialiasedLineEnable);
+	return out;
+}
+
+D3D11_DEPTH_STENCIL_DESC RenderStateDesc::Normalize(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+	D3D11_DEPTH_STENCIL_DESC out;
+	memset(&out, 0, sizeof out);
+	out.DepthEnable = NormalizeBool(desc.DepthEnable);
+	// 关闭深度测试时同时不会写入深度
+	out.DepthWriteMask = out.DepthEnable ? desc.DepthWriteMask : D3D11_DEPTH_WRITE_MASK_ALL;
+	out.DepthFunc = out.DepthEnable ? desc.DepthFunc : D3D11_COMPARISON_LESS;
+	out.StencilEnable = NormalizeBool(desc.StencilEnable);
+	if (out.StencilEnable)
+	{
+		out.StencilReadMask = desc.StencilReadMask;
+		out.StencilWriteMask = desc.StencilWriteMask;
+		out.FrontFace = desc.FrontFace;
+		out.BackFace = desc.BackFace;
+	}
+	else
+	{
+		out.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+		out.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+		out.FrontFace = out.BackFace = DefaultStencilOp();
+	}
+	return out;
+}
+
+D3D11_BLEND_DESC RenderStateDesc::Normalize(const D3D11_BLEND_DESC& desc)
+{
+	D3D11_BLEND_DESC out;
+	memset(&out, 0, sizeof out);
+	out.AlphaToCoverageEnable = NormalizeBool(desc.AlphaToCoverageEnable);
+	out.IndependentBlendEnable = NormalizeBool(desc.IndependentBlendEnable);
+	for (int i = 0; i < 8; ++i)
+		out.RenderTarget[i] = NormalizeRenderTarget(desc.RenderTarget[out.IndependentBlendEnable ? i : 0]);
+
+	// 所有渲染目标的设置都相同时，独立混合与非独立混合等价
+	if (out.IndependentBlendEnable)
+	{
+		bool allSame = true;
+		for (int i = 1; i < 8 && allSame; ++i)
+			allSame = memcmp(&out.RenderTarget[i], &out.RenderTarget[0], sizeof out.RenderTarget[0]) == 0;
+		if (allSame)
+			out.IndependentBlendEnable = FALSE;
+	}
+	return out;
+}
+
+uint64_t RenderStateDesc::Hash(const D3D11_RASTERIZER_DESC& desc)
+{
+	D3D11_RASTERIZER_DESC normalized = Normalize(desc);
+	return Hash::HashBytes(&normalized, sizeof normalized);
+}
+
+uint64_t RenderStateDesc::Hash(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+	D3D11_DEPTH_STENCIL_DESC normalized = Normalize(desc);
+	return Hash::HashBytes(&normalized, sizeof normalized);
+}
+
+uint64_t RenderStateDesc::Hash(const D3D11_BLEND_DESC& desc)
+{
+	D3D11_BLEND_DESC normalized = Normalize(desc);
+	return Hash::HashBytes(&normalized, sizeof normalized);
+}
+
+RenderStateCache& RenderStateCache::Get()
+{
+	static RenderStateCache s_Instance;
+	return s_Instance;
+}
+
+template<class Desc, class State, class CreateFunc>
+HRESULT RenderStateCache::FindOrCreate(Table<Desc, State>& table, const Desc* pDesc, State** ppState, CreateFunc&& create)
+{
+	if (!pDesc || !ppState)
+		return E_INVALIDARG;
+
+	Desc normalized = RenderStateDesc::Normalize(*pDesc);
+	auto& bucket = table.entries[Hash::HashBytes(&normalized, sizeof normalized)];
+	for (auto& entry : bucket)
+	{
+		if (memcmp(&entry.desc, &normalized, sizeof normalized) == 0)
+		{
+			*ppState = entry.pState.Get();
+			(*ppState)->AddRef();
+			return S_OK;
+		}
+	}
+
+	// 规范化后的描述与原描述效果相同，用它创建
+	Microsoft::WRL::ComPtr<State> pState;
+	HRESULT hr = create(&normalized, pState.GetAddressOf());
+	if (FAILED(hr))
+		return hr;
+	bucket.push_back({ normalized, pState });
+	++table.count;
+	*ppState = pState.Detach();
+	return S_OK;
+}
+
+HRESULT RenderStateCache::CreateRasterizerState(ID3D11Device* device, const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState)
+{
+	if (!device)
+		return E_INVALIDARG;
+	return FindOrCreate(m_RasterizerStates, pDesc, ppState,
+		[device](const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState) { return device->CreateRasterizerState(pDesc, ppState); });
+}
+
+HRESULT RenderStateCache::CreateDepthStencilState(ID3D11Device* device, const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState)
+{
+	if (!device)
+		return E_INVALIDARG;
+	return FindOrCreate(m_DepthStencilStates, pDesc, ppState,
+		[device](const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState) { return device->CreateDepthStencilState(pDesc, ppState); });
+}
+
+HRESULT RenderStateCache::CreateBlendState(ID3D11Device* device, const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState)
+{
+	if (!device)
+		return E_INVALIDARG;
+	return FindOrCreate(m_BlendStates, pDesc, ppState,
+		[device](const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState) { return device->CreateBlendState(pDesc, ppState); });
+}
+
+size_t RenderStateCache::GetStateCount() const
+{
+	return m_RasterizerStates.count + m_DepthStencilStates.count + m_BlendStates.count;
+}
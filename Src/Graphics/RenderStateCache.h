@@ -0,0 +1,62 @@
+#pragma once
+
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 渲染状态描述的规范化与哈希，只依赖描述结构体，不需要设备
+// 规范化将不影响结果的字段(如禁用混合时的混合因子、禁用模板测试时的模板操作)置为默认值，
+// 并清零结构体中的填充字节，规范化后的描述可以直接按字节比较
+namespace RenderStateDesc
+{
+	D3D11_RASTERIZER_DESC Normalize(const D3D11_RASTERIZER_DESC& desc);
+	D3D11_DEPTH_STENCIL_DESC Normalize(const D3D11_DEPTH_STENCIL_DESC& desc);
+	D3D11_BLEND_DESC Normalize(const D3D11_BLEND_DESC& desc);
+
+	// 对规范化后的描述计算哈希，等价的描述得到相同的结果
+	uint64_t Hash(const D3D11_RASTERIZER_DESC& desc);
+	uint64_t Hash(const D3D11_DEPTH_STENCIL_DESC& desc);
+	uint64_t Hash(const D3D11_BLEND_DESC& desc);
+}
+
+// 按规范化描述去重的渲染状态对象缓存，等价的描述总是返回同一对象，
+// 因此ShaderPass::Apply可以用指针比较跳过重复的状态设置
+// 只在主线程创建RenderStates与着色器时使用，不加锁
+// 状态对象与设备的生命周期相同，程序退出时随单例释放
+class RenderStateCache
+{
+public:
+	static RenderStateCache& Get();
+
+	// 与ID3D11Device中对应方法的用法一致，返回的对象已增加引用计数
+	HRESULT CreateRasterizerState(ID3D11Device* device, const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState);
+	HRESULT CreateDepthStencilState(ID3D11Device* device, const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState);
+	HRESULT CreateBlendState(ID3D11Device* device, const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState);
+
+	// 缓存中不同状态对象的数目
+	size_t GetStateCount() const;
+
+private:
+	template<class Desc, class State>
+	struct Table
+	{
+		struct Entry
+		{
+			Desc desc;
+			Microsoft::WRL::ComPtr<State> pState;
+		};
+		// 哈希相同时再按字节比较规范化后的描述
+		std::unordered_map<uint64_t, std::vector<Entry>> entries;
+		size_t count = 0;
+	};
+
+	template<class Desc, class State, class CreateFunc>
+	static HRESULT FindOrCreate(Table<Desc, State>& table, const Desc* pDesc, State** ppState, CreateFunc&& create);
+
+	Table<D3D11_RASTERIZER_DESC, ID3D11RasterizerState> m_RasterizerStates;
+	Table<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState> m_DepthStencilStates;
+	Table<D3D11_BLEND_DESC, ID3D11BlendState> m_BlendStates;
+};
@@ -1,5 +1,6 @@
 #include <Graphics/RenderStates.h>
 #include "d3dUtil.h"
+#include "RenderStateCache.h"
 #include "DXTrace.h"
 
 using namespace Microsoft::WRL;
@@ -41,6 +42,8 @@ void RenderStates::InitAll(ID3D11Device * device)
 	// 先前初始化过的话就没必要重来了
 	if (IsInit())
 		return;
+	// 光栅化、混合与深度/模板状态经过缓存创建，着色器中描述相同的状态会得到同一对象
+	RenderStateCache& cache = RenderStateCache::Get();
 	// ******************
 	// 初始化光栅化器状态
 	//
@@ -52,21 +55,21 @@ void RenderStates::InitAll(ID3D11Device * device)
 	rasterizerDesc.CullMode = D3D11_CULL_NONE;
 	rasterizerDesc.FrontCounterClockwise = false;
 	rasterizerDesc.DepthClipEnable = true;
-	ThrowIfFailed(device->CreateRasterizerState(&rasterizerDesc, RSWireframe.GetAddressOf()));
+	ThrowIfFailed(cache.CreateRasterizerState(device, &rasterizerDesc, RSWireframe.GetAddressOf()));
 	 
 	// 无背面剔除模式
 	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
 	rasterizerDesc.CullMode = D3D11_CULL_NONE;
 	rasterizerDesc.FrontCounterClockwise = false;
 	rasterizerDesc.DepthClipEnable = true;
-	ThrowIfFailed(device->CreateRasterizerState(&rasterizerDesc, RSNoCull.GetAddressOf()));
+	ThrowIfFailed(cache.CreateRasterizerState(device, &rasterizerDesc, RSNoCull.GetAddressOf()));
 
 	// 顺时针剔除模式
 	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
 	rasterizerDesc.CullMode = D3D11_CULL_BACK;
 	rasterizerDesc.FrontCounterClockwise = true;
 	rasterizerDesc.DepthClipEnable = true;
-	ThrowIfFailed(device->CreateRasterizerState(&rasterizerDesc, RSCullClockWise.GetAddressOf()));
+	ThrowIfFailed(cache.CreateRasterizerState(device, &rasterizerDesc, RSCullClockWise.GetAddressOf()));
 
 	// 深度偏移模式
 	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
@@ -76,7 +79,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	rasterizerDesc.DepthBias = 100000;
 	rasterizerDesc.DepthBiasClamp = 0.0f;
 	rasterizerDesc.SlopeScaledDepthBias = 1.0f;
-	ThrowIfFailed(device->CreateRasterizerState(&rasterizerDesc, RSDepth.GetAddressOf()));
+	ThrowIfFailed(cache.CreateRasterizerState(device, &rasterizerDesc, RSDepth.GetAddressOf()));
 
 	// ******************
 	// 初始化采样器状态
@@ -149,7 +152,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	blendDesc.IndependentBlendEnable = false;
 	rtDesc.BlendEnable = false;
 	rtDesc.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-	ThrowIfFailed(device->CreateBlendState(&blendDesc, BSAlphaToCoverage.GetAddressOf()));
+	ThrowIfFailed(cache.CreateBlendState(device, &blendDesc, BSAlphaToCoverage.GetAddressOf()));
 
 	// 透明混合模式
 	// Color = SrcAlpha * SrcColor + (1 - SrcAlpha) * DestColor 
@@ -164,7 +167,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	rtDesc.DestBlendAlpha = D3D11_BLEND_ZERO;
 	rtDesc.BlendOpAlpha = D3D11_BLEND_OP_ADD;
 
-	ThrowIfFailed(device->CreateBlendState(&blendDesc, BSTransparent.GetAddressOf()));
+	ThrowIfFailed(cache.CreateBlendState(device, &blendDesc, BSTransparent.GetAddressOf()));
 	
 	// 加法混合模式
 	// Color = SrcColor + DestColor
@@ -176,7 +179,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	rtDesc.DestBlendAlpha = D3D11_BLEND_ZERO;
 	rtDesc.BlendOpAlpha = D3D11_BLEND_OP_ADD;
 
-	ThrowIfFailed(device->CreateBlendState(&blendDesc, BSAdditive.GetAddressOf()));
+	ThrowIfFailed(cache.CreateBlendState(device, &blendDesc, BSAdditive.GetAddressOf()));
 
 	// 无颜色写入混合模式
 	// Color = DestColor
@@ -189,7 +192,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	rtDesc.DestBlendAlpha = D3D11_BLEND_ONE;
 	rtDesc.BlendOpAlpha = D3D11_BLEND_OP_ADD;
 	rtDesc.RenderTargetWriteMask = 0;
-	ThrowIfFailed(device->CreateBlendState(&blendDesc, BSNoColorWrite.GetAddressOf()));
+	ThrowIfFailed(cache.CreateBlendState(device, &blendDesc, BSNoColorWrite.GetAddressOf()));
 
 	// ******************
 	// 初始化深度/模板状态
@@ -204,7 +207,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 
 	dsDesc.StencilEnable = false;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSLessEqual.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSLessEqual.GetAddressOf()));
 
 	// 写入模板值的深度/模板状态
 	// 这里不写入深度信息
@@ -227,7 +230,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_REPLACE;
 	dsDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSWriteStencil.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSWriteStencil.GetAddressOf()));
 
 	// 对指定模板值进行绘制的深度/模板状态
 	// 对满足模板值条件的区域才进行绘制，并更新深度
@@ -249,7 +252,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 	dsDesc.BackFace.StencilFunc = D3D11_COMPARISON_EQUAL;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSDrawWithStencil.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSDrawWithStencil.GetAddressOf()));
 
 	// 无二次混合深度/模板状态
 	// 允许默认深度测试
@@ -272,7 +275,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_INCR;
 	dsDesc.BackFace.StencilFunc = D3D11_COMPARISON_EQUAL;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSNoDoubleBlend.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSNoDoubleBlend.GetAddressOf()));
 
 	// 关闭深度测试的深度/模板状态
 	// 若绘制非透明物体，务必严格按照绘制顺序
@@ -281,7 +284,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.DepthEnable = false;
 	dsDesc.StencilEnable = false;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSNoDepthTest.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSNoDepthTest.GetAddressOf()));
 
 
 	// 关闭深度测试
@@ -302,7 +305,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 	dsDesc.BackFace.StencilFunc = D3D11_COMPARISON_EQUAL;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSNoDepthTestWithStencil.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSNoDepthTestWithStencil.GetAddressOf()));
 
 	// 进行深度测试，但不写入深度值的状态
 	// 若绘制非透明物体时，应使用默认状态
@@ -313,7 +316,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.DepthFunc = D3D11_COMPARISON_LESS;
 	dsDesc.StencilEnable = false;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSNoDepthWrite.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSNoDepthWrite.GetAddressOf()));
 
 
 	// 进行深度测试，但不写入深度值的状态
@@ -335,7 +338,7 @@ void RenderStates::InitAll(ID3D11Device * device)
 	dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 	dsDesc.BackFace.StencilFunc = D3D11_COMPARISON_EQUAL;
 
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, DSSNoDepthWriteWithStencil.GetAddressOf()));
+	ThrowIfFailed(cache.CreateDepthStencilState(device, &dsDesc, DSSNoDepthWriteWithStencil.GetAddressOf()));
 
 	// ******************
 	// 设置调试对象名
@@ -1,6 +1,103 @@
 #include <Graphics/RenderTexture.h>
 #include "d3dUtil.h"
 
+static uint32_t BitsPerPixel(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 128;
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+        return 64;
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+        return 16;
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+        return 8;
+    default:
+        return 32;
+    }
+}
+
+//
+// RenderTextureDesc
+//
+
+size_t RenderTextureDesc::GetHash() const
+{
+    size_t hash = 14695981039346656037ull;
+    auto Combine = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    Combine(width);
+    Combine(height);
+    Combine(depthBits);
+    Combine(colorFormat);
+    Combine(msaaLevel);
+    Combine((uint64_t)useMipmaps | (uint64_t)useRandomWrite << 1 | (uint64_t)bindTextureMS << 2);
+    Combine((uint64_t)shadowSamplingMode);
+    return hash;
+}
+
+uint64_t RenderTextureDesc::GetByteSize() const
+{
+    uint64_t pixels = (uint64_t)width * height;
+    uint64_t byteSize = 0;
+    if (shadowSamplingMode == ShadowSamplingMode::None)
+    {
+        uint64_t colorBytes = pixels * BitsPerPixel(colorFormat) / 8;
+        // 完整的mipmap链约为原图的4/3
+        if (useMipmaps)
+            colorBytes = colorBytes * 4 / 3;
+        if (!bindTextureMS)
+            byteSize += colorBytes;
+        if (msaaLevel > 1)
+            byteSize += colorBytes * msaaLevel;
+    }
+    if (depthBits != 0)
+        byteSize += pixels * (depthBits == 16 ? 2 : 4) * msaaLevel;
+    return byteSize;
+}
+
+bool RenderTextureDesc::operator==(const RenderTextureDesc& rhs) const
+{
+    return width == rhs.width && height == rhs.height && depthBits == rhs.depthBits &&
+        colorFormat == rhs.colorFormat && msaaLevel == rhs.msaaLevel && useMipmaps == rhs.useMipmaps &&
+        useRandomWrite == rhs.useRandomWrite && bindTextureMS == rhs.bindTextureMS && 
+        shadowSamplingMode == rhs.shadowSamplingMode;
+}
+
+//
+// RenderTexture
+//
+
 bool RenderTexture::DepthStencilFormats(uint32_t depthBits, DXGI_FORMAT& depthBufferFormat, DXGI_FORMAT& depthSRVFormat, DXGI_FORMAT& depthDSVFormat)
 {
     switch (depthBits)
@@ -34,6 +131,28 @@ RenderTexture::RenderTexture(uint32_t width, uint32_t height, uint32_t depthBits
 {
 }
 
+RenderTexture::RenderTexture(const RenderTextureDesc& desc)
+    : m_Width(desc.width), m_Height(desc.height), m_DepthBits(desc.depthBits), m_ColorFormat(desc.colorFormat), 
+    m_UseRandomWrite(desc.useRandomWrite), m_MsaaLevel(desc.msaaLevel), m_UseMipmaps(desc.useMipmaps), 
+    m_BindTextureMS(desc.bindTextureMS), m_ShadowSamplingMode(desc.shadowSamplingMode)
+{
+}
+
+RenderTextureDesc RenderTexture::GetDesc() const
+{
+    RenderTextureDesc desc;
+    desc.width = m_Width;
+    desc.height = m_Height;
+    desc.depthBits = m_DepthBits;
+    desc.colorFormat = m_ColorFormat;
+    desc.msaaLevel = m_MsaaLevel;
+    desc.useMipmaps = m_UseMipmaps;
+    desc.useRandomWrite = m_UseRandomWrite;
+    desc.bindTextureMS = m_BindTextureMS;
+    desc.shadowSamplingMode = m_ShadowSamplingMode;
+    return desc;
+}
+
 void RenderTexture::SetTextureSize(uint32_t width, uint32_t height)
 {
     m_Width = width;
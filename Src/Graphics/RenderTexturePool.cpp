@@ -0,0 +1,120 @@
+#include <Graphics/RenderTexturePool.h>
+#include <algorithm>
+#include "DXTrace.h"
+
+namespace
+{
+    RenderTexturePool* s_pSingleton = nullptr;
+}
+
+RenderTexturePool::RenderTexturePool(ID3D11Device* device)
+    : m_pDevice(device)
+{
+    if (s_pSingleton)
+        throw std::exception("RenderTexturePool is a singleton!");
+    s_pSingleton = this;
+}
+
+RenderTexturePool::~RenderTexturePool()
+{
+    s_pSingleton = nullptr;
+}
+
+RenderTexturePool& RenderTexturePool::Get()
+{
+    return *s_pSingleton;
+}
+
+RenderTexture* RenderTexturePool::GetTemporary(const RenderTextureDesc& desc)
+{
+    std::unique_ptr<RenderTexture> pTexture;
+
+    auto it = m_FreeEntries.find(desc.GetHash());
+    if (it != m_FreeEntries.end())
+    {
+        // 从后往前找，优先使用最近用过的纹理，让旧的纹理尽快老化释放
+        auto& entries = it->second;
+        for (size_t i = entries.size(); i > 0; --i)
+        {
+            if (entries[i - 1].pTexture->GetDesc() != desc)
+                continue;
+            pTexture = std::move(entries[i - 1].pTexture);
+            entries.erase(entries.begin() + (i - 1));
+            if (entries.empty())
+                m_FreeEntries.erase(it);
+            break;
+        }
+    }
+
+    if (pTexture)
+    {
+        ++m_Statistics.hitCount;
+        --m_Statistics.pooledCount;
+        m_Statistics.pooledBytes -= desc.GetByteSize();
+    }
+    else
+    {
+        ++m_Statistics.missCount;
+        pTexture = std::make_unique<RenderTexture>(desc);
+        ThrowIfFailed(pTexture->Create(m_pDevice));
+    }
+
+    RenderTexture* pResult = pTexture.get();
+    m_pActiveTextures.emplace(pResult, std::move(pTexture));
+    ++m_Statistics.activeCount;
+    return pResult;
+}
+
+void RenderTexturePool::ReleaseTemporary(RenderTexture* pTexture)
+{
+    auto it = m_pActiveTextures.find(pTexture);
+    if (it == m_pActiveTextures.end())
+        throw std::exception("RenderTexturePool::ReleaseTemporary: texture is not from this pool!");
+
+    RenderTextureDesc desc = pTexture->GetDesc();
+    m_FreeEntries[desc.GetHash()].push_back({ std::move(it->second), m_FrameIndex });
+    m_pActiveTextures.erase(it);
+
+    --m_Statistics.activeCount;
+    ++m_Statistics.pooledCount;
+    m_Statistics.pooledBytes += desc.GetByteSize();
+}
+
+void RenderTexturePool::EndFrame()
+{
+    ++m_FrameIndex;
+    for (auto it = m_FreeEntries.begin(); it != m_FreeEntries.end();)
+    {
+        auto& entries = it->second;
+        auto removeBegin = std::remove_if(entries.begin(), entries.end(), [this](const Entry& entry) {
+            return m_FrameIndex - entry.lastUsedFrame > m_MaxUnusedFrames;
+        });
+        for (auto entryIt = removeBegin; entryIt != entries.end(); ++entryIt)
+        {
+            ++m_Statistics.evictedCount;
+            --m_Statistics.pooledCount;
+            m_Statistics.pooledBytes -= entryIt->pTexture->GetDesc().GetByteSize();
+        }
+        entries.erase(removeBegin, entries.end());
+
+        if (entries.empty())
+            it = m_FreeEntries.erase(it);
+        else
+            ++it;
+    }
+}
+
+void RenderTexturePool::ReleaseUnused()
+{
+    m_Statistics.evictedCount += m_Statistics.pooledCount;
+    m_Statistics.pooledCount = 0;
+    m_Statistics.pooledBytes = 0;
+    m_FreeEntries.clear();
+}
+
+void RenderTexturePool::ResetStatistics()
+{
+    m_Statistics.hitCount = 0;
+    m_Statistics.missCount = 0;
+    m_Statistics.evictedCount = 0;
+}
@@ -5,6 +5,8 @@
 #include <Graphics/ResourceManager.h>
 #include <Graphics/RenderStates.h>
 #include <Graphics/Shader.h>
+#include <Utils/ThreadPool.h>
+#include <Utils/Geometry.h>
 
 #include <fstream>
 #include <vector>
@@ -30,6 +32,9 @@ using namespace XMath;
 namespace
 {
 	ResourceManager* s_pSingleton = nullptr;
+
+	// 三角形数达到该值的导入网格会划分为簇
+	constexpr uint32_t s_MinMeshletTriangles = 4096;
 }
 
 ResourceManager::ResourceManager(ID3D11Device* device)
@@ -46,6 +51,8 @@ ResourceManager::~ResourceManager()
 	{
 		p.second->Destroy();
 	}
+	// 之后释放的共享网格不再访问ResourceManager
+	s_pSingleton = nullptr;
 }
 
 ResourceManager& ResourceManager::Get()
@@ -64,17 +71,57 @@ GameObject* ResourceManager::CreateModel(std::string_view path)
 
 	Assimp::Importer importer;
 
+	// 顶点缓存优化在导入后由MeshData::Optimize完成
 	auto pAssimpScene = importer.ReadFile(path.data(), aiProcess_ConvertToLeftHanded |
-		aiProcess_FixInfacingNormals | aiProcess_GenBoundingBoxes | aiProcess_Triangulate | aiProcess_ImproveCacheLocality);
+		aiProcess_FixInfacingNormals | aiProcess_GenBoundingBoxes | aiProcess_Triangulate);
 
 	if (pAssimpScene && !(pAssimpScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) && pAssimpScene->HasMeshes())
 	{
 		auto pModel = iter->second = GameObject::Create(nullptr, path.data());
+		std::vector<MeshFilter*> pMeshFilters(pAssimpScene->mNumMeshes);
+		std::vector<MeshData*> pMeshDatas(pAssimpScene->mNumMeshes);
 		for (uint32_t i = 0; i < pAssimpScene->mNumMeshes; ++i)
 		{
 			auto pSubModel = GameObject::Create(nullptr, pAssimpScene->mMeshes[i]->mName.C_Str(), pModel);
 			_LoadSubModel(path, pSubModel, pAssimpScene, pAssimpScene->mMeshes[i]);
+			pMeshFilters[i] = pSubModel->FindComponent<MeshFilter>();
+			pMeshDatas[i] = pMeshFilters[i]->GetMesh();
+		}
+
+		// 各子模型的网格互相独立，并行优化三角形与顶点顺序，然后尽量使用16位索引并划分簇
+		// 只在网格一级并行，每个网格内部的子网格串行处理
+		std::vector<std::pair<MeshUtility::VertexCacheStatistics, MeshUtility::VertexCacheStatistics>> stats(pMeshDatas.size());
+		ThreadPool::Get().ParallelFor(pMeshDatas.size(), 1, [&pMeshDatas, &stats](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				pMeshDatas[i]->Optimize(&stats[i].first, &stats[i].second, false);
+				pMeshDatas[i]->OptimizeIndexFormat(true);
+				// 三角形较多的网格划分为簇，部分可见时只绘制可见的簇
+				if (stats[i].first.triangleCount >= s_MinMeshletTriangles)
+					pMeshDatas[i]->BuildMeshlets(64, 124, false);
+			}
+		});
+
+		// 内容相同的网格(同一模型内或其它模型中)合并为一个共享网格
+		[[maybe_unused]] size_t savedBytes = m_MeshRegistryStatistics.savedBytes;
+		for (auto pMeshFilter : pMeshFilters)
+		{
+			pMeshFilter->m_pSharedMeshRef = RegisterMesh(std::move(pMeshFilter->m_pMesh));
+			pMeshFilter->m_pSharedMesh = pMeshFilter->m_pSharedMeshRef.get();
+		}
+		savedBytes = m_MeshRegistryStatistics.savedBytes - savedBytes;
+
+#if defined(DEBUG) | defined(_DEBUG)
+		char str[512];
+		for (uint32_t i = 0; i < pAssimpScene->mNumMeshes; ++i)
+		{
+			sprintf_s(str, "%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", pAssimpScene->mMeshes[i]->mName.C_Str(),
+				stats[i].first.acmr, stats[i].second.acmr, stats[i].first.atvr, stats[i].second.atvr);
+			OutputDebugStringA(str);
 		}
+		sprintf_s(str, "%s: %zu bytes saved by mesh deduplication\n", path.data(), savedBytes);
+		OutputDebugStringA(str);
+#endif
 
 		return pModel;
 	}
@@ -162,6 +209,115 @@ void ResourceManager::DestroyMeshGraphicsResources(MeshData* ptr)
 		m_MeshGraphicsResources.erase(it);
 }
 
+PrimitiveMeshDesc PrimitiveMeshDesc::Box(float width, float height, float depth)
+{
+	PrimitiveMeshDesc desc;
+	desc.type = Type::Box;
+	desc.params[0] = width;
+	desc.params[1] = height;
+	desc.params[2] = depth;
+	return desc;
+}
+
+PrimitiveMeshDesc PrimitiveMeshDesc::Sphere(float radius, uint32_t levels, uint32_t slices)
+{
+	PrimitiveMeshDesc desc;
+	desc.type = Type::Sphere;
+	desc.params[0] = radius;
+	desc.counts[0] = levels;
+	desc.counts[1] = slices;
+	return desc;
+}
+
+PrimitiveMeshDesc PrimitiveMeshDesc::Cylinder(float radius, float height, uint32_t slices, uint32_t stacks)
+{
+	PrimitiveMeshDesc desc;
+	desc.type = Type::Cylinder;
+	desc.params[0] = radius;
+	desc.params[1] = height;
+	desc.counts[0] = slices;
+	desc.counts[1] = stacks;
+	return desc;
+}
+
+PrimitiveMeshDesc PrimitiveMeshDesc::Plane(float width, float depth)
+{
+	PrimitiveMeshDesc desc;
+	desc.type = Type::Plane;
+	desc.params[0] = width;
+	desc.params[1] = depth;
+	return desc;
+}
+
+bool PrimitiveMeshDesc::operator<(const PrimitiveMeshDesc& rhs) const
+{
+	return std::tie(type, params[0], params[1], params[2], params[3], counts[0], counts[1]) <
+		std::tie(rhs.type, rhs.params[0], rhs.params[1], rhs.params[2], rhs.params[3], rhs.counts[0], rhs.counts[1]);
+}
+
+std::shared_ptr<MeshData> ResourceManager::GetPrimitiveMesh(const PrimitiveMeshDesc& desc)
+{
+	auto& pWeakMesh = m_PrimitiveMeshes[desc];
+	if (auto pMeshData = pWeakMesh.lock())
+		return pMeshData;
+
+	auto pMeshData = std::make_unique<MeshData>();
+	switch (desc.type)
+	{
+	case PrimitiveMeshDesc::Type::Box: Geometry::CreateBox(pMeshData.get(), desc.params[0], desc.params[1], desc.params[2]); break;
+	case PrimitiveMeshDesc::Type::Sphere: Geometry::CreateSphere(pMeshData.get(), desc.params[0], desc.counts[0], desc.counts[1]); break;
+	case PrimitiveMeshDesc::Type::Cylinder: Geometry::CreateCylinder(pMeshData.get(), desc.params[0], desc.params[1], desc.counts[0], desc.counts[1]); break;
+	case PrimitiveMeshDesc::Type::Plane: Geometry::CreatePlane(pMeshData.get(), desc.params[0], desc.params[1]); break;
+	}
+	pMeshData->Optimize();
+	pMeshData->OptimizeIndexFormat();
+
+	// 最后一个引用释放时从缓存中移除，并销毁GPU资源
+	std::shared_ptr<MeshData> pSharedMesh(pMeshData.release(), [desc](MeshData* ptr) {
+		if (s_pSingleton)
+		{
+			s_pSingleton->DestroyMeshGraphicsResources(ptr);
+			s_pSingleton->m_PrimitiveMeshes.erase(desc);
+		}
+		delete ptr;
+	});
+	pWeakMesh = pSharedMesh;
+	return pSharedMesh;
+}
+
+std::shared_ptr<MeshData> ResourceManager::RegisterMesh(std::unique_ptr<MeshData> pMeshData)
+{
+	uint64_t hash = pMeshData->ComputeContentHash();
+	auto range = m_RegisteredMeshes.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		// 哈希相同时逐字节比较，避免碰撞导致错误合并
+		auto pRegistered = it->second.lock();
+		if (pRegistered && pRegistered->HasSameContent(*pMeshData))
+		{
+			++m_MeshRegistryStatistics.duplicateMeshCount;
+			m_MeshRegistryStatistics.savedBytes += pMeshData->GetByteSize();
+			return pRegistered;
+		}
+	}
+
+	std::shared_ptr<MeshData> pSharedMesh(pMeshData.release(), [hash](MeshData* ptr) {
+		if (s_pSingleton)
+		{
+			s_pSingleton->DestroyMeshGraphicsResources(ptr);
+			// 此时该网格的弱引用已失效，移除同一哈希下所有失效的项
+			auto range = s_pSingleton->m_RegisteredMeshes.equal_range(hash);
+			for (auto it = range.first; it != range.second;)
+				it = it->second.expired() ? s_pSingleton->m_RegisteredMeshes.erase(it) : std::next(it);
+			--s_pSingleton->m_MeshRegistryStatistics.uniqueMeshCount;
+		}
+		delete ptr;
+	});
+	m_RegisteredMeshes.emplace(hash, pSharedMesh);
+	++m_MeshRegistryStatistics.uniqueMeshCount;
+	return pSharedMesh;
+}
+
 Material* ResourceManager::CreateMaterial(std::string_view path)
 {
 	bool emplaced;
@@ -1,6 +1,19 @@
 #include "ShaderImpl.h"
 #include "DXTrace.h"
 #include "d3dUtil.h"
+#include "ShaderCompileCache.h"
+#include "ShaderReflectionData.h"
+#include "ShaderProperties.h"
+#include "RenderStateCache.h"
+#include "InputLayoutCache.h"
+#include <Utils/FileWatcher.h>
+#include <Utils/Hash.h>
+#include <Utils/ThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <type_traits>
 
 
 using namespace Microsoft::WRL;
@@ -29,6 +42,109 @@ namespace
 	std::unordered_map<size_t, GeometryShaderInfo> s_GeometryShaders;
 	std::unordered_map<size_t, PixelShaderInfo> s_PixelShaders;
 	std::unordered_map<size_t, ComputeShaderInfo> s_ComputeShaders;
+
+	// 与XShaderInclude的系统包含目录一致
+	const std::vector<std::string> s_SystemIncludeDirs{ "../../Include", "../../../Include" };
+
+	Shader::CompileStatistics s_CompileStatistics;
+	Shader::CBufferUploadStatistics s_CBufferUploadStatistics;
+	bool s_ConstantRingEnabled = true;
+
+	// 与Shader::Impl::PassDesc中各阶段的顺序一致
+	const char* const s_StageTypes[] = { "vs", "hs", "ds", "gs", "ps", "cs" };
+
+	// 只读映射的着色器归档，最后一个引用释放时解除映射
+	struct MappedShaderArchive
+	{
+		MappedShaderArchive() = default;
+		MappedShaderArchive(const MappedShaderArchive&) = delete;
+		MappedShaderArchive& operator=(const MappedShaderArchive&) = delete;
+		~MappedShaderArchive()
+		{
+			if (pView)
+				UnmapViewOfFile(pView);
+			if (hMapping)
+				CloseHandle(hMapping);
+			if (hFile != INVALID_HANDLE_VALUE)
+				CloseHandle(hFile);
+		}
+
+		HANDLE hFile = INVALID_HANDLE_VALUE;
+		HANDLE hMapping = nullptr;
+		LPVOID pView = nullptr;
+		ShaderArchive archive;
+	};
+
+	// 直接引用归档映射内存的字节码，持有归档直到最后一个引用释放
+	class ArchiveBlob : public ID3DBlob
+	{
+	public:
+		ArchiveBlob(std::shared_ptr<const ShaderArchive> pArchive, const void* pData, SIZE_T byteSize)
+			: m_pArchive(std::move(pArchive)), m_pData(pData), m_ByteSize(byteSize) {}
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+		{
+			if (!ppvObject)
+				return E_POINTER;
+			if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D10Blob))
+			{
+				*ppvObject = static_cast<ID3DBlob*>(this);
+				AddRef();
+				return S_OK;
+			}
+			*ppvObject = nullptr;
+			return E_NOINTERFACE;
+		}
+		ULONG STDMETHODCALLTYPE AddRef() override { return ++m_RefCount; }
+		ULONG STDMETHODCALLTYPE Release() override
+		{
+			ULONG refCount = --m_RefCount;
+			if (refCount == 0)
+				delete this;
+			return refCount;
+		}
+		// 映射为只读，调用者不能写入
+		LPVOID STDMETHODCALLTYPE GetBufferPointer() override { return const_cast<void*>(m_pData); }
+		SIZE_T STDMETHODCALLTYPE GetBufferSize() override { return m_ByteSize; }
+
+	private:
+		virtual ~ArchiveBlob() = default;
+
+		std::atomic<ULONG> m_RefCount = 1;
+		std::shared_ptr<const ShaderArchive> m_pArchive;
+		const void* m_pData;
+		SIZE_T m_ByteSize;
+	};
+
+	std::shared_ptr<const ShaderArchive> s_pArchive;
+
+	// 已加载的入口点，WriteArchive按此生成归档
+	struct ArchiveSource
+	{
+		uint64_t key;
+		uint64_t nameHash;
+		std::wstring wCsoPath;
+	};
+	std::vector<ArchiveSource> s_ArchiveSources;
+
+	// 一批热重载，编译期间发生的新变化留到下一批
+	struct HotReloadTask
+	{
+		std::vector<Shader*> pShaders;
+		std::shared_ptr<std::vector<Shader::Impl::CompileJob>> pJobs;
+		std::future<void> compiled;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	// 热重载的状态只在主线程访问
+	std::unique_ptr<FileWatcher> s_pFileWatcher;
+	std::unordered_set<std::string> s_DirtyShaderPaths;
+	// 上一批没有替换成功的主着色器文件，其哈希已经是新的，在下一批热重载中一并重新编译
+	std::unordered_set<std::string> s_RetryShaderPaths;
+	std::unique_ptr<HotReloadTask> s_pHotReloadTask;
+
+	// id到字符串的记录，用于检测冲突，只在主线程访问
+	std::unordered_map<size_t, std::string> s_PropertyNames;
 }
 
 //
@@ -92,8 +208,34 @@ namespace
 
 #define PASS_SET_CBUFFER(ShaderType) \
 {\
-	for (auto& it : cBuffers)\
+	const FrameConstantBuffer::Binding* pPrepared = pPreparedCBuffers;\
+	for (auto& it : cBufferDatas)\
 	{\
+		if (pPrepared)\
+		{\
+			const FrameConstantBuffer::Binding& binding = *pPrepared++;\
+			if (binding.numConstants)\
+				pFrameCBuffer->GetDeviceContext1()->##ShaderType##SetConstantBuffers1(it.first, 1, &binding.pBuffer,\
+					&binding.firstConstant, &binding.numConstants);\
+			else\
+				deviceContext->##ShaderType##SetConstantBuffers(it.first, 1, &binding.pBuffer);\
+			continue;\
+		}\
+		if (ID3D11Buffer* pOverride = FindCBufferOverride(pOverrides, numOverrides, it.first))\
+		{\
+			deviceContext->##ShaderType##SetConstantBuffers(it.first, 1, &pOverride);\
+			continue;\
+		}\
+		if (pFrameCBuffer && !it.second.UsesPartialUpdate())\
+		{\
+			auto& binding = it.second.UpdateRingBuffer(pFrameCBuffer);\
+			if (binding.pBuffer)\
+			{\
+				pFrameCBuffer->GetDeviceContext1()->##ShaderType##SetConstantBuffers1(it.first, 1, &binding.pBuffer,\
+					&binding.firstConstant, &binding.numConstants);\
+				continue;\
+			}\
+		}\
 		it.second.UpdateBuffer(deviceContext);\
 		deviceContext->##ShaderType##SetConstantBuffers(it.first, 1, it.second.cBuffer.GetAddressOf());\
 	}\
@@ -114,20 +256,228 @@ namespace
 //
 // 函数
 //
-static std::string SystemTimeToString(const SYSTEMTIME& st)
+static ID3D11Buffer* FindCBufferOverride(const CBufferOverride* pOverrides, uint32_t numOverrides, uint32_t startSlot)
+{
+	for (uint32_t i = 0; i < numOverrides; ++i)
+	{
+		if (pOverrides[i].startSlot == startSlot)
+			return pOverrides[i].pBuffer;
+	}
+	return nullptr;
+}
+
+// 将反射数据写入着色器信息，属性id由名称计算
+template<class ShaderInfo>
+static void ApplyReflection(ShaderInfo& info, const ShaderReflectionData& reflection)
+{
+	for (auto& cbuffer : reflection.constantBuffers)
+	{
+		auto& cbufferInfo = info.cBuffers.try_emplace(cbuffer.startSlot,
+			ConstantBufferInfo{ cbuffer.name, cbuffer.startSlot, cbuffer.byteWidth }).first->second;
+		for (auto& variable : cbuffer.variables)
+		{
+			Property& prop = cbufferInfo.properties[Shader::RegisterPropertyName(variable.name)];
+			prop.startByteOffset = variable.startByteOffset;
+			prop.byteWidth = variable.byteWidth;
+		}
+	}
+
+	for (auto& resource : reflection.shaderResources)
+	{
+		ShaderResourceInfo& resourceInfo = info.shaderResources[Shader::RegisterPropertyName(resource.name)];
+		resourceInfo.name = resource.name;
+		resourceInfo.startSlot = resource.startSlot;
+		resourceInfo.dim = static_cast<D3D11_SRV_DIMENSION>(resource.dimension);
+	}
+
+	for (auto& sampler : reflection.samplers)
+	{
+		SamplerStateInfo& samplerInfo = info.samplers[Shader::RegisterPropertyName(sampler.name)];
+		samplerInfo.name = sampler.name;
+		samplerInfo.startSlot = sampler.startSlot;
+	}
+
+	// 只有像素着色器与计算着色器可以使用可读写资源
+	if constexpr (std::is_same_v<ShaderInfo, PixelShaderInfo> || std::is_same_v<ShaderInfo, ComputeShaderInfo>)
+	{
+		for (auto& resource : reflection.rwResources)
+		{
+			RWResourceInfo& resourceInfo = info.rwResources[Shader::RegisterPropertyName(resource.name)];
+			resourceInfo.name = resource.name;
+			resourceInfo.startSlot = resource.startSlot;
+			resourceInfo.dim = static_cast<D3D11_UAV_DIMENSION>(resource.dimension);
+		}
+	}
+}
+
+// 读取.cso旁的反射数据，文件不存在或与字节码不匹配时返回false
+static bool ReadShaderReflection(const std::wstring& path, uint64_t blobHash, ShaderReflectionData& reflection)
+{
+	std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!fin.is_open())
+		return false;
+	std::vector<char> bytes((size_t)fin.tellg());
+	fin.seekg(0, std::ios::beg);
+	fin.read(bytes.data(), bytes.size());
+	fin.close();
+	return DeserializeShaderReflection(bytes.data(), bytes.size(), blobHash, reflection);
+}
+
+static void WriteShaderReflection(const std::wstring& path, uint64_t blobHash, const ShaderReflectionData& reflection)
+{
+	std::vector<uint8_t> bytes;
+	SerializeShaderReflection(reflection, blobHash, bytes);
+	std::ofstream fout(path, std::ios::out | std::ios::binary);
+	fout.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	fout.close();
+}
+
+static DWORD GetShaderCompileFlags()
+{
+	DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+	// 设置 D3DCOMPILE_DEBUG 标志用于获取着色器调试信息。该标志可以提升调试体验，
+	// 但仍然允许着色器进行优化操作
+	dwShaderFlags |= D3DCOMPILE_DEBUG;
+
+	// 在Debug环境下禁用优化以避免出现一些不合理的情况
+	dwShaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+	return dwShaderFlags;
+}
+
+static void CompileShader(Shader::Impl::CompileJob& job, const std::wstring& wCsoPath);
+
+// 从归档读取字节码与反射数据，主着色器文件不存在时按名称查找
+static bool LoadFromArchive(Shader::Impl::CompileJob& job)
+{
+	const ShaderArchive& archive = *job.pArchive;
+	const ShaderArchive::Entry* pEntry = job.cacheKey.empty() ? archive.FindByName(job.nameHash) : archive.FindByKey(job.key);
+	if (!pEntry || !DeserializeShaderReflection(archive.GetReflection(*pEntry), pEntry->reflectionSize, pEntry->blobHash, job.reflection))
+		return false;
+	job.pBlob.Attach(new ArchiveBlob(job.pArchive, archive.GetBlob(*pEntry), pEntry->blobSize));
+	job.key = pEntry->cacheKey;
+	job.fromArchive = true;
+	return true;
+}
+
+// 依次从归档、.cso与反射数据读取，都不存在时编译、反射并写入。可在工作线程调用，错误写入job.errorMsg
+static void RunCompileJob(Shader::Impl::CompileJob& job)
 {
-	char str[40];
-	sprintf_s(str, "%d/%d/%d %d:%02d:%02d", st.wYear, st.wMonth, st.wDay, st.wHour,
-		st.wMinute, st.wSecond);
-	return std::string(str);
+	if (job.pArchive && LoadFromArchive(job))
+		return;
+	if (job.cacheKey.empty())
+	{
+		job.errorMsg = "HLSL file " + job.shaderPath + " is not found and the entry point is not in the shader archive\n";
+		return;
+	}
+
+	std::wstring wCsoPath = job.wCsoPrefix + UTF8ToUCS2(job.cacheKey) + L".cso";
+	if (SUCCEEDED(D3DReadFileToBlob(wCsoPath.c_str(), job.pBlob.GetAddressOf())))
+		job.fromCache = true;
+	else
+		CompileShader(job, wCsoPath);
+	if (!job.errorMsg.empty())
+		return;
+
+	// 反射数据保存在.cso旁，读取成功时整个启动过程不再调用D3DReflect
+	std::wstring wReflectionPath = job.wCsoPrefix + UTF8ToUCS2(job.cacheKey) + L".refl";
+	uint64_t blobHash = Hash::HashBytes(job.pBlob->GetBufferPointer(), job.pBlob->GetBufferSize());
+	if (job.fromCache && ReadShaderReflection(wReflectionPath, blobHash, job.reflection))
+		return;
+
+	HRESULT hr = Shader::Impl::ReflectShader(job.pBlob->GetBufferPointer(), job.pBlob->GetBufferSize(), job.reflection);
+	if (FAILED(hr))
+	{
+		job.errorMsg = "D3DReflect failed, HRESULT: " + std::to_string(hr);
+		return;
+	}
+	job.reflected = true;
+	WriteShaderReflection(wReflectionPath, blobHash, job.reflection);
 }
 
-static SYSTEMTIME StringToSystemTime(const std::string& str)
+// 编译入口点并写入.cso，错误写入job.errorMsg
+static void CompileShader(Shader::Impl::CompileJob& job, const std::wstring& wCsoPath)
 {
-	SYSTEMTIME st;
-	sscanf_s(str.c_str(), "%hd/%hd/%hd %hd:%hd:%hd", &st.wYear, &st.wMonth, &st.wDay,
-		&st.wHour, &st.wMinute, &st.wSecond);
-	return st;
+	// 只在需要写入.cso时创建目录，全部从归档读取时不会创建
+	CreateDirectory(wCsoPath.substr(0, wCsoPath.find_last_of(L'/')).c_str(), nullptr);
+
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (auto& define : job.defines)
+		macros.push_back({ define.c_str(), "1" });
+	macros.push_back({ nullptr, nullptr });
+
+	// 每个任务使用独立的包含处理器，其中保存着打开的文件内容
+	XShaderInclude includeHandler(s_SystemIncludeDirs, job.localPath);
+	ComPtr<ID3DBlob> pErrorMsg;
+	HRESULT hr = D3DCompileFromFile(UTF8ToUCS2(job.shaderPath).c_str(), macros.data(), &includeHandler, job.entryPoint.c_str(),
+		job.shaderModel.c_str(), GetShaderCompileFlags(), 0, job.pBlob.ReleaseAndGetAddressOf(), pErrorMsg.GetAddressOf());
+	if (pErrorMsg)
+		job.errorMsg = reinterpret_cast<char*>(pErrorMsg->GetBufferPointer());
+	else if (FAILED(hr))
+		job.errorMsg = "D3DCompileFromFile failed, HRESULT: " + std::to_string(hr);
+	else if (FAILED(hr = D3DWriteBlobToFile(job.pBlob.Get(), wCsoPath.c_str(), TRUE)))
+		job.errorMsg = "D3DWriteBlobToFile failed, HRESULT: " + std::to_string(hr);
+}
+
+// 每个任务单独提交到线程池，不阻塞调用线程，最后完成的任务使返回的future就绪
+// 错误写入job.errorMsg，任务本身不会抛出异常
+static std::future<void> SubmitCompileJobs(std::shared_ptr<std::vector<Shader::Impl::CompileJob>> pJobs)
+{
+	struct Batch
+	{
+		std::shared_ptr<std::vector<Shader::Impl::CompileJob>> pJobs;
+		std::atomic<size_t> remaining;
+		std::promise<void> done;
+	};
+	auto pBatch = std::make_shared<Batch>();
+	pBatch->pJobs = std::move(pJobs);
+	pBatch->remaining = pBatch->pJobs->size();
+	std::future<void> res = pBatch->done.get_future();
+	if (pBatch->pJobs->empty())
+	{
+		pBatch->done.set_value();
+		return res;
+	}
+
+	for (size_t i = 0; i < pBatch->pJobs->size(); ++i)
+	{
+		ThreadPool::Get().Submit([pBatch, i]() {
+			RunCompileJob((*pBatch->pJobs)[i]);
+			if (pBatch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				pBatch->done.set_value();
+		});
+	}
+	return res;
+}
+
+// 汇总所有任务的错误，每条错误前标明入口点
+static std::string CollectCompileErrors(const std::vector<Shader::Impl::CompileJob>& jobs)
+{
+	std::string errors;
+	for (auto& job : jobs)
+	{
+		if (job.errorMsg.empty())
+			continue;
+		errors += job.name + " (" + job.shaderModel + "):\n" + job.errorMsg;
+		if (errors.back() != '\n')
+			errors.push_back('\n');
+	}
+	return errors;
+}
+
+// 非默认变体的着色器名后缀
+static std::string MakeVariantSuffix(const std::vector<std::string>& defines)
+{
+	std::string suffix = "[";
+	for (size_t i = 0; i < defines.size(); ++i)
+	{
+		if (i)
+			suffix.push_back(' ');
+		suffix += defines[i];
+	}
+	suffix.push_back(']');
+	return suffix;
 }
 
 template<class Type,
@@ -242,7 +592,7 @@ static HRESULT CreateRasterizerStateFromJson(ID3D11Device* device, const nlohman
 	if (!ParseBool(json, "MultisampleEnable", rsDesc.MultisampleEnable)) return E_INVALIDARG;
 	if (!ParseBool(json, "AntialiasedLineEnable", rsDesc.AntialiasedLineEnable)) return E_INVALIDARG;
 
-	return device->CreateRasterizerState(&rsDesc, outRasterizerState);
+	return RenderStateCache::Get().CreateRasterizerState(device, &rsDesc, outRasterizerState);
 }
 
 static HRESULT CreateDepthStencilStateFromJson(ID3D11Device* device, const nlohmann::json& json, ID3D11DepthStencilState** outDepthStencilState)
@@ -291,7 +641,7 @@ static HRESULT CreateDepthStencilStateFromJson(ID3D11Device* device, const nlohm
 	if (!Parse(json, "BackFace.StencilPassOp", stencilFunc, dsDesc.BackFace.StencilPassOp)) return E_INVALIDARG;
 	if (!Parse(json, "BackFace.StencilFunc", compFunc, dsDesc.BackFace.StencilFunc)) return E_INVALIDARG;
 
-	return device->CreateDepthStencilState(&dsDesc, outDepthStencilState);
+	return RenderStateCache::Get().CreateDepthStencilState(device, &dsDesc, outDepthStencilState);
 }
 
 static HRESULT CreateBlendStateFromJson(ID3D11Device* device, const nlohmann::json& json, ID3D11BlendState** outBlendState)
@@ -366,7 +716,7 @@ static HRESULT CreateBlendStateFromJson(ID3D11Device* device, const nlohmann::js
 		}
 	}
 
-	return device->CreateBlendState(&bsDesc, outBlendState);
+	return RenderStateCache::Get().CreateBlendState(device, &bsDesc, outBlendState);
 }
 
 //
@@ -381,7 +731,7 @@ void ShaderPass::SetBlendState(ID3D11BlendState* pBS, const FLOAT blendFactor[4]
 {
 	this->pBlendState = pBS;
 	if (blendFactor)
-		memcpy_s(this->blendFactor.data(), sizeof blendFactor, blendFactor, sizeof blendFactor);
+		memcpy_s(this->blendFactor.data(), sizeof this->blendFactor, blendFactor, sizeof this->blendFactor);
 	this->sampleMask = sampleMask;
 }
 
@@ -424,6 +774,40 @@ ID3D11InputLayout* ShaderPass::GetInputLayout()
 
 void ShaderPass::Apply(ID3D11DeviceContext* deviceContext)
 {
+	Apply(deviceContext, cBuffers);
+}
+
+void ShaderPass::PrepareCBuffers(ID3D11DeviceContext* deviceContext, std::map<uint32_t, CBufferData>& cBufferDatas, FrameConstantBuffer* pFrameCBuffer,
+	const CBufferOverride* pOverrides, uint32_t numOverrides, std::vector<FrameConstantBuffer::Binding>& bindings)
+{
+	for (auto& it : cBufferDatas)
+	{
+		FrameConstantBuffer::Binding binding;
+		if (ID3D11Buffer* pOverride = FindCBufferOverride(pOverrides, numOverrides, it.first))
+		{
+			binding.pBuffer = pOverride;
+			bindings.push_back(binding);
+			continue;
+		}
+		CBufferData& cbuffer = it.second;
+		if (!cbuffer.UsesPartialUpdate() || cbuffer.isDirty || cbuffer.HasRingBinding(pFrameCBuffer))
+			binding = cbuffer.UpdateRingBuffer(pFrameCBuffer);
+		if (!binding.pBuffer)
+		{
+			cbuffer.UpdateBuffer(deviceContext);
+			binding.pBuffer = cbuffer.cBuffer.Get();
+		}
+		bindings.push_back(binding);
+	}
+}
+
+void ShaderPass::Apply(ID3D11DeviceContext* deviceContext, std::map<uint32_t, CBufferData>& cBufferDatas, FrameConstantBuffer* pFrameCBuffer,
+	const CBufferOverride* pOverrides, uint32_t numOverrides, RenderStateBindings* pBoundStates, const FrameConstantBuffer::Binding* pPreparedCBuffers)
+{
+	// 预先准备的绑定已经引用了帧常量缓冲区
+	if (pFrameCBuffer && !pPreparedCBuffers && (!pFrameCBuffer->IsSupported() || !s_ConstantRingEnabled))
+		pFrameCBuffer = nullptr;
+
 	//
 	// 设置着色器、常量缓冲区、形参常量缓冲区、采样器、着色器资源、可读写资源
 	//
@@ -506,10 +890,28 @@ void ShaderPass::Apply(ID3D11DeviceContext* deviceContext)
 		deviceContext->CSSetShader(nullptr, nullptr, 0);
 	}
 
-	// 设置渲染状态
-	deviceContext->RSSetState(pRasterizerState.Get());
-	deviceContext->OMSetBlendState(pBlendState.Get(), blendFactor.data(), sampleMask);
-	deviceContext->OMSetDepthStencilState(pDepthStencilState.Get(), stencilRef);
+	// 设置渲染状态，与上下文中已有的相同时跳过
+	RenderStateBindings bindings;
+	RenderStateBindings& bound = pBoundStates ? *pBoundStates : bindings;
+	if (!bound.isValid || bound.pRasterizerState != pRasterizerState.Get())
+	{
+		deviceContext->RSSetState(pRasterizerState.Get());
+		bound.pRasterizerState = pRasterizerState.Get();
+	}
+	if (!bound.isValid || bound.pBlendState != pBlendState.Get() || bound.blendFactor != blendFactor || bound.sampleMask != sampleMask)
+	{
+		deviceContext->OMSetBlendState(pBlendState.Get(), blendFactor.data(), sampleMask);
+		bound.pBlendState = pBlendState.Get();
+		bound.blendFactor = blendFactor;
+		bound.sampleMask = sampleMask;
+	}
+	if (!bound.isValid || bound.pDepthStencilState != pDepthStencilState.Get() || bound.stencilRef != stencilRef)
+	{
+		deviceContext->OMSetDepthStencilState(pDepthStencilState.Get(), stencilRef);
+		bound.pDepthStencilState = pDepthStencilState.Get();
+		bound.stencilRef = stencilRef;
+	}
+	bound.isValid = true;
 }
 
 
@@ -517,20 +919,43 @@ void ShaderPass::Apply(ID3D11DeviceContext* deviceContext)
 // Shader::Impl
 //
 void Shader::Impl::SetGlobalRaw(size_t propertyID, const void* data, uint32_t byteOffset, uint32_t byteCount)
+{
+	SetRaw(m_CBuffers, propertyID, data, byteOffset, byteCount);
+	// 已创建的关键字变体有各自的常量缓冲区，同样写入
+	for (auto& variant : m_Variants)
+	{
+		if (variant.second.pShader)
+			variant.second.pShader->pImpl->SetGlobalRaw(propertyID, data, byteOffset, byteCount);
+	}
+}
+
+void Shader::Impl::SetRaw(std::map<uint32_t, CBufferData>& cBufferDatas, size_t propertyID, const void* data, uint32_t byteOffset, uint32_t byteCount)
 {
 	auto it = m_Properties.find(propertyID);
 	if (it == m_Properties.end())
 		return;
-	if (byteOffset > it->second.byteWidth)
-		return;
-	if (byteOffset + byteCount > it->second.byteWidth)
-		byteCount = it->second.byteWidth - byteOffset;
+
+	Property prop = it->second;
+	if (&cBufferDatas != &m_CBuffers)
+	{
+		auto cbufferIt = cBufferDatas.find(prop.pCBufferData->startSlot);
+		if (cbufferIt == cBufferDatas.end())
+			return;
+		prop.pCBufferData = &cbufferIt->second;
+	}
 
 	// 仅当值不同时更新
-	if (memcmp(it->second.pCBufferData->data.data() + it->second.startByteOffset + byteOffset, data, byteCount))
+	ShaderProperties::WriteRaw(prop, data, byteOffset, byteCount);
+}
+
+void Shader::Impl::CopyGlobals(const std::unordered_map<size_t, Property>& properties, const std::vector<ShaderPass>& passes)
+{
+	ShaderProperties::CopyValues(properties, m_Properties);
+	// 同一组PassSource创建的Pass数量与顺序相同
+	for (size_t i = 0; i < m_Passes.size() && i < passes.size(); ++i)
 	{
-		memcpy_s(it->second.pCBufferData->data.data() + it->second.startByteOffset + byteOffset, byteCount, data, byteCount);
-		it->second.pCBufferData->isDirty = true;
+		ShaderProperties::CopyBindings(passes[i].shaderResources, m_Passes[i].shaderResources);
+		ShaderProperties::CopyBindings(passes[i].samplers, m_Passes[i].samplers);
 	}
 }
 
@@ -586,41 +1011,380 @@ ShaderPass& Shader::Impl::AddPass(const PassDesc& desc)
 	return m_Passes.back();
 }
 
+void Shader::Impl::BuildPasses(const std::vector<PassSource>& sources, std::string_view shaderPath, std::string_view nameSuffix)
+{
+	for (auto& source : sources)
+	{
+		PassDesc desc;
+		const std::string* entryPoints = reinterpret_cast<const std::string*>(&source.entryPoints);
+		std::string* names = reinterpret_cast<std::string*>(&desc);
+		for (size_t i = 0; i < std::size(s_StageTypes); ++i)
+		{
+			if (!entryPoints[i].empty())
+				names[i] = std::string(shaderPath) + "/" + entryPoints[i] + std::string(nameSuffix);
+		}
+
+		auto& pass = AddPass(desc);
+		pass.SetRasterizerState(source.pRS.Get());
+		pass.SetDepthStencilState(source.pDSS.Get(), source.stencilValue);
+		pass.SetBlendState(source.pBS.Get(), source.hasBlendFactor ? source.blendFactor : nullptr, source.sampleMask);
+		// TODO: Sampler State binding with texture
+		/*pass.SetSamplerState(X_SAMPLER_LINEAR_WARP, RenderStates::SSLinearWrap.Get());
+		pass.SetSamplerState(X_SAMPLER_ANISTROPIC_WRAP, RenderStates::SSAnistropicWrap.Get());
+		pass.SetSamplerState(X_SAMPLER_POINT_CLAMP, RenderStates::SSPointClamp.Get());
+		pass.SetSamplerState(X_SAMPLER_SHADOW, RenderStates::SSShadow.Get());*/
+	}
+}
+
+void Shader::Impl::RebuildPasses(const std::vector<PassSource>& sources, std::string_view shaderPath, std::string_view nameSuffix)
+{
+	// 旧的Property指向的CBufferData随节点一起移动，地址不变
+	std::map<uint32_t, CBufferData> oldCBuffers = std::move(m_CBuffers);
+	std::unordered_map<size_t, Property> oldProperties = std::move(m_Properties);
+	std::vector<ShaderPass> oldPasses = std::move(m_Passes);
+	m_CBuffers.clear();
+	m_Properties.clear();
+	m_Passes.clear();
+
+	BuildPasses(sources, shaderPath, nameSuffix);
+	CopyGlobals(oldProperties, oldPasses);
+
+	// Pass的数量与顺序由json决定，热重载时不变
+	for (size_t i = 0; i < m_Passes.size() && i < oldPasses.size(); ++i)
+	{
+		ShaderPass& pass = m_Passes[i];
+		ShaderPass& oldPass = oldPasses[i];
+		for (auto& [propertyID, binding] : pass.rwResources)
+		{
+			if (auto it = oldPass.rwResources.find(propertyID); it != oldPass.rwResources.end())
+				binding.second = std::move(it->second.second);
+		}
+	}
+}
+
+uint64_t Shader::Impl::GetVariantKey(const std::vector<size_t>& keywordIds, std::vector<std::string>& defines) const
+{
+	uint64_t key = 0;
+	for (size_t i = 0; i < m_KeywordSets.size(); ++i)
+	{
+		auto& ids = m_KeywordIds[i];
+		size_t selected = 0;
+		for (size_t j = 1; j < ids.size(); ++j)
+		{
+			if (std::binary_search(keywordIds.begin(), keywordIds.end(), ids[j]))
+			{
+				selected = j;
+				break;
+			}
+		}
+		// 每组占8位
+		key |= (uint64_t)selected << (8 * i);
+		if (m_KeywordSets[i][selected] != "_")
+			defines.push_back(m_KeywordSets[i][selected]);
+	}
+	return key;
+}
+
+void Shader::Impl::AppendCompileJobs(const std::vector<std::string>& defines, std::string_view nameSuffix,
+	std::vector<CompileJob>& jobs, std::unordered_set<std::string>& jobNames) const
+{
+	// 输出目录由主着色器文件决定而不是Shader类名：去重后的任务被多个Shader类共用，
+	// 目录与json中Shader类的顺序无关，新增或删除引用同一文件的Shader类不会让缓存失效
+	std::string normalizedPath = ShaderDependencyGraph::NormalizePath(m_ShaderPath);
+	std::string fileName = normalizedPath.substr(normalizedPath.find_last_of('/') + 1);
+	std::wstring wCsoDir = UTF8ToUCS2(fileName.substr(0, fileName.find_last_of('.')) + "." +
+		ShaderCompileKeyToString(Hash::FNV1a64(normalizedPath)).substr(8));
+	DWORD compileFlags = GetShaderCompileFlags();
+	for (auto& source : m_PassSources)
+	{
+		const std::string* entryPoints = reinterpret_cast<const std::string*>(&source.entryPoints);
+		for (size_t i = 0; i < std::size(s_StageTypes); ++i)
+		{
+			if (entryPoints[i].empty())
+				continue;
+			std::string shaderModel = std::string(s_StageTypes[i]) + "_5_0";
+			std::string name = m_ShaderPath + "/" + entryPoints[i] + std::string(nameSuffix);
+			// 同一文件的同一入口点只编译一次，即使被多个Shader类引用
+			if (!jobNames.insert(name + "." + shaderModel).second)
+				continue;
+
+			CompileJob& job = jobs.emplace_back();
+			job.name = name;
+			job.shaderPath = m_ShaderPath;
+			job.localPath = m_LocalPath;
+			job.entryPoint = entryPoints[i];
+			job.shaderModel = shaderModel;
+			job.defines = defines;
+			if (m_SourceHash)
+			{
+				job.key = ComputeShaderCompileKey(m_SourceHash, entryPoints[i], shaderModel, defines, compileFlags, D3D_COMPILER_VERSION);
+				job.cacheKey = ShaderCompileKeyToString(job.key);
+			}
+			job.nameHash = ShaderArchive::HashEntryName(name, shaderModel);
+			job.wCsoPrefix = wCsoDir + L'/' + UTF8ToUCS2(entryPoints[i]) + L'.';
+			job.pArchive = s_pArchive;
+		}
+	}
+}
+
 bool Shader::Impl::InitAll(ID3D11Device* pDevice)
 {
 	s_pDevice = pDevice;
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	CBufferData::s_PartialUpdateSupported = SUCCEEDED(pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof options)) &&
+		options.ConstantBufferPartialUpdate;
+	D3D11_FEATURE_DATA_THREADING threading{};
+	CBufferData::s_DriverCommandLists = SUCCEEDED(pDevice->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof threading)) &&
+		threading.DriverCommandLists;
 	return true;
 }
 
+void Shader::Impl::EndFrameStatistics()
+{
+	auto& bytes = CBufferData::s_UploadBytes;
+	s_CBufferUploadStatistics.perFrameBytes = bytes[(size_t)CBufferFrequency::PerFrame].exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.perCameraBytes = bytes[(size_t)CBufferFrequency::PerCamera].exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.perMaterialBytes = bytes[(size_t)CBufferFrequency::PerMaterial].exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.perObjectBytes = bytes[(size_t)CBufferFrequency::PerObject].exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.discardMapCount = CBufferData::s_DiscardMapCount.exchange(0, std::memory_order_relaxed) +
+		FrameConstantBuffer::s_DiscardMapCount.exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.noOverwriteMapCount = FrameConstantBuffer::s_NoOverwriteMapCount.exchange(0, std::memory_order_relaxed);
+	s_CBufferUploadStatistics.updateSubresourceCount = CBufferData::s_UpdateSubresourceCount.exchange(0, std::memory_order_relaxed);
+}
+
 bool Shader::Impl::Exists(std::string_view name)
 {
 	return s_ShaderSet.find(StringToID(name)) != s_ShaderSet.end();
 }
 
-HRESULT Shader::Impl::AddFromBlob(std::string_view name, ID3D11Device* device, ID3DBlob* blob)
+void Shader::Impl::RemoveShader(std::string_view name)
+{
+	size_t shaderID = StringToID(name);
+	s_ShaderSet.erase(shaderID);
+	s_VertexShaders.erase(shaderID);
+	s_HullShaders.erase(shaderID);
+	s_DomainShaders.erase(shaderID);
+	s_GeometryShaders.erase(shaderID);
+	s_PixelShaders.erase(shaderID);
+	s_ComputeShaders.erase(shaderID);
+}
+
+// 重新计算脏的主着色器文件的哈希，为内容改变的着色器及其已创建的变体生成编译任务
+static std::unique_ptr<HotReloadTask> StartHotReload()
+{
+	auto pTask = std::make_unique<HotReloadTask>();
+	pTask->startTime = std::chrono::steady_clock::now();
+	pTask->pJobs = std::make_shared<std::vector<Shader::Impl::CompileJob>>();
+
+	// 每批重新读取文件
+	ShaderDependencyGraph dependencyGraph(s_SystemIncludeDirs);
+	std::unordered_set<std::string> jobNames;
+	for (auto& it : s_ShaderMap)
+	{
+		Shader* pShader = it.second.get();
+		auto& impl = *pShader->pImpl;
+		bool retry = s_RetryShaderPaths.count(impl.m_ShaderPath) > 0;
+		if (!retry && !s_DirtyShaderPaths.count(impl.m_ShaderPath))
+			continue;
+
+		// 新增的包含文件也需要监视
+		impl.m_Dependencies = dependencyGraph.GetDependencies(impl.m_ShaderPath);
+		for (auto& path : impl.m_Dependencies)
+			s_pFileWatcher->Watch(path);
+
+		// 内容没有改变(如只是保存)或主着色器文件被删除时不重新编译
+		uint64_t sourceHash = dependencyGraph.GetSourceHash(impl.m_ShaderPath);
+		if (!sourceHash || (sourceHash == impl.m_SourceHash && !retry))
+			continue;
+		impl.m_SourceHash = sourceHash;
+
+		std::vector<std::string> defines;
+		impl.GetVariantKey({}, defines);
+		impl.AppendCompileJobs(defines, "", *pTask->pJobs, jobNames);
+		// 未完成或失败的变体在下次请求时按新的源码编译
+		for (auto variantIt = impl.m_Variants.begin(); variantIt != impl.m_Variants.end();)
+		{
+			auto& variant = variantIt->second;
+			if (!variant.pShader)
+			{
+				variantIt = impl.m_Variants.erase(variantIt);
+				continue;
+			}
+			impl.AppendCompileJobs(variant.defines, variant.nameSuffix, *pTask->pJobs, jobNames);
+			++variantIt;
+		}
+		pTask->pShaders.push_back(pShader);
+	}
+	s_DirtyShaderPaths.clear();
+	s_RetryShaderPaths.clear();
+
+	if (pTask->pShaders.empty())
+		return nullptr;
+	pTask->compiled = SubmitCompileJobs(pTask->pJobs);
+	return pTask;
+}
+
+// 这一批的着色器在下一批热重载中重新编译
+static void RetryHotReload(const HotReloadTask& task)
+{
+	for (Shader* pShader : task.pShaders)
+		s_RetryShaderPaths.insert(pShader->pImpl->m_ShaderPath);
+}
+
+// 替换期间暂存的旧着色器，创建新着色器失败时放回
+class ShaderTableBackup
+{
+public:
+	void Take(size_t shaderID)
+	{
+		Move(s_ShaderSet, m_ShaderSet, shaderID);
+		Move(s_VertexShaders, m_VertexShaders, shaderID);
+		Move(s_HullShaders, m_HullShaders, shaderID);
+		Move(s_DomainShaders, m_DomainShaders, shaderID);
+		Move(s_GeometryShaders, m_GeometryShaders, shaderID);
+		Move(s_PixelShaders, m_PixelShaders, shaderID);
+		Move(s_ComputeShaders, m_ComputeShaders, shaderID);
+	}
+
+	// 调用前需要先移除同名的新着色器
+	void Restore()
+	{
+		s_ShaderSet.merge(m_ShaderSet);
+		s_VertexShaders.merge(m_VertexShaders);
+		s_HullShaders.merge(m_HullShaders);
+		s_DomainShaders.merge(m_DomainShaders);
+		s_GeometryShaders.merge(m_GeometryShaders);
+		s_PixelShaders.merge(m_PixelShaders);
+		s_ComputeShaders.merge(m_ComputeShaders);
+	}
+
+private:
+	template<class Container>
+	static void Move(Container& from, Container& to, size_t shaderID)
+	{
+		if (auto node = from.extract(shaderID))
+			to.insert(std::move(node));
+	}
+
+	std::unordered_set<size_t> m_ShaderSet;
+	std::unordered_map<size_t, VertexShaderInfo> m_VertexShaders;
+	std::unordered_map<size_t, HullShaderInfo> m_HullShaders;
+	std::unordered_map<size_t, DomainShaderInfo> m_DomainShaders;
+	std::unordered_map<size_t, GeometryShaderInfo> m_GeometryShaders;
+	std::unordered_map<size_t, PixelShaderInfo> m_PixelShaders;
+	std::unordered_map<size_t, ComputeShaderInfo> m_ComputeShaders;
+};
+
+// 所有入口点都编译并创建成功后一次性替换，否则保留旧的着色器，这一批在下次变化时重试
+static void FinishHotReload(HotReloadTask& task)
+{
+	std::string errors = CollectCompileErrors(*task.pJobs);
+	if (!errors.empty())
+	{
+		errors = "[Shader] Hot reload failed, keeping previous shaders:\n" + errors;
+		OutputDebugStringA(errors.c_str());
+		RetryHotReload(task);
+		return;
+	}
+
+	// 旧着色器先移出表，以便用同样的名称创建新着色器
+	ShaderTableBackup backup;
+	for (auto& job : *task.pJobs)
+		backup.Take(Shader::StringToID(job.name));
+	for (auto& job : *task.pJobs)
+	{
+		if (SUCCEEDED(Shader::Impl::AddFromBlob(job.name, s_pDevice.Get(), job.pBlob.Get(), &job.reflection)))
+			continue;
+
+		std::string error = "[Shader] Hot reload failed, keeping previous shaders:\n" + job.name + " (" + job.shaderModel +
+			"): failed to create shader\n";
+		OutputDebugStringA(error.c_str());
+		for (auto& createdJob : *task.pJobs)
+			Shader::Impl::RemoveShader(createdJob.name);
+		backup.Restore();
+		RetryHotReload(task);
+		return;
+	}
+	for (auto& job : *task.pJobs)
+		s_ArchiveSources.push_back({ job.key, job.nameHash, job.wCsoPrefix + UTF8ToUCS2(ShaderCompileKeyToString(job.key)) + L".cso" });
+
+	// Pass中保存着旧的着色器信息的地址，需要全部重建
+	for (Shader* pShader : task.pShaders)
+	{
+		auto& impl = *pShader->pImpl;
+		impl.RebuildPasses(impl.m_PassSources, impl.m_ShaderPath, "");
+		++impl.m_Version;
+		for (auto& variant : impl.m_Variants)
+		{
+			// 替换期间新请求的变体已经按新的源码编译
+			if (!variant.second.pShader)
+				continue;
+			auto& variantImpl = *variant.second.pShader->pImpl;
+			variantImpl.RebuildPasses(impl.m_PassSources, impl.m_ShaderPath, variant.second.nameSuffix);
+			++variantImpl.m_Version;
+		}
+	}
+
+#if defined(DEBUG) | defined(_DEBUG)
+	char buffer[256];
+	sprintf_s(buffer, "[Shader] Hot reload: %zu entry points replaced in %.3fs\n", task.pJobs->size(),
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - task.startTime).count());
+	OutputDebugStringA(buffer);
+#endif
+}
+
+void Shader::Impl::UpdateHotReload()
+{
+	if (!s_pFileWatcher)
+		return;
+
+	for (auto& path : s_pFileWatcher->PollChanges())
+	{
+		for (auto& it : s_ShaderMap)
+		{
+			auto& impl = *it.second->pImpl;
+			if (std::binary_search(impl.m_Dependencies.begin(), impl.m_Dependencies.end(), path))
+				s_DirtyShaderPaths.insert(impl.m_ShaderPath);
+		}
+	}
+
+	// 帧开始时没有录制中的命令，可以安全地替换着色器
+	if (s_pHotReloadTask)
+	{
+		if (s_pHotReloadTask->compiled.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+		FinishHotReload(*s_pHotReloadTask);
+		s_pHotReloadTask.reset();
+	}
+
+	if (!s_DirtyShaderPaths.empty())
+		s_pHotReloadTask = StartHotReload();
+}
+
+HRESULT Shader::Impl::AddFromBlob(std::string_view name, ID3D11Device* device, ID3DBlob* blob, const ShaderReflectionData* pReflection)
 {
 	if (name.empty())
 		return E_INVALIDARG;
 
-	size_t shaderID = StringToID(name);
+	size_t shaderID = RegisterPropertyName(name);
 	if (auto it = s_ShaderSet.find(shaderID); it != s_ShaderSet.end())
 		return S_OK;
 
 	HRESULT hr;
-	// 着色器反射
-	ComPtr<ID3D11ShaderReflection> pShaderReflection;
-	hr = D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), __uuidof(ID3D11ShaderReflection),
-		reinterpret_cast<void**>(pShaderReflection.GetAddressOf()));
-	if (FAILED(hr))
-		return hr;
+	// 没有缓存的反射数据时进行着色器反射
+	ShaderReflectionData reflection;
+	if (!pReflection)
+	{
+		hr = ReflectShader(blob->GetBufferPointer(), blob->GetBufferSize(), reflection);
+		if (FAILED(hr))
+			return hr;
+		pReflection = &reflection;
+	}
 
-	// 获取着色器类型
-	D3D11_SHADER_DESC sd;
-	pShaderReflection->GetDesc(&sd);
-	ShaderFlag shaderFlag = static_cast<ShaderFlag>(1 << D3D11_SHVER_GET_TYPE(sd.Version));
-	
 	// 创建着色器信息并建立反射
-	switch (shaderFlag)
+	hr = E_INVALIDARG;
+	switch (static_cast<ShaderFlag>(pReflection->shaderFlag))
 	{
 	case PixelShader:    CREATE_SHADER(PixelShader, PS, shaderID);
 	case VertexShader:   CREATE_SHADER(VertexShader, VS, shaderID);
@@ -633,11 +1397,12 @@ HRESULT Shader::Impl::AddFromBlob(std::string_view name, ID3D11Device* device, I
 		return hr;
 
 	// 建立着色器反射
-	hr = UpdateShaderReflection(name, device, pShaderReflection.Get(), shaderFlag);
+	UpdateShaderReflection(name, *pReflection);
 
 	// 创建输入布局
-	if (shaderFlag == ShaderFlag::VertexShader)
+	if (pReflection->shaderFlag == ShaderFlag::VertexShader)
 	{
+		s_VertexShaders[shaderID].pByteCode = blob;
 		hr = device->CreateInputLayout(s_VertexShaders[shaderID].signatureParams.data(), (uint32_t)s_VertexShaders[shaderID].signatureParams.size(),
 			blob->GetBufferPointer(), blob->GetBufferSize(), s_VertexShaders[shaderID].pDefaultInputLayout.GetAddressOf());
 	}
@@ -645,15 +1410,25 @@ HRESULT Shader::Impl::AddFromBlob(std::string_view name, ID3D11Device* device, I
 	return hr;
 }
 
-HRESULT Shader::Impl::UpdateShaderReflection(std::string_view name, ID3D11Device* device, ID3D11ShaderReflection* pShaderReflection, UINT shaderFlag)
+HRESULT Shader::Impl::ReflectShader(const void* pByteCode, size_t byteSize, ShaderReflectionData& reflection)
 {
-	size_t shaderID = StringToID(name);
+	ComPtr<ID3D11ShaderReflection> pShaderReflection;
+	HRESULT hr = D3DReflect(pByteCode, byteSize, __uuidof(ID3D11ShaderReflection),
+		reinterpret_cast<void**>(pShaderReflection.GetAddressOf()));
+	if (FAILED(hr))
+		return hr;
+
+	// 获取着色器类型
+	D3D11_SHADER_DESC sd;
+	hr = pShaderReflection->GetDesc(&sd);
+	if (FAILED(hr))
+		return hr;
+	reflection = ShaderReflectionData{};
+	reflection.shaderFlag = 1 << D3D11_SHVER_GET_TYPE(sd.Version);
 
-	HRESULT hr;
 	// 输入布局
-	if (shaderFlag == VertexShader)
+	if (reflection.shaderFlag == VertexShader)
 	{
-		LPCSTR lastSemanticName = nullptr;
 		for (UINT i = 0;; ++i)
 		{
 			D3D11_SIGNATURE_PARAMETER_DESC spDesc;
@@ -661,71 +1436,56 @@ HRESULT Shader::Impl::UpdateShaderReflection(std::string_view name, ID3D11Device
 			if (FAILED(hr))
 				break;
 
-			D3D11_INPUT_ELEMENT_DESC ieDesc{};
-			auto it = s_SemanticNames.find(spDesc.SemanticName);
-			if (it == s_SemanticNames.end())
-			{
-				auto p = s_SemanticNames.insert(spDesc.SemanticName);
-				it = p.first;
-			}
-			ieDesc.SemanticName = it->c_str();
-			ieDesc.SemanticIndex = 0;
-			ieDesc.InputSlot = 0;
-			ieDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-			auto& vs = s_VertexShaders[StringToID(name)];
-			if (i > 0 && vs.signatureParams[i - 1].SemanticName == ieDesc.SemanticName)
+			ShaderReflectionData::InputElement element;
+			element.semanticName = spDesc.SemanticName;
+			auto& signature = reflection.inputSignature;
+			if (i > 0 && signature[i - 1].semanticName == element.semanticName)
 			{
-				ieDesc.SemanticIndex = vs.signatureParams[i - 1].SemanticIndex + 1;
-				ieDesc.InputSlot = vs.signatureParams[i - 1].InputSlot;
+				element.semanticIndex = signature[i - 1].semanticIndex + 1;
+				element.inputSlot = signature[i - 1].inputSlot;
 			}
 			else if (i > 0)
 			{
-				ieDesc.InputSlot = vs.signatureParams[i - 1].InputSlot + 1;
+				element.inputSlot = signature[i - 1].inputSlot + 1;
 			}
 
+			DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
 			int compCount = (int)round(log2(spDesc.Mask + 1));
 			if (spDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
 			{
 				switch (compCount)
 				{
-				case 1: ieDesc.Format = DXGI_FORMAT_R32_FLOAT; break;
-				case 2: ieDesc.Format = DXGI_FORMAT_R32G32_FLOAT; break;
-				case 3: ieDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT; break;
-				case 4: ieDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT; break;
+				case 1: format = DXGI_FORMAT_R32_FLOAT; break;
+				case 2: format = DXGI_FORMAT_R32G32_FLOAT; break;
+				case 3: format = DXGI_FORMAT_R32G32B32_FLOAT; break;
+				case 4: format = DXGI_FORMAT_R32G32B32A32_FLOAT; break;
 				}
 			}
 			else if (spDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
 			{
 				switch (compCount)
 				{
-				case 1: ieDesc.Format = DXGI_FORMAT_R32_SINT; break;
-				case 2: ieDesc.Format = DXGI_FORMAT_R32G32_SINT; break;
-				case 3: ieDesc.Format = DXGI_FORMAT_R32G32B32_SINT; break;
-				case 4: ieDesc.Format = DXGI_FORMAT_R32G32B32A32_SINT; break;
+				case 1: format = DXGI_FORMAT_R32_SINT; break;
+				case 2: format = DXGI_FORMAT_R32G32_SINT; break;
+				case 3: format = DXGI_FORMAT_R32G32B32_SINT; break;
+				case 4: format = DXGI_FORMAT_R32G32B32A32_SINT; break;
 				}
 			}
 			else if (spDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
 			{
 				switch (compCount)
 				{
-				case 1: ieDesc.Format = DXGI_FORMAT_R32_UINT; break;
-				case 2: ieDesc.Format = DXGI_FORMAT_R32G32_UINT; break;
-				case 3: ieDesc.Format = DXGI_FORMAT_R32G32B32_UINT; break;
-				case 4: ieDesc.Format = DXGI_FORMAT_R32G32B32A32_UINT; break;
+				case 1: format = DXGI_FORMAT_R32_UINT; break;
+				case 2: format = DXGI_FORMAT_R32G32_UINT; break;
+				case 3: format = DXGI_FORMAT_R32G32B32_UINT; break;
+				case 4: format = DXGI_FORMAT_R32G32B32A32_UINT; break;
 				}
 			}
-			ieDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-			ieDesc.InstanceDataStepRate = 0;
-
-			vs.signatureParams.push_back(ieDesc);
+			element.format = format;
+			signature.push_back(std::move(element));
 		}
 	}
 
-	D3D11_SHADER_DESC sd;
-	hr = pShaderReflection->GetDesc(&sd);
-	if (FAILED(hr))
-		return hr;
-
 	for (UINT i = 0;; ++i)
 	{
 		D3D11_SHADER_INPUT_BIND_DESC sibDesc;
@@ -737,31 +1497,22 @@ HRESULT Shader::Impl::UpdateShaderReflection(std::string_view name, ID3D11Device
 		// 常量缓冲区
 		if (sibDesc.Type == D3D_SIT_CBUFFER)
 		{
+			// 全局变量组成的$Params不建立映射
+			static std::string_view params = "$Params";
+			if (params == sibDesc.Name)
+				continue;
+
 			ID3D11ShaderReflectionConstantBuffer* pSRCBuffer = pShaderReflection->GetConstantBufferByName(sibDesc.Name);
-			// 获取cbuffer内的变量信息并建立映射
+			// 获取cbuffer内的变量信息
 			D3D11_SHADER_BUFFER_DESC cbDesc{};
 			hr = pSRCBuffer->GetDesc(&cbDesc);
 			if (FAILED(hr))
 				return hr;
-			
 
-			// 确定常量缓冲区的创建位置
-			static std::string_view params = "$Params";
-			bool isParam = (params == sibDesc.Name);
-			if (!isParam)
-			{
-				switch (shaderFlag)
-				{
-				case VertexShader: s_VertexShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				case DomainShader: s_DomainShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				case HullShader: s_HullShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				case GeometryShader: s_GeometryShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				case PixelShader: s_PixelShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				case ComputeShader: s_ComputeShaders[shaderID].cBuffers.try_emplace(sibDesc.BindPoint, ConstantBufferInfo{ sibDesc.Name, sibDesc.BindPoint, cbDesc.Size }); break;
-				}
-			}
-
-			// 记录内部变量
+			auto& cbuffer = reflection.constantBuffers.emplace_back();
+			cbuffer.name = sibDesc.Name;
+			cbuffer.startSlot = sibDesc.BindPoint;
+			cbuffer.byteWidth = cbDesc.Size;
 			for (UINT j = 0; j < cbDesc.Variables; ++j)
 			{
 				ID3D11ShaderReflectionVariable* pSRVar = pSRCBuffer->GetVariableByIndex(j);
@@ -769,85 +1520,67 @@ HRESULT Shader::Impl::UpdateShaderReflection(std::string_view name, ID3D11Device
 				hr = pSRVar->GetDesc(&svDesc);
 				if (FAILED(hr))
 					return hr;
-
-				// 常量缓冲区的成员
-				if (!isParam)
-				{
-					std::unordered_map<size_t, Property>::iterator it;
-					bool emplaced;
-					switch (shaderFlag)
-					{
-					case VertexShader:   std::tie(it, emplaced) = s_VertexShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					case DomainShader:   std::tie(it, emplaced) = s_DomainShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					case HullShader:     std::tie(it, emplaced) = s_HullShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					case GeometryShader: std::tie(it, emplaced) = s_GeometryShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					case PixelShader:    std::tie(it, emplaced) = s_PixelShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					case ComputeShader:  std::tie(it, emplaced) = s_ComputeShaders[shaderID].cBuffers[sibDesc.BindPoint].properties.try_emplace(StringToID(svDesc.Name), Property{}); break;
-					}	
-					it->second.startByteOffset = svDesc.StartOffset;
-					it->second.byteWidth = svDesc.Size;
-				}
-				
+				cbuffer.variables.push_back({ svDesc.Name, svDesc.StartOffset, svDesc.Size });
 			}
 		}
 		// 着色器资源
 		else if (sibDesc.Type == D3D_SIT_TEXTURE || sibDesc.Type == D3D_SIT_STRUCTURED || sibDesc.Type == D3D_SIT_BYTEADDRESS ||
 			sibDesc.Type == D3D_SIT_TBUFFER)
 		{
-			std::unordered_map<size_t, ShaderResourceInfo>::iterator it;
-			bool emplaced;
-			switch (shaderFlag)
-			{
-			case VertexShader:   std::tie(it, emplaced) = s_VertexShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case DomainShader:   std::tie(it, emplaced) = s_DomainShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case HullShader:     std::tie(it, emplaced) = s_HullShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case GeometryShader: std::tie(it, emplaced) = s_GeometryShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case PixelShader:    std::tie(it, emplaced) = s_PixelShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case ComputeShader:  std::tie(it, emplaced) = s_ComputeShaders[shaderID].shaderResources.try_emplace(StringToID(sibDesc.Name)); break;
-			}
-
-			it->second.name = sibDesc.Name;
-			it->second.dim = sibDesc.Dimension;
-			it->second.startSlot = sibDesc.BindPoint;
+			reflection.shaderResources.push_back({ sibDesc.Name, sibDesc.BindPoint, (uint32_t)sibDesc.Dimension });
 		}
 		// 采样器
 		else if (sibDesc.Type == D3D_SIT_SAMPLER)
 		{
-			std::unordered_map<size_t, SamplerStateInfo>::iterator it;
-			bool emplaced;
-			switch (shaderFlag)
-			{
-			case VertexShader:   std::tie(it, emplaced) = s_VertexShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			case DomainShader:   std::tie(it, emplaced) = s_DomainShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			case HullShader:     std::tie(it, emplaced) = s_HullShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			case GeometryShader: std::tie(it, emplaced) = s_GeometryShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			case PixelShader:    std::tie(it, emplaced) = s_PixelShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			case ComputeShader:  std::tie(it, emplaced) = s_ComputeShaders[shaderID].samplers.try_emplace(StringToID(sibDesc.Name)); break;
-			}
-			it->second.name = sibDesc.Name;
-			it->second.startSlot = sibDesc.BindPoint;
+			reflection.samplers.push_back({ sibDesc.Name, sibDesc.BindPoint, 0 });
 		}
 		// 可读写资源
 		else if (sibDesc.Type == D3D_SIT_UAV_RWTYPED || sibDesc.Type == D3D_SIT_UAV_RWSTRUCTURED ||
 			sibDesc.Type == D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER || sibDesc.Type == D3D_SIT_UAV_APPEND_STRUCTURED ||
 			sibDesc.Type == D3D_SIT_UAV_CONSUME_STRUCTURED || sibDesc.Type == D3D_SIT_UAV_RWBYTEADDRESS)
 		{
-			std::unordered_map<size_t, RWResourceInfo>::iterator it;
-			bool emplaced;
-			switch (shaderFlag)
-			{
-			case PixelShader:    std::tie(it, emplaced) = s_PixelShaders[shaderID].rwResources.try_emplace(StringToID(sibDesc.Name)); break;
-			case ComputeShader:  std::tie(it, emplaced) = s_ComputeShaders[shaderID].rwResources.try_emplace(StringToID(sibDesc.Name)); break;
-			}
-			it->second.name = sibDesc.Name;
-			it->second.dim = static_cast<D3D11_UAV_DIMENSION>(sibDesc.Dimension);
-			it->second.startSlot = sibDesc.BindPoint;
+			reflection.rwResources.push_back({ sibDesc.Name, sibDesc.BindPoint, (uint32_t)sibDesc.Dimension });
 		}
 	}
 
 	return S_OK;
 }
 
+void Shader::Impl::UpdateShaderReflection(std::string_view name, const ShaderReflectionData& reflection)
+{
+	size_t shaderID = StringToID(name);
+
+	// 输入布局
+	if (reflection.shaderFlag == VertexShader)
+	{
+		auto& vs = s_VertexShaders[shaderID];
+		for (auto& element : reflection.inputSignature)
+		{
+			D3D11_INPUT_ELEMENT_DESC ieDesc{};
+			// 语义名的字符串需要在输入布局的整个生命周期内有效
+			ieDesc.SemanticName = s_SemanticNames.insert(element.semanticName).first->c_str();
+			ieDesc.SemanticIndex = element.semanticIndex;
+			ieDesc.Format = static_cast<DXGI_FORMAT>(element.format);
+			ieDesc.InputSlot = element.inputSlot;
+			ieDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			ieDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			ieDesc.InstanceDataStepRate = 0;
+			vs.signatureParams.push_back(ieDesc);
+		}
+		vs.signatureHash = InputLayoutCache::HashElements(vs.signatureParams.data(), (uint32_t)vs.signatureParams.size());
+	}
+
+	switch (reflection.shaderFlag)
+	{
+	case VertexShader:   ApplyReflection(s_VertexShaders[shaderID], reflection); break;
+	case DomainShader:   ApplyReflection(s_DomainShaders[shaderID], reflection); break;
+	case HullShader:     ApplyReflection(s_HullShaders[shaderID], reflection); break;
+	case GeometryShader: ApplyReflection(s_GeometryShaders[shaderID], reflection); break;
+	case PixelShader:    ApplyReflection(s_PixelShaders[shaderID], reflection); break;
+	case ComputeShader:  ApplyReflection(s_ComputeShaders[shaderID], reflection); break;
+	}
+}
+
 //
 // Shader
 //
@@ -868,9 +1601,10 @@ void Shader::Destroy()
 
 void Shader::InitFromJson(std::string_view jsonFile, std::string_view recordFile)
 {
+	auto startTime = std::chrono::steady_clock::now();
+
 	std::ifstream fin(jsonFile.data());
-	nlohmann::json json, jsonRecord;
-	bool noRecord = false;
+	nlohmann::json json, jsonRecord, jsonNewRecord = nlohmann::json::object();
 	if (!fin.is_open())
 		throw std::exception("Error: shader json file is not found!");
 	fin >> json;
@@ -880,23 +1614,28 @@ void Shader::InitFromJson(std::string_view jsonFile, std::string_view recordFile
 
 	if (!recordFile.empty())
 	{
+		// 记录每个入口点上一次使用的缓存键，用于删除过期的.cso
 		fin.open(recordFile.data());
 		if (!fin.is_open())
-		{
-			noRecord = true;
 			jsonRecord = nlohmann::json::object();
-		}
 		else
 		{
 			fin >> jsonRecord;
 			fin.close();
-			if (!json.is_object())
-				throw std::exception("Error: modified record json file must start with json object!");
+			if (!jsonRecord.is_object())
+				throw std::exception("Error: shader record json file must start with json object!");
 		}
 	}
 
-	size_t shaderCount = json.size();
-	// 读取所有Shader类
+	// 缓存键由主着色器文件及其传递包含的所有文件的内容决定，只有真正改变的入口点才会重新编译
+	ShaderDependencyGraph dependencyGraph(s_SystemIncludeDirs);
+	std::vector<Impl::CompileJob> jobs;
+	std::unordered_set<std::string> jobNames;
+	std::vector<Shader*> pShaders;
+
+	//
+	// 先解析所有Shader类，收集默认变体的编译任务
+	//
 	for (auto shaderIter = json.begin(); shaderIter != json.end(); ++shaderIter)
 	{
 		auto& shaderName = shaderIter.key();
@@ -911,52 +1650,64 @@ void Shader::InitFromJson(std::string_view jsonFile, std::string_view recordFile
 
 		std::unordered_map<size_t, std::unique_ptr<Shader, ShaderDestroyer>>::iterator iter;
 		bool emplaced;
-		std::tie(iter, emplaced) = s_ShaderMap.try_emplace(StringToID(shaderName));
+		std::tie(iter, emplaced) = s_ShaderMap.try_emplace(RegisterPropertyName(shaderName));
 		if (!emplaced)
 			throw std::exception("Error: Duplicate Shader object name!");
 		auto& pShader = iter->second = std::unique_ptr<Shader, ShaderDestroyer>(new Shader(shaderName));
+		pShaders.push_back(pShader.get());
+		auto& impl = *pShader->pImpl;
 		
-		std::wstring wShaderPath = UTF8ToUCS2(shaderPath);
-		std::wstring wShaderName = UTF8ToUCS2(shaderName);
-		bool isModified = noRecord;
-		if (!recordFile.empty())
+		impl.m_ShaderPath = shaderPath;
+		impl.m_SourceHash = dependencyGraph.GetSourceHash(shaderPath);
+		impl.m_Dependencies = dependencyGraph.GetDependencies(shaderPath);
+		if (s_pFileWatcher)
 		{
-			// 读取本地修改时间进行比对
-			HANDLE hFile = CreateFile(wShaderPath.c_str(), 0, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
-				FILE_ATTRIBUTE_NORMAL, nullptr);
-			if (hFile == INVALID_HANDLE_VALUE)
-			{
-				std::string str = "Loading HLSL file failed, error code: " + std::to_string(GetLastError());
-				throw std::exception(str.c_str());
-			}
-			FILETIME ft, lft;
-			SYSTEMTIME st;
-			GetFileTime(hFile, nullptr, nullptr, &ft);
-			FileTimeToLocalFileTime(&ft, &lft);
-			FileTimeToSystemTime(&lft, &st);
-
-			auto mod_it = jsonRecord.find(shaderPath);
-			if (mod_it == jsonRecord.end())
-			{
-				isModified = true;
-				jsonRecord[shaderPath] = SystemTimeToString(st);
-			}
-			else
+			for (auto& path : impl.m_Dependencies)
+				s_pFileWatcher->Watch(path);
+		}
+		// 发布时可以只提供归档而不提供源文件
+		if (!impl.m_SourceHash && !s_pArchive)
+		{
+			std::string str = "Error: HLSL file " + shaderPath + " is not found!";
+			throw std::exception(str.c_str());
+		}
+
+		impl.m_LocalPath = shaderPath;
+		if (size_t pos; (pos = impl.m_LocalPath.find_last_of('/')) != std::string::npos || (pos = impl.m_LocalPath.find_last_of('\\')) != std::string::npos)
+			impl.m_LocalPath.erase(pos + 1);
+		else
+			impl.m_LocalPath.clear();
+
+		// 读取关键字组，如 "Keywords": [["_", "SHADOWS_ON"], "NORMAL_MAP"]
+		if (auto keywordsIt = shaderObject.find("Keywords"); keywordsIt != shaderObject.end())
+		{
+			if (!keywordsIt->is_array())
+				throw std::exception("Error: Keywords object must be a json array!");
+			for (auto& keywordSet : *keywordsIt)
 			{
-				SYSTEMTIME prev = StringToSystemTime(mod_it->get<std::string>());
-				if (prev.wYear != st.wYear || prev.wMonth != st.wMonth || prev.wDay != st.wDay ||
-					prev.wHour != st.wHour || prev.wMinute != st.wMinute || prev.wSecond != st.wSecond)
+				std::vector<std::string> keywords;
+				if (keywordSet.is_string())
+					keywords.push_back(keywordSet.get<std::string>());
+				else if (keywordSet.is_array())
 				{
-					isModified = true;
-					jsonRecord[shaderPath] = SystemTimeToString(st);
+					for (auto& keyword : keywordSet)
+						keywords.push_back(keyword.get<std::string>());
 				}
+				if (keywords.empty() || keywords.size() > 255)
+					throw std::exception("Error: keyword set must be a keyword or a json array of 1 to 255 keywords!");
+				// 只有一个关键字时表示开与关两种情况
+				if (keywords.size() == 1)
+					keywords.insert(keywords.begin(), "_");
+
+				auto& ids = impl.m_KeywordIds.emplace_back();
+				for (auto& keyword : keywords)
+					ids.push_back(RegisterPropertyName(keyword));
+				impl.m_KeywordSets.push_back(std::move(keywords));
 			}
+			if (impl.m_KeywordSets.size() > 8)
+				throw std::exception("Error: a Shader object supports at most 8 keyword sets!");
 		}
 
-		std::map<std::string, std::map<std::string, ComPtr<ID3DBlob>>> shaderBlobs{
-			{"vs", {}}, {"ds", {}}, {"hs", {}}, {"gs", {}}, {"ps", {}}, {"cs", {}}
-		};
-
 		// 读取所有pass
 		for (auto passIter = passes.begin(); passIter != passes.end(); ++passIter)
 		{
@@ -964,120 +1715,308 @@ void Shader::InitFromJson(std::string_view jsonFile, std::string_view recordFile
 			if (!passObject.is_object())
 				throw std::exception("Error: pass object must be json object!");
 
-			Impl::PassDesc passDesc;
-			ComPtr<ID3D11RasterizerState> pRS;
-			ComPtr<ID3D11DepthStencilState> pDSS;
-			ComPtr<ID3D11BlendState> pBS;
-			ComPtr<ID3DBlob> pErrorMsg;
-			UINT stencilValue = 0;
-			bool hasBlendFactor = false;
-			float blendFactor[4]{};
-			UINT sampleMask = 0xFFFFFFFF;
+			Impl::PassSource& source = impl.m_PassSources.emplace_back();
 			// 读取所有shader、状态
 			for (auto it = passObject.begin(); it != passObject.end(); ++it)
 			{
 				auto& type = it.key();
 
-				std::string* strs = reinterpret_cast<std::string*>(&passDesc);
-				static std::map<std::string, int> offsets{
-					{"vs", 0}, {"ds", 1}, {"hs", 2}, {"gs", 3}, {"ps", 4}, {"cs", 5}, {"rs", -1}, {"dss", -2}, {"bs", -3}
+				std::string* strs = reinterpret_cast<std::string*>(&source.entryPoints);
+				static const std::map<std::string, int> offsets{
+					{"vs", 0}, {"hs", 1}, {"ds", 2}, {"gs", 3}, {"ps", 4}, {"cs", 5}, {"rs", -1}, {"dss", -2}, {"bs", -3}
 				};
+				auto offsetIt = offsets.find(type);
+				if (offsetIt == offsets.end())
+					throw std::exception("Error: unknown key in pass object!");
 
-				switch (offsets[type])
+				switch (offsetIt->second)
 				{
 				case -1:
-					ThrowIfFailed(CreateRasterizerStateFromJson(s_pDevice.Get(), it.value(), pRS.GetAddressOf()));
+					ThrowIfFailed(CreateRasterizerStateFromJson(s_pDevice.Get(), it.value(), source.pRS.GetAddressOf()));
 					break;
 				case -2:
-					ThrowIfFailed(CreateDepthStencilStateFromJson(s_pDevice.Get(), it.value(), pDSS.GetAddressOf()));
-					Parse(it.value(), "StencilValue", stencilValue);
+					ThrowIfFailed(CreateDepthStencilStateFromJson(s_pDevice.Get(), it.value(), source.pDSS.GetAddressOf()));
+					Parse(it.value(), "StencilValue", source.stencilValue);
 					break;
 				case -3:
-					ThrowIfFailed(CreateBlendStateFromJson(s_pDevice.Get(), it.value(), pBS.GetAddressOf()));
-					hasBlendFactor = Parse(it.value(), "BlendFactor", blendFactor);
-					Parse(it.value(), "SampleMask", sampleMask);
+					ThrowIfFailed(CreateBlendStateFromJson(s_pDevice.Get(), it.value(), source.pBS.GetAddressOf()));
+					source.hasBlendFactor = Parse(it.value(), "BlendFactor", source.blendFactor);
+					Parse(it.value(), "SampleMask", source.sampleMask);
 					break;
 				default:
-				{
-					bool emplaced;
-					std::map<std::string, ComPtr<ID3DBlob>>::iterator _iter;
-					auto entryPoint = it.value().get<std::string>();
-					std::tie(_iter, emplaced) = shaderBlobs[type].try_emplace(entryPoint);
-					if (emplaced)
-					{
-						std::wstring wCsoPath = wShaderName + L'/';
-						wCsoPath += UTF8ToUCS2(entryPoint);
-						std::string shaderModel = type + "_5_0";
-						wCsoPath += L".cso";
-
-						CreateDirectory(wShaderName.c_str(), nullptr);
-						std::string localPath = shaderPath;
-						if (size_t pos; (pos = localPath.find_last_of('/')) != std::string::npos || (pos = localPath.find_last_of('\\')) != std::string::npos)
-							localPath.erase(pos + 1);
-						else
-							localPath.clear();
-
-						//
-						// 读取 或 编译shader
-						// 
-						HRESULT hr = E_FAIL;
-						if (!isModified)
-						{
-							hr = D3DReadFileToBlob(wCsoPath.c_str(), _iter->second.GetAddressOf());
-						}
-						if (FAILED(hr))
-						{
-							XShaderInclude includeHandler({"../../Include", "../../../Include"}, localPath);
-
-							DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
-#ifdef _DEBUG
-							// 设置 D3DCOMPILE_DEBUG 标志用于获取着色器调试信息。该标志可以提升调试体验，
-							// 但仍然允许着色器进行优化操作
-							dwShaderFlags |= D3DCOMPILE_DEBUG;
+					strs[offsetIt->second] = it.value().get<std::string>();
+					break;
+				}
+			}
+		}
 
-							// 在Debug环境下禁用优化以避免出现一些不合理的情况
-							dwShaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-							hr = D3DCompileFromFile(wShaderPath.c_str(), nullptr, &includeHandler, entryPoint.c_str(), shaderModel.c_str(),
-								dwShaderFlags, 0, _iter->second.GetAddressOf(), pErrorMsg.GetAddressOf());
-							if (pErrorMsg)
-							{
-								OutputDebugStringA(reinterpret_cast<char*>(pErrorMsg->GetBufferPointer()));
-								throw std::exception(reinterpret_cast<char*>(pErrorMsg->GetBufferPointer()));
-							}
-								
-							ThrowIfFailed(hr);
-							ThrowIfFailed(D3DWriteBlobToFile(_iter->second.Get(), wCsoPath.c_str(), isModified));
-						}
-							
-						std::string name = shaderPath + "/" + entryPoint;
-						ThrowIfFailed(Impl::AddFromBlob(name, s_pDevice.Get(), _iter->second.Get()));
-						strs[offsets[type]] = name;
+		// 只有默认变体在启动时编译，其余变体在材质首次使用时编译
+		std::vector<std::string> defines;
+		impl.GetVariantKey({}, defines);
+		size_t firstJob = jobs.size();
+		impl.AppendCompileJobs(defines, "", jobs, jobNames);
 
+		if (!recordFile.empty())
+		{
+			for (size_t i = firstJob; i < jobs.size(); ++i)
+			{
+				auto& job = jobs[i];
+				if (job.cacheKey.empty())
+					continue;
+				std::string recordName = job.name + "." + job.shaderModel;
+				if (auto recordIt = jsonRecord.find(recordName); recordIt != jsonRecord.end() && recordIt->is_string())
+				{
+					auto prevKey = recordIt->get<std::string>();
+					if (prevKey != job.cacheKey)
+					{
+						DeleteFile((job.wCsoPrefix + UTF8ToUCS2(prevKey) + L".cso").c_str());
+						DeleteFile((job.wCsoPrefix + UTF8ToUCS2(prevKey) + L".refl").c_str());
 					}
-					break;
-				}
 				}
+				jsonNewRecord[recordName] = job.cacheKey;
 			}
-
-			auto& pass = pShader->pImpl->AddPass(passDesc);
-			pass.SetRasterizerState(pRS.Get());
-			pass.SetDepthStencilState(pDSS.Get(), stencilValue);
-			pass.SetBlendState(pBS.Get(), hasBlendFactor ? blendFactor : nullptr, sampleMask);
-			// TODO: Sampler State binding with texture
-			/*pass.SetSamplerState(X_SAMPLER_LINEAR_WARP, RenderStates::SSLinearWrap.Get());
-			pass.SetSamplerState(X_SAMPLER_ANISTROPIC_WRAP, RenderStates::SSAnistropicWrap.Get());
-			pass.SetSamplerState(X_SAMPLER_POINT_CLAMP, RenderStates::SSPointClamp.Get());
-			pass.SetSamplerState(X_SAMPLER_SHADOW, RenderStates::SSShadow.Get());*/
 		}
 	}
 
+	//
+	// 并行读取 或 编译shader
+	//
+	auto compileStartTime = std::chrono::steady_clock::now();
+	ThreadPool::Get().ParallelFor(jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			RunCompileJob(jobs[i]);
+	});
+	auto compileEndTime = std::chrono::steady_clock::now();
+
+	// 汇总所有任务的错误后再抛出，一次启动即可看到全部编译错误
+	std::string errors = CollectCompileErrors(jobs);
+	if (!errors.empty())
+	{
+		OutputDebugStringA(errors.c_str());
+		throw std::exception(errors.c_str());
+	}
+
+	//
+	// 按任务收集的顺序创建着色器与反射信息，结果与线程调度无关
+	//
+	CompileStatistics& statistics = s_CompileStatistics;
+	statistics = CompileStatistics{};
+	for (auto& job : jobs)
+	{
+		ThrowIfFailed(Impl::AddFromBlob(job.name, s_pDevice.Get(), job.pBlob.Get(), &job.reflection));
+		++(job.fromArchive ? statistics.archivedCount : job.fromCache ? statistics.cachedCount : statistics.compiledCount);
+		statistics.reflectedCount += job.reflected;
+		s_ArchiveSources.push_back({ job.key, job.nameHash, job.wCsoPrefix + UTF8ToUCS2(ShaderCompileKeyToString(job.key)) + L".cso" });
+	}
+
+	for (auto pShader : pShaders)
+		pShader->pImpl->BuildPasses(pShader->pImpl->m_PassSources, pShader->pImpl->m_ShaderPath, "");
+
 	if (!recordFile.empty())
 	{
 		std::ofstream fout(recordFile.data());
-		fout << jsonRecord;
+		fout << jsonNewRecord;
 		fout.close();
 	}
+
+	statistics.compileSeconds = std::chrono::duration<double>(compileEndTime - compileStartTime).count();
+	statistics.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+#if defined(DEBUG) | defined(_DEBUG)
+	char buffer[256];
+	sprintf_s(buffer, "[Shader] %s: %u entry points compiled, %u loaded from cache, %u loaded from archive, %u reflected, compile %.3fs, total %.3fs\n",
+		jsonFile.data(), statistics.compiledCount, statistics.cachedCount, statistics.archivedCount, statistics.reflectedCount, statistics.compileSeconds, statistics.totalSeconds);
+	OutputDebugStringA(buffer);
+#endif
+}
+
+bool Shader::LoadArchive(std::string_view archiveFile)
+{
+	auto pMapped = std::make_shared<MappedShaderArchive>();
+	pMapped->hFile = CreateFileW(UTF8ToUCS2(archiveFile).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize{};
+	if (pMapped->hFile != INVALID_HANDLE_VALUE && GetFileSizeEx(pMapped->hFile, &fileSize))
+		pMapped->hMapping = CreateFileMappingW(pMapped->hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (pMapped->hMapping)
+		pMapped->pView = MapViewOfFile(pMapped->hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!pMapped->pView || !pMapped->archive.Open(pMapped->pView, (size_t)fileSize.QuadPart))
+	{
+#if defined(DEBUG) | defined(_DEBUG)
+		char buffer[256];
+		sprintf_s(buffer, "[Shader] %s: shader archive is missing or invalid, using .cso files\n", archiveFile.data());
+		OutputDebugStringA(buffer);
+#endif
+		return false;
+	}
+
+	// 条目与字节码共享映射的生命周期
+	s_pArchive = std::shared_ptr<const ShaderArchive>(pMapped, &pMapped->archive);
+	return true;
+}
+
+void Shader::WriteArchive(std::string_view archiveFile)
+{
+	ShaderArchiveWriter writer;
+	for (auto& source : s_ArchiveSources)
+	{
+		if (writer.Contains(source.key))
+			continue;
+		// 从归档读取的入口点没有对应的.cso
+		if (const ShaderArchive::Entry* pEntry = s_pArchive ? s_pArchive->FindByKey(source.key) : nullptr)
+		{
+			writer.Add(pEntry->cacheKey, source.nameHash, s_pArchive->GetBlob(*pEntry), pEntry->blobSize,
+				s_pArchive->GetReflection(*pEntry), pEntry->reflectionSize);
+			continue;
+		}
+
+		ComPtr<ID3DBlob> pBlob;
+		ThrowIfFailed(D3DReadFileToBlob(source.wCsoPath.c_str(), pBlob.GetAddressOf()));
+		ShaderReflectionData reflection;
+		ThrowIfFailed(Impl::ReflectShader(pBlob->GetBufferPointer(), pBlob->GetBufferSize(), reflection));
+		std::vector<uint8_t> reflectionBytes;
+		SerializeShaderReflection(reflection, Hash::HashBytes(pBlob->GetBufferPointer(), pBlob->GetBufferSize()), reflectionBytes);
+		writer.Add(source.key, source.nameHash, pBlob->GetBufferPointer(), pBlob->GetBufferSize(),
+			reflectionBytes.data(), reflectionBytes.size());
+	}
+
+	std::vector<uint8_t> bytes;
+	writer.Build(bytes);
+	std::ofstream fout(archiveFile.data(), std::ios::out | std::ios::binary);
+	if (!fout.is_open())
+		throw std::exception("Error: failed to open shader archive file for writing!");
+	fout.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	fout.close();
+}
+
+void Shader::EnableHotReload(bool enable)
+{
+	if (!enable)
+	{
+		// 编译中的任务持有自身的数据，可以直接丢弃，重新开启后随下一次变化重新编译
+		if (s_pHotReloadTask)
+			RetryHotReload(*s_pHotReloadTask);
+		s_pHotReloadTask.reset();
+		s_DirtyShaderPaths.clear();
+		s_pFileWatcher.reset();
+		return;
+	}
+	if (s_pFileWatcher)
+		return;
+
+	s_pFileWatcher = std::make_unique<FileWatcher>();
+	for (auto& it : s_ShaderMap)
+	{
+		for (auto& path : it.second->pImpl->m_Dependencies)
+			s_pFileWatcher->Watch(path);
+	}
+}
+
+const Shader::CompileStatistics& Shader::GetCompileStatistics()
+{
+	return s_CompileStatistics;
+}
+
+const Shader::CBufferUploadStatistics& Shader::GetCBufferUploadStatistics()
+{
+	return s_CBufferUploadStatistics;
+}
+
+void Shader::EnableConstantRing(bool enable)
+{
+	s_ConstantRingEnabled = enable;
+}
+
+bool Shader::IsConstantRingEnabled()
+{
+	return s_ConstantRingEnabled;
+}
+
+void Shader::EnableCBufferDirtyRanges(bool enable)
+{
+	CBufferData::s_DirtyRangesEnabled = enable;
+}
+
+bool Shader::IsCBufferDirtyRangesEnabled()
+{
+	return CBufferData::s_DirtyRangesEnabled;
+}
+
+Shader* Shader::GetVariant(const std::vector<size_t>& keywordIds)
+{
+	auto& impl = *pImpl;
+	if (impl.m_KeywordSets.empty())
+		return this;
+
+	std::vector<std::string> defines;
+	uint64_t key = impl.GetVariantKey(keywordIds, defines);
+	if (key == 0)
+		return this;
+
+	auto& variant = impl.m_Variants[key];
+	if (variant.pShader)
+		return variant.pShader.get();
+	if (variant.failed)
+		return this;
+
+	std::string suffix = MakeVariantSuffix(defines);
+	if (!variant.pJobs)
+	{
+		// 首次请求，在后台读取或编译该变体的所有入口点
+		variant.pJobs = std::make_shared<std::vector<Impl::CompileJob>>();
+		std::unordered_set<std::string> jobNames;
+		impl.AppendCompileJobs(defines, suffix, *variant.pJobs, jobNames);
+		variant.compiled = SubmitCompileJobs(variant.pJobs);
+		variant.defines = defines;
+		variant.nameSuffix = suffix;
+		return this;
+	}
+	if (variant.compiled.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return this;
+
+	// 编译完成，着色器表与反射信息只在主线程修改
+	auto pJobs = std::move(variant.pJobs);
+	std::string errors = CollectCompileErrors(*pJobs);
+	for (auto& job : *pJobs)
+	{
+		if (!errors.empty())
+			break;
+		if (FAILED(Impl::AddFromBlob(job.name, s_pDevice.Get(), job.pBlob.Get(), &job.reflection)))
+			errors = job.name + " (" + job.shaderModel + "): failed to create shader\n";
+		else
+			s_ArchiveSources.push_back({ job.key, job.nameHash, job.wCsoPrefix + UTF8ToUCS2(ShaderCompileKeyToString(job.key)) + L".cso" });
+	}
+	if (!errors.empty())
+	{
+		// 变体编译失败时继续使用默认变体
+		OutputDebugStringA(errors.c_str());
+		variant.failed = true;
+		return this;
+	}
+
+	variant.pShader.reset(new Shader(impl.m_Name + suffix));
+	variant.pShader->pImpl->BuildPasses(impl.m_PassSources, impl.m_ShaderPath, suffix);
+	// 之前设置的全局属性与资源，之后的SetGlobal*由SetGlobalRaw转发
+	variant.pShader->pImpl->CopyGlobals(impl.m_Properties, impl.m_Passes);
+	return variant.pShader.get();
+}
+
+size_t Shader::RegisterPropertyName(std::string_view name)
+{
+	size_t id = StringToID(name);
+	auto [it, emplaced] = s_PropertyNames.try_emplace(id, name);
+	if (!emplaced && it->second != name)
+	{
+		std::string str = "Error: property id collision between \"" + it->second + "\" and \"" + std::string(name) + "\"!";
+		throw std::exception(str.c_str());
+	}
+	return id;
+}
+
+std::string_view Shader::GetPropertyName(size_t id)
+{
+	auto it = s_PropertyNames.find(id);
+	return it != s_PropertyNames.end() ? std::string_view(it->second) : std::string_view();
 }
 
 Shader* Shader::Find(std::string_view name)
@@ -0,0 +1,157 @@
+#include "ShaderArchive.h"
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// 范围[offset, offset + size)位于数据区[dataStart, fileSize)内
+	bool InRange(uint64_t offset, uint64_t size, uint64_t dataStart, uint64_t fileSize)
+	{
+		return offset >= dataStart && offset <= fileSize && size <= fileSize - offset;
+	}
+}
+
+bool ShaderArchive::Open(const void* pData, size_t byteSize)
+{
+	m_pData = nullptr;
+	m_pHeader = nullptr;
+	m_pEntries = nullptr;
+	m_pNameIndices = nullptr;
+
+	if (!pData || byteSize < sizeof(Header) || reinterpret_cast<uintptr_t>(pData) % alignof(Entry))
+		return false;
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	const Header* pHeader = reinterpret_cast<const Header*>(pBytes);
+	if (pHeader->magic != s_Magic || pHeader->version != s_Version || pHeader->fileSize != byteSize)
+		return false;
+
+	uint64_t tocSize = (uint64_t)pHeader->entryCount * (sizeof(Entry) + sizeof(uint32_t));
+	if (!InRange(sizeof(Header), tocSize, sizeof(Header), byteSize))
+		return false;
+	uint64_t dataStart = sizeof(Header) + tocSize;
+	const Entry* pEntries = reinterpret_cast<const Entry*>(pBytes + sizeof(Header));
+	const uint32_t* pNameIndices = reinterpret_cast<const uint32_t*>(pEntries + pHeader->entryCount);
+
+	// 打开时检查一次，之后的查找与读取不再检查
+	for (uint32_t i = 0; i < pHeader->entryCount; ++i)
+	{
+		const Entry& entry = pEntries[i];
+		if (i > 0 && pEntries[i - 1].cacheKey >= entry.cacheKey)
+			return false;
+		// 数据与头部或目录重叠说明文件已损坏
+		if (!InRange(entry.blobOffset, entry.blobSize, dataStart, byteSize) ||
+			!InRange(entry.reflectionOffset, entry.reflectionSize, dataStart, byteSize))
+			return false;
+		if (pNameIndices[i] >= pHeader->entryCount ||
+			(i > 0 && pEntries[pNameIndices[i - 1]].nameHash > pEntries[pNameIndices[i]].nameHash))
+			return false;
+	}
+
+	m_pData = pBytes;
+	m_pHeader = pHeader;
+	m_pEntries = pEntries;
+	m_pNameIndices = pNameIndices;
+	return true;
+}
+
+const ShaderArchive::Entry* ShaderArchive::FindByKey(uint64_t cacheKey) const
+{
+	const Entry* pEnd = m_pEntries + GetEntryCount();
+	const Entry* it = std::lower_bound(m_pEntries, pEnd, cacheKey,
+		[](const Entry& entry, uint64_t key) { return entry.cacheKey < key; });
+	return it != pEnd && it->cacheKey == cacheKey ? it : nullptr;
+}
+
+const ShaderArchive::Entry* ShaderArchive::FindByName(uint64_t nameHash) const
+{
+	const uint32_t* pEnd = m_pNameIndices + GetEntryCount();
+	const uint32_t* it = std::lower_bound(m_pNameIndices, pEnd, nameHash,
+		[this](uint32_t index, uint64_t hash) { return m_pEntries[index].nameHash < hash; });
+	return it != pEnd && m_pEntries[*it].nameHash == nameHash ? m_pEntries + *it : nullptr;
+}
+
+uint64_t ShaderArchive::HashEntryName(std::string_view name, std::string_view shaderModel)
+{
+	uint64_t hash = Hash::FNV1a64(name);
+	hash = Hash::FNV1a64(".", hash);
+	return Hash::FNV1a64(shaderModel, hash);
+}
+
+void ShaderArchiveWriter::Add(uint64_t cacheKey, uint64_t nameHash, const void* pBlob, size_t blobSize,
+	const void* pReflection, size_t reflectionSize)
+{
+	if (Contains(cacheKey))
+		return;
+	PendingEntry& entry = m_Entries.emplace_back();
+	entry.cacheKey = cacheKey;
+	entry.nameHash = nameHash;
+	entry.blob.assign(static_cast<const uint8_t*>(pBlob), static_cast<const uint8_t*>(pBlob) + blobSize);
+	entry.reflection.assign(static_cast<const uint8_t*>(pReflection), static_cast<const uint8_t*>(pReflection) + reflectionSize);
+}
+
+bool ShaderArchiveWriter::Contains(uint64_t cacheKey) const
+{
+	return std::any_of(m_Entries.begin(), m_Entries.end(),
+		[cacheKey](const PendingEntry& entry) { return entry.cacheKey == cacheKey; });
+}
+
+void ShaderArchiveWriter::Build(std::vector<uint8_t>& out) const
+{
+	uint32_t entryCount = (uint32_t)m_Entries.size();
+	std::vector<uint32_t> order(entryCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(),
+		[this](uint32_t lhs, uint32_t rhs) { return m_Entries[lhs].cacheKey < m_Entries[rhs].cacheKey; });
+
+	// 目录之后是数据区，每段数据都对齐，映射后字节码的地址满足对齐要求
+	uint64_t offset = AlignUp(sizeof(ShaderArchive::Header) +
+		(uint64_t)entryCount * (sizeof(ShaderArchive::Entry) + sizeof(uint32_t)), ShaderArchive::s_DataAlignment);
+	std::vector<ShaderArchive::Entry> entries(entryCount);
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		const PendingEntry& pending = m_Entries[order[i]];
+		ShaderArchive::Entry& entry = entries[i];
+		entry.cacheKey = pending.cacheKey;
+		entry.nameHash = pending.nameHash;
+		entry.blobHash = Hash::HashBytes(pending.blob.data(), pending.blob.size());
+		entry.blobSize = (uint32_t)pending.blob.size();
+		entry.blobOffset = offset;
+		offset = AlignUp(offset + entry.blobSize, ShaderArchive::s_DataAlignment);
+		entry.reflectionSize = (uint32_t)pending.reflection.size();
+		entry.reflectionOffset = offset;
+		offset = AlignUp(offset + entry.reflectionSize, ShaderArchive::s_DataAlignment);
+	}
+
+	std::vector<uint32_t> nameIndices(entryCount);
+	std::iota(nameIndices.begin(), nameIndices.end(), 0);
+	std::stable_sort(nameIndices.begin(), nameIndices.end(),
+		[&entries](uint32_t lhs, uint32_t rhs) { return entries[lhs].nameHash < entries[rhs].nameHash; });
+
+	ShaderArchive::Header header{};
+	header.magic = ShaderArchive::s_Magic;
+	header.version = ShaderArchive::s_Version;
+	header.entryCount = entryCount;
+	header.fileSize = offset;
+
+	out.assign((size_t)offset, 0);
+	uint8_t* pOut = out.data();
+	memcpy(pOut, &header, sizeof header);
+	if (entryCount == 0)
+		return;
+	memcpy(pOut + sizeof header, entries.data(), entries.size() * sizeof(ShaderArchive::Entry));
+	memcpy(pOut + sizeof header + entries.size() * sizeof(ShaderArchive::Entry), nameIndices.data(), nameIndices.size() * sizeof(uint32_t));
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		const PendingEntry& pending = m_Entries[order[i]];
+		memcpy(pOut + entries[i].blobOffset, pending.blob.data(), pending.blob.size());
+		if (!pending.reflection.empty())
+			memcpy(pOut + entries[i].reflectionOffset, pending.reflection.data(), pending.reflection.size());
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 着色器归档：一个文件包含所有入口点的字节码与序列化的反射数据，只依赖标准库
+// 文件布局：
+//   Header
+//   Entry[entryCount]          按cacheKey升序排列，二分查找
+//   uint32_t[entryCount]       按nameHash升序排列的条目下标，源文件不存在时按名称查找
+//   数据区                      字节码与反射数据，均按s_DataAlignment对齐
+// 所有偏移都相对于文件开头，运行时直接在映射的内存上读取，不做复制
+class ShaderArchive
+{
+public:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t fileSize;
+	};
+
+	struct Entry
+	{
+		uint64_t cacheKey;			// ComputeShaderCompileKey的结果
+		uint64_t nameHash;			// Hash::FNV1a64("ShaderFileName/EntryPoint.ShaderModel")
+		uint64_t blobHash;			// 字节码的Hash::HashBytes，与反射数据中记录的一致
+		uint64_t blobOffset;
+		uint64_t reflectionOffset;
+		uint32_t blobSize;
+		uint32_t reflectionSize;
+	};
+
+	static constexpr uint32_t s_Magic = 0x52415358;	// "XSAR"
+	// 文件格式的版本，布局改变时递增
+	static constexpr uint32_t s_Version = 1;
+	static constexpr uint32_t s_DataAlignment = 16;
+
+	// 校验头部、目录与所有条目的范围(必须位于目录之后的数据区)，数据必须在ShaderArchive的生命周期内有效
+	bool Open(const void* pData, size_t byteSize);
+	bool IsOpen() const { return m_pHeader != nullptr; }
+
+	const Entry* FindByKey(uint64_t cacheKey) const;
+	const Entry* FindByName(uint64_t nameHash) const;
+	const Entry* GetEntries() const { return m_pEntries; }
+	uint32_t GetEntryCount() const { return m_pHeader ? m_pHeader->entryCount : 0; }
+
+	const void* GetBlob(const Entry& entry) const { return m_pData + entry.blobOffset; }
+	const void* GetReflection(const Entry& entry) const { return m_pData + entry.reflectionOffset; }
+
+	static uint64_t HashEntryName(std::string_view name, std::string_view shaderModel);
+
+private:
+	const uint8_t* m_pData = nullptr;
+	const Header* m_pHeader = nullptr;
+	const Entry* m_pEntries = nullptr;
+	const uint32_t* m_pNameIndices = nullptr;
+};
+
+// 离线生成归档，相同cacheKey的条目只保留第一个
+class ShaderArchiveWriter
+{
+public:
+	void Add(uint64_t cacheKey, uint64_t nameHash, const void* pBlob, size_t blobSize,
+		const void* pReflection, size_t reflectionSize);
+	bool Contains(uint64_t cacheKey) const;
+	size_t GetEntryCount() const { return m_Entries.size(); }
+
+	void Build(std::vector<uint8_t>& out) const;
+
+private:
+	struct PendingEntry
+	{
+		uint64_t cacheKey;
+		uint64_t nameHash;
+		std::vector<uint8_t> blob;
+		std::vector<uint8_t> reflection;
+	};
+
+	std::vector<PendingEntry> m_Entries;
+};
@@ -0,0 +1,223 @@
+#include "ShaderCompileCache.h"
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+ShaderDependencyGraph::ShaderDependencyGraph(std::vector<std::string> systemDirs)
+	: m_SystemDirs(std::move(systemDirs))
+{
+}
+
+uint64_t ShaderDependencyGraph::GetSourceHash(std::string_view shaderPath)
+{
+	return Resolve(shaderPath).sourceHash;
+}
+
+const std::vector<std::string>& ShaderDependencyGraph::GetDependencies(std::string_view shaderPath)
+{
+	return Resolve(shaderPath).dependencies;
+}
+
+std::string ShaderDependencyGraph::NormalizePath(std::string_view path)
+{
+	std::vector<std::string_view> segments;
+	bool isAbsolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+	size_t pos = 0;
+	while (pos <= path.size())
+	{
+		size_t end = path.find_first_of("/\\", pos);
+		if (end == std::string_view::npos)
+			end = path.size();
+		std::string_view segment = path.substr(pos, end - pos);
+		if (segment == "..")
+		{
+			if (!segments.empty() && segments.back() != "..")
+				segments.pop_back();
+			else if (!isAbsolute)
+				segments.push_back(segment);
+		}
+		else if (!segment.empty() && segment != ".")
+			segments.push_back(segment);
+		pos = end + 1;
+	}
+
+	std::string result = isAbsolute ? "/" : "";
+	for (size_t i = 0; i < segments.size(); ++i)
+	{
+		if (i)
+			result.push_back('/');
+		result += segments[i];
+	}
+	return result;
+}
+
+void ShaderDependencyGraph::ScanIncludes(std::string_view source, std::vector<IncludeDirective>& includes)
+{
+	size_t i = 0, n = source.size();
+	bool lineStart = true;
+	auto SkipLine = [&]() {
+		while (i < n && source[i] != '\n')
+			++i;
+	};
+	auto SkipBlanks = [&]() {
+		while (i < n && (source[i] == ' ' || source[i] == '\t'))
+			++i;
+	};
+
+	while (i < n)
+	{
+		char c = source[i];
+		if (c == '\n')
+		{
+			lineStart = true;
+			++i;
+		}
+		else if (c == ' ' || c == '\t' || c == '\r')
+			++i;
+		else if (c == '/' && i + 1 < n && source[i + 1] == '/')
+			SkipLine();
+		else if (c == '/' && i + 1 < n && source[i + 1] == '*')
+		{
+			// 注释在预处理指令之前被替换为空格，不影响所在行是否可以作为指令
+			size_t end = source.find("*/", i + 2);
+			i = end == std::string_view::npos ? n : end + 2;
+		}
+		else if (c == '#' && lineStart)
+		{
+			++i;
+			SkipBlanks();
+			if (source.substr(i, 7) == "include")
+			{
+				i += 7;
+				SkipBlanks();
+				if (i < n && (source[i] == '"' || source[i] == '<'))
+				{
+					char close = source[i] == '"' ? '"' : '>';
+					size_t end = source.find_first_of(std::string{ close, '\n' }, i + 1);
+					if (end != std::string_view::npos && source[end] == close)
+						includes.push_back({ std::string(source.substr(i + 1, end - i - 1)), close == '>' });
+				}
+			}
+			SkipLine();
+		}
+		else
+		{
+			lineStart = false;
+			if (c == '"')
+			{
+				// 跳过字符串，避免其中的"//"被当作注释
+				++i;
+				while (i < n && source[i] != '"' && source[i] != '\n')
+					i += source[i] == '\\' ? 2 : 1;
+			}
+			++i;
+		}
+	}
+}
+
+const ShaderDependencyGraph::FileNode& ShaderDependencyGraph::LoadFile(const std::string& path)
+{
+	auto [it, emplaced] = m_Files.try_emplace(path);
+	FileNode& node = it->second;
+	if (!emplaced)
+		return node;
+
+	std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!fin.is_open())
+		return node;
+	std::string source((size_t)fin.tellg(), '\0');
+	fin.seekg(0, std::ios::beg);
+	fin.read(source.data(), source.size());
+	fin.close();
+
+	node.exists = true;
+	node.contentHash = Hash::HashBytes(source.data(), source.size());
+	ScanIncludes(source, node.includes);
+	return node;
+}
+
+const ShaderDependencyGraph::RootNode& ShaderDependencyGraph::Resolve(std::string_view shaderPath)
+{
+	std::string rootPath = NormalizePath(shaderPath);
+	auto [rootIt, emplaced] = m_Roots.try_emplace(rootPath);
+	RootNode& root = rootIt->second;
+	if (!emplaced)
+		return root;
+
+	// 与Shader::InitFromJson传给XShaderInclude的目录一致，包含文件中的相对路径同样相对于主着色器目录
+	std::string shaderDir;
+	if (size_t pos = std::string_view(shaderPath).find_last_of("/\\"); pos != std::string_view::npos)
+		shaderDir = shaderPath.substr(0, pos + 1);
+
+	std::unordered_set<std::string> visited{ rootPath };
+	std::vector<std::string> stack{ rootPath };
+	while (!stack.empty())
+	{
+		std::string path = std::move(stack.back());
+		stack.pop_back();
+		// 复制包含列表，下面的LoadFile会向m_Files中插入节点
+		std::vector<IncludeDirective> includes = LoadFile(path).includes;
+		for (auto& include : includes)
+		{
+			std::vector<std::string> candidates;
+			if (!include.isSystem)
+				candidates.push_back(shaderDir.empty() ? include.name : shaderDir + "/" + include.name);
+			else
+			{
+				for (auto& dir : m_SystemDirs)
+					candidates.push_back(shaderDir + dir + "/" + include.name);
+			}
+
+			// 在找到的文件之前查找失败的候选路径也是依赖
+			for (auto& candidate : candidates)
+			{
+				std::string normalized = NormalizePath(candidate);
+				bool exists = LoadFile(normalized).exists;
+				if (visited.insert(normalized).second && exists)
+					stack.push_back(normalized);
+				if (exists)
+					break;
+			}
+		}
+	}
+
+	root.dependencies.assign(visited.begin(), visited.end());
+	std::sort(root.dependencies.begin(), root.dependencies.end());
+	if (!m_Files[rootPath].exists)
+		return root;
+
+	uint64_t hash = Hash::s_FNVOffsetBasis;
+	for (auto& path : root.dependencies)
+	{
+		const FileNode& node = m_Files[path];
+		hash = Hash::Combine(hash, Hash::FNV1a64(path));
+		hash = Hash::Combine(hash, node.exists ? node.contentHash : 0);
+	}
+	// 0保留给主着色器文件不存在的情况
+	root.sourceHash = hash ? hash : 1;
+	return root;
+}
+
+uint64_t ComputeShaderCompileKey(uint64_t sourceHash, std::string_view entryPoint, std::string_view shaderModel,
+	const std::vector<std::string>& defines, uint32_t compileFlags, uint32_t compilerVersion)
+{
+	uint64_t hash = Hash::Combine(Hash::s_FNVOffsetBasis, sourceHash);
+	hash = Hash::Combine(hash, Hash::FNV1a64(entryPoint));
+	hash = Hash::Combine(hash, Hash::FNV1a64(shaderModel));
+	hash = Hash::Combine(hash, defines.size());
+	for (auto& define : defines)
+		hash = Hash::Combine(hash, Hash::FNV1a64(define));
+	hash = Hash::Combine(hash, compileFlags);
+	hash = Hash::Combine(hash, compilerVersion);
+	return hash;
+}
+
+std::string ShaderCompileKeyToString(uint64_t key)
+{
+	static const char s_Digits[] = "0123456789abcdef";
+	std::string str(16, '0');
+	for (int i = 15; i >= 0; --i, key >>= 4)
+		str[i] = s_Digits[key & 0xF];
+	return str;
+}
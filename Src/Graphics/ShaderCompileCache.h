@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 着色器源文件的包含关系与编译缓存的键，只依赖标准库
+// 包含文件的查找规则与XShaderInclude一致：
+// #include "x" 在主着色器文件所在的目录下查找，#include <x> 依次在 主着色器目录 + systemDir 下查找
+class ShaderDependencyGraph
+{
+public:
+	struct IncludeDirective
+	{
+		std::string name;
+		bool isSystem;		// <x>形式
+	};
+
+	explicit ShaderDependencyGraph(std::vector<std::string> systemDirs);
+
+	// 主着色器文件及其传递包含的所有文件的路径与内容的哈希，主着色器文件不存在时返回0
+	uint64_t GetSourceHash(std::string_view shaderPath);
+	// 主着色器文件传递包含的所有文件(包括自身)，按路径排序
+	// 查找过但不存在的候选路径也会记录，之后创建该文件同样会改变哈希
+	const std::vector<std::string>& GetDependencies(std::string_view shaderPath);
+
+	// 统一使用'/'，消去"."、".."和重复的分隔符，开头无法消去的".."保留
+	static std::string NormalizePath(std::string_view path);
+	// 提取源码中的#include指令，跳过注释。不处理条件编译，被排除的包含也会记为依赖
+	static void ScanIncludes(std::string_view source, std::vector<IncludeDirective>& includes);
+
+private:
+	struct FileNode
+	{
+		bool exists = false;
+		uint64_t contentHash = 0;
+		std::vector<IncludeDirective> includes;
+	};
+
+	struct RootNode
+	{
+		uint64_t sourceHash = 0;
+		std::vector<std::string> dependencies;
+	};
+
+	const FileNode& LoadFile(const std::string& path);
+	const RootNode& Resolve(std::string_view shaderPath);
+
+	std::vector<std::string> m_SystemDirs;
+	// 文件只读取一次，被多个着色器包含的公共文件共享
+	std::unordered_map<std::string, FileNode> m_Files;
+	std::unordered_map<std::string, RootNode> m_Roots;
+};
+
+// 编译缓存的键：源码哈希、入口点、着色器模型、宏、编译标志与编译器版本，任一不同都需要重新编译
+uint64_t ComputeShaderCompileKey(uint64_t sourceHash, std::string_view entryPoint, std::string_view shaderModel,
+	const std::vector<std::string>& defines, uint32_t compileFlags, uint32_t compilerVersion);
+
+// 16位十六进制字符串，用于.cso文件名
+std::string ShaderCompileKeyToString(uint64_t key);
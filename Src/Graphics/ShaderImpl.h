@@ -1,7 +1,11 @@
+#pragma once
+
 #include <Graphics/Shader.h>
 #include <Graphics/RenderStates.h>
 #include <wrl/client.h>
 #include <memory>
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <d3d11_1.h>
 #include <d3dcompiler.h>
@@ -9,8 +13,12 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <future>
 #include <fstream>
 #include <json.hpp>
+#include "FrameConstantBuffer.h"
+#include "ShaderReflectionData.h"
+#include "ShaderArchive.h"
 
 
 //
@@ -73,19 +81,99 @@ struct CBufferBase
 };
 
 
+// 常量缓冲区的更新频率，按名称前缀约定识别：
+//   PerFrame                 每帧一次(时间、光照等)
+//   PerCamera/PerView        每个摄像机一次
+//   PerMaterial              材质属性改变时
+//   PerDraw/PerObject        每次绘制，未识别的名称也归入此组
+enum class CBufferFrequency : uint32_t
+{
+	PerFrame,
+	PerCamera,
+	PerMaterial,
+	PerObject,
+	Count
+};
+
+inline CBufferFrequency GetCBufferFrequency(std::string_view name)
+{
+	auto startsWith = [name](std::string_view prefix) { return name.substr(0, prefix.size()) == prefix; };
+	if (startsWith("PerFrame"))
+		return CBufferFrequency::PerFrame;
+	if (startsWith("PerCamera") || startsWith("PerView"))
+		return CBufferFrequency::PerCamera;
+	if (startsWith("PerMaterial"))
+		return CBufferFrequency::PerMaterial;
+	return CBufferFrequency::PerObject;
+}
+
 // 内部使用的常量缓冲区数据
 struct CBufferData : CBufferBase
 {
 	std::vector<uint8_t> data;
 	std::string cbufferName;
 	uint32_t startSlot;
+	CBufferFrequency frequency = CBufferFrequency::PerObject;
+
+	// 自上次上传以来被修改的字节区间[dirtyBegin, dirtyEnd)，多次修改时取并集
+	uint32_t dirtyBegin = 0;
+	uint32_t dirtyEnd = 0;
+
+	// 上次在帧常量缓冲区中的分配，分配者或代数不一致(已换到下一个命令列表)时说明已失效
+	FrameConstantBuffer* pRingOwner = nullptr;
+	uint64_t ringGeneration = 0;
+	FrameConstantBuffer::Binding ringBinding;
+
+	// 设备能力，由Shader::Impl::InitAll查询
+	inline static bool s_PartialUpdateSupported = false;
+	inline static bool s_DriverCommandLists = false;
+	// 关闭时任何修改都标记整个缓冲区，由Shader::EnableCBufferDirtyRanges设置
+	inline static bool s_DirtyRangesEnabled = true;
+	// 本帧各更新频率上传的字节数与各上传方式的调用次数，工作线程录制时同样会累加
+	inline static std::atomic<uint64_t> s_UploadBytes[(size_t)CBufferFrequency::Count]{};
+	inline static std::atomic<uint64_t> s_DiscardMapCount = 0;
+	inline static std::atomic<uint64_t> s_UpdateSubresourceCount = 0;
 
 	CBufferData() : CBufferBase(), startSlot() {}
 	CBufferData(std::string_view name, uint32_t startSlot, uint32_t byteWidth, void* initData = nullptr) :
-		CBufferBase(), cbufferName(name), data(byteWidth), startSlot(startSlot)
+		CBufferBase(), cbufferName(name), data(byteWidth), startSlot(startSlot), frequency(GetCBufferFrequency(name))
 	{
 		if (initData)
 			memcpy_s(data.data(), byteWidth, initData, byteWidth);
+		// 新建的缓冲区没有初始数据，首次使用时完整上传
+		MarkAllDirty();
+	}
+
+	// 每物体的常量缓冲区几乎每次绘制都会改变，仍整体写入动态缓冲区或帧常量缓冲区
+	// 其余频率较低的使用DEFAULT缓冲区，只上传变化的区间，未改变时跨帧保留而不必重新上传
+	bool UsesPartialUpdate() const
+	{
+		return s_PartialUpdateSupported && frequency != CBufferFrequency::PerObject;
+	}
+
+	void MarkDirty(uint32_t byteOffset, uint32_t byteCount)
+	{
+		if (!s_DirtyRangesEnabled)
+		{
+			byteOffset = 0;
+			byteCount = (uint32_t)data.size();
+		}
+		if (!isDirty)
+		{
+			dirtyBegin = byteOffset;
+			dirtyEnd = byteOffset + byteCount;
+			isDirty = TRUE;
+		}
+		else
+		{
+			dirtyBegin = (std::min)(dirtyBegin, byteOffset);
+			dirtyEnd = (std::max)(dirtyEnd, byteOffset + byteCount);
+		}
+	}
+
+	void MarkAllDirty()
+	{
+		MarkDirty(0, (uint32_t)data.size());
 	}
 
 	HRESULT CreateBuffer(ID3D11Device* device) override
@@ -94,23 +182,80 @@ struct CBufferData : CBufferBase
 			return S_OK;
 		D3D11_BUFFER_DESC cbd;
 		ZeroMemory(&cbd, sizeof(cbd));
-		cbd.Usage = D3D11_USAGE_DYNAMIC;
+		cbd.Usage = UsesPartialUpdate() ? D3D11_USAGE_DEFAULT : D3D11_USAGE_DYNAMIC;
 		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		cbd.CPUAccessFlags = UsesPartialUpdate() ? 0 : D3D11_CPU_ACCESS_WRITE;
 		cbd.ByteWidth = (uint32_t)data.size();
 		return device->CreateBuffer(&cbd, nullptr, cBuffer.GetAddressOf());
 	}
 
 	void UpdateBuffer(ID3D11DeviceContext* deviceContext) override
 	{
-		if (isDirty)
+		// 上次的数据写入了帧常量缓冲区时，自身的缓冲区中的数据已过期
+		if (!isDirty && !pRingOwner)
+			return;
+		// 写入帧常量缓冲区时已清除脏标记，自身的缓冲区缺少那之后的所有修改
+		if (pRingOwner)
+		{
+			dirtyBegin = 0;
+			dirtyEnd = (uint32_t)data.size();
+		}
+		isDirty = false;
+		pRingOwner = nullptr;
+		if (!UsesPartialUpdate())
 		{
-			isDirty = false;
 			D3D11_MAPPED_SUBRESOURCE mappedData;
 			deviceContext->Map(cBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData);
 			memcpy_s(mappedData.pData, data.size(), data.data(), data.size());
 			deviceContext->Unmap(cBuffer.Get(), 0);
+			s_UploadBytes[(size_t)frequency].fetch_add(data.size(), std::memory_order_relaxed);
+			s_DiscardMapCount.fetch_add(1, std::memory_order_relaxed);
+			return;
 		}
+
+		// 常量缓冲区的部分更新以16字节为单位
+		uint32_t begin = dirtyBegin & ~15u;
+		uint32_t end = (std::min)((dirtyEnd + 15u) & ~15u, (uint32_t)data.size());
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext1> deviceContext1;
+		if (FAILED(deviceContext->QueryInterface(IID_PPV_ARGS(deviceContext1.GetAddressOf()))))
+		{
+			deviceContext->UpdateSubresource(cBuffer.Get(), 0, nullptr, data.data(), 0, 0);
+			s_UploadBytes[(size_t)frequency].fetch_add(data.size(), std::memory_order_relaxed);
+			s_UpdateSubresourceCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		D3D11_BOX box = { begin, 0, 0, end, 1, 1 };
+		const uint8_t* pSrcData = data.data() + begin;
+		// 驱动不支持命令列表时，运行时在延迟上下文中会再次按box的偏移读取源数据，需要预先减去
+		if (deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED && !s_DriverCommandLists)
+			pSrcData -= begin;
+		deviceContext1->UpdateSubresource1(cBuffer.Get(), 0, &box, pSrcData, 0, 0, 0);
+		s_UploadBytes[(size_t)frequency].fetch_add(end - begin, std::memory_order_relaxed);
+		s_UpdateSubresourceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// 当前命令列表中已在pFrameCBuffer中分配过
+	bool HasRingBinding(const FrameConstantBuffer* pFrameCBuffer) const
+	{
+		return pRingOwner == pFrameCBuffer && ringGeneration == pFrameCBuffer->GetGeneration();
+	}
+
+	// 数据变化或当前命令列表尚未在pFrameCBuffer中分配时重新分配，返回用于偏移绑定的信息
+	const FrameConstantBuffer::Binding& UpdateRingBuffer(FrameConstantBuffer* pFrameCBuffer)
+	{
+		if (isDirty || !HasRingBinding(pFrameCBuffer))
+		{
+			ringBinding = pFrameCBuffer->Upload(data.data(), (uint32_t)data.size());
+			pRingOwner = pFrameCBuffer;
+			ringGeneration = pFrameCBuffer->GetGeneration();
+			// 分配失败时保留脏标记，交由普通的动态缓冲区更新
+			if (ringBinding.pBuffer)
+			{
+				isDirty = false;
+				s_UploadBytes[(size_t)frequency].fetch_add(data.size(), std::memory_order_relaxed);
+			}
+		}
+		return ringBinding;
 	}
 
 	void BindVS(ID3D11DeviceContext* deviceContext) override
@@ -144,6 +289,28 @@ struct CBufferData : CBufferBase
 	}
 };
 
+// 绘制时替换某个槽位上的常量缓冲区(如材质预先烘焙好的缓冲区)
+struct CBufferOverride
+{
+	uint32_t startSlot = 0;
+	ID3D11Buffer* pBuffer = nullptr;
+};
+
+// 上下文中最近一次由ShaderPass设置的渲染状态，相同的状态不再重复设置
+// 状态对象经由RenderStateCache去重，描述相同即指针相同。上下文的状态被清除后需要调用Invalidate
+struct RenderStateBindings
+{
+	bool isValid = false;
+	ID3D11RasterizerState* pRasterizerState = nullptr;
+	ID3D11BlendState* pBlendState = nullptr;
+	std::array<float, 4> blendFactor = {};
+	UINT sampleMask = 0xFFFFFFFF;
+	ID3D11DepthStencilState* pDepthStencilState = nullptr;
+	UINT stencilRef = 0;
+
+	void Invalidate() { isValid = false; }
+};
+
 struct Property
 {
 	uint32_t startByteOffset = 0;
@@ -174,7 +341,11 @@ struct VertexShaderInfo
 	std::unordered_map<PropertyID, SamplerStateInfo> samplers;
 
 	std::vector<D3D11_INPUT_ELEMENT_DESC> signatureParams;
+	// InputLayoutCache::HashElements(signatureParams)，签名相同的顶点着色器共享网格的输入布局
+	uint64_t signatureHash = 0;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> pDefaultInputLayout;
+	// 保留字节码，用于为压缩/交错的顶点格式创建输入布局
+	Microsoft::WRL::ComPtr<ID3DBlob> pByteCode;
 };
 
 struct DomainShaderInfo
@@ -256,6 +427,19 @@ struct ShaderPass
 	const std::vector<D3D11_INPUT_ELEMENT_DESC>& GetInputSignatures();
 	ID3D11InputLayout* GetInputLayout();
 	void Apply(ID3D11DeviceContext* deviceContext);
+	// 使用外部提供的常量缓冲区数据(如工作线程的副本)代替着色器自身的数据
+	// pFrameCBuffer不为空时，常量数据从帧常量缓冲区中分配并以偏移方式绑定
+	// pOverrides中出现的槽位直接绑定给定的缓冲区，不再上传对应的CBufferData
+	// pBoundStates不为空时，与其记录的渲染状态相同则跳过设置，并更新为本Pass的状态
+	// pPreparedCBuffers不为空时直接绑定PrepareCBuffers的结果，不再上传
+	void Apply(ID3D11DeviceContext* deviceContext, std::map<uint32_t, CBufferData>& cBufferDatas, FrameConstantBuffer* pFrameCBuffer = nullptr,
+		const CBufferOverride* pOverrides = nullptr, uint32_t numOverrides = 0, RenderStateBindings* pBoundStates = nullptr,
+		const FrameConstantBuffer::Binding* pPreparedCBuffers = nullptr);
+	// 批量录制的第一步：按cBufferDatas的顺序为每个常量缓冲区确定绑定并追加到bindings，numConstants为0表示绑定整个缓冲区
+	// 数据在批量中可能随绘制变化，被修改的部分更新缓冲区同样写入帧常量缓冲区；
+	// 未修改的绑定自身的缓冲区，其更新在此时录制，位于本批所有绘制之前
+	void PrepareCBuffers(ID3D11DeviceContext* deviceContext, std::map<uint32_t, CBufferData>& cBufferDatas, FrameConstantBuffer* pFrameCBuffer,
+		const CBufferOverride* pOverrides, uint32_t numOverrides, std::vector<FrameConstantBuffer::Binding>& bindings);
 
 	// 渲染状态
 	Microsoft::WRL::ComPtr<ID3D11BlendState> pBlendState = nullptr;
@@ -301,15 +485,90 @@ public:
 		std::string csName;
 	};
 
+	// JSON中一个Pass的描述，默认变体与关键字变体都由它创建
+	struct PassSource
+	{
+		PassDesc entryPoints;	// 各阶段的入口点名
+		Microsoft::WRL::ComPtr<ID3D11RasterizerState> pRS;
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilState> pDSS;
+		Microsoft::WRL::ComPtr<ID3D11BlendState> pBS;
+		UINT stencilValue = 0;
+		bool hasBlendFactor = false;
+		float blendFactor[4]{};
+		UINT sampleMask = 0xFFFFFFFF;
+	};
+
+	// 一个入口点的读取或编译任务，在线程池中执行，只写入自身的结果
+	struct CompileJob
+	{
+		std::string name;			// ShaderFileName/EntryPoint，变体带有关键字后缀
+		std::string shaderPath;
+		std::string localPath;
+		std::string entryPoint;
+		std::string shaderModel;
+		std::vector<std::string> defines;
+		std::string cacheKey;		// 主着色器文件不存在时为空，只能从归档中按名称读取
+		uint64_t key = 0;
+		uint64_t nameHash = 0;		// ShaderArchive::HashEntryName
+		std::wstring wCsoPrefix;
+		std::shared_ptr<const ShaderArchive> pArchive;
+		Microsoft::WRL::ComPtr<ID3DBlob> pBlob;
+		std::string errorMsg;
+		bool fromCache = false;
+		bool fromArchive = false;
+		ShaderReflectionData reflection;
+		bool reflected = false;		// 反射数据由D3DReflect生成而不是从文件读取
+	};
+
+	struct VariantDeleter
+	{
+		void operator()(Shader* pShader) const { pShader->Destroy(); }
+	};
+
+	struct Variant
+	{
+		std::unique_ptr<Shader, VariantDeleter> pShader;
+		// 编译中的任务，完成后在主线程创建着色器
+		std::shared_ptr<std::vector<CompileJob>> pJobs;
+		std::future<void> compiled;
+		bool failed = false;
+		// 热重载时按相同的宏重新编译
+		std::vector<std::string> defines;
+		std::string nameSuffix;
+	};
+
 	static bool InitAll(ID3D11Device* pDevice);
 	static bool Exists(std::string_view name);
+	// 开启热重载后在每帧开始时调用：检查源文件的变化，后台编译受影响的入口点，编译完成后替换着色器
+	static void UpdateHotReload();
+	// 在帧末调用：记录本帧各更新频率的常量缓冲区上传字节数与上传次数并清零计数
+	static void EndFrameStatistics();
 
 	// name: ShaderFileName/EntryPoint
-	static HRESULT AddFromBlob(std::string_view name, ID3D11Device* device, ID3DBlob* blob);
-	static HRESULT UpdateShaderReflection(std::string_view name, ID3D11Device* device, ID3D11ShaderReflection* pShaderReflection, UINT shaderFlag);
-
+	// pReflection为空时对字节码进行反射
+	static HRESULT AddFromBlob(std::string_view name, ID3D11Device* device, ID3DBlob* blob, const ShaderReflectionData* pReflection = nullptr);
+	// 只读取字节码，不修改全局的着色器表，可在工作线程调用
+	static HRESULT ReflectShader(const void* pByteCode, size_t byteSize, ShaderReflectionData& reflection);
+	static void UpdateShaderReflection(std::string_view name, const ShaderReflectionData& reflection);
+	// 从着色器表中移除，引用它的Pass需要随后重建
+	static void RemoveShader(std::string_view name);
+
+	// 同时写入已创建的关键字变体
 	void SetGlobalRaw(size_t propertyID, const void* data, uint32_t byteOffset = 0, uint32_t byteCount = 0xFFFFFFFF);
+	// 写入到指定的常量缓冲区集合，该集合需与m_CBuffers的槽位布局一致
+	void SetRaw(std::map<uint32_t, CBufferData>& cBufferDatas, size_t propertyID, const void* data, uint32_t byteOffset = 0, uint32_t byteCount = 0xFFFFFFFF);
 	ShaderPass& AddPass(const PassDesc& desc);
+	// 按sources创建所有Pass，着色器名为 shaderPath/EntryPoint + nameSuffix
+	void BuildPasses(const std::vector<PassSource>& sources, std::string_view shaderPath, std::string_view nameSuffix);
+	// 复制ID与大小相同的属性的值，以及各Pass中绑定的着色器资源与采样器
+	void CopyGlobals(const std::unordered_map<size_t, Property>& properties, const std::vector<ShaderPass>& passes);
+	// 热重载后重建所有Pass，保留名称与大小不变的全局属性的值以及绑定的资源
+	void RebuildPasses(const std::vector<PassSource>& sources, std::string_view shaderPath, std::string_view nameSuffix);
+	// 每组关键字选出启用的一个(都未启用时为第一个)，返回变体的键与需要定义的宏。默认变体的键为0
+	uint64_t GetVariantKey(const std::vector<size_t>& keywordIds, std::vector<std::string>& defines) const;
+	// 为变体的所有入口点生成编译任务，jobNames中已有的入口点不再重复生成
+	void AppendCompileJobs(const std::vector<std::string>& defines, std::string_view nameSuffix,
+		std::vector<CompileJob>& jobs, std::unordered_set<std::string>& jobNames) const;
 
 	std::string m_Name;
 
@@ -317,4 +576,19 @@ public:
 
 	std::unordered_map<size_t, Property> m_Properties;
 	std::map<uint32_t, CBufferData> m_CBuffers;
+
+	// 创建关键字变体所需的信息，只有InitFromJson创建的着色器才有
+	std::string m_ShaderPath;
+	std::string m_LocalPath;
+	uint64_t m_SourceHash = 0;
+	// 主着色器文件及其传递包含的所有文件，热重载时据此判断哪些着色器受影响
+	std::vector<std::string> m_Dependencies;
+	std::vector<PassSource> m_PassSources;
+	// 每组关键字中至多启用一个，第一个为默认值，"_"表示不定义宏
+	std::vector<std::vector<std::string>> m_KeywordSets;
+	std::vector<std::vector<size_t>> m_KeywordIds;
+	std::unordered_map<uint64_t, Variant> m_Variants;
+
+	// 热重载的次数，材质据此判断烘焙的常量缓冲区是否失效
+	uint32_t m_Version = 0;
 };
\ No newline at end of file
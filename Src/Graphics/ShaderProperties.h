@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// 着色器属性值的写入与复制，只依赖标准库
+// PropertyMap: 属性ID -> { startByteOffset, byteWidth, pCBufferData }
+// CBuffer需要提供字节数组data与MarkDirty(byteOffset, byteCount)
+namespace ShaderProperties
+{
+	// 写入属性的[byteOffset, byteOffset + byteCount)，超出属性的部分被截断，仅当值不同时标记为脏
+	template<class Prop>
+	void WriteRaw(const Prop& prop, const void* data, uint32_t byteOffset, uint32_t byteCount)
+	{
+		if (byteOffset > prop.byteWidth)
+			return;
+		if (byteCount > prop.byteWidth - byteOffset)
+			byteCount = prop.byteWidth - byteOffset;
+
+		auto& cbuffer = *prop.pCBufferData;
+		uint8_t* pDest = cbuffer.data.data() + prop.startByteOffset + byteOffset;
+		if (memcmp(pDest, data, byteCount))
+		{
+			memcpy(pDest, data, byteCount);
+			cbuffer.MarkDirty(prop.startByteOffset + byteOffset, byteCount);
+		}
+	}
+
+	// 把src中的属性值复制到dst中ID与大小都相同的属性，两者的常量缓冲区布局可以不同
+	// 热重载重建Pass与新建关键字变体时使用
+	template<class PropertyMap>
+	void CopyValues(const PropertyMap& src, PropertyMap& dst)
+	{
+		for (auto& [propertyID, prop] : dst)
+		{
+			auto it = src.find(propertyID);
+			if (it == src.end() || it->second.byteWidth != prop.byteWidth)
+				continue;
+			WriteRaw(prop, it->second.pCBufferData->data.data() + it->second.startByteOffset, 0, prop.byteWidth);
+		}
+	}
+
+	// 按属性ID复制绑定的资源，BindingMap: 属性ID -> { 槽位, 资源 }，槽位保持dst自身的值
+	template<class BindingMap>
+	void CopyBindings(const BindingMap& src, BindingMap& dst)
+	{
+		for (auto& [propertyID, binding] : dst)
+		{
+			if (auto it = src.find(propertyID); it != src.end())
+				binding.second = it->second.second;
+		}
+	}
+}
@@ -0,0 +1,186 @@
+#include "ShaderReflectionData.h"
+#include <cstring>
+
+namespace
+{
+	// "XSRF"
+	constexpr uint32_t s_Magic = 0x46525358;
+
+	class Writer
+	{
+	public:
+		Writer(std::vector<uint8_t>& out) : m_Out(out) {}
+
+		void U32(uint32_t value) { Raw(&value, sizeof value); }
+		void U64(uint64_t value) { Raw(&value, sizeof value); }
+		void String(const std::string& str)
+		{
+			U32((uint32_t)str.size());
+			Raw(str.data(), str.size());
+		}
+		void Raw(const void* data, size_t byteSize)
+		{
+			const uint8_t* pBytes = static_cast<const uint8_t*>(data);
+			m_Out.insert(m_Out.end(), pBytes, pBytes + byteSize);
+		}
+
+	private:
+		std::vector<uint8_t>& m_Out;
+	};
+
+	// 所有读取都检查边界，失败后后续读取也失败
+	class Reader
+	{
+	public:
+		Reader(const void* pData, size_t byteSize) : m_pData(static_cast<const uint8_t*>(pData)), m_ByteSize(byteSize) {}
+
+		bool U32(uint32_t& value) { return Raw(&value, sizeof value); }
+		bool U64(uint64_t& value) { return Raw(&value, sizeof value); }
+		bool String(std::string& str)
+		{
+			uint32_t length;
+			if (!U32(length) || length > m_ByteSize - m_Offset)
+				return Fail();
+			str.assign(reinterpret_cast<const char*>(m_pData + m_Offset), length);
+			m_Offset += length;
+			return true;
+		}
+		// 数组长度，元素至少占minElementSize字节，防止损坏的长度导致过量分配
+		bool Count(uint32_t& count, size_t minElementSize)
+		{
+			if (!U32(count) || (size_t)count * minElementSize > m_ByteSize - m_Offset)
+				return Fail();
+			return true;
+		}
+		bool Raw(void* data, size_t byteSize)
+		{
+			if (m_Failed || byteSize > m_ByteSize - m_Offset)
+				return Fail();
+			memcpy(data, m_pData + m_Offset, byteSize);
+			m_Offset += byteSize;
+			return true;
+		}
+		bool AtEnd() const { return !m_Failed && m_Offset == m_ByteSize; }
+
+	private:
+		bool Fail()
+		{
+			m_Failed = true;
+			return false;
+		}
+
+		const uint8_t* m_pData;
+		size_t m_ByteSize;
+		size_t m_Offset = 0;
+		bool m_Failed = false;
+	};
+
+	void WriteResources(Writer& writer, const std::vector<ShaderReflectionData::Resource>& resources)
+	{
+		writer.U32((uint32_t)resources.size());
+		for (auto& resource : resources)
+		{
+			writer.String(resource.name);
+			writer.U32(resource.startSlot);
+			writer.U32(resource.dimension);
+		}
+	}
+
+	bool ReadResources(Reader& reader, std::vector<ShaderReflectionData::Resource>& resources)
+	{
+		uint32_t count;
+		if (!reader.Count(count, 12))
+			return false;
+		resources.resize(count);
+		for (auto& resource : resources)
+		{
+			if (!reader.String(resource.name) || !reader.U32(resource.startSlot) || !reader.U32(resource.dimension))
+				return false;
+		}
+		return true;
+	}
+}
+
+void SerializeShaderReflection(const ShaderReflectionData& data, uint64_t blobHash, std::vector<uint8_t>& out)
+{
+	out.clear();
+	Writer writer(out);
+	writer.U32(s_Magic);
+	writer.U32(s_ShaderReflectionVersion);
+	writer.U64(blobHash);
+	writer.U32(data.shaderFlag);
+
+	writer.U32((uint32_t)data.constantBuffers.size());
+	for (auto& cbuffer : data.constantBuffers)
+	{
+		writer.String(cbuffer.name);
+		writer.U32(cbuffer.startSlot);
+		writer.U32(cbuffer.byteWidth);
+		writer.U32((uint32_t)cbuffer.variables.size());
+		for (auto& variable : cbuffer.variables)
+		{
+			writer.String(variable.name);
+			writer.U32(variable.startByteOffset);
+			writer.U32(variable.byteWidth);
+		}
+	}
+
+	WriteResources(writer, data.shaderResources);
+	WriteResources(writer, data.samplers);
+	WriteResources(writer, data.rwResources);
+
+	writer.U32((uint32_t)data.inputSignature.size());
+	for (auto& element : data.inputSignature)
+	{
+		writer.String(element.semanticName);
+		writer.U32(element.semanticIndex);
+		writer.U32(element.format);
+		writer.U32(element.inputSlot);
+	}
+}
+
+bool DeserializeShaderReflection(const void* pData, size_t byteSize, uint64_t blobHash, ShaderReflectionData& data)
+{
+	Reader reader(pData, byteSize);
+	uint32_t magic, version;
+	uint64_t hash;
+	if (!reader.U32(magic) || magic != s_Magic || !reader.U32(version) || version != s_ShaderReflectionVersion ||
+		!reader.U64(hash) || hash != blobHash)
+		return false;
+
+	data = ShaderReflectionData{};
+	if (!reader.U32(data.shaderFlag))
+		return false;
+
+	uint32_t count;
+	if (!reader.Count(count, 16))
+		return false;
+	data.constantBuffers.resize(count);
+	for (auto& cbuffer : data.constantBuffers)
+	{
+		if (!reader.String(cbuffer.name) || !reader.U32(cbuffer.startSlot) || !reader.U32(cbuffer.byteWidth) ||
+			!reader.Count(count, 12))
+			return false;
+		cbuffer.variables.resize(count);
+		for (auto& variable : cbuffer.variables)
+		{
+			if (!reader.String(variable.name) || !reader.U32(variable.startByteOffset) || !reader.U32(variable.byteWidth))
+				return false;
+		}
+	}
+
+	if (!ReadResources(reader, data.shaderResources) || !ReadResources(reader, data.samplers) ||
+		!ReadResources(reader, data.rwResources))
+		return false;
+
+	if (!reader.Count(count, 16))
+		return false;
+	data.inputSignature.resize(count);
+	for (auto& element : data.inputSignature)
+	{
+		if (!reader.String(element.semanticName) || !reader.U32(element.semanticIndex) || !reader.U32(element.format) ||
+			!reader.U32(element.inputSlot))
+			return false;
+	}
+	return reader.AtEnd();
+}
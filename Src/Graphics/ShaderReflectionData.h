@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 着色器反射的结果，只依赖标准库，可以序列化为.cso旁的二进制文件，启动时跳过D3DReflect
+// 只保存名称，属性id在加载时由名称重新计算
+struct ShaderReflectionData
+{
+	struct Variable
+	{
+		std::string name;
+		uint32_t startByteOffset = 0;
+		uint32_t byteWidth = 0;
+	};
+
+	struct ConstantBuffer
+	{
+		std::string name;
+		uint32_t startSlot = 0;
+		uint32_t byteWidth = 0;
+		std::vector<Variable> variables;
+	};
+
+	// 着色器资源、采样器与可读写资源，dimension为D3D11_SRV_DIMENSION或D3D11_UAV_DIMENSION，采样器为0
+	struct Resource
+	{
+		std::string name;
+		uint32_t startSlot = 0;
+		uint32_t dimension = 0;
+	};
+
+	// 顶点着色器的输入签名，format为DXGI_FORMAT
+	struct InputElement
+	{
+		std::string semanticName;
+		uint32_t semanticIndex = 0;
+		uint32_t format = 0;
+		uint32_t inputSlot = 0;
+	};
+
+	uint32_t shaderFlag = 0;	// ShaderFlag
+	std::vector<ConstantBuffer> constantBuffers;
+	std::vector<Resource> shaderResources;
+	std::vector<Resource> samplers;
+	std::vector<Resource> rwResources;
+	std::vector<InputElement> inputSignature;
+};
+
+// 文件格式的版本，ShaderReflectionData或序列化方式改变时递增
+constexpr uint32_t s_ShaderReflectionVersion = 1;
+
+// 序列化反射数据。blobHash为对应字节码的哈希，读取时用于判断文件是否与.cso匹配
+void SerializeShaderReflection(const ShaderReflectionData& data, uint64_t blobHash, std::vector<uint8_t>& out);
+// 反序列化，格式、版本、blobHash不匹配或数据截断时返回false
+bool DeserializeShaderReflection(const void* pData, size_t byteSize, uint64_t blobHash, ShaderReflectionData& data);
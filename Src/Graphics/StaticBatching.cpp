@@ -0,0 +1,187 @@
+#include <Graphics/StaticBatching.h>
+#include <Graphics/ResourceManager.h>
+#include <Graphics/Shader.h>
+#include <unordered_map>
+
+using namespace XMath;
+
+namespace
+{
+	struct BatchSource
+	{
+		MeshRenderer* pMeshRenderer;
+		MeshData* pMeshData;
+		Matrix4x4 localToWorld;
+	};
+
+	// 只有顶点属性完全一致的网格才能合并到同一个顶点缓冲区
+	uint32_t GetAttributeMask(const MeshData* pMeshData)
+	{
+		return (pMeshData->normals.empty() ? 0 : 1) |
+			(pMeshData->tangents.empty() ? 0 : 2) |
+			(pMeshData->colors.empty() ? 0 : 4) |
+			(pMeshData->texcoords.empty() ? 0 : 8);
+	}
+
+	uint32_t GetIndexCount(const MeshData* pMeshData)
+	{
+		return pMeshData->indexSize ? (uint32_t)(pMeshData->indices.size() / pMeshData->indexSize) : 0;
+	}
+
+	uint32_t ReadIndex(const MeshData* pMeshData, size_t pos)
+	{
+		if (pMeshData->indexSize == sizeof(uint16_t))
+			return reinterpret_cast<const uint16_t*>(pMeshData->indices.data())[pos];
+		return reinterpret_cast<const uint32_t*>(pMeshData->indices.data())[pos];
+	}
+
+	// 将网格变换到世界空间后追加到合并网格，返回其子网格
+	SubMeshDescriptor AppendSource(MeshData& batch, const BatchSource& source)
+	{
+		const MeshData& mesh = *source.pMeshData;
+		Matrix3x3 linear = source.localToWorld.topLeftCorner<3, 3>();
+		Vector3 translation = source.localToWorld.topRightCorner<3, 1>();
+		Matrix3x3 normalMatrix = linear.inverse().transpose();
+		// 负缩放会翻转三角形的环绕方向，需要交换索引以保持正面朝向
+		bool flipWinding = linear.determinant() < 0.0f;
+
+		uint32_t baseVertex = (uint32_t)batch.vertices.size();
+		SubMeshDescriptor subMesh;
+		subMesh.indexStart = (uint32_t)(batch.indices.size() / sizeof(uint16_t));
+
+		for (size_t i = 0; i < mesh.vertices.size(); ++i)
+		{
+			Vector3 pos = linear * mesh.vertices[i] + translation;
+			if (i == 0)
+				subMesh.vMin = subMesh.vMax = pos;
+			subMesh.vMin = subMesh.vMin.cwiseMin(pos);
+			subMesh.vMax = subMesh.vMax.cwiseMax(pos);
+			batch.vertices.push_back(pos);
+		}
+		for (auto& normal : mesh.normals)
+			batch.normals.push_back((normalMatrix * normal).normalized());
+		for (auto& tangent : mesh.tangents)
+		{
+			Vector3 t = (linear * tangent.head<3>()).normalized();
+			batch.tangents.push_back(Vector4(t.x(), t.y(), t.z(), flipWinding ? -tangent.w() : tangent.w()));
+		}
+		batch.colors.insert(batch.colors.end(), mesh.colors.begin(), mesh.colors.end());
+		batch.texcoords.insert(batch.texcoords.end(), mesh.texcoords.begin(), mesh.texcoords.end());
+
+		uint32_t indexCount = GetIndexCount(&mesh) / 3 * 3;
+		size_t oldSize = batch.indices.size();
+		batch.indices.resize(oldSize + indexCount * sizeof(uint16_t));
+		uint16_t* pDest = reinterpret_cast<uint16_t*>(batch.indices.data() + oldSize);
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			uint32_t i0 = ReadIndex(&mesh, i);
+			uint32_t i1 = ReadIndex(&mesh, i + 1);
+			uint32_t i2 = ReadIndex(&mesh, i + 2);
+			if (flipWinding)
+				std::swap(i1, i2);
+			pDest[i] = (uint16_t)(baseVertex + i0);
+			pDest[i + 1] = (uint16_t)(baseVertex + i1);
+			pDest[i + 2] = (uint16_t)(baseVertex + i2);
+		}
+		subMesh.indexCount = indexCount;
+		return subMesh;
+	}
+}
+
+size_t StaticBatching::Combine(Scene* pScene)
+{
+	Clear(pScene);
+
+	// 按(材质, 顶点属性)分组，保持物体的遍历顺序
+	struct Group
+	{
+		Material* pMaterial;
+		uint32_t attributeMask;
+		std::vector<BatchSource> sources;
+	};
+	std::vector<Group> groups;
+	std::unordered_map<Material*, std::vector<size_t>> groupIndices;
+
+	for (GameObject* pObject : pScene->GetGameObjects())
+	{
+		if (!pObject->IsStatic())
+			continue;
+		MeshRenderer* pMeshRenderer = pObject->FindComponent<MeshRenderer>();
+		MeshFilter* pMeshFilter = pObject->FindComponent<MeshFilter>();
+		if (!pMeshRenderer || !pMeshFilter)
+			continue;
+		// 属性块是逐物体的，无法合并
+		if (!pMeshRenderer->m_pMaterialPropertyBlocks.empty() && pMeshRenderer->m_pMaterialPropertyBlocks[0])
+			continue;
+		Material* pMaterial = pMeshRenderer->GetMaterial();
+		if (!pMaterial || !pMaterial->GetShader())
+			continue;
+
+		MeshData* pMeshData = pMeshFilter->GetMesh();
+		if (pMeshData == nullptr)
+			pMeshData = pMeshFilter->GetSharedMesh();
+		if (!pMeshData || pMeshData->vertices.empty() || GetIndexCount(pMeshData) < 3 ||
+			pMeshData->vertices.size() > s_MaxVerticesPerBatch)
+			continue;
+
+		uint32_t attributeMask = GetAttributeMask(pMeshData);
+		auto& indices = groupIndices[pMaterial];
+		size_t groupIndex = groups.size();
+		for (size_t idx : indices)
+		{
+			if (groups[idx].attributeMask == attributeMask)
+			{
+				groupIndex = idx;
+				break;
+			}
+		}
+		if (groupIndex == groups.size())
+		{
+			groups.push_back({ pMaterial, attributeMask, {} });
+			indices.push_back(groupIndex);
+		}
+		groups[groupIndex].sources.push_back({ pMeshRenderer, pMeshData, pObject->GetTransform()->GetLocalToWorldMatrix() });
+	}
+
+	for (auto& group : groups)
+	{
+		// 只有一个物体时合并没有收益
+		if (group.sources.size() < 2)
+			continue;
+
+		MeshData* pBatch = nullptr;
+		for (auto& source : group.sources)
+		{
+			if (!pBatch || pBatch->vertices.size() + source.pMeshData->vertices.size() > s_MaxVerticesPerBatch)
+			{
+				pScene->m_pStaticBatchMeshes.push_back(std::make_unique<MeshData>());
+				pBatch = pScene->m_pStaticBatchMeshes.back().get();
+				pBatch->indexSize = sizeof(uint16_t);
+			}
+			pBatch->subMeshes.push_back(AppendSource(*pBatch, source));
+			source.pMeshRenderer->m_pStaticBatchMesh = pBatch;
+			source.pMeshRenderer->m_StaticBatchSubMesh = (uint32_t)pBatch->subMeshes.size() - 1;
+		}
+	}
+
+	for (auto& pBatch : pScene->m_pStaticBatchMeshes)
+	{
+		pBatch->UpdateBoundingData();
+		pBatch->UploadMeshData();
+	}
+
+	return pScene->m_pStaticBatchMeshes.size();
+}
+
+void StaticBatching::Clear(Scene* pScene)
+{
+	for (Component* pComponent : pScene->GetComponents(MeshRenderer::GetType()))
+	{
+		MeshRenderer* pMeshRenderer = static_cast<MeshRenderer*>(pComponent);
+		pMeshRenderer->m_pStaticBatchMesh = nullptr;
+		pMeshRenderer->m_StaticBatchSubMesh = 0;
+	}
+	for (auto& pBatch : pScene->m_pStaticBatchMeshes)
+		ResourceManager::Get().DestroyMeshGraphicsResources(pBatch.get());
+	pScene->m_pStaticBatchMeshes.clear();
+}
@@ -0,0 +1,286 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define VERTEX_PACKING_SSE2 1
+#include <emmintrin.h>
+#else
+#define VERTEX_PACKING_SSE2 0
+#endif
+
+namespace
+{
+	constexpr uint32_t s_F16MaxAsF32 = (127 + 16) << 23;			// 不小于该值的float转换为无穷
+	constexpr uint32_t s_MinNormalAsF32 = (127 - 14) << 23;			// 能转换为规格化half的最小float
+	constexpr uint32_t s_SubnormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+	constexpr uint32_t s_NormalBias = 0xfff - ((127 - 15) << 23);	// 调整指数并加上尾数舍入
+
+	float SnormToFloat(int16_t value)
+	{
+		return (std::max)(value / 32767.0f, -1.0f);
+	}
+
+	int16_t FloatToSnorm16(float value)
+	{
+		return (int16_t)lrintf((std::min)((std::max)(value, -1.0f), 1.0f) * 32767.0f);
+	}
+
+	void EncodeOctahedral(float x, float y, float z, float& outX, float& outY)
+	{
+		float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+		float inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+		x *= inv;
+		y *= inv;
+		if (z < 0.0f)
+		{
+			float wrapX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float wrapY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = wrapX;
+			y = wrapY;
+		}
+		outX = x;
+		outY = y;
+	}
+
+#if VERTEX_PACKING_SSE2
+	// 4个float同时转换为half，结果位于每个32位元素的低16位
+	// 符号位扩展到高16位，使得_mm_packs_epi32不会发生饱和
+	__m128i FloatToHalfSSE2(__m128 f)
+	{
+		const __m128i maskSign = _mm_set1_epi32((int)0x80000000u);
+		const __m128i f16Max = _mm_set1_epi32((int)s_F16MaxAsF32);
+		const __m128i nanBit = _mm_set1_epi32(0x200);
+		const __m128i infinity = _mm_set1_epi32(0x7c00);
+		const __m128i minNormal = _mm_set1_epi32((int)s_MinNormalAsF32);
+		const __m128i subnormMagic = _mm_set1_epi32((int)s_SubnormMagic);
+		const __m128i normalBias = _mm_set1_epi32((int)s_NormalBias);
+
+		__m128 justSign = _mm_and_ps(_mm_castsi128_ps(maskSign), f);
+		__m128 absF = _mm_xor_ps(f, justSign);
+		__m128i absFInt = _mm_castps_si128(absF);
+		__m128 isNaN = _mm_cmpunord_ps(absF, absF);
+		__m128i isRegular = _mm_cmpgt_epi32(f16Max, absFInt);
+		__m128i infOrNaN = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNaN), nanBit), infinity);
+
+		// 结果为非规格化数
+		__m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absFInt);
+		__m128 subnormal1 = _mm_add_ps(absF, _mm_castsi128_ps(subnormMagic));
+		__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormal1), subnormMagic);
+
+		// 结果为规格化数，尾数最低位为奇数时向上舍入
+		__m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absFInt, 31 - 13), 31);
+		__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absFInt, normalBias), mantOdd), 13);
+
+		__m128i nonSpecial = _mm_or_si128(_mm_and_si128(subnormal, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+		__m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, infOrNaN));
+		return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+	}
+
+	__m128i FloatToSnorm16SSE2(__m128 f)
+	{
+		f = _mm_min_ps(_mm_max_ps(f, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+		return _mm_cvtps_epi32(_mm_mul_ps(f, _mm_set1_ps(32767.0f)));
+	}
+#endif
+}
+
+namespace VertexPacking
+{
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t f;
+		memcpy(&f, &value, sizeof f);
+		uint32_t sign = f & 0x80000000u;
+		f ^= sign;
+
+		uint32_t result;
+		if (f >= s_F16MaxAsF32)
+		{
+			result = f > 0x7f800000u ? 0x7e00 : 0x7c00;
+		}
+		else if (f < s_MinNormalAsF32)
+		{
+			float absF, magic;
+			memcpy(&absF, &f, sizeof f);
+			memcpy(&magic, &s_SubnormMagic, sizeof magic);
+			absF += magic;
+			memcpy(&f, &absF, sizeof f);
+			result = f - s_SubnormMagic;
+		}
+		else
+		{
+			uint32_t mantOdd = (f >> 13) & 1;
+			result = (f + s_NormalBias + mantOdd) >> 13;
+		}
+		return (uint16_t)(result | (sign >> 16));
+	}
+
+	float HalfToFloat(uint16_t value)
+	{
+		uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+		uint32_t exponent = (value >> 10) & 0x1f;
+		uint32_t mantissa = value & 0x3ff;
+		uint32_t f;
+		if (exponent == 0x1f)
+		{
+			f = sign | 0x7f800000u | (mantissa << 13);
+		}
+		else if (exponent == 0)
+		{
+			float result = mantissa * (1.0f / (1 << 24));
+			return sign ? -result : result;
+		}
+		else
+		{
+			f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+		float result;
+		memcpy(&result, &f, sizeof f);
+		return result;
+	}
+
+	void FloatToHalf(const float* pSrc, uint16_t* pDest, size_t count)
+	{
+		size_t i = 0;
+#if VERTEX_PACKING_SSE2
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i lo = FloatToHalfSSE2(_mm_loadu_ps(pSrc + i));
+			__m128i hi = FloatToHalfSSE2(_mm_loadu_ps(pSrc + i + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), _mm_packs_epi32(lo, hi));
+		}
+#endif
+		for (; i < count; ++i)
+			pDest[i] = FloatToHalf(pSrc[i]);
+	}
+
+	void FloatToSnorm16(const float* pSrc, int16_t* pDest, size_t count)
+	{
+		size_t i = 0;
+#if VERTEX_PACKING_SSE2
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i lo = FloatToSnorm16SSE2(_mm_loadu_ps(pSrc + i));
+			__m128i hi = FloatToSnorm16SSE2(_mm_loadu_ps(pSrc + i + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), _mm_packs_epi32(lo, hi));
+		}
+#endif
+		for (; i < count; ++i)
+			pDest[i] = ::FloatToSnorm16(pSrc[i]);
+	}
+
+	void FloatToUnorm8(const float* pSrc, uint8_t* pDest, size_t count)
+	{
+		size_t i = 0;
+#if VERTEX_PACKING_SSE2
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(255.0f);
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i v[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				__m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + i + j * 4), zero), one);
+				v[j] = _mm_cvtps_epi32(_mm_mul_ps(f, scale));
+			}
+			__m128i lo = _mm_packs_epi32(v[0], v[1]);
+			__m128i hi = _mm_packs_epi32(v[2], v[3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; i < count; ++i)
+			pDest[i] = (uint8_t)lrintf((std::min)((std::max)(pSrc[i], 0.0f), 1.0f) * 255.0f);
+	}
+
+	void EncodeOctahedralSnorm16(const float* pSrc, size_t srcStride, int16_t* pDest, size_t count)
+	{
+		size_t i = 0;
+#if VERTEX_PACKING_SSE2
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			// AoS -> SoA
+			const float* p0 = pSrc + i * srcStride;
+			const float* p1 = p0 + srcStride;
+			const float* p2 = p1 + srcStride;
+			const float* p3 = p2 + srcStride;
+			__m128 x = _mm_set_ps(p3[0], p2[0], p1[0], p0[0]);
+			__m128 y = _mm_set_ps(p3[1], p2[1], p1[1], p0[1]);
+			__m128 z = _mm_set_ps(p3[2], p2[2], p1[2], p0[2]);
+
+			__m128 absX = _mm_andnot_ps(signMask, x);
+			__m128 absY = _mm_andnot_ps(signMask, y);
+			__m128 absZ = _mm_andnot_ps(signMask, z);
+			__m128 l1 = _mm_add_ps(_mm_add_ps(absX, absY), absZ);
+			// 零向量编码为(0, 0)
+			__m128 inv = _mm_and_ps(_mm_div_ps(one, l1), _mm_cmpgt_ps(l1, zero));
+			x = _mm_mul_ps(x, inv);
+			y = _mm_mul_ps(y, inv);
+
+			// 下半球折叠到外侧的三角形
+			__m128 signX = _mm_or_ps(_mm_and_ps(x, signMask), one);
+			__m128 signY = _mm_or_ps(_mm_and_ps(y, signMask), one);
+			__m128 wrapX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), signX);
+			__m128 wrapY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), signY);
+			__m128 lower = _mm_cmplt_ps(z, zero);
+			x = _mm_or_ps(_mm_and_ps(lower, wrapX), _mm_andnot_ps(lower, x));
+			y = _mm_or_ps(_mm_and_ps(lower, wrapY), _mm_andnot_ps(lower, y));
+
+			__m128i qx = FloatToSnorm16SSE2(x);
+			__m128i qy = FloatToSnorm16SSE2(y);
+			__m128i xy = _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i * 2), xy);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const float* p = pSrc + i * srcStride;
+			float x, y;
+			EncodeOctahedral(p[0], p[1], p[2], x, y);
+			pDest[i * 2] = ::FloatToSnorm16(x);
+			pDest[i * 2 + 1] = ::FloatToSnorm16(y);
+		}
+	}
+
+	void DecodeOctahedralSnorm16(const int16_t* pSrc, float* pDest, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			float x = SnormToFloat(pSrc[i * 2]);
+			float y = SnormToFloat(pSrc[i * 2 + 1]);
+			float z = 1.0f - fabsf(x) - fabsf(y);
+			float t = (std::max)(-z, 0.0f);
+			x += x >= 0.0f ? -t : t;
+			y += y >= 0.0f ? -t : t;
+			float invLen = 1.0f / sqrtf(x * x + y * y + z * z);
+			pDest[i * 3] = x * invLen;
+			pDest[i * 3 + 1] = y * invLen;
+			pDest[i * 3 + 2] = z * invLen;
+		}
+	}
+
+	void Interleave(const void* const* ppStreams, const uint32_t* pStreamStrides, uint32_t streamCount,
+		size_t vertexCount, void* pDest)
+	{
+		uint32_t vertexStride = 0;
+		for (uint32_t s = 0; s < streamCount; ++s)
+			vertexStride += pStreamStrides[s];
+
+		uint8_t* pDestBytes = static_cast<uint8_t*>(pDest);
+		uint32_t offset = 0;
+		for (uint32_t s = 0; s < streamCount; ++s)
+		{
+			const uint8_t* pSrcBytes = static_cast<const uint8_t*>(ppStreams[s]);
+			uint32_t stride = pStreamStrides[s];
+			// 按流逐个写入，源数据连续读取
+			for (size_t v = 0; v < vertexCount; ++v)
+				memcpy(pDestBytes + v * vertexStride + offset, pSrcBytes + v * stride, stride);
+			offset += stride;
+		}
+	}
+}
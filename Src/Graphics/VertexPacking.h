@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 顶点属性的压缩与交错
+// 只依赖标准库，x86/x64下使用SSE2，其余平台使用等价的标量实现
+namespace VertexPacking
+{
+	// float -> half(就近舍入到偶数)，处理非规格化数、无穷与NaN
+	void FloatToHalf(const float* pSrc, uint16_t* pDest, size_t count);
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	// [-1, 1] -> snorm16，超出范围的值会被截断
+	void FloatToSnorm16(const float* pSrc, int16_t* pDest, size_t count);
+	// [0, 1] -> unorm8，超出范围的值会被截断
+	void FloatToUnorm8(const float* pSrc, uint8_t* pDest, size_t count);
+
+	// 单位向量的八面体编码，每个向量输出两个snorm16
+	// srcStride为相邻向量之间的float数(紧密排列的float3为3)
+	void EncodeOctahedralSnorm16(const float* pSrc, size_t srcStride, int16_t* pDest, size_t count);
+	// 八面体编码的解码，每个向量输出3个float
+	void DecodeOctahedralSnorm16(const int16_t* pSrc, float* pDest, size_t count);
+
+	// 将多个紧密排列的属性流交错为一个顶点流
+	// ppStreams[i]中每个顶点占pStreamStrides[i]字节，输出的顶点步长为所有步长之和
+	void Interleave(const void* const* ppStreams, const uint32_t* pStreamStrides, uint32_t streamCount,
+		size_t vertexCount, void* pDest);
+}
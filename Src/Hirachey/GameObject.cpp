@@ -43,6 +43,8 @@ GameObject* GameObject::Instantiate(GameObject* pObject)
 			continue;
 	}
 	
+	pNewObject->m_IsStatic = pObject->m_IsStatic;
+
 	auto pComponents = pNewObject->GetComponents();
 	for (auto pComponent : pComponents)
 	{
@@ -110,6 +112,16 @@ void GameObject::SetEnabled(bool enabled)
 	m_IsEnabled = enabled;
 }
 
+bool GameObject::IsStatic() const
+{
+	return m_IsStatic;
+}
+
+void GameObject::SetStatic(bool isStatic)
+{
+	m_IsStatic = isStatic;
+}
+
 GameObject* GameObject::GetParent()
 {
 	return m_pParent;
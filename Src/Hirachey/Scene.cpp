@@ -1,6 +1,5 @@
 #include <Hierarchy/Scene.h>
 #include <Hierarchy/GameObject.h>
-#include <Utils/Geometry.h>
 #include <Graphics/ResourceManager.h>
 
 using namespace XMath;
@@ -53,42 +52,42 @@ GameObject* Scene::AddGameObject(std::string_view name)
 	return GameObject::Create(this, name);
 }
 
-GameObject* Scene::AddCube(std::string_view name)
+GameObject* Scene::AddCube(std::string_view name, float width, float height, float depth)
 {
 	GameObject* pObj = GameObject::Create(this, name);
-	auto& pMeshData = pObj->AddComponent<MeshFilter>()->m_pMesh;
-	pMeshData = std::make_unique<MeshData>();
-	Geometry::CreateBox(pMeshData.get());
+	MeshFilter* pMeshFilter = pObj->AddComponent<MeshFilter>();
+	pMeshFilter->m_pSharedMeshRef = ResourceManager::Get().GetPrimitiveMesh(PrimitiveMeshDesc::Box(width, height, depth));
+	pMeshFilter->m_pSharedMesh = pMeshFilter->m_pSharedMeshRef.get();
 	//pObj->AddComponent<MeshRenderer>()->SetMaterial(ResourceManager::Get().FindMaterial("@DefaultColorLit"));
 	return pObj;
 }
 
-GameObject* Scene::AddSphere(std::string_view name)
+GameObject* Scene::AddSphere(std::string_view name, float radius, uint32_t levels, uint32_t slices)
 {
 	GameObject* pObj = GameObject::Create(this, name);
-	auto& pMeshData = pObj->AddComponent<MeshFilter>()->m_pMesh;
-	pMeshData = std::make_unique<MeshData>();
-	Geometry::CreateSphere(pMeshData.get());
+	MeshFilter* pMeshFilter = pObj->AddComponent<MeshFilter>();
+	pMeshFilter->m_pSharedMeshRef = ResourceManager::Get().GetPrimitiveMesh(PrimitiveMeshDesc::Sphere(radius, levels, slices));
+	pMeshFilter->m_pSharedMesh = pMeshFilter->m_pSharedMeshRef.get();
 	//pObj->AddComponent<MeshRenderer>()->SetMaterial(ResourceManager::Get().FindMaterial("@DefaultColorLit"));
 	return pObj;
 }
 
-GameObject* Scene::AddCylinder(std::string_view name)
+GameObject* Scene::AddCylinder(std::string_view name, float radius, float height, uint32_t slices, uint32_t stacks)
 {
 	GameObject* pObj = GameObject::Create(this, name);
-	auto& pMeshData = pObj->AddComponent<MeshFilter>()->m_pMesh;
-	pMeshData = std::make_unique<MeshData>();
-	Geometry::CreateCylinder(pMeshData.get());
+	MeshFilter* pMeshFilter = pObj->AddComponent<MeshFilter>();
+	pMeshFilter->m_pSharedMeshRef = ResourceManager::Get().GetPrimitiveMesh(PrimitiveMeshDesc::Cylinder(radius, height, slices, stacks));
+	pMeshFilter->m_pSharedMesh = pMeshFilter->m_pSharedMeshRef.get();
 	//pObj->AddComponent<MeshRenderer>()->SetMaterial(ResourceManager::Get().FindMaterial("@DefaultColorLit"));
 	return pObj;
 }
 
-GameObject* Scene::AddPlane(std::string_view name)
+GameObject* Scene::AddPlane(std::string_view name, float width, float depth)
 {
 	GameObject* pObj = GameObject::Create(this, name);
-	auto& pMeshData = pObj->AddComponent<MeshFilter>()->m_pMesh;
-	pMeshData = std::make_unique<MeshData>();
-	Geometry::CreatePlane(pMeshData.get());
+	MeshFilter* pMeshFilter = pObj->AddComponent<MeshFilter>();
+	pMeshFilter->m_pSharedMeshRef = ResourceManager::Get().GetPrimitiveMesh(PrimitiveMeshDesc::Plane(width, depth));
+	pMeshFilter->m_pSharedMesh = pMeshFilter->m_pSharedMeshRef.get();
 	//pObj->AddComponent<MeshRenderer>()->SetMaterial(ResourceManager::Get().FindMaterial("@DefaultColorLit"));
 	return pObj;
 }
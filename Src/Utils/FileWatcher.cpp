@@ -0,0 +1,216 @@
+#include <Utils/FileWatcher.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#error "FileWatcher: unsupported platform"
+#endif
+
+namespace
+{
+	// 拆分为所在目录与文件名，没有目录时为"."
+	std::pair<std::string, std::string> SplitPath(std::string_view path)
+	{
+		size_t pos = path.find_last_of("/\\");
+		if (pos == std::string_view::npos)
+			return { ".", std::string(path) };
+		return { pos == 0 ? std::string("/") : std::string(path.substr(0, pos)), std::string(path.substr(pos + 1)) };
+	}
+
+#if defined(_WIN32)
+	std::wstring ToWide(std::string_view str)
+	{
+		int length = MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0);
+		std::wstring wstr(length, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), wstr.data(), length);
+		return wstr;
+	}
+#endif
+}
+
+class FileWatcher::Impl
+{
+public:
+	struct File
+	{
+		std::vector<std::string> paths;		// 指向同一文件的不同写法
+#if defined(_WIN32)
+		bool exists = false;
+		FILETIME lastWriteTime{};
+		ULARGE_INTEGER size{};
+#endif
+	};
+
+	struct Directory
+	{
+#if defined(_WIN32)
+		HANDLE hChange = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+		int wd = -1;
+#endif
+		std::unordered_map<std::string, File> files;
+	};
+
+	Impl()
+	{
+#if defined(__linux__)
+		m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	}
+
+	~Impl()
+	{
+		Clear();
+#if defined(__linux__)
+		if (m_Fd >= 0)
+			close(m_Fd);
+#endif
+	}
+
+	void Watch(std::string_view path)
+	{
+		if (!m_Paths.insert(std::string(path)).second)
+			return;
+		auto [dirPath, fileName] = SplitPath(path);
+		auto [dirIt, emplaced] = m_Directories.try_emplace(dirPath);
+		Directory& dir = dirIt->second;
+		if (emplaced)
+		{
+#if defined(_WIN32)
+			dir.hChange = FindFirstChangeNotificationW(ToWide(dirPath).c_str(), FALSE,
+				FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE);
+#elif defined(__linux__)
+			if (m_Fd >= 0)
+				dir.wd = inotify_add_watch(m_Fd, dirPath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+			if (dir.wd >= 0)
+				m_WatchDescriptors[dir.wd] = &dir;
+#endif
+		}
+
+		File& file = dir.files[fileName];
+		file.paths.push_back(std::string(path));
+#if defined(_WIN32)
+		if (file.paths.size() == 1)
+			UpdateFileState(ToWide(path), file);
+#endif
+	}
+
+	void Clear()
+	{
+		for (auto& dir : m_Directories)
+		{
+#if defined(_WIN32)
+			if (dir.second.hChange != INVALID_HANDLE_VALUE)
+				FindCloseChangeNotification(dir.second.hChange);
+#elif defined(__linux__)
+			if (dir.second.wd >= 0)
+				inotify_rm_watch(m_Fd, dir.second.wd);
+#endif
+		}
+		m_Directories.clear();
+		m_Paths.clear();
+#if defined(__linux__)
+		m_WatchDescriptors.clear();
+#endif
+	}
+
+	std::vector<std::string> PollChanges()
+	{
+		std::unordered_set<std::string> changed;
+#if defined(_WIN32)
+		for (auto& dir : m_Directories)
+		{
+			if (dir.second.hChange == INVALID_HANDLE_VALUE || WaitForSingleObject(dir.second.hChange, 0) != WAIT_OBJECT_0)
+				continue;
+			FindNextChangeNotification(dir.second.hChange);
+			// 通知只说明目录中有变化，逐个比较被监视文件的状态
+			for (auto& file : dir.second.files)
+			{
+				if (UpdateFileState(ToWide(file.second.paths[0]), file.second))
+					changed.insert(file.second.paths.begin(), file.second.paths.end());
+			}
+		}
+#elif defined(__linux__)
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			ssize_t length = m_Fd >= 0 ? read(m_Fd, buffer, sizeof buffer) : -1;
+			if (length <= 0)
+				break;
+			for (ssize_t offset = 0; offset < length;)
+			{
+				const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += sizeof(inotify_event) + pEvent->len;
+				auto dirIt = m_WatchDescriptors.find(pEvent->wd);
+				if (dirIt == m_WatchDescriptors.end() || pEvent->len == 0)
+					continue;
+				auto fileIt = dirIt->second->files.find(pEvent->name);
+				if (fileIt != dirIt->second->files.end())
+					changed.insert(fileIt->second.paths.begin(), fileIt->second.paths.end());
+			}
+		}
+#endif
+		return std::vector<std::string>(changed.begin(), changed.end());
+	}
+
+private:
+#if defined(_WIN32)
+	// 返回文件的存在性、修改时间或大小是否改变
+	static bool UpdateFileState(const std::wstring& path, File& file)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		bool exists = GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data) != FALSE;
+		FILETIME lastWriteTime = exists ? data.ftLastWriteTime : FILETIME{};
+		ULARGE_INTEGER size{};
+		if (exists)
+		{
+			size.HighPart = data.nFileSizeHigh;
+			size.LowPart = data.nFileSizeLow;
+		}
+		bool changed = exists != file.exists || CompareFileTime(&lastWriteTime, &file.lastWriteTime) != 0 ||
+			size.QuadPart != file.size.QuadPart;
+		file.exists = exists;
+		file.lastWriteTime = lastWriteTime;
+		file.size = size;
+		return changed;
+	}
+#endif
+
+	// 节点的地址在插入其他元素后保持不变
+	std::unordered_map<std::string, Directory> m_Directories;
+	std::unordered_set<std::string> m_Paths;
+#if defined(__linux__)
+	int m_Fd = -1;
+	std::unordered_map<int, Directory*> m_WatchDescriptors;
+#endif
+};
+
+FileWatcher::FileWatcher()
+	: pImpl(std::make_unique<Impl>())
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::Watch(std::string_view path)
+{
+	pImpl->Watch(path);
+}
+
+void FileWatcher::Clear()
+{
+	pImpl->Clear();
+}
+
+std::vector<std::string> FileWatcher::PollChanges()
+{
+	return pImpl->PollChanges();
+}
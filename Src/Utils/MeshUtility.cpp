@@ -0,0 +1,648 @@
+#include <Utils/MeshUtility.h>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MESH_UTILITY_SSE2 1
+#include <emmintrin.h>
+#else
+#define MESH_UTILITY_SSE2 0
+#endif
+
+namespace MeshUtility
+{
+	uint32_t ComputeIndexBitsOr(const uint32_t* pIndices, size_t count)
+	{
+		uint32_t result = 0;
+		size_t i = 0;
+#if MESH_UTILITY_SSE2
+		__m128i acc0 = _mm_setzero_si128();
+		__m128i acc1 = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8)
+		{
+			acc0 = _mm_or_si128(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIndices + i)));
+			acc1 = _mm_or_si128(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIndices + i + 4)));
+		}
+		acc0 = _mm_or_si128(acc0, acc1);
+		acc0 = _mm_or_si128(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc0 = _mm_or_si128(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(2, 3, 0, 1)));
+		result = (uint32_t)_mm_cvtsi128_si32(acc0);
+#endif
+		for (; i < count; ++i)
+			result |= pIndices[i];
+		return result;
+	}
+
+	void NarrowIndices(const uint32_t* pSrc, uint16_t* pDest, size_t count, uint32_t baseVertex)
+	{
+		size_t i = 0;
+#if MESH_UTILITY_SSE2
+		// _mm_packs_epi32是有符号饱和的，先平移到[-32768, 32767]，打包后再恢复
+		const __m128i bias = _mm_set1_epi32((int)baseVertex + 32768);
+		const __m128i signFlip = _mm_set1_epi16((short)0x8000);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i lo = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)), bias);
+			__m128i hi = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 4)), bias);
+			__m128i packed = _mm_xor_si128(_mm_packs_epi32(lo, hi), signFlip);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), packed);
+		}
+#endif
+		for (; i < count; ++i)
+			pDest[i] = (uint16_t)(pSrc[i] - baseVertex);
+	}
+
+	bool SplitIndicesFor16Bit(const uint32_t* pIndices, size_t count, std::vector<IndexRange>& ranges)
+	{
+		ranges.clear();
+		if (count % 3)
+			return false;
+
+		size_t start = 0;
+		uint32_t minIndex = UINT32_MAX, maxIndex = 0;
+		for (size_t i = 0; i < count; i += 3)
+		{
+			uint32_t triMin = (std::min)({ pIndices[i], pIndices[i + 1], pIndices[i + 2] });
+			uint32_t triMax = (std::max)({ pIndices[i], pIndices[i + 1], pIndices[i + 2] });
+			if (triMax - triMin > UINT16_MAX)
+				return false;
+
+			uint32_t newMin = (std::min)(minIndex, triMin);
+			uint32_t newMax = (std::max)(maxIndex, triMax);
+			if (newMax - newMin > UINT16_MAX)
+			{
+				ranges.push_back({ (uint32_t)start, (uint32_t)(i - start), minIndex });
+				start = i;
+				newMin = triMin;
+				newMax = triMax;
+			}
+			minIndex = newMin;
+			maxIndex = newMax;
+		}
+		if (start < count)
+			ranges.push_back({ (uint32_t)start, (uint32_t)(count - start), minIndex });
+		return true;
+	}
+
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStatistics stats;
+		if (indexCount < 3 || vertexCount == 0 || cacheSize == 0)
+			return stats;
+
+		// 顶点进入缓存时的时间戳，与当前时间戳相差不超过cacheSize时仍在缓存中
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		std::vector<uint8_t> referenced(vertexCount, 0);
+		uint32_t timestamp = cacheSize + 1;
+		for (size_t i = 0; i < indexCount / 3 * 3; ++i)
+		{
+			uint32_t index = pIndices[i];
+			if (timestamp - timestamps[index] > cacheSize)
+			{
+				timestamps[index] = timestamp++;
+				++stats.verticesTransformed;
+			}
+			if (!referenced[index])
+			{
+				referenced[index] = 1;
+				++stats.vertexCount;
+			}
+		}
+
+		stats.triangleCount = (uint32_t)(indexCount / 3);
+		stats.acmr = (float)stats.verticesTransformed / stats.triangleCount;
+		stats.atvr = (float)stats.verticesTransformed / stats.vertexCount;
+		return stats;
+	}
+
+	namespace
+	{
+		// Forsyth算法的参数
+		constexpr uint32_t s_CacheSize = 32;
+		constexpr float s_CacheDecayPower = 1.5f;
+		constexpr float s_LastTriangleScore = 0.75f;
+		constexpr float s_ValenceBoostScale = 2.0f;
+		constexpr float s_ValenceBoostPower = 0.5f;
+
+		struct ForsythScoreTable
+		{
+			float cacheScores[s_CacheSize];
+			float valenceScores[64];
+
+			ForsythScoreTable()
+			{
+				for (uint32_t i = 0; i < s_CacheSize; ++i)
+				{
+					// 最近使用的三个顶点属于上一个三角形，给固定分数，避免总是选择同一条带
+					cacheScores[i] = i < 3 ? s_LastTriangleScore :
+						std::pow(1.0f - (float)(i - 3) / (s_CacheSize - 3), s_CacheDecayPower);
+				}
+				valenceScores[0] = 0.0f;
+				for (uint32_t i = 1; i < 64; ++i)
+					valenceScores[i] = s_ValenceBoostScale * std::pow((float)i, -s_ValenceBoostPower);
+			}
+		};
+
+		// 剩余三角形越少的顶点分数越高，尽快用完以免留下孤立的三角形
+		float GetVertexScore(const ForsythScoreTable& table, int cachePos, uint32_t remaining)
+		{
+			if (remaining == 0)
+				return -1.0f;
+			float score = cachePos >= 0 ? table.cacheScores[cachePos] : 0.0f;
+			return score + (remaining < 64 ? table.valenceScores[remaining] :
+				s_ValenceBoostScale * std::pow((float)remaining, -s_ValenceBoostPower));
+		}
+	}
+
+	void OptimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2 || vertexCount == 0)
+			return;
+
+		static const ForsythScoreTable s_Table;
+
+		// 每个顶点相邻的三角形，按CSR方式存放，已输出的三角形被交换到每段末尾
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+			++remaining[pIndices[i]];
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; ++v)
+			offsets[v + 1] = offsets[v] + remaining[v];
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; ++i)
+				adjacency[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+		}
+
+		std::vector<int> cachePos(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+			vertexScores[v] = GetVertexScore(s_Table, -1, remaining[v]);
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; ++t)
+		{
+			triangleScores[t] = vertexScores[pIndices[t * 3]] + vertexScores[pIndices[t * 3 + 1]] +
+				vertexScores[pIndices[t * 3 + 2]];
+		}
+
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		std::vector<uint32_t> result(triangleCount * 3);
+		uint32_t cache[s_CacheSize + 3];
+		uint32_t cacheCount = 0;
+		size_t scanCursor = 0;
+		int64_t bestTriangle = -1;
+
+		for (size_t outTriangle = 0; outTriangle < triangleCount; ++outTriangle)
+		{
+			// 缓存中的顶点都没有剩余三角形时，按顺序找下一个未输出的三角形
+			if (bestTriangle < 0)
+			{
+				while (emitted[scanCursor])
+					++scanCursor;
+				bestTriangle = (int64_t)scanCursor;
+			}
+
+			const uint32_t* tri = pIndices + bestTriangle * 3;
+			memcpy(result.data() + outTriangle * 3, tri, 3 * sizeof(uint32_t));
+			emitted[bestTriangle] = 1;
+
+			// 从三个顶点的相邻列表中移除该三角形
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t v = tri[k];
+				uint32_t* pAdj = adjacency.data() + offsets[v];
+				uint32_t count = remaining[v];
+				for (uint32_t j = 0; j < count; ++j)
+				{
+					if (pAdj[j] == (uint32_t)bestTriangle)
+					{
+						std::swap(pAdj[j], pAdj[count - 1]);
+						break;
+					}
+				}
+				--remaining[v];
+			}
+
+			// 三角形的顶点移到缓存最前面，其余顶点依次后移
+			uint32_t newCache[s_CacheSize + 3];
+			uint32_t newCount = 0;
+			for (int k = 0; k < 3; ++k)
+				newCache[newCount++] = tri[k];
+			for (uint32_t j = 0; j < cacheCount; ++j)
+			{
+				uint32_t v = cache[j];
+				if (v != tri[0] && v != tri[1] && v != tri[2])
+					newCache[newCount++] = v;
+			}
+			for (uint32_t j = 0; j < newCount; ++j)
+				cachePos[newCache[j]] = j < s_CacheSize ? (int)j : -1;
+
+			// 更新缓存中(以及刚被挤出的)顶点及其相邻三角形的分数
+			for (uint32_t j = 0; j < newCount; ++j)
+			{
+				uint32_t v = newCache[j];
+				float newScore = GetVertexScore(s_Table, cachePos[v], remaining[v]);
+				float delta = newScore - vertexScores[v];
+				vertexScores[v] = newScore;
+				const uint32_t* pAdj = adjacency.data() + offsets[v];
+				for (uint32_t a = 0; a < remaining[v]; ++a)
+					triangleScores[pAdj[a]] += delta;
+			}
+
+			// 下一个三角形只从与缓存中顶点相邻的三角形中选择
+			cacheCount = (std::min)(newCount, s_CacheSize);
+			bestTriangle = -1;
+			float bestScore = -1.0f;
+			for (uint32_t j = 0; j < cacheCount; ++j)
+			{
+				uint32_t v = newCache[j];
+				const uint32_t* pAdj = adjacency.data() + offsets[v];
+				for (uint32_t a = 0; a < remaining[v]; ++a)
+				{
+					if (triangleScores[pAdj[a]] > bestScore)
+					{
+						bestScore = triangleScores[pAdj[a]];
+						bestTriangle = pAdj[a];
+					}
+				}
+			}
+			memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+		}
+
+		memcpy(pIndices, result.data(), result.size() * sizeof(uint32_t));
+	}
+
+	void OptimizeOverdraw(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride,
+		size_t vertexCount, float threshold)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2 || vertexCount == 0)
+			return;
+
+		constexpr uint32_t cacheSize = 16;
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t timestamp = cacheSize + 1;
+		auto countMisses = [&](size_t t) {
+			uint32_t misses = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t index = pIndices[t * 3 + k];
+				if (timestamp - timestamps[index] > cacheSize)
+				{
+					timestamps[index] = timestamp++;
+					++misses;
+				}
+			}
+			return misses;
+		};
+		auto flushCache = [&]() { timestamp += cacheSize + 1; };
+
+		// 硬边界：三个顶点都未命中说明顶点缓存优化在此处另起了一段
+		// 第一个三角形总是边界，即使它是退化的(未命中少于3次)，否则之前的三角形会被丢弃
+		std::vector<size_t> hardBoundaries{ 0 };
+		countMisses(0);
+		for (size_t t = 1; t < triangleCount; ++t)
+		{
+			if (countMisses(t) == 3)
+				hardBoundaries.push_back(t);
+		}
+		hardBoundaries.push_back(triangleCount);
+
+		// 软边界：段内前缀的ACMR不超过该段ACMR的threshold倍时可以再切分
+		std::vector<size_t> clusters;
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+		{
+			size_t start = hardBoundaries[h], end = hardBoundaries[h + 1];
+			flushCache();
+			uint32_t clusterMisses = 0;
+			for (size_t t = start; t < end; ++t)
+				clusterMisses += countMisses(t);
+			float clusterThreshold = threshold * clusterMisses / (end - start);
+
+			flushCache();
+			clusters.push_back(start);
+			uint32_t runningMisses = 0, runningTriangles = 0;
+			for (size_t t = start; t < end; ++t)
+			{
+				runningMisses += countMisses(t);
+				++runningTriangles;
+				if (t + 1 < end && (float)runningMisses / runningTriangles <= clusterThreshold)
+				{
+					clusters.push_back(t + 1);
+					flushCache();
+					runningMisses = runningTriangles = 0;
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+		size_t clusterCount = clusters.size() - 1;
+
+		// 网格的面积加权中心
+		auto position = [&](uint32_t index) { return pPositions + index * positionStride; };
+		double meshCenter[3] = {}, meshArea = 0.0;
+		std::vector<float> clusterKeys(clusterCount);
+		std::vector<double> clusterData(clusterCount * 7, 0.0);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			double* data = clusterData.data() + c * 7;
+			for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+			{
+				const float* p0 = position(pIndices[t * 3]);
+				const float* p1 = position(pIndices[t * 3 + 1]);
+				const float* p2 = position(pIndices[t * 3 + 2]);
+				double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (int k = 0; k < 3; ++k)
+				{
+					double center = (p0[k] + p1[k] + p2[k]) / 3.0;
+					data[k] += center * area;
+					data[3 + k] += n[k];
+				}
+				data[6] += area;
+			}
+			for (int k = 0; k < 3; ++k)
+				meshCenter[k] += data[k];
+			meshArea += data[6];
+		}
+		for (int k = 0; k < 3; ++k)
+			meshCenter[k] = meshArea > 0.0 ? meshCenter[k] / meshArea : 0.0;
+
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			const double* data = clusterData.data() + c * 7;
+			double area = data[6] > 0.0 ? data[6] : 1.0;
+			double length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+			double key = 0.0;
+			if (length > 0.0)
+			{
+				for (int k = 0; k < 3; ++k)
+					key += (data[k] / area - meshCenter[k]) * data[3 + k] / length;
+			}
+			clusterKeys[c] = (float)key;
+		}
+
+		// 越朝外的簇越先绘制
+		std::vector<size_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return clusterKeys[lhs] > clusterKeys[rhs]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+		for (size_t c : order)
+			result.insert(result.end(), pIndices + clusters[c] * 3, pIndices + clusters[c + 1] * 3);
+		assert(result.size() == triangleCount * 3);
+		memcpy(pIndices, result.data(), result.size() * sizeof(uint32_t));
+	}
+
+	size_t OptimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+	{
+		remap.assign(vertexCount, UINT32_MAX);
+		uint32_t next = 0;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			uint32_t& target = remap[pIndices[i]];
+			if (target == UINT32_MAX)
+				target = next++;
+			pIndices[i] = target;
+		}
+		size_t referencedCount = next;
+		for (auto& target : remap)
+		{
+			if (target == UINT32_MAX)
+				target = next++;
+		}
+		return referencedCount;
+	}
+
+	namespace
+	{
+		void ComputeMeshletBounds(Meshlet& meshlet, const uint32_t* pIndices, const uint32_t* pVertices,
+			const float* pPositions, size_t positionStride)
+		{
+			auto position = [&](uint32_t index) { return pPositions + index * positionStride; };
+
+			// 包围盒中心作为球心
+			float vMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, vMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+			{
+				const float* p = position(pVertices[i]);
+				for (int k = 0; k < 3; ++k)
+				{
+					vMin[k] = (std::min)(vMin[k], p[k]);
+					vMax[k] = (std::max)(vMax[k], p[k]);
+				}
+			}
+			float radiusSq = 0.0f;
+			for (int k = 0; k < 3; ++k)
+				meshlet.center[k] = (vMin[k] + vMax[k]) * 0.5f;
+			for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+			{
+				const float* p = position(pVertices[i]);
+				float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+				radiusSq = (std::max)(radiusSq, dx * dx + dy * dy + dz * dz);
+			}
+			meshlet.radius = std::sqrt(radiusSq);
+
+			// 法线锥的轴取单位法线的平均，锥角取与轴夹角最大的法线
+			std::vector<float> normals;
+			normals.reserve(meshlet.indexCount);
+			float axis[3] = {};
+			for (uint32_t t = 0; t < meshlet.indexCount; t += 3)
+			{
+				const float* p0 = position(pIndices[t]);
+				const float* p1 = position(pIndices[t + 1]);
+				const float* p2 = position(pIndices[t + 2]);
+				float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				// 退化三角形不可见，不影响法线锥
+				if (length <= 0.0f)
+					continue;
+				for (int k = 0; k < 3; ++k)
+				{
+					normals.push_back(n[k] / length);
+					axis[k] += n[k] / length;
+				}
+			}
+
+			meshlet.coneAxis[0] = meshlet.coneAxis[1] = meshlet.coneAxis[2] = 0.0f;
+			meshlet.coneCutoff = 2.0f;
+			float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			if (axisLength <= 0.0f)
+				return;
+			for (int k = 0; k < 3; ++k)
+				meshlet.coneAxis[k] = axis[k] / axisLength;
+
+			float minDot = 1.0f;
+			for (size_t i = 0; i < normals.size(); i += 3)
+			{
+				minDot = (std::min)(minDot, normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] +
+					normals[i + 2] * meshlet.coneAxis[2]);
+			}
+			// 锥角达到90度时任何方向都能看到部分三角形
+			if (minDot > 0.0f)
+				meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+		}
+	}
+
+	void BuildMeshlets(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, size_t vertexCount,
+		std::vector<Meshlet>& meshlets, uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		meshlets.clear();
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || vertexCount == 0 || maxVertices < 3 || maxTriangles == 0)
+			return;
+
+		// 顶点相邻的三角形
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+			++offsets[pIndices[i] + 1];
+		for (size_t v = 0; v < vertexCount; ++v)
+			offsets[v + 1] += offsets[v];
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; ++i)
+				adjacency[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+		}
+
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		// 顶点/三角形最后一次加入的簇编号，用于判断是否已在当前簇或候选列表中
+		std::vector<uint32_t> vertexStamps(vertexCount, UINT32_MAX);
+		std::vector<uint32_t> candidateStamps(triangleCount, UINT32_MAX);
+		std::vector<uint32_t> candidates;
+		std::vector<uint32_t> meshletVertices;
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+		size_t scanCursor = 0;
+
+		while (result.size() < triangleCount * 3)
+		{
+			uint32_t meshletIndex = (uint32_t)meshlets.size();
+			Meshlet meshlet{};
+			meshlet.indexStart = (uint32_t)result.size();
+			meshletVertices.clear();
+			candidates.clear();
+
+			auto addTriangle = [&](uint32_t t) {
+				emitted[t] = 1;
+				for (int k = 0; k < 3; ++k)
+				{
+					uint32_t v = pIndices[t * 3 + k];
+					result.push_back(v);
+					if (vertexStamps[v] == meshletIndex)
+						continue;
+					vertexStamps[v] = meshletIndex;
+					meshletVertices.push_back(v);
+					for (uint32_t a = offsets[v]; a < offsets[v + 1]; ++a)
+					{
+						uint32_t adj = adjacency[a];
+						if (!emitted[adj] && candidateStamps[adj] != meshletIndex)
+						{
+							candidateStamps[adj] = meshletIndex;
+							candidates.push_back(adj);
+						}
+					}
+				}
+			};
+
+			while (emitted[scanCursor])
+				++scanCursor;
+			addTriangle((uint32_t)scanCursor);
+
+			// 优先选择新增顶点最少的相邻三角形，相同时取先加入候选的
+			for (uint32_t triangles = 1; triangles < maxTriangles; ++triangles)
+			{
+				int64_t best = -1;
+				uint32_t bestNewVertices = 4;
+				size_t live = 0;
+				for (size_t c = 0; c < candidates.size(); ++c)
+				{
+					uint32_t t = candidates[c];
+					if (emitted[t])
+						continue;
+					candidates[live++] = t;
+					uint32_t newVertices = 0;
+					for (int k = 0; k < 3; ++k)
+						newVertices += vertexStamps[pIndices[t * 3 + k]] != meshletIndex ? 1 : 0;
+					if (newVertices < bestNewVertices && meshletVertices.size() + newVertices <= maxVertices)
+					{
+						best = (int64_t)t;
+						bestNewVertices = newVertices;
+					}
+				}
+				candidates.resize(live);
+				if (best < 0)
+					break;
+				addTriangle((uint32_t)best);
+			}
+
+			meshlet.indexCount = (uint32_t)result.size() - meshlet.indexStart;
+			meshlet.vertexCount = (uint32_t)meshletVertices.size();
+			ComputeMeshletBounds(meshlet, result.data() + meshlet.indexStart, meshletVertices.data(), pPositions, positionStride);
+			meshlets.push_back(meshlet);
+		}
+
+		memcpy(pIndices, result.data(), result.size() * sizeof(uint32_t));
+	}
+
+	void CullMeshlets(const Meshlet* pMeshlets, size_t count, const float* pPlanes, const float* pCameraPos,
+		std::vector<IndexRange>& visibleRanges)
+	{
+		visibleRanges.clear();
+
+		// 包围球判定需要单位法向的平面
+		float planes[6][4];
+		for (int i = 0; i < 6; ++i)
+		{
+			const float* plane = pPlanes + i * 4;
+			float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+			for (int k = 0; k < 4; ++k)
+				planes[i][k] = plane[k] * invLength;
+		}
+
+		for (size_t m = 0; m < count; ++m)
+		{
+			const Meshlet& meshlet = pMeshlets[m];
+			const float* c = meshlet.center;
+
+			bool visible = true;
+			for (int i = 0; i < 6 && visible; ++i)
+				visible = planes[i][0] * c[0] + planes[i][1] * c[1] + planes[i][2] * c[2] + planes[i][3] >= -meshlet.radius;
+			if (!visible)
+				continue;
+
+			// 包围球内任意一点看向簇的方向都在法线锥的背面时剔除：
+			// dot(normalize(center - eye), axis) >= cutoff + radius / distance
+			if (meshlet.coneCutoff <= 1.0f)
+			{
+				float v[3] = { c[0] - pCameraPos[0], c[1] - pCameraPos[1], c[2] - pCameraPos[2] };
+				float distance = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+				float d = v[0] * meshlet.coneAxis[0] + v[1] * meshlet.coneAxis[1] + v[2] * meshlet.coneAxis[2];
+				if (distance > meshlet.radius && d >= meshlet.coneCutoff * distance + meshlet.radius)
+					continue;
+			}
+
+			if (!visibleRanges.empty())
+			{
+				IndexRange& last = visibleRanges.back();
+				if (last.indexStart + last.indexCount == meshlet.indexStart && last.baseVertex == meshlet.baseVertex)
+				{
+					last.indexCount += meshlet.indexCount;
+					continue;
+				}
+			}
+			visibleRanges.push_back({ meshlet.indexStart, meshlet.indexCount, meshlet.baseVertex });
+		}
+	}
+}
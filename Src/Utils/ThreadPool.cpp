@@ -0,0 +1,129 @@
+#include <Utils/ThreadPool.h>
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		size_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	m_Workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+		m_Workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool s_ThreadPool;
+	return s_ThreadPool;
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+	return m_Workers.size();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& func)
+{
+	if (count == 0)
+		return;
+	if (chunkSize == 0)
+		chunkSize = 1;
+
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (chunkCount == 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	// 各线程通过原子计数领取块，调用线程同样参与。调用线程只等待已被领取的块完成，
+	// 而不等待辅助任务本身：还在队列中的辅助任务开始时已没有剩余的块，直接返回。
+	// 因此在线程池的任务中嵌套调用时，即使所有工作线程都在等待也不会死锁
+	struct SharedState
+	{
+		std::atomic<size_t> nextChunk = 0;
+		std::atomic<size_t> finishedChunks = 0;
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr exception;
+	};
+	auto pState = std::make_shared<SharedState>();
+	// 只有领取到块时才访问func，而领取到的块在调用线程返回前都已完成，这里按引用捕获是安全的
+	auto RunChunks = [pState, &func, count, chunkSize, chunkCount]() {
+		size_t chunk;
+		while ((chunk = pState->nextChunk.fetch_add(1)) < chunkCount)
+		{
+			size_t begin = chunk * chunkSize;
+			size_t end = (std::min)(begin + chunkSize, count);
+			try
+			{
+				func(begin, end);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(pState->mutex);
+				if (!pState->exception)
+					pState->exception = std::current_exception();
+			}
+			if (pState->finishedChunks.fetch_add(1) + 1 == chunkCount)
+			{
+				std::lock_guard<std::mutex> lock(pState->mutex);
+				pState->finished.notify_all();
+			}
+		}
+	};
+
+	size_t helperCount = (std::min)(chunkCount - 1, m_Workers.size());
+	for (size_t i = 0; i < helperCount; ++i)
+		Enqueue(RunChunks);
+
+	RunChunks();
+	{
+		std::unique_lock<std::mutex> lock(pState->mutex);
+		pState->finished.wait(lock, [&pState, chunkCount]() { return pState->finishedChunks.load() == chunkCount; });
+	}
+	if (pState->exception)
+		std::rethrow_exception(pState->exception);
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Tasks.push(std::move(task));
+	}
+	m_Condition.notify_one();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Stopping && m_Tasks.empty())
+				return;
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop();
+		}
+		task();
+	}
+}
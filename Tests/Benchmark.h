@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// 基准测试程序的公共部分，不使用测试框架，直接打印测量结果
+// 传入--quick时缩小规模，ctest使用该参数只确认程序能够运行
+namespace Bench
+{
+	inline bool IsQuick(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--quick") == 0)
+				return true;
+		}
+		return false;
+	}
+
+	// 执行repeat次，返回最快一次的毫秒数
+	template<class Func>
+	double MeasureMilliseconds(int repeat, Func&& func)
+	{
+		double best = 0.0;
+		for (int i = 0; i < repeat; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			func();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			best = i == 0 || ms < best ? ms : best;
+		}
+		return best;
+	}
+
+	// 指针本身为volatile，每次写入都不能被省略
+	inline const void* volatile s_pSink = nullptr;
+
+	// 防止被测结果被优化掉
+	template<class T>
+	void DoNotOptimize(const T& value)
+	{
+		s_pSink = &value;
+	}
+}
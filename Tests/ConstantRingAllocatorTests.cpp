@@ -0,0 +1,78 @@
+#include "TestFramework.h"
+#include <ConstantRingAllocator.h>
+#include <cstring>
+
+TEST_CASE(AllocationsAreAlignedForOffsetBinding)
+{
+	ConstantRingAllocator allocator;
+	auto a = allocator.Allocate(64);
+	auto b = allocator.Allocate(300);
+	auto c = allocator.Allocate(16);
+	CHECK(a.byteOffset == 0 && a.byteSize == 256);
+	CHECK(b.byteOffset == 256 && b.byteSize == 512);
+	CHECK(c.byteOffset == 768);
+	CHECK(b.GetFirstConstant() == 16 && b.GetNumConstants() == 32);
+	CHECK(allocator.GetAllocatedBytes() == 1024);
+}
+
+TEST_CASE(InvalidSizesFail)
+{
+	ConstantRingAllocator allocator;
+	CHECK(allocator.Allocate(0u).pData == nullptr);
+	CHECK(allocator.Allocate(ConstantRingAllocator::s_MaxAllocationSize + 1).pData == nullptr);
+	CHECK(allocator.Allocate(ConstantRingAllocator::s_MaxAllocationSize).pData != nullptr);
+}
+
+TEST_CASE(PageSizeIsAtLeastOneMaximumAllocation)
+{
+	ConstantRingAllocator allocator(1000);
+	CHECK(allocator.GetPageSize() == ConstantRingAllocator::s_MaxAllocationSize);
+}
+
+TEST_CASE(FullPageMovesToNextPage)
+{
+	ConstantRingAllocator allocator(65536);
+	for (int i = 0; i < 256; ++i)
+		allocator.Allocate(256);
+	CHECK(allocator.GetUsedPageCount() == 1);
+	CHECK(allocator.GetPageUsedBytes(0) == 65536);
+
+	auto next = allocator.Allocate(256);
+	CHECK(next.pageIndex == 1 && next.byteOffset == 0);
+	CHECK(allocator.GetUsedPageCount() == 2);
+	CHECK(allocator.GetPageUsedBytes(1) == 256);
+}
+
+TEST_CASE(CopiedDataIsPaddedWithZeros)
+{
+	ConstantRingAllocator allocator;
+	uint8_t garbage[256];
+	memset(garbage, 0xcd, sizeof garbage);
+	allocator.Allocate(garbage, sizeof garbage);
+	allocator.Reset();
+
+	float values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+	auto allocation = allocator.Allocate(values, sizeof values);
+	CHECK(memcmp(allocation.pData, values, sizeof values) == 0);
+	bool padded = true;
+	for (uint32_t i = sizeof values; i < allocation.byteSize; ++i)
+		padded = padded && allocation.pData[i] == 0;
+	CHECK(padded);
+}
+
+TEST_CASE(ResetKeepsPagesAndAdvancesGeneration)
+{
+	ConstantRingAllocator allocator(65536);
+	for (int i = 0; i < 300; ++i)
+		allocator.Allocate(256);
+	uint64_t generation = allocator.GetGeneration();
+	CHECK(allocator.GetPageCount() == 2);
+
+	allocator.Reset();
+	CHECK(allocator.GetGeneration() == generation + 1);
+	CHECK(allocator.GetPageCount() == 2);
+	CHECK(allocator.GetUsedPageCount() == 0);
+	CHECK(allocator.GetAllocatedBytes() == 0);
+	auto allocation = allocator.Allocate(16);
+	CHECK(allocation.pageIndex == 0 && allocation.byteOffset == 0);
+}
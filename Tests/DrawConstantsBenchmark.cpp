@@ -0,0 +1,130 @@
+// 每次绘制更新内置常量(RecordDrawMesh)的CPU开销
+// 修改前：每次绘制对属性名求std::hash、对物体矩阵做通用4x4求逆、计算Proj * View
+// 修改后：编译期计算的ID、InverseAffine、SetViewMatrix/SetProjMatrix时缓存的ViewProj
+// 逐项累加这三处修改，输出每次绘制的纳秒数
+//   DrawConstantsBenchmark [--quick]
+#include "Benchmark.h"
+#include <Math/XMath.h>
+#include <Utils/Hash.h>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	constexpr size_t StringToID(std::string_view str) { return (size_t)Hash::FNV1a64(str); }
+
+	constexpr std::string_view s_Names[] = { "x_Matrix_LocalToWorld", "x_Matrix_WorldToLocal",
+		"x_Matrix_View", "x_Matrix_Proj", "x_Matrix_ViewProj" };
+	constexpr size_t s_IDs[] = { StringToID(s_Names[0]), StringToID(s_Names[1]),
+		StringToID(s_Names[2]), StringToID(s_Names[3]), StringToID(s_Names[4]) };
+
+	// 代替Shader::Impl::SetRaw：按ID查找变量的偏移，内容不同时才写入并标记为脏
+	struct PerObjectCBuffer
+	{
+		std::unordered_map<size_t, uint32_t> offsets;
+		uint8_t data[5 * sizeof(XMath::Matrix4x4)] = {};
+		bool dirty = false;
+
+		explicit PerObjectCBuffer(bool constexprIDs)
+		{
+			for (uint32_t i = 0; i < 5; ++i)
+				offsets[constexprIDs ? s_IDs[i] : std::hash<std::string_view>()(s_Names[i])] = i * (uint32_t)sizeof(XMath::Matrix4x4);
+		}
+
+		void SetRaw(size_t id, const void* pData, uint32_t byteSize)
+		{
+			auto it = offsets.find(id);
+			if (it == offsets.end() || memcmp(data + it->second, pData, byteSize) == 0)
+				return;
+			memcpy(data + it->second, pData, byteSize);
+			dirty = true;
+		}
+	};
+
+	struct Camera
+	{
+		XMath::Matrix4x4 view, proj, viewProj;
+	};
+
+	template<bool ConstexprIDs, bool Affine, bool CachedViewProj>
+	void RecordDraws(PerObjectCBuffer& cbuffer, const Camera& camera, const std::vector<XMath::Matrix4x4>& matrices)
+	{
+		for (const XMath::Matrix4x4& matrix : matrices)
+		{
+			size_t ids[5];
+			for (int i = 0; i < 5; ++i)
+				ids[i] = ConstexprIDs ? s_IDs[i] : std::hash<std::string_view>()(s_Names[i]);
+
+			XMath::Matrix4x4 worldToLocal = Affine ? XMath::Matrix::InverseAffine(matrix) : XMath::Matrix4x4(matrix.inverse());
+			XMath::Matrix4x4 viewProj = CachedViewProj ? camera.viewProj : XMath::Matrix4x4(camera.proj * camera.view);
+			cbuffer.SetRaw(ids[0], matrix.data(), (uint32_t)sizeof matrix);
+			cbuffer.SetRaw(ids[1], worldToLocal.data(), (uint32_t)sizeof worldToLocal);
+			cbuffer.SetRaw(ids[2], camera.view.data(), (uint32_t)sizeof camera.view);
+			cbuffer.SetRaw(ids[3], camera.proj.data(), (uint32_t)sizeof camera.proj);
+			cbuffer.SetRaw(ids[4], viewProj.data(), (uint32_t)sizeof viewProj);
+			Bench::DoNotOptimize(cbuffer.data);
+		}
+	}
+
+	// 与Transform::GetLocalToWorldMatrix相同的T * R * S，包含负缩放
+	std::vector<XMath::Matrix4x4> CreateMatrices(size_t count)
+	{
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f), scale(0.1f, 4.0f), translation(-100.0f, 100.0f);
+		std::vector<XMath::Matrix4x4> matrices(count);
+		for (auto& m : matrices)
+		{
+			XMath::Vector3 axis = XMath::Vector3(unit(rng), unit(rng), unit(rng)).normalized();
+			XMath::Vector3 s(scale(rng), scale(rng), unit(rng) < 0.0f ? -scale(rng) : scale(rng));
+			m.setIdentity();
+			m.topLeftCorner<3, 3>() = XMath::QuaternionA(Eigen::AngleAxisf(unit(rng) * XMath::PI, axis)).toRotationMatrix() * s.asDiagonal();
+			m.topRightCorner<3, 1>() = XMath::Vector3(translation(rng), translation(rng), translation(rng));
+		}
+		return matrices;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = Bench::IsQuick(argc, argv);
+	size_t drawCount = quick ? 1000 : 100000;
+	int repeat = quick ? 1 : 10;
+
+	auto matrices = CreateMatrices(drawCount);
+	Camera camera;
+	XMath::Matrix4x4A cameraToWorld = XMath::Matrix4x4A::Identity();
+	cameraToWorld.topLeftCorner<3, 3>() = Eigen::AngleAxisf(XMath::PI / 6, XMath::Vector3::UnitX()).toRotationMatrix();
+	cameraToWorld.topRightCorner<3, 1>() = XMath::Vector3(0.0f, 10.0f, -20.0f);
+	camera.view = XMath::Matrix::InverseAffine(cameraToWorld);
+	camera.proj = XMath::Matrix::PerspectiveFovLH(XMath::PI / 3, 16.0f / 9.0f, 0.1f, 1000.0f);
+	camera.viewProj = camera.proj * camera.view;
+	printf("%zu draws\n\n", drawCount);
+
+	struct Variant
+	{
+		const char* name;
+		bool constexprIDs;
+		void (*record)(PerObjectCBuffer&, const Camera&, const std::vector<XMath::Matrix4x4>&);
+	};
+	const Variant variants[] = {
+		{ "before", false, RecordDraws<false, false, false> },
+		{ "+ constexpr IDs", true, RecordDraws<true, false, false> },
+		{ "+ InverseAffine", true, RecordDraws<true, true, false> },
+		{ "+ cached ViewProj", true, RecordDraws<true, true, true> },
+	};
+
+	printf("%-20s %12s %12s %10s\n", "Variant", "total ms", "ns/draw", "speedup");
+	double baseline = 0.0;
+	for (const Variant& variant : variants)
+	{
+		PerObjectCBuffer cbuffer(variant.constexprIDs);
+		double ms = Bench::MeasureMilliseconds(repeat, [&]() { variant.record(cbuffer, camera, matrices); });
+		baseline = baseline > 0.0 ? baseline : ms;
+		printf("%-20s %12.3f %12.1f %9.2fx\n", variant.name, ms, ms * 1e6 / drawCount, baseline / ms);
+	}
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include "TestFramework.h"
+#include <InputLayoutCache.h>
+
+namespace
+{
+	D3D11_INPUT_ELEMENT_DESC Element(const char* semanticName, DXGI_FORMAT format, UINT inputSlot = 0, UINT semanticIndex = 0)
+	{
+		return { semanticName, semanticIndex, format, inputSlot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	}
+
+	uint64_t Hash(const std::vector<D3D11_INPUT_ELEMENT_DESC>& elements)
+	{
+		return InputLayoutCache::HashElements(elements.data(), (uint32_t)elements.size());
+	}
+
+	// 着色器签名中NORMAL的声明
+	const auto s_NormalFloat3 = Element("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT);
+	const auto s_NormalFloat2 = Element("NORMAL", DXGI_FORMAT_R32G32_FLOAT);
+}
+
+TEST_CASE(HashIgnoresSemanticCase)
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> upper{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT), Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 1) };
+	std::vector<D3D11_INPUT_ELEMENT_DESC> lower{ Element("position", DXGI_FORMAT_R32G32B32_FLOAT), Element("TexCoord", DXGI_FORMAT_R32G32_FLOAT, 1) };
+	CHECK(Hash(upper) == Hash(lower));
+	CHECK(Hash({}) == InputLayoutCache::HashElements(nullptr, 0));
+}
+
+TEST_CASE(HashCoversEveryField)
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> elements{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT), Element("NORMAL", DXGI_FORMAT_R16G16_SNORM, 1) };
+	uint64_t hash = Hash(elements);
+
+	auto changed = [&elements, hash](auto modify) {
+		auto other = elements;
+		modify(other[1]);
+		return Hash(other) != hash;
+	};
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.SemanticName = "TANGENT"; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.SemanticIndex = 1; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.Format = DXGI_FORMAT_R32G32B32_FLOAT; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.InputSlot = 2; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.AlignedByteOffset = 12; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA; }));
+	CHECK(changed([](D3D11_INPUT_ELEMENT_DESC& e) { e.InstanceDataStepRate = 1; }));
+
+	// 顺序不同的布局不同
+	std::vector<D3D11_INPUT_ELEMENT_DESC> swapped{ elements[1], elements[0] };
+	CHECK(Hash(swapped) != hash);
+	// 语义名之间有分隔，"AB"+"C"与"A"+"BC"不同
+	CHECK(Hash({ Element("AB", DXGI_FORMAT_R32_FLOAT), Element("C", DXGI_FORMAT_R32_FLOAT) }) !=
+		Hash({ Element("A", DXGI_FORMAT_R32_FLOAT), Element("BC", DXGI_FORMAT_R32_FLOAT) }));
+}
+
+TEST_CASE(SemanticMatchingIgnoresCase)
+{
+	CHECK(InputLayoutCache::IsSameSemantic(Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT), Element("texcoord", DXGI_FORMAT_R16G16_FLOAT, 1)));
+	CHECK(!InputLayoutCache::IsSameSemantic(Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 0, 0), Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 0, 1)));
+	CHECK(!InputLayoutCache::IsSameSemantic(Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT), Element("TEXCOORD0", DXGI_FORMAT_R32G32_FLOAT)));
+
+	CHECK(InputLayoutCache::IsSystemValue("SV_VertexID"));
+	CHECK(InputLayoutCache::IsSystemValue("sv_InstanceID"));
+	CHECK(!InputLayoutCache::IsSystemValue("SV_"));
+	CHECK(!InputLayoutCache::IsSystemValue("POSITION"));
+	CHECK(!InputLayoutCache::IsSystemValue(nullptr));
+}
+
+TEST_CASE(StreamMustProvideEverySignatureInput)
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> stream{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT),
+		Element("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, 1), Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 2) };
+
+	// 着色器不使用的元素与系统值语义都不影响兼容性
+	CHECK(InputLayoutCache::IsCompatible(stream, { Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT) }));
+	CHECK(InputLayoutCache::IsCompatible(stream, { Element("position", DXGI_FORMAT_R32G32B32_FLOAT), Element("SV_VertexID", DXGI_FORMAT_R32_UINT) }));
+	CHECK(InputLayoutCache::IsCompatible({}, { Element("SV_VertexID", DXGI_FORMAT_R32_UINT) }));
+
+	CHECK(!InputLayoutCache::IsCompatible(stream, { Element("TANGENT", DXGI_FORMAT_R32G32B32A32_FLOAT) }));
+	CHECK(!InputLayoutCache::IsCompatible(stream, { Element("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 0, 1) }));
+}
+
+TEST_CASE(NormalFormatsMatchTheirDeclaration)
+{
+	auto position = Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT);
+	std::vector<D3D11_INPUT_ELEMENT_DESC> octahedral{ position, Element("NORMAL", DXGI_FORMAT_R16G16_SNORM, 1) };
+	std::vector<D3D11_INPUT_ELEMENT_DESC> snorm4{ position, Element("NORMAL", DXGI_FORMAT_R16G16B16A16_SNORM, 1) };
+	std::vector<D3D11_INPUT_ELEMENT_DESC> uncompressed{ position, Element("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, 1) };
+
+	// 八面体编码只能用于float2的声明，R16G16B16A16_SNORM只能用于float3/float4的声明
+	CHECK(InputLayoutCache::IsCompatible(octahedral, { position, s_NormalFloat2 }));
+	CHECK(!InputLayoutCache::IsCompatible(octahedral, { position, s_NormalFloat3 }));
+	CHECK(InputLayoutCache::IsCompatible(snorm4, { position, s_NormalFloat3 }));
+	CHECK(!InputLayoutCache::IsCompatible(snorm4, { position, s_NormalFloat2 }));
+	// 未压缩的法线只能用于float3/float4的声明，float2的声明会按八面体编码解码
+	CHECK(InputLayoutCache::IsCompatible(uncompressed, { position, s_NormalFloat3 }));
+	CHECK(!InputLayoutCache::IsCompatible(uncompressed, { position, s_NormalFloat2 }));
+	CHECK(!InputLayoutCache::IsCompatible({ position, s_NormalFloat2 }, { position, s_NormalFloat2 }));
+	// 只有NORMAL按压缩格式检查
+	CHECK(InputLayoutCache::IsCompatible({ Element("TEXCOORD", DXGI_FORMAT_R16G16_SNORM) }, { Element("TEXCOORD", DXGI_FORMAT_R32G32B32_FLOAT) }));
+}
+
+TEST_CASE(GetOrCreateRejectsInvalidArguments)
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> stream{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT) };
+	const uint8_t byteCode[4] = {};
+	ID3D11InputLayout* pInputLayout = nullptr;
+	auto& cache = InputLayoutCache::Get();
+	size_t layoutCount = cache.GetLayoutCount();
+	CHECK(cache.GetOrCreate(nullptr, 1, stream, Hash(stream), byteCode, sizeof byteCode, &pInputLayout) == E_INVALIDARG);
+	CHECK(!pInputLayout);
+	CHECK(cache.GetLayoutCount() == layoutCount);
+}
+
+// Stubs中的ID3D11Device只声明了少数几个方法，可以在测试中实现；Windows SDK中的接口则需要真实的设备
+#ifndef _WIN32
+namespace
+{
+	class FakeInputLayout : public ID3D11InputLayout
+	{
+	public:
+		ULONG AddRef() override { return ++m_RefCount; }
+		ULONG Release() override
+		{
+			ULONG refCount = --m_RefCount;
+			if (refCount == 0)
+				delete this;
+			return refCount;
+		}
+
+	private:
+		ULONG m_RefCount = 1;
+	};
+
+	class FakeDevice : public ID3D11Device
+	{
+	public:
+		ULONG AddRef() override { return 1; }
+		ULONG Release() override { return 1; }
+		HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout** ppInputLayout) override
+		{
+			++createCount;
+			if (fail)
+				return E_INVALIDARG;
+			*ppInputLayout = new FakeInputLayout;
+			return S_OK;
+		}
+		HRESULT CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) override { return E_INVALIDARG; }
+		HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState**) override { return E_INVALIDARG; }
+		HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) override { return E_INVALIDARG; }
+
+		int createCount = 0;
+		bool fail = false;
+	};
+}
+
+TEST_CASE(LayoutsAreSharedPerSignatureAndStream)
+{
+	InputLayoutCache cache;
+	FakeDevice device;
+	const uint8_t byteCode[4] = {};
+	std::vector<D3D11_INPUT_ELEMENT_DESC> stream{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT), Element("NORMAL", DXGI_FORMAT_R16G16_SNORM, 1) };
+	std::vector<D3D11_INPUT_ELEMENT_DESC> otherStream{ Element("POSITION", DXGI_FORMAT_R32G32B32_FLOAT), Element("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, 1) };
+	uint64_t streamHash = Hash(stream), otherStreamHash = Hash(otherStream);
+
+	// 签名与顶点流布局相同时只创建一次，与字节码无关
+	ID3D11InputLayout* pFirst = nullptr, * pSecond = nullptr;
+	CHECK(cache.GetOrCreate(&device, 1, stream, streamHash, byteCode, sizeof byteCode, &pFirst) == S_OK);
+	CHECK(cache.GetOrCreate(&device, 1, stream, streamHash, byteCode, 2, &pSecond) == S_OK);
+	CHECK(pFirst && pFirst == pSecond);
+	CHECK(device.createCount == 1 && cache.GetLayoutCount() == 1);
+
+	ID3D11InputLayout* pOtherSignature = nullptr, * pOtherStream = nullptr;
+	CHECK(cache.GetOrCreate(&device, 2, stream, streamHash, byteCode, sizeof byteCode, &pOtherSignature) == S_OK);
+	CHECK(cache.GetOrCreate(&device, 1, otherStream, otherStreamHash, byteCode, sizeof byteCode, &pOtherStream) == S_OK);
+	CHECK(pOtherSignature != pFirst && pOtherStream != pFirst && pOtherSignature != pOtherStream);
+	CHECK(device.createCount == 3 && cache.GetLayoutCount() == 3);
+
+	// 创建失败时不缓存，下次重新尝试
+	device.fail = true;
+	ID3D11InputLayout* pFailed = nullptr;
+	CHECK(FAILED(cache.GetOrCreate(&device, 3, stream, streamHash, byteCode, sizeof byteCode, &pFailed)));
+	CHECK(!pFailed && cache.GetLayoutCount() == 3);
+	device.fail = false;
+	CHECK(cache.GetOrCreate(&device, 3, stream, streamHash, byteCode, sizeof byteCode, &pFailed) == S_OK);
+	CHECK(pFailed && device.createCount == 5 && cache.GetLayoutCount() == 4);
+}
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// 测试与基准测试共用的合成网格，位置为紧密排列的float3，三角形为顺时针(左手坐标系下朝外)
+namespace TestMesh
+{
+	struct Mesh
+	{
+		std::vector<float> positions;
+		std::vector<uint32_t> indices;
+
+		size_t GetVertexCount() const { return positions.size() / 3; }
+	};
+
+	// xz平面上(n + 1) x (n + 1)个顶点的网格，朝+y
+	inline Mesh CreateGrid(uint32_t n)
+	{
+		Mesh mesh;
+		for (uint32_t i = 0; i <= n; ++i)
+		{
+			for (uint32_t j = 0; j <= n; ++j)
+				mesh.positions.insert(mesh.positions.end(), { (float)j, 0.0f, (float)i });
+		}
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			for (uint32_t j = 0; j < n; ++j)
+			{
+				uint32_t v0 = i * (n + 1) + j, v1 = v0 + 1, v2 = v0 + n + 1, v3 = v2 + 1;
+				mesh.indices.insert(mesh.indices.end(), { v0, v2, v1, v1, v2, v3 });
+			}
+		}
+		return mesh;
+	}
+
+	// 将球体追加到mesh中
+	inline void AppendSphere(Mesh& mesh, float cx, float cy, float cz, float radius, uint32_t levels, uint32_t slices)
+	{
+		uint32_t base = (uint32_t)mesh.GetVertexCount();
+		for (uint32_t i = 0; i <= levels; ++i)
+		{
+			float theta = 3.14159265f * i / levels;
+			for (uint32_t j = 0; j <= slices; ++j)
+			{
+				float phi = 6.28318531f * j / slices;
+				mesh.positions.insert(mesh.positions.end(), { cx + radius * std::sin(theta) * std::cos(phi),
+					cy + radius * std::cos(theta), cz + radius * std::sin(theta) * std::sin(phi) });
+			}
+		}
+		for (uint32_t i = 0; i < levels; ++i)
+		{
+			for (uint32_t j = 0; j < slices; ++j)
+			{
+				uint32_t v0 = base + i * (slices + 1) + j, v1 = v0 + 1, v2 = v0 + slices + 1, v3 = v2 + 1;
+				mesh.indices.insert(mesh.indices.end(), { v0, v1, v2, v1, v3, v2 });
+			}
+		}
+	}
+
+	inline Mesh CreateSphere(uint32_t levels, uint32_t slices)
+	{
+		Mesh mesh;
+		AppendSphere(mesh, 0.0f, 0.0f, 0.0f, 1.0f, levels, slices);
+		return mesh;
+	}
+
+	// 多个互相遮挡的球体组成的网格，用于测量过度绘制
+	inline Mesh CreateSphereCluster(uint32_t sphereCount, uint32_t levels, uint32_t slices, uint32_t seed = 1)
+	{
+		Mesh mesh;
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f), radius(0.3f, 0.6f);
+		for (uint32_t i = 0; i < sphereCount; ++i)
+			AppendSphere(mesh, offset(rng), offset(rng), offset(rng), radius(rng), levels, slices);
+		return mesh;
+	}
+
+	// 打乱三角形的顺序，模拟未经优化的导入顺序
+	inline void ShuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed = 1)
+	{
+		size_t triangleCount = indices.size() / 3;
+		std::vector<uint32_t> order(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i)
+			order[i] = (uint32_t)i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t t : order)
+			result.insert(result.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+		indices.swap(result);
+	}
+
+	// 旋转每个三角形使最小的索引在前(保持环绕方向)并排序，用于比较两个索引列表的三角形集合是否相同
+	inline std::vector<std::array<uint32_t, 3>> GetSortedTriangles(const uint32_t* pIndices, size_t indexCount)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i + 3 <= indexCount; i += 3)
+		{
+			std::array<uint32_t, 3> tri{ pIndices[i], pIndices[i + 1], pIndices[i + 2] };
+			std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+			triangles.push_back(tri);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
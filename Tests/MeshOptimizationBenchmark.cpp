@@ -0,0 +1,241 @@
+// 网格优化的离线测量：顶点缓存优化、过度绘制优化与顶点读取优化前后的ACMR、ATVR与过度绘制
+// 过度绘制由一个CPU光栅化器从多个方向正交投影网格测得：通过深度测试(LESS)的像素数 / 被覆盖的像素数，开启背面剔除
+//   MeshOptimizationBenchmark [--quick] [model.obj ...]
+#include "Benchmark.h"
+#include "MeshGenerators.h"
+#include <Utils/MeshUtility.h>
+#include <cfloat>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	// 只读取位置与面，多边形按扇形三角化
+	bool LoadObj(const char* path, TestMesh::Mesh& mesh)
+	{
+		std::ifstream fin(path);
+		if (!fin)
+			return false;
+		std::string line;
+		while (std::getline(fin, line))
+		{
+			std::istringstream iss(line);
+			std::string type;
+			iss >> type;
+			if (type == "v")
+			{
+				float x = 0.0f, y = 0.0f, z = 0.0f;
+				iss >> x >> y >> z;
+				mesh.positions.insert(mesh.positions.end(), { x, y, z });
+			}
+			else if (type == "f")
+			{
+				std::vector<uint32_t> face;
+				std::string token;
+				while (iss >> token)
+				{
+					long index = std::stol(token.substr(0, token.find('/')));
+					face.push_back((uint32_t)(index < 0 ? (long)mesh.GetVertexCount() + index : index - 1));
+				}
+				for (size_t i = 2; i < face.size(); ++i)
+					mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+			}
+		}
+		return !mesh.indices.empty();
+	}
+
+	struct Vec3
+	{
+		float x, y, z;
+	};
+
+	Vec3 Sub(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	Vec3 Normalize(const Vec3& v)
+	{
+		float length = std::sqrt(Dot(v, v));
+		return { v.x / length, v.y / length, v.z / length };
+	}
+
+	class OverdrawAnalyzer
+	{
+	public:
+		OverdrawAnalyzer(uint32_t resolution, uint32_t viewCount)
+			: m_Resolution(resolution)
+		{
+			// 均匀分布在球面上的观察方向
+			for (uint32_t i = 0; i < viewCount; ++i)
+			{
+				float y = 1.0f - 2.0f * (i + 0.5f) / viewCount;
+				float r = std::sqrt(1.0f - y * y);
+				float phi = 2.39996323f * i;
+				m_Directions.push_back({ r * std::cos(phi), y, r * std::sin(phi) });
+			}
+		}
+
+		// 所有方向上的平均过度绘制
+		float Analyze(const TestMesh::Mesh& mesh)
+		{
+			uint64_t shaded = 0, covered = 0;
+			for (const Vec3& forward : m_Directions)
+				Rasterize(mesh, forward, shaded, covered);
+			return covered ? (float)shaded / covered : 0.0f;
+		}
+
+	private:
+		void Rasterize(const TestMesh::Mesh& mesh, const Vec3& forward, uint64_t& shaded, uint64_t& covered)
+		{
+			Vec3 up = std::fabs(forward.y) < 0.99f ? Vec3{ 0.0f, 1.0f, 0.0f } : Vec3{ 1.0f, 0.0f, 0.0f };
+			Vec3 right = Normalize(Cross(up, forward));
+			up = Cross(forward, right);
+
+			// 投影到屏幕空间(x, y为像素坐标，z为深度)
+			size_t vertexCount = mesh.GetVertexCount();
+			std::vector<Vec3> projected(vertexCount);
+			float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				Vec3 p{ mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2] };
+				projected[v] = { Dot(p, right), Dot(p, up), Dot(p, forward) };
+				minX = (std::min)(minX, projected[v].x);
+				minY = (std::min)(minY, projected[v].y);
+				maxX = (std::max)(maxX, projected[v].x);
+				maxY = (std::max)(maxY, projected[v].y);
+			}
+			float scale = (m_Resolution - 1) / (std::max)({ maxX - minX, maxY - minY, 1e-6f });
+			for (auto& p : projected)
+			{
+				p.x = (p.x - minX) * scale;
+				p.y = (p.y - minY) * scale;
+			}
+
+			std::vector<float> depth(m_Resolution * m_Resolution, FLT_MAX);
+			for (size_t i = 0; i + 3 <= mesh.indices.size(); i += 3)
+			{
+				const float* p0 = &mesh.positions[mesh.indices[i] * 3];
+				const float* p1 = &mesh.positions[mesh.indices[i + 1] * 3];
+				const float* p2 = &mesh.positions[mesh.indices[i + 2] * 3];
+				Vec3 normal = Cross(Sub({ p1[0], p1[1], p1[2] }, { p0[0], p0[1], p0[2] }), Sub({ p2[0], p2[1], p2[2] }, { p0[0], p0[1], p0[2] }));
+				// 顺时针为正面，正面的几何法线朝向摄像机
+				if (Dot(normal, forward) >= 0.0f)
+					continue;
+				shaded += DrawTriangle(projected[mesh.indices[i]], projected[mesh.indices[i + 1]], projected[mesh.indices[i + 2]], depth);
+			}
+			for (float d : depth)
+				covered += d != FLT_MAX ? 1 : 0;
+		}
+
+		uint64_t DrawTriangle(Vec3 a, Vec3 b, Vec3 c, std::vector<float>& depth)
+		{
+			float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (area == 0.0f)
+				return 0;
+			if (area < 0.0f)
+			{
+				std::swap(b, c);
+				area = -area;
+			}
+			int x0 = (std::max)(0, (int)std::floor((std::min)({ a.x, b.x, c.x })));
+			int y0 = (std::max)(0, (int)std::floor((std::min)({ a.y, b.y, c.y })));
+			int x1 = (std::min)((int)m_Resolution - 1, (int)std::ceil((std::max)({ a.x, b.x, c.x })));
+			int y1 = (std::min)((int)m_Resolution - 1, (int)std::ceil((std::max)({ a.y, b.y, c.y })));
+
+			uint64_t passed = 0;
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					float px = x + 0.5f, py = y + 0.5f;
+					float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+					float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+					float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+						continue;
+					float z = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+					float& d = depth[y * m_Resolution + x];
+					if (z < d)
+					{
+						d = z;
+						++passed;
+					}
+				}
+			}
+			return passed;
+		}
+
+		uint32_t m_Resolution;
+		std::vector<Vec3> m_Directions;
+	};
+
+	void Report(const char* stage, const TestMesh::Mesh& mesh, OverdrawAnalyzer& analyzer, double ms)
+	{
+		auto stats = MeshUtility::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+		printf("  %-14s ACMR %6.3f  ATVR %6.3f  overdraw %6.3f  %10.2f ms\n", stage, stats.acmr, stats.atvr, analyzer.Analyze(mesh), ms);
+	}
+
+	// 与MeshData::Optimize相同的处理顺序
+	void Run(const char* name, TestMesh::Mesh mesh, OverdrawAnalyzer& analyzer)
+	{
+		printf("%s: %zu vertices, %zu triangles\n", name, mesh.GetVertexCount(), mesh.indices.size() / 3);
+		Report("source", mesh, analyzer, 0.0);
+
+		double ms = Bench::MeasureMilliseconds(1, [&]() {
+			MeshUtility::OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+		});
+		Report("vertex cache", mesh, analyzer, ms);
+
+		ms = Bench::MeasureMilliseconds(1, [&]() {
+			MeshUtility::OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount());
+		});
+		Report("overdraw", mesh, analyzer, ms);
+
+		std::vector<uint32_t> remap;
+		std::vector<std::array<float, 3>> positions(mesh.GetVertexCount());
+		memcpy(positions.data(), mesh.positions.data(), mesh.positions.size() * sizeof(float));
+		ms = Bench::MeasureMilliseconds(1, [&]() {
+			MeshUtility::OptimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount(), remap);
+			MeshUtility::RemapVertices(positions, remap);
+		});
+		memcpy(mesh.positions.data(), positions.data(), mesh.positions.size() * sizeof(float));
+		Report("vertex fetch", mesh, analyzer, ms);
+		printf("\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = Bench::IsQuick(argc, argv);
+	OverdrawAnalyzer analyzer(quick ? 64 : 512, quick ? 4 : 16);
+
+	bool hasModel = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] == '-')
+			continue;
+		TestMesh::Mesh mesh;
+		if (!LoadObj(argv[i], mesh))
+		{
+			printf("Failed to load %s\n", argv[i]);
+			return 1;
+		}
+		Run(argv[i], std::move(mesh), analyzer);
+		hasModel = true;
+	}
+	if (hasModel)
+		return 0;
+
+	uint32_t gridSize = quick ? 32 : 256;
+	auto grid = TestMesh::CreateGrid(gridSize);
+	TestMesh::ShuffleTriangles(grid.indices);
+	Run("Shuffled grid", std::move(grid), analyzer);
+
+	uint32_t sphereCount = quick ? 4 : 32;
+	uint32_t tessellation = quick ? 12 : 48;
+	auto cluster = TestMesh::CreateSphereCluster(sphereCount, tessellation, tessellation);
+	Run("Sphere cluster", cluster, analyzer);
+	TestMesh::ShuffleTriangles(cluster.indices);
+	Run("Shuffled sphere cluster", std::move(cluster), analyzer);
+	return 0;
+}
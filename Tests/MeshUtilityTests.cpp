@@ -0,0 +1,223 @@
+#include "TestFramework.h"
+#include "MeshGenerators.h"
+#include <Utils/MeshUtility.h>
+#include <cstring>
+
+TEST_CASE(IndexBitsAndNarrowingMatchScalar)
+{
+	std::vector<uint32_t> indices;
+	for (uint32_t i = 0; i < 37; ++i)
+		indices.push_back(70000 + i * 997 % 60000);
+	CHECK(MeshUtility::ComputeIndexBitsOr(indices.data(), indices.size()) > UINT16_MAX);
+
+	std::vector<uint16_t> narrowed(indices.size());
+	MeshUtility::NarrowIndices(indices.data(), narrowed.data(), indices.size(), 70000);
+	bool same = true;
+	for (size_t i = 0; i < indices.size(); ++i)
+		same = same && narrowed[i] == indices[i] - 70000;
+	CHECK(same);
+}
+
+TEST_CASE(SplitIndicesKeepsEachRangeWithin16Bits)
+{
+	// 两段相距很远的三角形
+	std::vector<uint32_t> indices{ 0, 1, 2, 3, 4, 5, 100000, 100001, 100002, 100003, 100004, 100005 };
+	std::vector<MeshUtility::IndexRange> ranges;
+	CHECK(MeshUtility::SplitIndicesFor16Bit(indices.data(), indices.size(), ranges));
+	CHECK(ranges.size() == 2);
+	CHECK(ranges[0].indexStart == 0 && ranges[0].indexCount == 6 && ranges[0].baseVertex == 0);
+	CHECK(ranges[1].indexStart == 6 && ranges[1].indexCount == 6 && ranges[1].baseVertex == 100000);
+
+	// 单个三角形跨度过大时无法划分
+	std::vector<uint32_t> wide{ 0, 1, 70000 };
+	CHECK(!MeshUtility::SplitIndicesFor16Bit(wide.data(), wide.size(), ranges));
+}
+
+TEST_CASE(VertexCacheStatisticsOfSingleQuad)
+{
+	uint32_t indices[6] = { 0, 1, 2, 2, 1, 3 };
+	auto stats = MeshUtility::AnalyzeVertexCache(indices, 6, 4);
+	CHECK(stats.verticesTransformed == 4 && stats.triangleCount == 2 && stats.vertexCount == 4);
+	CHECK(stats.acmr == 2.0f && stats.atvr == 1.0f);
+}
+
+TEST_CASE(VertexCacheOptimizationKeepsTrianglesAndLowersAcmr)
+{
+	auto mesh = TestMesh::CreateGrid(120);
+	TestMesh::ShuffleTriangles(mesh.indices);
+	auto triangles = TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size());
+	auto before = MeshUtility::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+
+	MeshUtility::OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+	auto after = MeshUtility::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+	CHECK(TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size()) == triangles);
+	CHECK(before.acmr > 2.5f);
+	CHECK(after.acmr < 0.8f);
+}
+
+TEST_CASE(OverdrawOptimizationKeepsTriangles)
+{
+	auto mesh = TestMesh::CreateSphereCluster(8, 16, 16);
+	TestMesh::ShuffleTriangles(mesh.indices);
+	auto triangles = TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size());
+	MeshUtility::OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+	auto optimized = MeshUtility::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+
+	MeshUtility::OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount());
+	auto after = MeshUtility::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.GetVertexCount());
+	CHECK(TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size()) == triangles);
+	// 簇的划分只允许ACMR小幅上升
+	CHECK(after.acmr <= optimized.acmr * 1.1f);
+}
+
+// 第一个三角形是退化的(顶点重复，未命中少于3次)时，它之前不能有三角形被丢弃
+TEST_CASE(OverdrawOptimizationKeepsLeadingDegenerateTriangle)
+{
+	auto mesh = TestMesh::CreateGrid(10);
+	mesh.indices.insert(mesh.indices.begin(), { 5, 5, 6 });
+	auto triangles = TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size());
+
+	MeshUtility::OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount());
+	CHECK(TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size()) == triangles);
+}
+
+TEST_CASE(VertexFetchOptimizationFollowsFirstUse)
+{
+	std::vector<uint32_t> indices{ 4, 2, 0, 2, 4, 5 };
+	std::vector<uint32_t> remap;
+	size_t referenced = MeshUtility::OptimizeVertexFetch(indices.data(), indices.size(), 7, remap);
+	CHECK(referenced == 4);
+	CHECK((indices == std::vector<uint32_t>{ 0, 1, 2, 1, 0, 3 }));
+	// 未被引用的顶点1、3、6按原顺序放在最后
+	CHECK(remap[4] == 0 && remap[2] == 1 && remap[0] == 2 && remap[5] == 3);
+	CHECK(remap[1] == 4 && remap[3] == 5 && remap[6] == 6);
+
+	std::vector<int> attributes{ 0, 1, 2, 3, 4, 5, 6 };
+	MeshUtility::RemapVertices(attributes, remap);
+	CHECK((attributes == std::vector<int>{ 4, 2, 0, 5, 1, 3, 6 }));
+}
+
+namespace
+{
+	// 包含所有位置的视锥体(6个平面都离原点很远)
+	void GetInfinitePlanes(float* pPlanes)
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			float plane[4] = { 0.0f, 0.0f, 0.0f, 1e6f };
+			plane[i / 2] = i % 2 ? -1.0f : 1.0f;
+			memcpy(pPlanes + i * 4, plane, sizeof plane);
+		}
+	}
+
+	bool IsFrontFacing(const TestMesh::Mesh& mesh, const uint32_t* tri, const float* pEye)
+	{
+		const float* p0 = &mesh.positions[tri[0] * 3];
+		const float* p1 = &mesh.positions[tri[1] * 3];
+		const float* p2 = &mesh.positions[tri[2] * 3];
+		float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		return n[0] * (pEye[0] - p0[0]) + n[1] * (pEye[1] - p0[1]) + n[2] * (pEye[2] - p0[2]) > 0.0f;
+	}
+}
+
+TEST_CASE(MeshletsRespectLimitsAndCoverAllTriangles)
+{
+	auto mesh = TestMesh::CreateSphere(64, 64);
+	TestMesh::ShuffleTriangles(mesh.indices);
+	auto triangles = TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size());
+
+	std::vector<MeshUtility::Meshlet> meshlets;
+	MeshUtility::BuildMeshlets(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount(), meshlets, 64, 124);
+	CHECK(TestMesh::GetSortedTriangles(mesh.indices.data(), mesh.indices.size()) == triangles);
+
+	bool withinLimits = true, contiguous = true, bounded = true;
+	uint32_t nextIndex = 0;
+	for (const auto& meshlet : meshlets)
+	{
+		contiguous = contiguous && meshlet.indexStart == nextIndex && meshlet.baseVertex == 0;
+		nextIndex = meshlet.indexStart + meshlet.indexCount;
+		withinLimits = withinLimits && meshlet.vertexCount <= 64 && meshlet.indexCount <= 124 * 3 && meshlet.indexCount > 0;
+		for (uint32_t i = meshlet.indexStart; i < nextIndex; ++i)
+		{
+			const float* p = &mesh.positions[mesh.indices[i] * 3];
+			float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+			bounded = bounded && std::sqrt(dx * dx + dy * dy + dz * dz) <= meshlet.radius * 1.0001f;
+		}
+	}
+	CHECK(withinLimits);
+	CHECK(contiguous && nextIndex == mesh.indices.size());
+	CHECK(bounded);
+	// 簇沿邻接关系生长，规整的网格上平均三角形数应超过上限的一半
+	CHECK(mesh.indices.size() / 3 / meshlets.size() > 62);
+}
+
+// 背面剔除是保守的：被剔除的簇中不能有朝向摄像机的三角形
+TEST_CASE(MeshletConeCullingIsConservative)
+{
+	auto mesh = TestMesh::CreateSphereCluster(4, 24, 24);
+	std::vector<MeshUtility::Meshlet> meshlets;
+	MeshUtility::BuildMeshlets(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount(), meshlets);
+
+	float planes[24];
+	GetInfinitePlanes(planes);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coordinate(-6.0f, 6.0f);
+	bool conservative = true;
+	size_t culledCount = 0;
+	for (int camera = 0; camera < 32; ++camera)
+	{
+		float eye[3] = { coordinate(rng), coordinate(rng), 5.0f };
+		std::vector<MeshUtility::IndexRange> ranges;
+		MeshUtility::CullMeshlets(meshlets.data(), meshlets.size(), planes, eye, ranges);
+
+		std::vector<uint8_t> visible(mesh.indices.size() / 3, 0);
+		for (const auto& range : ranges)
+			std::fill_n(visible.begin() + range.indexStart / 3, range.indexCount / 3, (uint8_t)1);
+		for (size_t t = 0; t < visible.size(); ++t)
+		{
+			culledCount += visible[t] ? 0 : 1;
+			conservative = conservative && (visible[t] || !IsFrontFacing(mesh, &mesh.indices[t * 3], eye));
+		}
+	}
+	CHECK(conservative);
+	CHECK(culledCount > 0);
+}
+
+TEST_CASE(MeshletFrustumCullingKeepsIntersectingClusters)
+{
+	auto mesh = TestMesh::CreateGrid(64);
+	std::vector<MeshUtility::Meshlet> meshlets;
+	MeshUtility::BuildMeshlets(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount(), meshlets);
+
+	// 只保留x <= 20的部分
+	float planes[24];
+	GetInfinitePlanes(planes);
+	planes[4 * 1 + 3] = 20.0f;
+	float eye[3] = { 32.0f, 100.0f, 32.0f };
+	std::vector<MeshUtility::IndexRange> ranges;
+	MeshUtility::CullMeshlets(meshlets.data(), meshlets.size(), planes, eye, ranges);
+
+	std::vector<uint8_t> visible(mesh.indices.size() / 3, 0);
+	size_t visibleCount = 0;
+	for (const auto& range : ranges)
+	{
+		std::fill_n(visible.begin() + range.indexStart / 3, range.indexCount / 3, (uint8_t)1);
+		visibleCount += range.indexCount / 3;
+	}
+	bool kept = true;
+	for (size_t t = 0; t < visible.size(); ++t)
+	{
+		const uint32_t* tri = &mesh.indices[t * 3];
+		bool inside = mesh.positions[tri[0] * 3] <= 20.0f || mesh.positions[tri[1] * 3] <= 20.0f || mesh.positions[tri[2] * 3] <= 20.0f;
+		kept = kept && (!inside || visible[t]);
+	}
+	CHECK(kept);
+	CHECK(visibleCount < visible.size());
+
+	// 全部可见时相邻的簇合并为一个区间
+	GetInfinitePlanes(planes);
+	MeshUtility::CullMeshlets(meshlets.data(), meshlets.size(), planes, eye, ranges);
+	CHECK(ranges.size() == 1 && ranges[0].indexStart == 0 && ranges[0].indexCount == mesh.indices.size());
+}
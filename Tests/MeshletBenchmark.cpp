@@ -0,0 +1,123 @@
+// 簇的构建与剔除的吞吐量
+// 构建：BuildMeshlets处理的三角形数/秒，以及簇的数量与平均大小
+// 剔除：从球面上随机位置看向网格中心，CullMeshlets处理的簇数/秒与剩余三角形的比例
+//   MeshletBenchmark [--quick]
+#include "Benchmark.h"
+#include "MeshGenerators.h"
+#include <Utils/MeshUtility.h>
+
+namespace
+{
+	// 位于eye、看向原点的透视视锥体，平面法向朝内
+	void GetFrustumPlanes(const float* eye, float fovY, float aspect, float nearZ, float farZ, float* pPlanes)
+	{
+		auto normalize = [](float* v) {
+			float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			v[0] /= length, v[1] /= length, v[2] /= length;
+		};
+		auto cross = [](const float* a, const float* b, float* out) {
+			out[0] = a[1] * b[2] - a[2] * b[1];
+			out[1] = a[2] * b[0] - a[0] * b[2];
+			out[2] = a[0] * b[1] - a[1] * b[0];
+		};
+
+		float forward[3] = { -eye[0], -eye[1], -eye[2] };
+		normalize(forward);
+		float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+		if (std::fabs(forward[1]) > 0.99f)
+			worldUp[1] = 0.0f, worldUp[0] = 1.0f;
+		float right[3], up[3];
+		cross(worldUp, forward, right);
+		normalize(right);
+		cross(forward, right, up);
+
+		float halfY = fovY * 0.5f;
+		float halfX = std::atan(std::tan(halfY) * aspect);
+		float normals[6][3];
+		for (int k = 0; k < 3; ++k)
+		{
+			normals[0][k] = forward[k];
+			normals[1][k] = -forward[k];
+			normals[2][k] = forward[k] * std::sin(halfX) + right[k] * std::cos(halfX);
+			normals[3][k] = forward[k] * std::sin(halfX) - right[k] * std::cos(halfX);
+			normals[4][k] = forward[k] * std::sin(halfY) + up[k] * std::cos(halfY);
+			normals[5][k] = forward[k] * std::sin(halfY) - up[k] * std::cos(halfY);
+		}
+		float eyeDotForward = eye[0] * forward[0] + eye[1] * forward[1] + eye[2] * forward[2];
+		for (int i = 0; i < 6; ++i)
+		{
+			memcpy(pPlanes + i * 4, normals[i], sizeof normals[i]);
+			pPlanes[i * 4 + 3] = -(normals[i][0] * eye[0] + normals[i][1] * eye[1] + normals[i][2] * eye[2]);
+		}
+		pPlanes[3] = -(eyeDotForward + nearZ);
+		pPlanes[7] = eyeDotForward + farZ;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = Bench::IsQuick(argc, argv);
+	uint32_t tessellation = quick ? 64 : 362;
+	int repeat = quick ? 1 : 5;
+	int cameraCount = quick ? 16 : 1024;
+
+	auto source = TestMesh::CreateSphere(tessellation, tessellation);
+	MeshUtility::OptimizeVertexCache(source.indices.data(), source.indices.size(), source.GetVertexCount());
+	size_t triangleCount = source.indices.size() / 3;
+	printf("Sphere: %zu vertices, %zu triangles\n\n", source.GetVertexCount(), triangleCount);
+
+	//
+	// 构建
+	//
+	printf("%-16s %10s %10s %12s %12s\n", "Limits", "meshlets", "avg tris", "build ms", "Mtri/s");
+	const uint32_t limits[][2] = { { 64, 124 }, { 128, 256 }, { 32, 64 } };
+	std::vector<MeshUtility::Meshlet> meshlets;
+	TestMesh::Mesh mesh;
+	for (int l = 2; l >= 0; --l)
+	{
+		// 每次都从同样的三角形顺序开始，最后保留默认上限的结果用于剔除
+		double ms = Bench::MeasureMilliseconds(repeat, [&]() {
+			mesh = source;
+			MeshUtility::BuildMeshlets(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), 3, mesh.GetVertexCount(),
+				meshlets, limits[l][0], limits[l][1]);
+		});
+		char name[32];
+		snprintf(name, sizeof name, "%u v / %u t", limits[l][0], limits[l][1]);
+		printf("%-16s %10zu %10.1f %12.3f %12.2f\n", name, meshlets.size(), (double)triangleCount / meshlets.size(),
+			ms, triangleCount / ms / 1000.0);
+	}
+
+	//
+	// 剔除
+	//
+	std::vector<std::array<float, 24>> frustums(cameraCount);
+	std::vector<std::array<float, 3>> eyes(cameraCount);
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f), distance(1.5f, 6.0f);
+	for (int c = 0; c < cameraCount; ++c)
+	{
+		float v[3] = { unit(rng), unit(rng), unit(rng) };
+		float scale = distance(rng) / std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + 1e-6f);
+		eyes[c] = { v[0] * scale, v[1] * scale, v[2] * scale };
+		// 视野较窄，近处的摄像机只能看到网格的一部分
+		GetFrustumPlanes(eyes[c].data(), 0.6f, 16.0f / 9.0f, 0.1f, 100.0f, frustums[c].data());
+	}
+
+	std::vector<MeshUtility::IndexRange> ranges;
+	size_t visibleTriangles = 0, rangeCount = 0;
+	double ms = Bench::MeasureMilliseconds(repeat, [&]() {
+		visibleTriangles = rangeCount = 0;
+		for (int c = 0; c < cameraCount; ++c)
+		{
+			MeshUtility::CullMeshlets(meshlets.data(), meshlets.size(), frustums[c].data(), eyes[c].data(), ranges);
+			rangeCount += ranges.size();
+			for (const auto& range : ranges)
+				visibleTriangles += range.indexCount / 3;
+		}
+	});
+	printf("\nCull: %d cameras x %zu meshlets in %.3f ms, %.1f M meshlets/s\n", cameraCount, meshlets.size(), ms,
+		cameraCount * meshlets.size() / ms / 1000.0);
+	printf("Visible triangles %.1f%%, %.1f draw ranges per camera\n",
+		100.0 * visibleTriangles / ((double)triangleCount * cameraCount), (double)rangeCount / cameraCount);
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include "TestFramework.h"
+#include <RenderGraphCompiler.h>
+
+namespace
+{
+	using Compiler = RenderGraphCompiler;
+	constexpr uint32_t s_Invalid = Compiler::s_InvalidIndex;
+
+	Compiler::ResourceNode Transient(uint32_t descClass, uint64_t byteSize)
+	{
+		Compiler::ResourceNode node;
+		node.descClass = descClass;
+		node.byteSize = byteSize;
+		return node;
+	}
+
+	Compiler::ResourceNode Imported()
+	{
+		Compiler::ResourceNode node;
+		node.imported = true;
+		return node;
+	}
+
+	Compiler::PassNode Pass(std::vector<uint32_t> reads, std::vector<uint32_t> writes, bool hasSideEffect = false)
+	{
+		Compiler::PassNode node;
+		node.reads = std::move(reads);
+		node.writes = std::move(writes);
+		node.hasSideEffect = hasSideEffect;
+		return node;
+	}
+}
+
+// 0: BackBuffer(导入)
+// Pass0写GBuffer(1) -> Pass1读1写Lighting(2) -> Pass2读2写BackBuffer；Pass3写Debug(3)但无人读取
+TEST_CASE(PassesWithoutConsumersAreCulled)
+{
+	std::vector<Compiler::ResourceNode> resources{ Imported(), Transient(0, 100), Transient(0, 100), Transient(1, 50) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 1 }),
+		Pass({ 1 }, { 2 }),
+		Pass({ 2 }, { 0 }),
+		Pass({}, { 3 }),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(!result.passCulled[0] && !result.passCulled[1] && !result.passCulled[2]);
+	CHECK(result.passCulled[3]);
+	CHECK(result.firstUse[3] == s_Invalid && result.physicalIndex[3] == s_Invalid);
+}
+
+// 只为被剔除的Pass生产数据的Pass也会被剔除
+TEST_CASE(CullingPropagatesToProducers)
+{
+	std::vector<Compiler::ResourceNode> resources{ Imported(), Transient(0, 10), Transient(0, 10) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 1 }),
+		Pass({ 1 }, { 2 }),
+		Pass({}, { 0 }),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(result.passCulled[0] && result.passCulled[1]);
+	CHECK(!result.passCulled[2]);
+	CHECK(result.transientBytes == 0);
+}
+
+TEST_CASE(SideEffectPassesAreKept)
+{
+	std::vector<Compiler::ResourceNode> resources{ Transient(0, 10) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 0 }),
+		Pass({ 0 }, {}, true),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(!result.passCulled[0] && !result.passCulled[1]);
+	CHECK(result.firstUse[0] == 0 && result.lastUse[0] == 1);
+}
+
+// A(0, 1) B(1, 2) C(2, 3) D(3, 4)：A与C、B与D的生命周期不重叠
+// 注意Pass下标相同视为重叠：前一个资源的最后一次使用与后一个资源的首次使用在同一Pass时不能共用
+TEST_CASE(NonOverlappingLifetimesAlias)
+{
+	std::vector<Compiler::ResourceNode> resources{
+		Imported(), Transient(0, 100), Transient(0, 100), Transient(0, 100), Transient(0, 100) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 1 }),
+		Pass({ 1 }, { 2 }),
+		Pass({ 2 }, { 3 }),
+		Pass({ 3 }, { 4 }),
+		Pass({ 4 }, { 0 }),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(result.firstUse[1] == 0 && result.lastUse[1] == 1);
+	CHECK(result.firstUse[4] == 3 && result.lastUse[4] == 4);
+	CHECK(result.physicalIndex[1] == result.physicalIndex[3]);
+	CHECK(result.physicalIndex[2] == result.physicalIndex[4]);
+	CHECK(result.physicalIndex[1] != result.physicalIndex[2]);
+	CHECK(result.physicalDescClasses.size() == 2);
+	CHECK(result.transientBytesWithoutAliasing == 400);
+	CHECK(result.transientBytes == 200);
+	CHECK(result.peakLiveBytes == 200);
+	CHECK(result.physicalIndex[0] == s_Invalid);
+}
+
+TEST_CASE(DifferentDescriptionsNeverAlias)
+{
+	std::vector<Compiler::ResourceNode> resources{ Imported(), Transient(0, 100), Transient(1, 100) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 1 }),
+		Pass({ 1 }, { 0 }),
+		Pass({}, { 2 }),
+		Pass({ 2 }, { 0 }),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(result.lastUse[1] < result.firstUse[2]);
+	CHECK(result.physicalIndex[1] != result.physicalIndex[2]);
+	CHECK(result.physicalDescClasses[result.physicalIndex[1]] == 0);
+	CHECK(result.physicalDescClasses[result.physicalIndex[2]] == 1);
+	CHECK(result.transientBytes == 200);
+	CHECK(result.peakLiveBytes == 100);
+}
+
+// 多个空闲的物理资源可用时选择最早空闲的那个
+TEST_CASE(EarliestFreedPhysicalResourceIsReused)
+{
+	std::vector<Compiler::ResourceNode> resources{
+		Imported(), Transient(0, 10), Transient(0, 10), Transient(0, 10) };
+	std::vector<Compiler::PassNode> passes{
+		Pass({}, { 1, 2 }),
+		Pass({ 1 }, { 0 }),
+		Pass({ 2 }, { 0 }),
+		Pass({}, { 3 }),
+		Pass({ 3 }, { 0 }),
+	};
+	auto result = Compiler::Compile(resources, passes);
+	CHECK(result.lastUse[1] == 1 && result.lastUse[2] == 2);
+	CHECK(result.physicalIndex[3] == result.physicalIndex[1]);
+	CHECK(result.physicalDescClasses.size() == 2);
+}
@@ -0,0 +1,211 @@
+#include "TestFramework.h"
+#include <RenderStateCache.h>
+#include <cstring>
+
+namespace
+{
+	// 先用非零字节填满，确认规范化会清零填充字节与未赋值的字段
+	template<class Desc>
+	Desc Garbage(uint8_t fill)
+	{
+		Desc desc;
+		memset(&desc, fill, sizeof desc);
+		return desc;
+	}
+
+	D3D11_RASTERIZER_DESC DefaultRasterizer(uint8_t fill = 0)
+	{
+		auto desc = Garbage<D3D11_RASTERIZER_DESC>(fill);
+		desc.FillMode = D3D11_FILL_SOLID;
+		desc.CullMode = D3D11_CULL_BACK;
+		desc.FrontCounterClockwise = FALSE;
+		desc.DepthBias = 0;
+		desc.DepthBiasClamp = 0.0f;
+		desc.SlopeScaledDepthBias = 0.0f;
+		desc.DepthClipEnable = TRUE;
+		desc.ScissorEnable = FALSE;
+		desc.MultisampleEnable = FALSE;
+		desc.AntialiasedLineEnable = FALSE;
+		return desc;
+	}
+
+	D3D11_DEPTH_STENCILOP_DESC StencilOp(D3D11_STENCIL_OP passOp, D3D11_COMPARISON_FUNC func)
+	{
+		return { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, passOp, func };
+	}
+
+	D3D11_DEPTH_STENCIL_DESC DefaultDepthStencil(uint8_t fill = 0)
+	{
+		auto desc = Garbage<D3D11_DEPTH_STENCIL_DESC>(fill);
+		desc.DepthEnable = TRUE;
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+		desc.DepthFunc = D3D11_COMPARISON_LESS;
+		desc.StencilEnable = FALSE;
+		desc.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+		desc.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+		desc.FrontFace = desc.BackFace = StencilOp(D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS);
+		return desc;
+	}
+
+	D3D11_RENDER_TARGET_BLEND_DESC AlphaBlend()
+	{
+		return { TRUE, D3D11_BLEND_SRC_ALPHA, D3D11_BLEND_INV_SRC_ALPHA, D3D11_BLEND_OP_ADD,
+			D3D11_BLEND_ONE, D3D11_BLEND_ZERO, D3D11_BLEND_OP_ADD, D3D11_COLOR_WRITE_ENABLE_ALL };
+	}
+
+	D3D11_BLEND_DESC DefaultBlend(uint8_t fill = 0)
+	{
+		auto desc = Garbage<D3D11_BLEND_DESC>(fill);
+		desc.AlphaToCoverageEnable = FALSE;
+		desc.IndependentBlendEnable = FALSE;
+		desc.RenderTarget[0] = { FALSE, D3D11_BLEND_ONE, D3D11_BLEND_ZERO, D3D11_BLEND_OP_ADD,
+			D3D11_BLEND_ONE, D3D11_BLEND_ZERO, D3D11_BLEND_OP_ADD, D3D11_COLOR_WRITE_ENABLE_ALL };
+		return desc;
+	}
+
+	template<class Desc>
+	bool IsSameNormalized(const Desc& lhs, const Desc& rhs)
+	{
+		Desc l = RenderStateDesc::Normalize(lhs), r = RenderStateDesc::Normalize(rhs);
+		return memcmp(&l, &r, sizeof l) == 0 && RenderStateDesc::Hash(lhs) == RenderStateDesc::Hash(rhs);
+	}
+}
+
+TEST_CASE(RasterizerEquivalentDescsMatch)
+{
+	auto desc = DefaultRasterizer();
+	CHECK(IsSameNormalized(desc, DefaultRasterizer(0xcd)));
+
+	// 任意非零值都视为TRUE
+	auto nonCanonicalBool = desc;
+	nonCanonicalBool.DepthClipEnable = 2;
+	CHECK(IsSameNormalized(desc, nonCanonicalBool));
+
+	auto negativeZero = desc;
+	negativeZero.SlopeScaledDepthBias = -0.0f;
+	CHECK(IsSameNormalized(desc, negativeZero));
+
+	// 没有深度偏移时Clamp被忽略
+	auto clampOnly = desc;
+	clampOnly.DepthBiasClamp = 0.5f;
+	CHECK(IsSameNormalized(desc, clampOnly));
+}
+
+TEST_CASE(RasterizerDifferentDescsDiffer)
+{
+	auto desc = DefaultRasterizer();
+	auto noCull = desc;
+	noCull.CullMode = D3D11_CULL_NONE;
+	CHECK(!IsSameNormalized(desc, noCull));
+	CHECK(RenderStateDesc::Hash(desc) != RenderStateDesc::Hash(noCull));
+
+	auto wireframe = desc;
+	wireframe.FillMode = D3D11_FILL_WIREFRAME;
+	CHECK(!IsSameNormalized(desc, wireframe));
+
+	// 有深度偏移时Clamp生效
+	auto biased = desc;
+	biased.DepthBias = 100;
+	auto biasedClamped = biased;
+	biasedClamped.DepthBiasClamp = 0.5f;
+	CHECK(!IsSameNormalized(desc, biased));
+	CHECK(!IsSameNormalized(biased, biasedClamped));
+}
+
+TEST_CASE(DepthStencilIgnoresDisabledTests)
+{
+	auto desc = DefaultDepthStencil();
+	CHECK(IsSameNormalized(desc, DefaultDepthStencil(0xcd)));
+
+	// 关闭模板测试时模板的掩码与操作不起作用
+	auto stencilOps = desc;
+	stencilOps.StencilReadMask = 0x0f;
+	stencilOps.FrontFace = StencilOp(D3D11_STENCIL_OP_REPLACE, D3D11_COMPARISON_EQUAL);
+	CHECK(IsSameNormalized(desc, stencilOps));
+
+	// 关闭深度测试时写入掩码与比较函数不起作用
+	auto noDepth = desc;
+	noDepth.DepthEnable = FALSE;
+	auto noDepthOther = noDepth;
+	noDepthOther.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	noDepthOther.DepthFunc = D3D11_COMPARISON_GREATER;
+	CHECK(!IsSameNormalized(desc, noDepth));
+	CHECK(IsSameNormalized(noDepth, noDepthOther));
+}
+
+TEST_CASE(DepthStencilEnabledFieldsDiffer)
+{
+	auto desc = DefaultDepthStencil();
+	auto lessEqual = desc;
+	lessEqual.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+	CHECK(!IsSameNormalized(desc, lessEqual));
+
+	auto stencil = desc;
+	stencil.StencilEnable = TRUE;
+	stencil.FrontFace = StencilOp(D3D11_STENCIL_OP_REPLACE, D3D11_COMPARISON_ALWAYS);
+	auto stencilBackFace = stencil;
+	stencilBackFace.BackFace = StencilOp(D3D11_STENCIL_OP_INCR, D3D11_COMPARISON_ALWAYS);
+	auto stencilReadMask = stencil;
+	stencilReadMask.StencilReadMask = 0x0f;
+	CHECK(!IsSameNormalized(desc, stencil));
+	CHECK(!IsSameNormalized(stencil, stencilBackFace));
+	CHECK(!IsSameNormalized(stencil, stencilReadMask));
+}
+
+TEST_CASE(BlendIgnoresDisabledFactorsAndUnusedTargets)
+{
+	auto desc = DefaultBlend();
+	CHECK(IsSameNormalized(desc, DefaultBlend(0xcd)));
+
+	// 关闭混合时混合因子不起作用，写入掩码仍然有效
+	auto factors = desc;
+	factors.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	factors.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_MAX;
+	CHECK(IsSameNormalized(desc, factors));
+	auto noColorWrite = desc;
+	noColorWrite.RenderTarget[0].RenderTargetWriteMask = 0;
+	CHECK(!IsSameNormalized(desc, noColorWrite));
+
+	// 非独立混合只使用RenderTarget[0]
+	auto otherTargets = desc;
+	for (int i = 1; i < 8; ++i)
+		otherTargets.RenderTarget[i] = AlphaBlend();
+	CHECK(IsSameNormalized(desc, otherTargets));
+
+	auto transparent = desc;
+	transparent.RenderTarget[0] = AlphaBlend();
+	CHECK(!IsSameNormalized(desc, transparent));
+}
+
+TEST_CASE(IndependentBlendWithSameTargetsMatchesShared)
+{
+	auto shared = DefaultBlend();
+	shared.RenderTarget[0] = AlphaBlend();
+
+	auto independent = shared;
+	independent.IndependentBlendEnable = TRUE;
+	for (int i = 1; i < 8; ++i)
+		independent.RenderTarget[i] = AlphaBlend();
+	CHECK(IsSameNormalized(shared, independent));
+
+	// 任一渲染目标不同时保持独立混合
+	independent.RenderTarget[3].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_RED;
+	CHECK(!IsSameNormalized(shared, independent));
+	CHECK(RenderStateDesc::Normalize(independent).IndependentBlendEnable == TRUE);
+}
+
+TEST_CASE(CacheRejectsInvalidArguments)
+{
+	RenderStateCache& cache = RenderStateCache::Get();
+	auto rsDesc = DefaultRasterizer();
+	auto dsDesc = DefaultDepthStencil();
+	auto bsDesc = DefaultBlend();
+	ID3D11RasterizerState* pRasterizerState = nullptr;
+	ID3D11DepthStencilState* pDepthStencilState = nullptr;
+	ID3D11BlendState* pBlendState = nullptr;
+	CHECK(cache.CreateRasterizerState(nullptr, &rsDesc, &pRasterizerState) == E_INVALIDARG);
+	CHECK(cache.CreateDepthStencilState(nullptr, &dsDesc, &pDepthStencilState) == E_INVALIDARG);
+	CHECK(cache.CreateBlendState(nullptr, &bsDesc, &pBlendState) == E_INVALIDARG);
+	CHECK(!pRasterizerState && !pDepthStencilState && !pBlendState);
+	CHECK(cache.GetStateCount() == 0);
+}
@@ -0,0 +1,149 @@
+// 着色器缓存从打开到可用的时间：逐文件的.cso + .refl与单个归档文件的比较
+// 逐文件：每个入口点读取.cso与.refl，计算字节码哈希并反序列化反射数据(与ReadShaderReflection相同)
+// 归档：读入整个归档，Open后逐个FindByKey并反序列化反射数据
+// 引擎中的归档使用文件映射，这里只用标准库读入整个文件，两者都在文件位于系统缓存时测量
+//   ShaderArchiveBenchmark [--quick]
+#include "Benchmark.h"
+#include <ShaderArchive.h>
+#include <ShaderReflectionData.h>
+#include <Utils/Hash.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct CachedEntry
+	{
+		uint64_t cacheKey;
+		std::vector<uint8_t> blob;
+		std::vector<uint8_t> reflection;
+	};
+
+	// 与常见的顶点/像素着色器大小相近的字节码与反射数据
+	std::vector<CachedEntry> CreateEntries(uint32_t count)
+	{
+		std::mt19937 rng(9);
+		std::uniform_int_distribution<uint32_t> blobSize(1024, 8192), byteValue(0, 255);
+		std::vector<CachedEntry> entries(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			CachedEntry& entry = entries[i];
+			entry.cacheKey = Hash::FNV1a64(std::to_string(i));
+			entry.blob.resize(blobSize(rng));
+			for (uint8_t& b : entry.blob)
+				b = (uint8_t)byteValue(rng);
+
+			ShaderReflectionData data;
+			data.constantBuffers = {
+				{ "CBChangesEveryDraw", 0, 128, { { "x_Matrix_LocalToWorld", 0, 64 }, { "x_Matrix_WorldToLocal", 64, 64 } } },
+				{ "CBChangesEveryFrame", 1, 144, { { "x_Matrix_ViewProj", 0, 64 }, { "x_Matrix_View", 64, 64 }, { "g_EyePosW", 128, 12 } } },
+				{ "CBMaterial", 2, 32, { { "g_Color", 0, 16 }, { "g_Roughness", 16, 4 } } },
+			};
+			data.shaderResources = { { "g_DiffuseMap", 0, 4 }, { "g_NormalMap", 1, 4 } };
+			data.samplers = { { "g_Sam", 0, 0 } };
+			data.inputSignature = { { "POSITION", 0, 6, 0 }, { "NORMAL", 0, 6, 1 }, { "TEXCOORD", 0, 16, 2 } };
+			SerializeShaderReflection(data, Hash::HashBytes(entry.blob.data(), entry.blob.size()), entry.reflection);
+		}
+		return entries;
+	}
+
+	void WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+	{
+		std::ofstream fout(path, std::ios::out | std::ios::binary);
+		fout.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	}
+
+	bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& bytes)
+	{
+		std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!fin.is_open())
+			return false;
+		bytes.resize((size_t)fin.tellg());
+		fin.seekg(0, std::ios::beg);
+		fin.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+		return (bool)fin;
+	}
+
+	std::filesystem::path GetCsoPath(const std::filesystem::path& dir, uint64_t cacheKey, const char* extension)
+	{
+		return dir / (std::to_string(cacheKey) + extension);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = Bench::IsQuick(argc, argv);
+	int repeat = quick ? 1 : 5;
+	const uint32_t counts[] = { 64, 512 };
+
+	std::filesystem::path root = std::filesystem::temp_directory_path() / "XEngineShaderArchiveBenchmark";
+	printf("%8s %10s %14s %14s %10s\n", "Entries", "MB", "per-file ms", "archive ms", "speedup");
+	bool allLoaded = true;
+	for (uint32_t count : counts)
+	{
+		if (quick && count > 64)
+			break;
+		auto entries = CreateEntries(count);
+		std::filesystem::path dir = root / std::to_string(count);
+		std::filesystem::create_directories(dir);
+
+		ShaderArchiveWriter writer;
+		for (auto& entry : entries)
+		{
+			WriteFile(GetCsoPath(dir, entry.cacheKey, ".cso"), entry.blob);
+			WriteFile(GetCsoPath(dir, entry.cacheKey, ".refl"), entry.reflection);
+			writer.Add(entry.cacheKey, entry.cacheKey, entry.blob.data(), entry.blob.size(), entry.reflection.data(), entry.reflection.size());
+		}
+		std::vector<uint8_t> archiveBytes;
+		writer.Build(archiveBytes);
+		WriteFile(dir / "Shaders.xsar", archiveBytes);
+
+		uint32_t perFileLoaded = 0, archiveLoaded = 0;
+		double perFileMs = Bench::MeasureMilliseconds(repeat, [&]() {
+			perFileLoaded = 0;
+			std::vector<uint8_t> blob, reflectionBytes;
+			ShaderReflectionData reflection;
+			for (auto& entry : entries)
+			{
+				if (!ReadFile(GetCsoPath(dir, entry.cacheKey, ".cso"), blob) ||
+					!ReadFile(GetCsoPath(dir, entry.cacheKey, ".refl"), reflectionBytes))
+					continue;
+				uint64_t blobHash = Hash::HashBytes(blob.data(), blob.size());
+				perFileLoaded += DeserializeShaderReflection(reflectionBytes.data(), reflectionBytes.size(), blobHash, reflection);
+				Bench::DoNotOptimize(blob);
+			}
+		});
+
+		double archiveMs = Bench::MeasureMilliseconds(repeat, [&]() {
+			archiveLoaded = 0;
+			std::vector<uint8_t> bytes;
+			ShaderArchive archive;
+			if (!ReadFile(dir / "Shaders.xsar", bytes) || !archive.Open(bytes.data(), bytes.size()))
+				return;
+			ShaderReflectionData reflection;
+			for (auto& entry : entries)
+			{
+				const ShaderArchive::Entry* pEntry = archive.FindByKey(entry.cacheKey);
+				if (!pEntry)
+					continue;
+				archiveLoaded += DeserializeShaderReflection(archive.GetReflection(*pEntry), pEntry->reflectionSize, pEntry->blobHash, reflection);
+				Bench::DoNotOptimize(*pEntry);
+			}
+		});
+
+		allLoaded = allLoaded && perFileLoaded == count && archiveLoaded == count;
+		printf("%8u %10.2f %14.3f %14.3f %9.2fx\n", count, archiveBytes.size() / (1024.0 * 1024.0), perFileMs, archiveMs, perFileMs / archiveMs);
+	}
+
+	std::error_code ec;
+	std::filesystem::remove_all(root, ec);
+	if (!allLoaded)
+	{
+		printf("Some entries failed to load\n");
+		return 1;
+	}
+	return 0;
+}
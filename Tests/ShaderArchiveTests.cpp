@@ -0,0 +1,201 @@
+#include "TestFramework.h"
+#include <ShaderArchive.h>
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	struct SyntheticEntry
+	{
+		uint64_t cacheKey;
+		const char* name;
+		std::vector<uint8_t> blob;
+		std::vector<uint8_t> reflection;
+	};
+
+	std::vector<SyntheticEntry> CreateSyntheticEntries()
+	{
+		// 键不按顺序添加，最后一个没有反射数据
+		return {
+			{ 300, "Basic/VS.vs_5_0", std::vector<uint8_t>(37, 0x11), std::vector<uint8_t>(20, 0x21) },
+			{ 100, "Basic/PS.ps_5_0", std::vector<uint8_t>(64, 0x12), std::vector<uint8_t>(5, 0x22) },
+			{ 200, "Sky/VS.vs_5_0", std::vector<uint8_t>(1, 0x13), {} },
+		};
+	}
+
+	std::vector<uint8_t> BuildArchive(const std::vector<SyntheticEntry>& entries)
+	{
+		ShaderArchiveWriter writer;
+		for (auto& entry : entries)
+		{
+			writer.Add(entry.cacheKey, Hash::FNV1a64(entry.name), entry.blob.data(), entry.blob.size(),
+				entry.reflection.data(), entry.reflection.size());
+		}
+		std::vector<uint8_t> bytes;
+		writer.Build(bytes);
+		return bytes;
+	}
+
+	template<class T>
+	void Patch(std::vector<uint8_t>& bytes, size_t offset, T value)
+	{
+		memcpy(bytes.data() + offset, &value, sizeof value);
+	}
+
+	size_t EntryOffset(uint32_t index, size_t member)
+	{
+		return sizeof(ShaderArchive::Header) + index * sizeof(ShaderArchive::Entry) + member;
+	}
+
+	bool CanOpen(const std::vector<uint8_t>& bytes)
+	{
+		ShaderArchive archive;
+		return archive.Open(bytes.data(), bytes.size());
+	}
+}
+
+TEST_CASE(ArchiveRoundTrip)
+{
+	auto entries = CreateSyntheticEntries();
+	ShaderArchiveWriter writer;
+	for (auto& entry : entries)
+	{
+		writer.Add(entry.cacheKey, Hash::FNV1a64(entry.name), entry.blob.data(), entry.blob.size(),
+			entry.reflection.data(), entry.reflection.size());
+	}
+	// 相同的键只保留第一个
+	writer.Add(100, Hash::FNV1a64("Other/PS.ps_5_0"), entries[0].blob.data(), entries[0].blob.size(), nullptr, 0);
+	CHECK(writer.GetEntryCount() == 3);
+	std::vector<uint8_t> bytes;
+	writer.Build(bytes);
+
+	ShaderArchive archive;
+	CHECK(archive.Open(bytes.data(), bytes.size()));
+	CHECK(archive.GetEntryCount() == 3);
+	for (auto& expected : entries)
+	{
+		const ShaderArchive::Entry* pEntry = archive.FindByKey(expected.cacheKey);
+		CHECK(pEntry && pEntry == archive.FindByName(Hash::FNV1a64(expected.name)));
+		if (!pEntry)
+			continue;
+		CHECK(pEntry->blobSize == expected.blob.size() && pEntry->reflectionSize == expected.reflection.size());
+		CHECK(memcmp(archive.GetBlob(*pEntry), expected.blob.data(), expected.blob.size()) == 0);
+		CHECK(expected.reflection.empty() ||
+			memcmp(archive.GetReflection(*pEntry), expected.reflection.data(), expected.reflection.size()) == 0);
+		CHECK(pEntry->blobHash == Hash::HashBytes(expected.blob.data(), expected.blob.size()));
+		CHECK(reinterpret_cast<uintptr_t>(archive.GetBlob(*pEntry)) % ShaderArchive::s_DataAlignment == 0);
+	}
+	CHECK(archive.GetEntries()[0].cacheKey == 100 && archive.GetEntries()[2].cacheKey == 300);
+	CHECK(!archive.FindByKey(150) && !archive.FindByKey(400));
+	CHECK(!archive.FindByName(Hash::FNV1a64("Other/PS.ps_5_0")));
+
+	// 空归档同样可以打开
+	std::vector<uint8_t> emptyBytes;
+	ShaderArchiveWriter().Build(emptyBytes);
+	CHECK(archive.Open(emptyBytes.data(), emptyBytes.size()));
+	CHECK(archive.GetEntryCount() == 0 && !archive.FindByKey(100) && !archive.FindByName(0));
+}
+
+TEST_CASE(ArchiveRejectsEveryTruncation)
+{
+	auto bytes = BuildArchive(CreateSyntheticEntries());
+	ShaderArchive archive;
+	CHECK(archive.Open(bytes.data(), bytes.size()));
+	uint64_t dataEnd = 0;
+	for (uint32_t i = 0; i < archive.GetEntryCount(); ++i)
+	{
+		const ShaderArchive::Entry& entry = archive.GetEntries()[i];
+		dataEnd = (std::max)({ dataEnd, entry.blobOffset + entry.blobSize, entry.reflectionOffset + entry.reflectionSize });
+	}
+
+	bool allRejected = true, allPatchedRejected = true;
+	for (size_t size = 0; size < bytes.size(); ++size)
+	{
+		// 复制到刚好大小的缓冲区中，越界读取可以被地址检查工具发现
+		std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + size);
+		allRejected = allRejected && !CanOpen(truncated);
+		// 头部记录的大小与截断后一致时，仍需发现目录或数据越界
+		if (size >= sizeof(ShaderArchive::Header) && size < dataEnd)
+		{
+			Patch<uint64_t>(truncated, offsetof(ShaderArchive::Header, fileSize), size);
+			allPatchedRejected = allPatchedRejected && !CanOpen(truncated);
+		}
+	}
+	CHECK(allRejected);
+	CHECK(allPatchedRejected);
+
+	// 末尾多出数据同样视为不匹配
+	bytes.push_back(0);
+	CHECK(!CanOpen(bytes));
+}
+
+TEST_CASE(ArchiveRejectsMismatchedHeader)
+{
+	auto bytes = BuildArchive(CreateSyntheticEntries());
+	CHECK(CanOpen(bytes));
+	ShaderArchive archive;
+	CHECK(!archive.Open(nullptr, bytes.size()));
+
+	auto badMagic = bytes;
+	badMagic[0] ^= 0xff;
+	CHECK(!CanOpen(badMagic));
+
+	auto badVersion = bytes;
+	Patch<uint32_t>(badVersion, offsetof(ShaderArchive::Header, version), ShaderArchive::s_Version + 1);
+	CHECK(!CanOpen(badVersion));
+
+	auto hugeCount = bytes;
+	Patch<uint32_t>(hugeCount, offsetof(ShaderArchive::Header, entryCount), 0x7fffffff);
+	CHECK(!CanOpen(hugeCount));
+
+	// 目录按原样读取，要求数据的地址满足条目的对齐
+	std::vector<uint8_t> misaligned(bytes.size() + 1);
+	memcpy(misaligned.data() + 1, bytes.data(), bytes.size());
+	CHECK(!archive.Open(misaligned.data() + 1, bytes.size()));
+	CHECK(!archive.IsOpen());
+}
+
+TEST_CASE(ArchiveRejectsCorruptedEntries)
+{
+	auto bytes = BuildArchive(CreateSyntheticEntries());
+	uint64_t fileSize = bytes.size();
+	const uint32_t entryCount = 3;
+
+	// 数据超出文件末尾
+	auto pastEnd = bytes;
+	Patch<uint64_t>(pastEnd, EntryOffset(1, offsetof(ShaderArchive::Entry, blobOffset)), fileSize);
+	CHECK(!CanOpen(pastEnd));
+
+	auto hugeBlob = bytes;
+	Patch<uint32_t>(hugeBlob, EntryOffset(0, offsetof(ShaderArchive::Entry, blobSize)), 0xffffffff);
+	CHECK(!CanOpen(hugeBlob));
+
+	auto wrappedOffset = bytes;
+	Patch<uint64_t>(wrappedOffset, EntryOffset(2, offsetof(ShaderArchive::Entry, reflectionOffset)), ~0ull);
+	CHECK(!CanOpen(wrappedOffset));
+
+	// 数据与头部或目录重叠
+	auto overlapsHeader = bytes;
+	Patch<uint64_t>(overlapsHeader, EntryOffset(0, offsetof(ShaderArchive::Entry, blobOffset)), 0);
+	CHECK(!CanOpen(overlapsHeader));
+
+	auto overlapsDirectory = bytes;
+	Patch<uint64_t>(overlapsDirectory, EntryOffset(2, offsetof(ShaderArchive::Entry, reflectionOffset)),
+		EntryOffset(1, offsetof(ShaderArchive::Entry, cacheKey)));
+	CHECK(!CanOpen(overlapsDirectory));
+
+	// 条目必须按键升序排列，否则二分查找会漏掉条目
+	auto unsorted = bytes;
+	Patch<uint64_t>(unsorted, EntryOffset(0, offsetof(ShaderArchive::Entry, cacheKey)), 250);
+	CHECK(!CanOpen(unsorted));
+	auto duplicated = bytes;
+	Patch<uint64_t>(duplicated, EntryOffset(1, offsetof(ShaderArchive::Entry, cacheKey)), 100);
+	CHECK(!CanOpen(duplicated));
+
+	// 名称索引越界
+	auto badNameIndex = bytes;
+	Patch<uint32_t>(badNameIndex, EntryOffset(entryCount, 0), entryCount);
+	CHECK(!CanOpen(badNameIndex));
+}
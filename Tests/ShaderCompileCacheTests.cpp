@@ -0,0 +1,168 @@
+#include "TestFramework.h"
+#include <ShaderCompileCache.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	// 每个用例一个临时目录，结构与引擎相同：
+	//   Shaders/        主着色器所在目录
+	//   ShaderLibrary/  systemDirs[0] = "../ShaderLibrary"
+	//   Include/HLSL/   systemDirs[1] = "../Include/HLSL"
+	class ShaderTree
+	{
+	public:
+		explicit ShaderTree(const char* name)
+			: m_Root(fs::temp_directory_path() / "XEngineShaderTests" / name)
+		{
+			fs::remove_all(m_Root);
+			fs::create_directories(m_Root / "Shaders");
+			fs::create_directories(m_Root / "ShaderLibrary");
+			fs::create_directories(m_Root / "Include/HLSL");
+		}
+		~ShaderTree() { fs::remove_all(m_Root); }
+
+		void Write(const char* relativePath, const std::string& content)
+		{
+			std::ofstream(m_Root / relativePath, std::ios::binary) << content;
+		}
+		void Remove(const char* relativePath) { fs::remove(m_Root / relativePath); }
+		std::string Path(const char* relativePath) const
+		{
+			return ShaderDependencyGraph::NormalizePath((m_Root / relativePath).generic_string());
+		}
+
+		uint64_t Hash(const char* shader) const { return CreateGraph().GetSourceHash(Path(shader)); }
+		ShaderDependencyGraph CreateGraph() const { return ShaderDependencyGraph({ "../ShaderLibrary", "../Include/HLSL" }); }
+
+	private:
+		fs::path m_Root;
+	};
+
+	bool Contains(const std::vector<std::string>& paths, const std::string& path)
+	{
+		return std::find(paths.begin(), paths.end(), path) != paths.end();
+	}
+}
+
+TEST_CASE(NormalizePathCollapsesSegments)
+{
+	CHECK(ShaderDependencyGraph::NormalizePath("Shaders\\.\\Lit\\..\\Common.hlsl") == "Shaders/Common.hlsl");
+	CHECK(ShaderDependencyGraph::NormalizePath("Shaders//Lit/") == "Shaders/Lit");
+	CHECK(ShaderDependencyGraph::NormalizePath("../../Include/HLSL/Common.hlsl") == "../../Include/HLSL/Common.hlsl");
+	CHECK(ShaderDependencyGraph::NormalizePath("Shaders/../../Include") == "../Include");
+	CHECK(ShaderDependencyGraph::NormalizePath("/a/../../b") == "/b");
+}
+
+TEST_CASE(ScanIncludesSkipsCommentsAndStrings)
+{
+	const char* source =
+		"#include \"A.hlsl\"\n"
+		"  #  include <B.hlsl>\n"
+		"// #include \"Commented.hlsl\"\n"
+		"/* #include \"Block.hlsl\"\n"
+		"#include \"BlockLine2.hlsl\" */\n"
+		"/* comment */ #include \"AfterComment.hlsl\"\n"
+		"float x; #include \"NotLineStart.hlsl\"\n"
+		"static const char* s = \"//\"; \n"
+		"#include \"C.hlsl\"\n"
+		"#include \"Unterminated.hlsl\n"
+		"#define INCLUDE_LIKE 1\n";
+	std::vector<ShaderDependencyGraph::IncludeDirective> includes;
+	ShaderDependencyGraph::ScanIncludes(source, includes);
+	CHECK(includes.size() == 4);
+	CHECK(includes.size() == 4 && includes[0].name == "A.hlsl" && !includes[0].isSystem);
+	CHECK(includes.size() == 4 && includes[1].name == "B.hlsl" && includes[1].isSystem);
+	CHECK(includes.size() == 4 && includes[2].name == "AfterComment.hlsl");
+	CHECK(includes.size() == 4 && includes[3].name == "C.hlsl");
+}
+
+// "x"相对于主着色器目录，<x>依次在各个系统目录中查找，包含文件中的相对路径同样相对于主着色器目录
+TEST_CASE(IncludesResolveLikeXShaderInclude)
+{
+	ShaderTree tree("Resolve");
+	tree.Write("Shaders/Lit.hlsl", "#include \"LitInput.hlsl\"\n#include <Common.hlsl>\nfloat4 PS() : SV_Target { return 0; }\n");
+	tree.Write("Shaders/LitInput.hlsl", "#include <Lighting.hlsl>\n");
+	tree.Write("ShaderLibrary/Lighting.hlsl", "#include \"Nested.hlsl\"\n");
+	tree.Write("Shaders/Nested.hlsl", "// nested\n");
+	tree.Write("Include/HLSL/Common.hlsl", "// common\n");
+	// 同名文件只在第一个找到的系统目录中生效
+	tree.Write("Include/HLSL/Lighting.hlsl", "// shadowed\n");
+
+	auto graph = tree.CreateGraph();
+	auto& dependencies = graph.GetDependencies(tree.Path("Shaders/Lit.hlsl"));
+	CHECK(Contains(dependencies, tree.Path("Shaders/Lit.hlsl")));
+	CHECK(Contains(dependencies, tree.Path("Shaders/LitInput.hlsl")));
+	CHECK(Contains(dependencies, tree.Path("ShaderLibrary/Lighting.hlsl")));
+	CHECK(Contains(dependencies, tree.Path("Shaders/Nested.hlsl")));
+	CHECK(Contains(dependencies, tree.Path("Include/HLSL/Common.hlsl")));
+	CHECK(!Contains(dependencies, tree.Path("Include/HLSL/Lighting.hlsl")));
+	// 先查找但不存在的候选路径也是依赖
+	CHECK(Contains(dependencies, tree.Path("ShaderLibrary/Common.hlsl")));
+	CHECK(std::is_sorted(dependencies.begin(), dependencies.end()));
+}
+
+TEST_CASE(IncludeCyclesTerminate)
+{
+	ShaderTree tree("Cycle");
+	tree.Write("Shaders/A.hlsl", "#include \"B.hlsl\"\n");
+	tree.Write("Shaders/B.hlsl", "#include \"A.hlsl\"\n#include \"B.hlsl\"\n");
+	auto graph = tree.CreateGraph();
+	CHECK(graph.GetDependencies(tree.Path("Shaders/A.hlsl")).size() == 2);
+	CHECK(graph.GetSourceHash(tree.Path("Shaders/A.hlsl")) != 0);
+}
+
+TEST_CASE(SourceHashChangesWithTransitiveIncludes)
+{
+	ShaderTree tree("Invalidate");
+	tree.Write("Shaders/Lit.hlsl", "#include <Lighting.hlsl>\n");
+	tree.Write("Include/HLSL/Lighting.hlsl", "#include \"Nested.hlsl\"\n");
+	tree.Write("Shaders/Nested.hlsl", "float a;\n");
+	tree.Write("Shaders/Unrelated.hlsl", "float b;\n");
+
+	uint64_t original = tree.Hash("Shaders/Lit.hlsl");
+	CHECK(original != 0);
+	CHECK(tree.Hash("Shaders/Lit.hlsl") == original);
+
+	// 与时间戳无关：内容不变时哈希不变
+	tree.Write("Shaders/Nested.hlsl", "float a;\n");
+	CHECK(tree.Hash("Shaders/Lit.hlsl") == original);
+
+	tree.Write("Shaders/Unrelated.hlsl", "float c;\n");
+	CHECK(tree.Hash("Shaders/Lit.hlsl") == original);
+
+	tree.Write("Shaders/Nested.hlsl", "float a2;\n");
+	uint64_t nestedChanged = tree.Hash("Shaders/Lit.hlsl");
+	CHECK(nestedChanged != original);
+
+	// 在更靠前的系统目录中创建同名文件会改变查找结果
+	tree.Write("ShaderLibrary/Lighting.hlsl", "#include \"Nested.hlsl\"\n");
+	uint64_t shadowed = tree.Hash("Shaders/Lit.hlsl");
+	CHECK(shadowed != nestedChanged);
+
+	tree.Remove("ShaderLibrary/Lighting.hlsl");
+	CHECK(tree.Hash("Shaders/Lit.hlsl") == nestedChanged);
+
+	tree.Remove("Shaders/Lit.hlsl");
+	CHECK(tree.Hash("Shaders/Lit.hlsl") == 0);
+}
+
+TEST_CASE(CompileKeyCoversEveryInput)
+{
+	std::vector<std::string> defines{ "SHADOWS", "NORMAL_MAP" };
+	uint64_t key = ComputeShaderCompileKey(1, "PS", "ps_5_0", defines, 0, 47);
+	CHECK(key == ComputeShaderCompileKey(1, "PS", "ps_5_0", defines, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(2, "PS", "ps_5_0", defines, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "VS", "ps_5_0", defines, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "PS", "ps_4_0", defines, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "PS", "ps_5_0", { "SHADOWS" }, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "PS", "ps_5_0", { "SHADOWSNORMAL_MAP" }, 0, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "PS", "ps_5_0", defines, 1, 47));
+	CHECK(key != ComputeShaderCompileKey(1, "PS", "ps_5_0", defines, 0, 43));
+
+	CHECK(ShaderCompileKeyToString(0x0123456789abcdefull) == "0123456789abcdef");
+	CHECK(ShaderCompileKeyToString(0xf) == "000000000000000f");
+}
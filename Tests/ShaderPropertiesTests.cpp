@@ -0,0 +1,165 @@
+#include "TestFramework.h"
+#include <ShaderProperties.h>
+#include <Utils/Hash.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// 与CBufferData相同的脏区间记录
+	struct FakeCBuffer
+	{
+		std::vector<uint8_t> data;
+		bool isDirty = false;
+		uint32_t dirtyBegin = 0;
+		uint32_t dirtyEnd = 0;
+
+		explicit FakeCBuffer(uint32_t byteWidth) : data(byteWidth) {}
+
+		void MarkDirty(uint32_t byteOffset, uint32_t byteCount)
+		{
+			dirtyBegin = isDirty ? (std::min)(dirtyBegin, byteOffset) : byteOffset;
+			dirtyEnd = isDirty ? (std::max)(dirtyEnd, byteOffset + byteCount) : byteOffset + byteCount;
+			isDirty = true;
+		}
+	};
+
+	struct FakeProperty
+	{
+		uint32_t startByteOffset = 0;
+		uint32_t byteWidth = 0;
+		FakeCBuffer* pCBufferData = nullptr;
+	};
+
+	constexpr size_t s_TimeID = Hash::FNV1a64("g_Time");
+	constexpr size_t s_EyePosID = Hash::FNV1a64("g_EyePosW");
+	constexpr size_t s_FogColorID = Hash::FNV1a64("g_FogColor");
+	constexpr size_t s_LightsID = Hash::FNV1a64("g_Lights");
+	constexpr size_t s_DiffuseMapID = Hash::FNV1a64("g_DiffuseMap");
+	constexpr size_t s_ShadowMapID = Hash::FNV1a64("g_ShadowMap");
+
+	// 着色器的一个编译结果：默认变体或关键字变体，关键字会改变常量缓冲区的布局
+	struct FakeShader
+	{
+		std::unique_ptr<FakeCBuffer> pCBuffer;
+		std::unordered_map<size_t, FakeProperty> properties;
+		std::unordered_map<size_t, std::pair<uint32_t, int>> shaderResources;	// 槽位, 资源
+		std::vector<FakeShader*> variants;
+
+		explicit FakeShader(bool fogKeyword)
+		{
+			// 开启雾效的变体在缓冲区开头多出g_FogColor，灯光数组也更长
+			uint32_t base = fogKeyword ? 16 : 0;
+			pCBuffer = std::make_unique<FakeCBuffer>(base + 96);
+			properties[s_TimeID] = { base + 0, 4, pCBuffer.get() };
+			properties[s_EyePosID] = { base + 16, 12, pCBuffer.get() };
+			properties[s_LightsID] = { base + 32, fogKeyword ? 64u : 32u, pCBuffer.get() };
+			if (fogKeyword)
+				properties[s_FogColorID] = { 0, 16, pCBuffer.get() };
+			shaderResources[s_DiffuseMapID] = { fogKeyword ? 1u : 0u, 0 };
+			shaderResources[s_ShadowMapID] = { fogKeyword ? 2u : 1u, 0 };
+		}
+
+		// 与Shader::Impl::SetGlobalRaw相同：写入自身，再转发给已创建的变体
+		void SetGlobalRaw(size_t propertyID, const void* data, uint32_t byteOffset = 0, uint32_t byteCount = 0xFFFFFFFF)
+		{
+			if (auto it = properties.find(propertyID); it != properties.end())
+				ShaderProperties::WriteRaw(it->second, data, byteOffset, byteCount);
+			for (FakeShader* pVariant : variants)
+				pVariant->SetGlobalRaw(propertyID, data, byteOffset, byteCount);
+		}
+
+		template<class T>
+		T Get(size_t propertyID) const
+		{
+			T value{};
+			auto& prop = properties.at(propertyID);
+			memcpy(&value, prop.pCBufferData->data.data() + prop.startByteOffset, sizeof value);
+			return value;
+		}
+	};
+}
+
+TEST_CASE(WriteRawMarksOnlyChangedBytes)
+{
+	FakeShader shader(false);
+	float time = 1.5f;
+	shader.SetGlobalRaw(s_TimeID, &time);
+	CHECK(shader.Get<float>(s_TimeID) == 1.5f);
+	CHECK(shader.pCBuffer->isDirty && shader.pCBuffer->dirtyBegin == 0 && shader.pCBuffer->dirtyEnd == 4);
+
+	// 值相同时不标记
+	shader.pCBuffer->isDirty = false;
+	shader.SetGlobalRaw(s_TimeID, &time);
+	CHECK(!shader.pCBuffer->isDirty);
+
+	// 超出属性的部分被截断，不会写到相邻的属性
+	float eye[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+	shader.SetGlobalRaw(s_EyePosID, eye, 4, 16);
+	CHECK(shader.pCBuffer->dirtyBegin == 20 && shader.pCBuffer->dirtyEnd == 28);
+	CHECK(shader.Get<uint32_t>(s_LightsID) == 0);
+
+	// 起始偏移超出属性时忽略
+	shader.pCBuffer->isDirty = false;
+	shader.SetGlobalRaw(s_EyePosID, eye, 16, 4);
+	CHECK(!shader.pCBuffer->isDirty);
+}
+
+TEST_CASE(CopyValuesMatchesByIdAcrossLayouts)
+{
+	FakeShader base(false), variant(true);
+	float time = 2.0f;
+	float eye[3] = { 1.0f, 2.0f, 3.0f };
+	std::vector<uint8_t> lights(32, 0x5a);
+	base.SetGlobalRaw(s_TimeID, &time);
+	base.SetGlobalRaw(s_EyePosID, eye);
+	base.SetGlobalRaw(s_LightsID, lights.data());
+
+	variant.pCBuffer->isDirty = false;
+	ShaderProperties::CopyValues(base.properties, variant.properties);
+	CHECK(variant.Get<float>(s_TimeID) == 2.0f);
+	CHECK(memcmp(variant.pCBuffer->data.data() + variant.properties[s_EyePosID].startByteOffset, eye, sizeof eye) == 0);
+	// 大小不同的属性保持变体自身的值
+	CHECK(variant.Get<uint32_t>(s_LightsID) == 0);
+	CHECK(variant.pCBuffer->isDirty && variant.pCBuffer->dirtyBegin == 16 && variant.pCBuffer->dirtyEnd == 44);
+}
+
+TEST_CASE(CopyBindingsKeepsOwnSlots)
+{
+	FakeShader base(false), variant(true);
+	base.shaderResources[s_DiffuseMapID].second = 7;
+	base.shaderResources[s_ShadowMapID].second = 9;
+	ShaderProperties::CopyBindings(base.shaderResources, variant.shaderResources);
+	CHECK(variant.shaderResources[s_DiffuseMapID] == std::make_pair(1u, 7));
+	CHECK(variant.shaderResources[s_ShadowMapID] == std::make_pair(2u, 9));
+}
+
+// 变体创建前后在默认变体上设置的全局属性，都能在变体中看到
+TEST_CASE(GlobalSetOnBaseIsVisibleInVariant)
+{
+	FakeShader base(false);
+	float time = 3.0f;
+	base.SetGlobalRaw(s_TimeID, &time);
+
+	// GetVariant创建变体：复制已有的值，之后的设置由SetGlobalRaw转发
+	FakeShader variant(true);
+	ShaderProperties::CopyValues(base.properties, variant.properties);
+	base.variants.push_back(&variant);
+	CHECK(variant.Get<float>(s_TimeID) == 3.0f);
+
+	float eye[3] = { 4.0f, 5.0f, 6.0f };
+	time = 4.0f;
+	base.SetGlobalRaw(s_TimeID, &time);
+	base.SetGlobalRaw(s_EyePosID, eye);
+	CHECK(variant.Get<float>(s_TimeID) == 4.0f);
+	CHECK(memcmp(variant.pCBuffer->data.data() + variant.properties[s_EyePosID].startByteOffset, eye, sizeof eye) == 0);
+
+	// 只有变体才有的属性同样可以设置
+	float fog[4] = { 0.5f, 0.5f, 0.5f, 1.0f };
+	base.SetGlobalRaw(s_FogColorID, fog);
+	CHECK(variant.Get<float>(s_FogColorID) == 0.5f);
+}
@@ -0,0 +1,137 @@
+#include "TestFramework.h"
+#include <ShaderReflectionData.h>
+#include <cstring>
+
+namespace
+{
+	constexpr uint64_t s_BlobHash = 0x1234567890abcdefull;
+
+	ShaderReflectionData CreateSyntheticData()
+	{
+		ShaderReflectionData data;
+		data.shaderFlag = 0x5;
+		data.constantBuffers = {
+			{ "CBPerObject", 0, 128, { { "g_World", 0, 64 }, { "g_WorldInvTranspose", 64, 64 } } },
+			{ "CBPerFrame", 1, 16, { { "g_EyePosW", 0, 12 }, { "g_Time", 12, 4 } } },
+			{ "CBEmpty", 2, 16, {} },
+		};
+		data.shaderResources = { { "g_DiffuseMap", 0, 4 }, { "g_ShadowMap", 1, 4 }, { "g_Particles", 2, 1 } };
+		data.samplers = { { "g_Sam", 0, 0 }, { "g_SamShadow", 1, 0 } };
+		data.rwResources = { { "g_Output", 0, 4 } };
+		data.inputSignature = { { "POSITION", 0, 6, 0 }, { "NORMAL", 0, 6, 1 }, { "TEXCOORD", 0, 16, 2 }, { "TEXCOORD", 1, 16, 3 } };
+		return data;
+	}
+
+	bool IsSame(const std::vector<ShaderReflectionData::Resource>& lhs, const std::vector<ShaderReflectionData::Resource>& rhs)
+	{
+		if (lhs.size() != rhs.size())
+			return false;
+		for (size_t i = 0; i < lhs.size(); ++i)
+		{
+			if (lhs[i].name != rhs[i].name || lhs[i].startSlot != rhs[i].startSlot || lhs[i].dimension != rhs[i].dimension)
+				return false;
+		}
+		return true;
+	}
+
+	bool IsSame(const ShaderReflectionData& lhs, const ShaderReflectionData& rhs)
+	{
+		if (lhs.shaderFlag != rhs.shaderFlag || lhs.constantBuffers.size() != rhs.constantBuffers.size() ||
+			lhs.inputSignature.size() != rhs.inputSignature.size())
+			return false;
+		for (size_t i = 0; i < lhs.constantBuffers.size(); ++i)
+		{
+			auto& l = lhs.constantBuffers[i];
+			auto& r = rhs.constantBuffers[i];
+			if (l.name != r.name || l.startSlot != r.startSlot || l.byteWidth != r.byteWidth || l.variables.size() != r.variables.size())
+				return false;
+			for (size_t j = 0; j < l.variables.size(); ++j)
+			{
+				if (l.variables[j].name != r.variables[j].name || l.variables[j].startByteOffset != r.variables[j].startByteOffset ||
+					l.variables[j].byteWidth != r.variables[j].byteWidth)
+					return false;
+			}
+		}
+		for (size_t i = 0; i < lhs.inputSignature.size(); ++i)
+		{
+			auto& l = lhs.inputSignature[i];
+			auto& r = rhs.inputSignature[i];
+			if (l.semanticName != r.semanticName || l.semanticIndex != r.semanticIndex || l.format != r.format || l.inputSlot != r.inputSlot)
+				return false;
+		}
+		return IsSame(lhs.shaderResources, rhs.shaderResources) && IsSame(lhs.samplers, rhs.samplers) &&
+			IsSame(lhs.rwResources, rhs.rwResources);
+	}
+}
+
+TEST_CASE(ReflectionRoundTrip)
+{
+	auto data = CreateSyntheticData();
+	std::vector<uint8_t> bytes;
+	SerializeShaderReflection(data, s_BlobHash, bytes);
+
+	ShaderReflectionData loaded;
+	CHECK(DeserializeShaderReflection(bytes.data(), bytes.size(), s_BlobHash, loaded));
+	CHECK(IsSame(data, loaded));
+
+	// 空数据同样可以往返
+	std::vector<uint8_t> emptyBytes;
+	SerializeShaderReflection(ShaderReflectionData{}, s_BlobHash, emptyBytes);
+	CHECK(DeserializeShaderReflection(emptyBytes.data(), emptyBytes.size(), s_BlobHash, loaded));
+	CHECK(IsSame(ShaderReflectionData{}, loaded));
+}
+
+TEST_CASE(ReflectionRejectsEveryTruncation)
+{
+	std::vector<uint8_t> bytes;
+	SerializeShaderReflection(CreateSyntheticData(), s_BlobHash, bytes);
+
+	bool allRejected = true;
+	ShaderReflectionData loaded;
+	for (size_t size = 0; size < bytes.size(); ++size)
+	{
+		// 复制到刚好大小的缓冲区中，越界读取可以被地址检查工具发现
+		std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + size);
+		allRejected = allRejected && !DeserializeShaderReflection(truncated.data(), truncated.size(), s_BlobHash, loaded);
+	}
+	CHECK(allRejected);
+
+	// 末尾多出数据同样视为不匹配
+	bytes.push_back(0);
+	CHECK(!DeserializeShaderReflection(bytes.data(), bytes.size(), s_BlobHash, loaded));
+}
+
+TEST_CASE(ReflectionRejectsMismatchedHeader)
+{
+	std::vector<uint8_t> bytes;
+	SerializeShaderReflection(CreateSyntheticData(), s_BlobHash, bytes);
+	ShaderReflectionData loaded;
+	CHECK(!DeserializeShaderReflection(bytes.data(), bytes.size(), s_BlobHash + 1, loaded));
+
+	auto badMagic = bytes;
+	badMagic[0] ^= 0xff;
+	CHECK(!DeserializeShaderReflection(badMagic.data(), badMagic.size(), s_BlobHash, loaded));
+
+	auto badVersion = bytes;
+	uint32_t version = s_ShaderReflectionVersion + 1;
+	memcpy(badVersion.data() + 4, &version, sizeof version);
+	CHECK(!DeserializeShaderReflection(badVersion.data(), badVersion.size(), s_BlobHash, loaded));
+}
+
+// 损坏的数组长度不应导致过量分配
+TEST_CASE(ReflectionRejectsCorruptedCounts)
+{
+	std::vector<uint8_t> bytes;
+	SerializeShaderReflection(CreateSyntheticData(), s_BlobHash, bytes);
+	// 头部之后是shaderFlag，然后是常量缓冲区的个数
+	uint32_t hugeCount = 0x7fffffff;
+	memcpy(bytes.data() + 20, &hugeCount, sizeof hugeCount);
+	ShaderReflectionData loaded;
+	CHECK(!DeserializeShaderReflection(bytes.data(), bytes.size(), s_BlobHash, loaded));
+
+	// 字符串长度超出剩余数据
+	SerializeShaderReflection(CreateSyntheticData(), s_BlobHash, bytes);
+	uint32_t hugeLength = 0xffffffff;
+	memcpy(bytes.data() + 24, &hugeLength, sizeof hugeLength);
+	CHECK(!DeserializeShaderReflection(bytes.data(), bytes.size(), s_BlobHash, loaded));
+}
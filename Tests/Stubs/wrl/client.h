@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+// 非Windows平台上代替<wrl/client.h>，只实现测试所编译的引擎代码用到的部分
+namespace Microsoft
+{
+	namespace WRL
+	{
+		template<class T>
+		class ComPtr
+		{
+		public:
+			ComPtr() = default;
+			ComPtr(std::nullptr_t) {}
+			ComPtr(T* p) : m_Ptr(p) { InternalAddRef(); }
+			ComPtr(const ComPtr& other) : m_Ptr(other.m_Ptr) { InternalAddRef(); }
+			ComPtr(ComPtr&& other) noexcept : m_Ptr(other.m_Ptr) { other.m_Ptr = nullptr; }
+			~ComPtr() { InternalRelease(); }
+
+			ComPtr& operator=(ComPtr other) noexcept
+			{
+				T* p = m_Ptr;
+				m_Ptr = other.m_Ptr;
+				other.m_Ptr = p;
+				return *this;
+			}
+
+			T* Get() const { return m_Ptr; }
+			T* operator->() const { return m_Ptr; }
+			explicit operator bool() const { return m_Ptr != nullptr; }
+			T** GetAddressOf() { return &m_Ptr; }
+			T** ReleaseAndGetAddressOf() { InternalRelease(); return &m_Ptr; }
+			T* Detach() { T* p = m_Ptr; m_Ptr = nullptr; return p; }
+			void Reset() { InternalRelease(); }
+
+		private:
+			void InternalAddRef() { if (m_Ptr) m_Ptr->AddRef(); }
+			void InternalRelease()
+			{
+				if (T* p = m_Ptr)
+				{
+					m_Ptr = nullptr;
+					p->Release();
+				}
+			}
+
+			T* m_Ptr = nullptr;
+		};
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// 不依赖第三方库的最小测试框架
+// TEST_CASE定义并注册用例，CHECK失败时输出位置并继续执行，TestMain.cpp依次运行所有用例
+namespace Test
+{
+	struct Case
+	{
+		const char* name;
+		void (*func)();
+	};
+
+	inline std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> s_Cases;
+		return s_Cases;
+	}
+
+	inline int& GetFailureCount()
+	{
+		static int s_FailureCount = 0;
+		return s_FailureCount;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*func)()) { GetCases().push_back({ name, func }); }
+	};
+
+	inline void ReportFailure(const char* expr, const char* file, int line)
+	{
+		std::printf("  %s(%d): CHECK(%s) failed\n", file, line, expr);
+		++GetFailureCount();
+	}
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static Test::Registrar s_Registrar_##name(#name, name); \
+	static void name()
+
+#define CHECK(expr) \
+	do { if (!(expr)) Test::ReportFailure(#expr, __FILE__, __LINE__); } while (0)
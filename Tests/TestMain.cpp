@@ -0,0 +1,16 @@
+#include "TestFramework.h"
+
+int main()
+{
+	int failedCases = 0;
+	for (const auto& testCase : Test::GetCases())
+	{
+		int failures = Test::GetFailureCount();
+		testCase.func();
+		bool passed = Test::GetFailureCount() == failures;
+		failedCases += passed ? 0 : 1;
+		std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.name);
+	}
+	std::printf("%d/%d passed\n", (int)Test::GetCases().size() - failedCases, (int)Test::GetCases().size());
+	return failedCases == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include "TestFramework.h"
+#include <Utils/ThreadPool.h>
+#include <atomic>
+#include <stdexcept>
+
+TEST_CASE(ParallelForCoversRange)
+{
+	ThreadPool pool(3);
+	std::vector<int> visited(1000, 0);
+	pool.ParallelFor(visited.size(), 7, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			++visited[i];
+	});
+	bool allOnce = true;
+	for (int v : visited)
+		allOnce = allOnce && v == 1;
+	CHECK(allOnce);
+}
+
+// 外层的块占满所有工作线程后，内层的辅助任务只能排在队列中
+TEST_CASE(NestedParallelForDoesNotDeadlock)
+{
+	ThreadPool pool(2);
+	std::atomic<size_t> sum = 0;
+	for (int iteration = 0; iteration < 100; ++iteration)
+	{
+		pool.ParallelFor(3, 1, [&](size_t, size_t) {
+			pool.ParallelFor(2, 1, [&](size_t begin, size_t end) { sum += end - begin; });
+		});
+	}
+	CHECK(sum == 100 * 3 * 2);
+}
+
+// 与着色器变体编译相同的用法：提交的任务数不少于工作线程数，每个任务内部再ParallelFor
+TEST_CASE(ParallelForInsideSubmittedTasks)
+{
+	ThreadPool pool(2);
+	std::atomic<size_t> sum = 0;
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < 4; ++i)
+	{
+		futures.push_back(pool.Submit([&]() {
+			pool.ParallelFor(8, 1, [&](size_t begin, size_t end) { sum += end - begin; });
+		}));
+	}
+	for (auto& f : futures)
+		f.get();
+	CHECK(sum == 4 * 8);
+}
+
+TEST_CASE(ParallelForRethrowsAfterAllChunks)
+{
+	ThreadPool pool(2);
+	std::atomic<size_t> finished = 0;
+	bool thrown = false;
+	try
+	{
+		pool.ParallelFor(16, 1, [&](size_t begin, size_t) {
+			if (begin == 3)
+				throw std::runtime_error("chunk 3");
+			++finished;
+		});
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	CHECK(thrown);
+	CHECK(finished == 15);
+}
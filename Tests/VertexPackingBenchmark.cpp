@@ -0,0 +1,189 @@
+// 顶点内存与打包吞吐量的测量
+// 按UpdateMeshResource使用的格式打包一个合成网格，输出各布局每顶点的字节数、总大小与各打包函数的吞吐量
+//   VertexPackingBenchmark [--quick]
+#include "Benchmark.h"
+#include <VertexPacking.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// 与MeshData相同的逐属性fp32数组
+	struct SyntheticMesh
+	{
+		std::vector<float> positions;	// float3
+		std::vector<float> normals;		// float3
+		std::vector<float> tangents;	// float4
+		std::vector<float> colors;		// float4
+		std::vector<float> texcoords;	// float2
+		size_t vertexCount = 0;
+	};
+
+	SyntheticMesh CreateSphere(uint32_t levels, uint32_t slices)
+	{
+		SyntheticMesh mesh;
+		for (uint32_t i = 0; i <= levels; ++i)
+		{
+			float theta = 3.1415926f * i / levels;
+			for (uint32_t j = 0; j <= slices; ++j)
+			{
+				float phi = 6.2831853f * j / slices;
+				float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+				mesh.positions.insert(mesh.positions.end(), { x, y, z });
+				mesh.normals.insert(mesh.normals.end(), { x, y, z });
+				mesh.tangents.insert(mesh.tangents.end(), { -std::sin(phi), 0.0f, std::cos(phi), 1.0f });
+				mesh.colors.insert(mesh.colors.end(), { x * 0.5f + 0.5f, y * 0.5f + 0.5f, z * 0.5f + 0.5f, 1.0f });
+				mesh.texcoords.insert(mesh.texcoords.end(), { (float)j / slices, (float)i / levels });
+			}
+		}
+		mesh.vertexCount = mesh.positions.size() / 3;
+		return mesh;
+	}
+
+	struct Layout
+	{
+		const char* name;
+		bool hasColor;
+		bool compressed;
+		bool octahedralNormal;
+	};
+
+	uint32_t GetVertexStride(const Layout& layout)
+	{
+		uint32_t stride = 12;
+		stride += !layout.compressed ? 12 : layout.octahedralNormal ? 4 : 8;
+		stride += layout.compressed ? 8 : 16;
+		stride += !layout.hasColor ? 0 : layout.compressed ? 4 : 16;
+		stride += layout.compressed ? 4 : 8;
+		return stride;
+	}
+
+	// 与PackVertexStreams相同的打包过程，返回交错后的顶点流
+	std::vector<uint8_t> PackInterleaved(const SyntheticMesh& mesh, const Layout& layout)
+	{
+		size_t count = mesh.vertexCount;
+		std::vector<std::vector<uint8_t>> streams;
+		std::vector<uint32_t> strides;
+		auto addStream = [&](uint32_t stride) -> uint8_t* {
+			strides.push_back(stride);
+			streams.emplace_back(count * stride);
+			return streams.back().data();
+		};
+
+		memcpy(addStream(12), mesh.positions.data(), count * 12);
+		if (!layout.compressed)
+		{
+			memcpy(addStream(12), mesh.normals.data(), count * 12);
+			memcpy(addStream(16), mesh.tangents.data(), count * 16);
+			if (layout.hasColor)
+				memcpy(addStream(16), mesh.colors.data(), count * 16);
+			memcpy(addStream(8), mesh.texcoords.data(), count * 8);
+		}
+		else
+		{
+			if (layout.octahedralNormal)
+			{
+				VertexPacking::EncodeOctahedralSnorm16(mesh.normals.data(), 3, reinterpret_cast<int16_t*>(addStream(4)), count);
+			}
+			else
+			{
+				std::vector<int16_t> packed(count * 3);
+				VertexPacking::FloatToSnorm16(mesh.normals.data(), packed.data(), packed.size());
+				uint8_t* pDest = addStream(8);
+				memset(pDest, 0, count * 8);
+				for (size_t v = 0; v < count; ++v)
+					memcpy(pDest + v * 8, packed.data() + v * 3, 6);
+			}
+			VertexPacking::FloatToSnorm16(mesh.tangents.data(), reinterpret_cast<int16_t*>(addStream(8)), count * 4);
+			if (layout.hasColor)
+				VertexPacking::FloatToUnorm8(mesh.colors.data(), addStream(4), count * 4);
+			VertexPacking::FloatToHalf(mesh.texcoords.data(), reinterpret_cast<uint16_t*>(addStream(4)), count * 2);
+		}
+
+		uint32_t vertexStride = 0;
+		std::vector<const void*> pStreams;
+		for (size_t i = 0; i < streams.size(); ++i)
+		{
+			vertexStride += strides[i];
+			pStreams.push_back(streams[i].data());
+		}
+		std::vector<uint8_t> merged(count * vertexStride);
+		VertexPacking::Interleave(pStreams.data(), strides.data(), (uint32_t)streams.size(), count, merged.data());
+		return merged;
+	}
+
+	double ToMegaPerSecond(size_t count, double ms)
+	{
+		return ms > 0.0 ? count / ms / 1000.0 : 0.0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = Bench::IsQuick(argc, argv);
+	SyntheticMesh mesh = quick ? CreateSphere(64, 64) : CreateSphere(1024, 1024);
+	int repeat = quick ? 1 : 10;
+	size_t count = mesh.vertexCount;
+	printf("Synthetic sphere: %zu vertices\n\n", count);
+
+	//
+	// 顶点内存
+	//
+	const Layout layouts[] = {
+		{ "fp32 pos/normal/tangent/uv", false, false, false },
+		{ "packed, float3 normal", false, true, false },
+		{ "packed, octahedral normal", false, true, true },
+		{ "fp32 pos/normal/tangent/color/uv", true, false, false },
+		{ "packed + color, float3 normal", true, true, false },
+		{ "packed + color, octahedral normal", true, true, true },
+	};
+	printf("%-36s %8s %10s %8s %12s\n", "Layout", "B/vertex", "MB", "ratio", "pack ms");
+	uint32_t baseStride = 0;
+	for (const auto& layout : layouts)
+	{
+		uint32_t stride = GetVertexStride(layout);
+		baseStride = layout.compressed ? baseStride : stride;
+		std::vector<uint8_t> packed;
+		double ms = Bench::MeasureMilliseconds(repeat, [&]() { packed = PackInterleaved(mesh, layout); });
+		if (packed.size() != count * stride)
+		{
+			printf("Unexpected packed size for %s\n", layout.name);
+			return 1;
+		}
+		printf("%-36s %8u %10.2f %7.0f%% %12.3f\n", layout.name, stride, packed.size() / (1024.0 * 1024.0),
+			100.0 * stride / baseStride, ms);
+	}
+
+	//
+	// 各打包函数的吞吐量
+	//
+	std::vector<uint16_t> halfs(count * 2);
+	std::vector<int16_t> snorms(count * 4);
+	std::vector<int16_t> octahedral(count * 2);
+	std::vector<uint8_t> unorms(count * 4);
+	double halfMs = Bench::MeasureMilliseconds(repeat, [&]() {
+		VertexPacking::FloatToHalf(mesh.texcoords.data(), halfs.data(), count * 2);
+	});
+	double snormMs = Bench::MeasureMilliseconds(repeat, [&]() {
+		VertexPacking::FloatToSnorm16(mesh.tangents.data(), snorms.data(), count * 4);
+	});
+	double octMs = Bench::MeasureMilliseconds(repeat, [&]() {
+		VertexPacking::EncodeOctahedralSnorm16(mesh.normals.data(), 3, octahedral.data(), count);
+	});
+	double unormMs = Bench::MeasureMilliseconds(repeat, [&]() {
+		VertexPacking::FloatToUnorm8(mesh.colors.data(), unorms.data(), count * 4);
+	});
+	Bench::DoNotOptimize(halfs);
+	Bench::DoNotOptimize(snorms);
+	Bench::DoNotOptimize(octahedral);
+	Bench::DoNotOptimize(unorms);
+
+	printf("\n%-36s %12s\n", "Kernel", "Mvertex/s");
+	printf("%-36s %12.1f\n", "FloatToHalf (float2 texcoord)", ToMegaPerSecond(count, halfMs));
+	printf("%-36s %12.1f\n", "FloatToSnorm16 (float4 tangent)", ToMegaPerSecond(count, snormMs));
+	printf("%-36s %12.1f\n", "EncodeOctahedralSnorm16 (normal)", ToMegaPerSecond(count, octMs));
+	printf("%-36s %12.1f\n", "FloatToUnorm8 (float4 color)", ToMegaPerSecond(count, unormMs));
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "TestFramework.h"
+#include <VertexPacking.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+TEST_CASE(HalfConversionMatchesScalarPath)
+{
+	// 覆盖规格化数、非规格化数、舍入边界、溢出与特殊值
+	std::vector<float> values{ 0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 65504.0f, 65520.0f, 1e6f, -1e6f,
+		6.1035156e-05f, 5.9604645e-08f, 2.9802322e-08f, 1e-10f, 1.0009765625f, 1.00048828125f, 1.00146484375f,
+		INFINITY, -INFINITY, NAN, 3.14159265f, -2.71828183f, 0.333333f, 1234.5678f };
+	for (int i = 0; i < 1000; ++i)
+		values.push_back(std::sin(i * 0.37f) * std::pow(2.0f, (float)(i % 40 - 25)));
+
+	std::vector<uint16_t> packed(values.size());
+	VertexPacking::FloatToHalf(values.data(), packed.data(), values.size());
+	bool identical = true;
+	for (size_t i = 0; i < values.size(); ++i)
+		identical = identical && packed[i] == VertexPacking::FloatToHalf(values[i]);
+	CHECK(identical);
+}
+
+TEST_CASE(HalfConversionRoundsToNearestEven)
+{
+	CHECK(VertexPacking::FloatToHalf(1.0f) == 0x3c00);
+	CHECK(VertexPacking::FloatToHalf(-2.0f) == 0xc000);
+	CHECK(VertexPacking::FloatToHalf(65504.0f) == 0x7bff);
+	CHECK(VertexPacking::FloatToHalf(65520.0f) == 0x7c00);
+	CHECK(VertexPacking::FloatToHalf(5.9604645e-08f) == 0x0001);
+	// 正好位于两个half中间时舍入到尾数为偶数的一侧
+	CHECK(VertexPacking::FloatToHalf(1.00048828125f) == 0x3c00);
+	CHECK(VertexPacking::FloatToHalf(1.00146484375f) == 0x3c02);
+	CHECK((VertexPacking::FloatToHalf(NAN) & 0x7c00) == 0x7c00 && (VertexPacking::FloatToHalf(NAN) & 0x3ff) != 0);
+
+	bool roundTrip = true;
+	for (uint32_t h = 0; h < 0x7c00; ++h)
+		roundTrip = roundTrip && VertexPacking::FloatToHalf(VertexPacking::HalfToFloat((uint16_t)h)) == h;
+	CHECK(roundTrip);
+}
+
+TEST_CASE(NormalizedConversionsClamp)
+{
+	float values[17] = { -2.0f, -1.0f, -0.5f, 0.0f, 0.5f, 1.0f, 2.0f, 0.25f, -0.25f, 0.1f, 0.9f, -0.9f, 0.75f, 0.6f, 0.3f, 1.5f, -1.5f };
+	int16_t snorm[17];
+	VertexPacking::FloatToSnorm16(values, snorm, 17);
+	CHECK(snorm[0] == -32767 && snorm[1] == -32767 && snorm[3] == 0 && snorm[5] == 32767 && snorm[6] == 32767);
+	CHECK(snorm[15] == 32767 && snorm[16] == -32767);
+
+	uint8_t unorm[17];
+	VertexPacking::FloatToUnorm8(values, unorm, 17);
+	CHECK(unorm[0] == 0 && unorm[3] == 0 && unorm[4] == 128 && unorm[5] == 255 && unorm[6] == 255);
+	CHECK(unorm[7] == 64 && unorm[15] == 255 && unorm[16] == 0);
+}
+
+TEST_CASE(OctahedralRoundTripIsAccurate)
+{
+	std::vector<float> normals;
+	for (int i = 0; i < 64; ++i)
+	{
+		for (int j = 0; j <= 32; ++j)
+		{
+			float phi = i * 6.2831853f / 64;
+			float theta = j * 3.1415926f / 32;
+			normals.insert(normals.end(), { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+		}
+	}
+	size_t count = normals.size() / 3;
+	std::vector<int16_t> encoded(count * 2);
+	std::vector<float> decoded(count * 3);
+	VertexPacking::EncodeOctahedralSnorm16(normals.data(), 3, encoded.data(), count);
+	VertexPacking::DecodeOctahedralSnorm16(encoded.data(), decoded.data(), count);
+
+	float minDot = 1.0f;
+	for (size_t i = 0; i < count; ++i)
+	{
+		float dot = normals[i * 3] * decoded[i * 3] + normals[i * 3 + 1] * decoded[i * 3 + 1] + normals[i * 3 + 2] * decoded[i * 3 + 2];
+		minDot = (std::min)(minDot, dot);
+	}
+	// 0.035度以内
+	CHECK(minDot > std::cos(0.035f * 3.1415926f / 180.0f));
+}
+
+TEST_CASE(OctahedralEncodingHonorsSourceStride)
+{
+	// float4切线的xyz部分
+	float tangents[8] = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, -1.0f, -1.0f };
+	int16_t encoded[4];
+	VertexPacking::EncodeOctahedralSnorm16(tangents, 4, encoded, 2);
+	float decoded[6];
+	VertexPacking::DecodeOctahedralSnorm16(encoded, decoded, 2);
+	CHECK(std::fabs(decoded[2] - 1.0f) < 1e-4f);
+	CHECK(std::fabs(decoded[5] + 1.0f) < 1e-4f);
+}
+
+TEST_CASE(InterleaveMergesStreams)
+{
+	float positions[6] = { 1, 2, 3, 4, 5, 6 };
+	uint16_t texcoords[4] = { 10, 11, 12, 13 };
+	uint8_t colors[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	const void* pStreams[3] = { positions, texcoords, colors };
+	uint32_t strides[3] = { 12, 4, 4 };
+	uint8_t merged[40];
+	VertexPacking::Interleave(pStreams, strides, 3, 2, merged);
+	CHECK(memcmp(merged, positions, 12) == 0 && memcmp(merged + 12, texcoords, 4) == 0 && memcmp(merged + 16, colors, 4) == 0);
+	CHECK(memcmp(merged + 20, positions + 3, 12) == 0 && memcmp(merged + 32, texcoords + 2, 4) == 0 && memcmp(merged + 36, colors + 4, 4) == 0);
+}
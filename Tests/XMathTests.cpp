@@ -0,0 +1,76 @@
+#include "TestFramework.h"
+#include <Math/XMath.h>
+#include <random>
+
+namespace
+{
+	// 与Transform::GetLocalToWorldMatrix相同的组合方式：T * R * S
+	XMath::Matrix4x4 RandomTRS(std::mt19937& rng, bool allowNegativeScale)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f), scale(0.1f, 4.0f), translation(-100.0f, 100.0f);
+		XMath::Vector3 axis(unit(rng), unit(rng), unit(rng));
+		axis = axis.norm() > 1e-3f ? axis.normalized() : XMath::Vector3::UnitY();
+		XMath::QuaternionA rotation(Eigen::AngleAxisf(unit(rng) * XMath::PI, axis));
+
+		XMath::Vector3 s(scale(rng), scale(rng), scale(rng));
+		for (int i = 0; allowNegativeScale && i < 3; ++i)
+			s[i] *= unit(rng) < 0.0f ? -1.0f : 1.0f;
+
+		XMath::Matrix4x4A m = XMath::Matrix4x4A::Identity();
+		m.topLeftCorner<3, 3>() = rotation.toRotationMatrix() * s.asDiagonal();
+		m.topRightCorner<3, 1>() = XMath::Vector3(translation(rng), translation(rng), translation(rng));
+		return m;
+	}
+
+	// 相对于矩阵元素量级的误差
+	bool IsNear(const XMath::Matrix4x4& lhs, const XMath::Matrix4x4& rhs, float tolerance)
+	{
+		float magnitude = (std::max)(1.0f, rhs.cwiseAbs().maxCoeff());
+		return (lhs - rhs).cwiseAbs().maxCoeff() <= tolerance * magnitude;
+	}
+}
+
+TEST_CASE(InverseAffineMatchesGeneralInverse)
+{
+	std::mt19937 rng(7);
+	int mismatches = 0, notIdentity = 0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		XMath::Matrix4x4 m = RandomTRS(rng, false);
+		XMath::Matrix4x4 inv = XMath::Matrix::InverseAffine(m);
+		mismatches += IsNear(inv, m.inverse(), 1e-4f) ? 0 : 1;
+		notIdentity += IsNear(inv * m, XMath::Matrix4x4::Identity(), 1e-4f) ? 0 : 1;
+	}
+	CHECK(mismatches == 0);
+	CHECK(notIdentity == 0);
+}
+
+// 镜像(负缩放)的物体同样是仿射变换
+TEST_CASE(InverseAffineHandlesNegativeScale)
+{
+	std::mt19937 rng(11);
+	int mismatches = 0, mirrored = 0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		XMath::Matrix4x4 m = RandomTRS(rng, true);
+		mirrored += m.topLeftCorner<3, 3>().determinant() < 0.0f ? 1 : 0;
+		mismatches += IsNear(XMath::Matrix::InverseAffine(m), m.inverse(), 1e-4f) ? 0 : 1;
+	}
+	CHECK(mirrored > 0);
+	CHECK(mismatches == 0);
+
+	XMath::Matrix4x4A mirror = XMath::Matrix4x4A::Identity();
+	mirror.diagonal().head<3>() = XMath::Vector3(-1.0f, 2.0f, -0.5f);
+	mirror.topRightCorner<3, 1>() = XMath::Vector3(3.0f, -4.0f, 5.0f);
+	XMath::Matrix4x4 expected = XMath::Matrix4x4::Identity();
+	expected.diagonal().head<3>() = XMath::Vector3(-1.0f, 0.5f, -2.0f);
+	expected.topRightCorner<3, 1>() = XMath::Vector3(3.0f, 2.0f, 10.0f);
+	CHECK(IsNear(XMath::Matrix::InverseAffine(mirror), expected, 1e-6f));
+}
+
+TEST_CASE(InverseAffineKeepsLastRow)
+{
+	std::mt19937 rng(13);
+	XMath::Matrix4x4 inv = XMath::Matrix::InverseAffine(RandomTRS(rng, true));
+	CHECK(inv(3, 0) == 0.0f && inv(3, 1) == 0.0f && inv(3, 2) == 0.0f && inv(3, 3) == 1.0f);
+}